@@ -0,0 +1,83 @@
+#include <algorithm>
+#include <random>
+#include <utility>
+#include <vector>
+#include "benchmark_util.hpp"
+#include "../bst.hpp"
+#include "../interval_tree.hpp"
+#include "../range_aggregate_tree.hpp"
+
+//queries of monoid augmented trees against full scans of plain binary_search_tree holding the same entries.
+//usage : augmented_tree_bench
+
+using namespace snowapril;
+
+int main() {
+    const size_t num_query = 1000U;
+    //full scans are slow, so they run fewer queries.
+    const size_t num_scan  = 20U;
+    std::mt19937 rng(0x5eed);
+    for (size_t num : { 10000U, 1000000U }) {
+        const int key_range = static_cast<int>(num) * 16;
+        std::vector<std::pair<int, int>> intervals(num);
+        for (auto& interval : intervals) {
+            interval.first  = static_cast<int>(rng() % static_cast<unsigned>(key_range));
+            interval.second = interval.first + static_cast<int>(rng() % 64U);
+        }
+        std::printf("n = %zu\n", num);
+        char name[64];
+        size_t hits = 0U;
+
+        binary_search_tree<std::pair<int, int>> plain_intervals;
+        interval_tree<int> augmented_intervals;
+        for (auto const & interval : intervals) {
+            if (!plain_intervals.contains(interval)) plain_intervals.append(interval);
+            augmented_intervals.insert(interval.first, interval.second);
+        }
+        double elapsed = bench::measure_ns([&] {
+            for (size_t i = 0U; i < num_scan; ++i) {
+                int low = static_cast<int>(rng() % static_cast<unsigned>(key_range)), high = low + 32;
+                for (auto const & interval : plain_intervals) hits += (interval.first <= high && low <= interval.second);
+            }
+        });
+        std::snprintf(name, sizeof(name), "binary_search_tree / overlap scan");
+        bench::report(name, num_scan, elapsed);
+
+        elapsed = bench::measure_ns([&] {
+            for (size_t i = 0U; i < num_query; ++i) {
+                int low = static_cast<int>(rng() % static_cast<unsigned>(key_range)), high = low + 32;
+                augmented_intervals.for_each_overlap(low, high, [&hits](std::pair<int, int> const &) { ++hits; });
+            }
+        });
+        std::snprintf(name, sizeof(name), "interval_tree / overlap query");
+        bench::report(name, num_query, elapsed);
+
+        binary_search_tree<std::pair<int, long long>> plain_entries;
+        range_aggregate_tree<int, long long> sum_tree;
+        for (auto const & interval : intervals) {
+            if (!plain_entries.contains(std::pair<int, long long>(interval.first, 0))) plain_entries.append(std::pair<int, long long>(interval.first, interval.second));
+            sum_tree.insert(interval.first, interval.second);
+        }
+        long long sum = 0;
+        elapsed = bench::measure_ns([&] {
+            for (size_t i = 0U; i < num_scan; ++i) {
+                int first = static_cast<int>(rng() % static_cast<unsigned>(key_range)), last = first + key_range / 4;
+                for (auto iter = plain_entries.lower_bound(std::pair<int, long long>(first, 0)); iter != plain_entries.end() && iter->first < last; ++iter) sum += iter->second;
+            }
+        });
+        std::snprintf(name, sizeof(name), "binary_search_tree / range sum scan");
+        bench::report(name, num_scan, elapsed);
+
+        elapsed = bench::measure_ns([&] {
+            for (size_t i = 0U; i < num_query; ++i) {
+                int first = static_cast<int>(rng() % static_cast<unsigned>(key_range)), last = first + key_range / 4;
+                sum += sum_tree.aggregate(first, last);
+            }
+        });
+        std::snprintf(name, sizeof(name), "range_aggregate_tree / range sum");
+        bench::report(name, num_query, elapsed);
+        bench::do_not_optimize(hits);
+        bench::do_not_optimize(sum);
+    }
+    return 0;
+}
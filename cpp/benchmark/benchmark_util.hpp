@@ -0,0 +1,110 @@
+#ifndef BENCHMARK_UTIL_HPP
+#define BENCHMARK_UTIL_HPP
+
+/**
+* @file      benchmark_util.hpp
+* @author    snowapril
+* @date      2026-10-17
+* @brief     minimal timing helpers shared by benchmark programs.
+* @details   each benchmark is a standalone translation unit.
+             build it with optimization, e.g. g++ -std=c++17 -O2 -I.. pool_allocator_bench.cpp
+*/
+
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstddef>
+#include <random>
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/resource.h>
+#include <unistd.h>
+#endif
+
+namespace snowapril {
+namespace bench {
+
+    //run given function once and return elapsed wall-clock time in nano seconds.
+    template <typename Function>
+    double measure_ns(Function&& _func) {
+        auto start = std::chrono::steady_clock::now();
+        _func();
+        auto end   = std::chrono::steady_clock::now();
+        return std::chrono::duration<double, std::nano>(end - start).count();
+    }
+
+    //print one result row with elapsed time per operation.
+    inline void report(char const *_name, size_t _num_ops, double _elapsed_ns) {
+        std::printf("%-40s %12zu ops %12.2f ns/op\n", _name, _num_ops, _elapsed_ns / static_cast<double>(_num_ops));
+    }
+
+    //prevent compiler from optimizing away given value.
+    template <typename Type>
+    inline void do_not_optimize(Type const & _value) {
+        asm volatile("" : : "g"(&_value) : "memory");
+    }
+
+    //return peak resident set size of this process in bytes. (0 if unsupported)
+    inline size_t peak_rss_bytes() {
+#if defined(__unix__) || defined(__APPLE__)
+        struct rusage usage;
+        if (getrusage(RUSAGE_SELF, &usage) != 0) return 0U;
+#if defined(__APPLE__)
+        return static_cast<size_t>(usage.ru_maxrss);
+#else
+        return static_cast<size_t>(usage.ru_maxrss) * 1024U;
+#endif
+#else
+        return 0U;
+#endif
+    }
+
+    //return current resident set size of this process in bytes. (0 if unsupported)
+    inline size_t current_rss_bytes() {
+#if defined(__linux__)
+        long num_page = 0L, num_resident = 0L;
+        FILE* statm = std::fopen("/proc/self/statm", "r");
+        if (statm == nullptr) return 0U;
+        if (std::fscanf(statm, "%ld %ld", &num_page, &num_resident) != 2) num_resident = 0L;
+        std::fclose(statm);
+        return static_cast<size_t>(num_resident) * static_cast<size_t>(sysconf(_SC_PAGESIZE));
+#else
+        return 0U;
+#endif
+    }
+
+    //zipfian rank generator over [0, n) with skew theta. (theta != 1)
+    //O(n) setup for zeta constant, O(1) per sample without probability table.
+    //rank 0 is the most frequent one.
+    class zipf_generator {
+    public:
+        zipf_generator(size_t _num, double _theta) : num(_num), theta(_theta) {
+            double zeta2 = 0.0;
+            for (size_t i = 1U; i <= num; ++i) {
+                zetan += 1.0 / std::pow(static_cast<double>(i), theta);
+                if (i == 2U) zeta2 = zetan;
+            }
+            if (num < 2U) zeta2 = zetan;
+            alpha = 1.0 / (1.0 - theta);
+            eta   = (1.0 - std::pow(2.0 / static_cast<double>(num), 1.0 - theta)) / (1.0 - zeta2 / zetan);
+        }
+        template <typename Engine>
+        size_t operator()(Engine& _engine) {
+            double u  = std::uniform_real_distribution<double>(0.0, 1.0)(_engine);
+            double uz = u * zetan;
+            if (uz < 1.0) return 0U;
+            if (uz < 1.0 + std::pow(0.5, theta)) return num > 1U ? 1U : 0U;
+            size_t rank = static_cast<size_t>(static_cast<double>(num) * std::pow(eta * u - eta + 1.0, alpha));
+            return rank < num ? rank : num - 1U;
+        }
+    private:
+        size_t num;
+        double theta;
+        double zetan = 0.0;
+        double alpha = 0.0;
+        double eta   = 0.0;
+    };
+}
+}
+
+#endif
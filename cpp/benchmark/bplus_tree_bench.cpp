@@ -0,0 +1,52 @@
+#include <algorithm>
+#include <random>
+#include <set>
+#include <vector>
+#include "benchmark_util.hpp"
+#include "../bplus_tree.hpp"
+
+using namespace snowapril;
+
+template <typename Tree>
+void run_index(char const *_label, std::vector<int> const & _keys, std::vector<int> const & _queries) {
+    char name[64];
+    Tree tree;
+    double elapsed = bench::measure_ns([&] { for (int key : _keys) tree.insert(key); });
+    std::snprintf(name, sizeof(name), "%s / random insert", _label);
+    bench::report(name, _keys.size(), elapsed);
+
+    size_t hits = 0U;
+    elapsed = bench::measure_ns([&] { for (int key : _queries) hits += (tree.find(key) != tree.end()); });
+    std::snprintf(name, sizeof(name), "%s / random find", _label);
+    bench::report(name, _queries.size(), elapsed);
+    bench::do_not_optimize(hits);
+
+    long long sum = 0;
+    elapsed = bench::measure_ns([&] { for (int key : tree) sum += key; });
+    std::snprintf(name, sizeof(name), "%s / ordered scan", _label);
+    bench::report(name, tree.size(), elapsed);
+    bench::do_not_optimize(sum);
+
+    elapsed = bench::measure_ns([&] { for (size_t i = 0; i < _keys.size(); i += 2) tree.erase(_keys[i]); });
+    std::snprintf(name, sizeof(name), "%s / random remove", _label);
+    bench::report(name, _keys.size() / 2U, elapsed);
+}
+
+//adapter which gives bplus_tree the std::set erase spelling used above.
+struct bplus_index : bplus_tree<int> {
+    size_type erase(int _key) { return remove(_key); }
+};
+
+int main() {
+    std::mt19937 rng(0x5eed);
+    for (size_t num : { 100000U, 1000000U, 10000000U }) {
+        std::vector<int> keys(num), queries(num);
+        for (int& key : keys)    key = static_cast<int>(rng());
+        for (int& key : queries) key = keys[rng() % num];
+
+        std::printf("n = %zu\n", num);
+        run_index<std::set<int>>("std::set", keys, queries);
+        run_index<bplus_index>("bplus_tree", keys, queries);
+    }
+    return 0;
+}
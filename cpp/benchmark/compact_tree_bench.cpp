@@ -0,0 +1,65 @@
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "benchmark_util.hpp"
+#include "../bst.hpp"
+#include "../compact_search_tree.hpp"
+
+//memory per element and speed of compact_search_tree against pointer based binary_search_tree.
+//usage : compact_tree_bench
+//memory is measured as growth of resident set size while the tree is built from random keys.
+
+using namespace snowapril;
+
+//binary_search_tree names insertion append.
+void insert_key(binary_search_tree<int>& _tree, int _key) { _tree.append(_key); }
+template <typename Tree>
+void insert_key(Tree& _tree, int _key) { _tree.insert(_key); }
+
+template <typename Tree>
+void run(char const *_label, std::vector<int> const & _keys, std::vector<int> const & _queries) {
+    char name[64];
+    size_t rss_before = bench::current_rss_bytes();
+    Tree*  tree       = new Tree();
+    double elapsed    = bench::measure_ns([&] { for (int key : _keys) insert_key(*tree, key); });
+    size_t rss_after  = bench::current_rss_bytes();
+    std::snprintf(name, sizeof(name), "%s / random insert", _label);
+    bench::report(name, _keys.size(), elapsed);
+    std::printf("%-40s %12.2f bytes/element\n", _label, static_cast<double>(rss_after - rss_before) / static_cast<double>(tree->size()));
+
+    size_t found = 0U;
+    elapsed = bench::measure_ns([&] { for (int key : _queries) found += tree->contains(key) ? 1U : 0U; });
+    std::snprintf(name, sizeof(name), "%s / random find", _label);
+    bench::report(name, _queries.size(), elapsed);
+
+    //lookup which returns iterator, so iterator state is built on every query.
+    elapsed = bench::measure_ns([&] { for (int key : _queries) found += tree->lower_bound(key) != tree->end() ? 1U : 0U; });
+    std::snprintf(name, sizeof(name), "%s / random lower_bound", _label);
+    bench::report(name, _queries.size(), elapsed);
+
+    long long sum = 0;
+    elapsed = bench::measure_ns([&] { for (int value : *tree) sum += value; });
+    std::snprintf(name, sizeof(name), "%s / in-order traversal", _label);
+    bench::report(name, tree->size(), elapsed);
+
+    elapsed = bench::measure_ns([&] { for (size_t i = 0U; i < _keys.size(); i += 2U) tree->remove(_keys[i]); });
+    std::snprintf(name, sizeof(name), "%s / random remove", _label);
+    bench::report(name, _keys.size() / 2U, elapsed);
+    bench::do_not_optimize(found);
+    bench::do_not_optimize(sum);
+    delete tree;
+}
+
+int main() {
+    std::mt19937 rng(0x5eed);
+    for (size_t num : { 10000U, 1000000U }) {
+        std::vector<int> keys(num), queries(num);
+        for (int& key : keys)    key = static_cast<int>(rng() >> 1);
+        for (int& key : queries) key = keys[rng() % num];
+        std::printf("n = %zu\n", num);
+        run<binary_search_tree<int>>("binary_search_tree", keys, queries);
+        run<compact_search_tree<int>>("compact_search_tree", keys, queries);
+        run<compact_search_tree<int, std::less<int>, true>>("compact_search_tree, parent link", keys, queries);
+    }
+    return 0;
+}
@@ -0,0 +1,93 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+#include <random>
+#include <set>
+#include <thread>
+#include <vector>
+#include "benchmark_util.hpp"
+#include "../concurrent_skip_list.hpp"
+
+//multi-writer throughput of concurrent_skip_list against mutex guarded std::set.
+//usage : concurrent_skip_list_bench [max_threads] [key_range]
+//every thread runs the same operation mix on uniformly random keys for a fixed time.
+//  insert-only : fresh keys from disjoint per-thread stripes.
+//  mixed       : 80% contains, 10% insert, 10% remove over half-full key range.
+
+using namespace snowapril;
+
+const auto run_time = std::chrono::milliseconds(1000);
+
+struct locked_set {
+    bool insert(int _key)   { std::lock_guard<std::mutex> guard(lock); return set.insert(_key).second; }
+    bool remove(int _key)   { std::lock_guard<std::mutex> guard(lock); return set.erase(_key) == 1U; }
+    bool contains(int _key) { std::lock_guard<std::mutex> guard(lock); return set.count(_key) == 1U; }
+
+    std::mutex    lock;
+    std::set<int> set;
+};
+
+struct skip_list_set {
+    bool insert(int _key)   { return list.insert(_key); }
+    bool remove(int _key)   { return list.remove(_key) == 1U; }
+    bool contains(int _key) { return list.contains(_key); }
+
+    concurrent_skip_list<int> list;
+};
+
+template <typename Set, typename Operation>
+double run_threads(Set& _set, size_t _num_threads, Operation _operation) {
+    std::atomic<bool>   stop  { false };
+    std::atomic<size_t> total { 0U };
+    std::vector<std::thread> threads;
+    for (size_t t = 0U; t < _num_threads; ++t) {
+        threads.emplace_back([&, t] {
+            std::mt19937 rng(static_cast<unsigned>(t + 1U));
+            size_t num_ops = 0U, checksum = 0U;
+            for (size_t i = 0U; !stop.load(std::memory_order_relaxed); ) {
+                for (int batch = 0; batch < 64; ++batch, ++i, ++num_ops) checksum += _operation(_set, rng, t, i);
+            }
+            bench::do_not_optimize(checksum);
+            total.fetch_add(num_ops);
+        });
+    }
+    std::this_thread::sleep_for(run_time);
+    stop = true;
+    for (std::thread& thread : threads) thread.join();
+    return static_cast<double>(total.load()) / std::chrono::duration<double>(run_time).count();
+}
+
+template <typename Set>
+void run_scaling(char const *_label, size_t _max_threads, int _key_range) {
+    for (size_t num_threads = 1U; num_threads <= _max_threads; num_threads *= 2U) {
+        double insert_rate, mixed_rate;
+        {
+            Set set;
+            insert_rate = run_threads(set, num_threads, [num_threads](Set& _set, std::mt19937&, size_t _thread, size_t _index) {
+                return _set.insert(static_cast<int>(_index * num_threads + _thread));
+            });
+        }
+        {
+            Set set;
+            std::mt19937 fill_rng(0x5eed);
+            for (int i = 0; i < _key_range / 2; ++i) set.insert(static_cast<int>(fill_rng() % static_cast<unsigned>(_key_range)));
+            mixed_rate = run_threads(set, num_threads, [_key_range](Set& _set, std::mt19937& _rng, size_t, size_t) {
+                unsigned dice = _rng() % 10U;
+                int      key  = static_cast<int>(_rng() % static_cast<unsigned>(_key_range));
+                if (dice == 0U) return _set.insert(key);
+                if (dice == 1U) return _set.remove(key);
+                return _set.contains(key);
+            });
+        }
+        std::printf("%-22s threads %3zu %14.0f insert-only ops/s %14.0f mixed ops/s\n", _label, num_threads, insert_rate, mixed_rate);
+    }
+}
+
+int main(int argc, char** argv) {
+    size_t max_threads = argc > 1 ? static_cast<size_t>(std::strtoull(argv[1], nullptr, 10)) : std::max<size_t>(1U, std::thread::hardware_concurrency());
+    int    key_range   = argc > 2 ? std::atoi(argv[2]) : 1000000;
+    run_scaling<locked_set>("mutex + std::set", max_threads, key_range);
+    run_scaling<skip_list_set>("concurrent_skip_list", max_threads, key_range);
+    return 0;
+}
@@ -0,0 +1,120 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <mutex>
+#include <random>
+#include <shared_mutex>
+#include <thread>
+#include <vector>
+#include "benchmark_util.hpp"
+#include "../bst.hpp"
+#include "../concurrent_search_tree.hpp"
+
+//read scaling of one shared index under single writer churn.
+//usage : concurrent_tree_bench [max_readers] [num_keys]
+//each row runs N reader threads doing random lookups for a fixed time while one writer thread
+//removes and re-inserts random keys, then reports total lookups per second and writer operations per second.
+
+using namespace snowapril;
+
+using key_type = int;
+const auto run_time = std::chrono::milliseconds(1000);
+
+//binary_search_tree guarded by one global mutex, the way shared index is protected today.
+struct locked_index {
+    using reader_type = locked_index*;
+    reader_type make_reader()        { return this; }
+    static bool contains(reader_type _self, key_type _key) {
+        std::lock_guard<std::mutex> guard(_self->lock);
+        return _self->tree.contains(_key);
+    }
+    void insert(key_type _key) { std::lock_guard<std::mutex> guard(lock); if (!tree.contains(_key)) tree.append(_key); }
+    void remove(key_type _key) { std::lock_guard<std::mutex> guard(lock); tree.remove(_key); }
+
+    std::mutex                   lock;
+    binary_search_tree<key_type> tree;
+};
+
+//binary_search_tree guarded by reader/writer lock.
+struct shared_locked_index {
+    using reader_type = shared_locked_index*;
+    reader_type make_reader()        { return this; }
+    static bool contains(reader_type _self, key_type _key) {
+        std::shared_lock<std::shared_mutex> guard(_self->lock);
+        return _self->tree.contains(_key);
+    }
+    void insert(key_type _key) { std::unique_lock<std::shared_mutex> guard(lock); if (!tree.contains(_key)) tree.append(_key); }
+    void remove(key_type _key) { std::unique_lock<std::shared_mutex> guard(lock); tree.remove(_key); }
+
+    std::shared_mutex            lock;
+    binary_search_tree<key_type> tree;
+};
+
+struct epoch_index {
+    using reader_type = concurrent_search_tree<key_type>::reader;
+    reader_type make_reader()        { return tree.make_reader(); }
+    static bool contains(reader_type& _reader, key_type _key) { return _reader.contains(_key); }
+    void insert(key_type _key) { tree.insert(_key); }
+    void remove(key_type _key) { tree.remove(_key); }
+
+    concurrent_search_tree<key_type> tree;
+};
+
+template <typename Index>
+void run_scaling(char const *_label, std::vector<key_type> const & _keys, size_t _max_readers) {
+    Index index;
+    for (key_type key : _keys) index.insert(key);
+
+    for (size_t num_reader = 1U; num_reader <= _max_readers; num_reader *= 2U) {
+        std::atomic<bool>   stop { false };
+        std::atomic<size_t> total_reads { 0U };
+        size_t              total_writes = 0U;
+
+        std::vector<std::thread> readers;
+        for (size_t t = 0U; t < num_reader; ++t) {
+            readers.emplace_back([&, t] {
+                auto reader = index.make_reader();
+                std::mt19937 rng(static_cast<unsigned>(t + 1U));
+                size_t reads = 0U, hits = 0U;
+                while (!stop.load(std::memory_order_relaxed)) {
+                    for (int i = 0; i < 64; ++i, ++reads) hits += Index::contains(reader, _keys[rng() % _keys.size()]);
+                }
+                bench::do_not_optimize(hits);
+                total_reads.fetch_add(reads);
+            });
+        }
+        std::thread writer([&] {
+            std::mt19937 rng(0xC0FFEE);
+            while (!stop.load(std::memory_order_relaxed)) {
+                key_type key = _keys[rng() % _keys.size()];
+                index.remove(key);
+                index.insert(key);
+                total_writes += 2U;
+            }
+        });
+
+        std::this_thread::sleep_for(run_time);
+        stop = true;
+        for (std::thread& reader : readers) reader.join();
+        writer.join();
+
+        double seconds = std::chrono::duration<double>(run_time).count();
+        std::printf("%-24s readers %3zu %14.0f reads/s %12.0f writes/s\n",
+                    _label, num_reader, static_cast<double>(total_reads.load()) / seconds, static_cast<double>(total_writes) / seconds);
+    }
+}
+
+int main(int argc, char** argv) {
+    size_t max_readers = argc > 1 ? static_cast<size_t>(std::strtoull(argv[1], nullptr, 10)) : std::max<size_t>(1U, std::thread::hardware_concurrency());
+    size_t num_keys    = argc > 2 ? static_cast<size_t>(std::strtoull(argv[2], nullptr, 10)) : 1000000U;
+
+    std::mt19937 rng(0x5eed);
+    std::vector<key_type> keys(num_keys);
+    for (key_type& key : keys) key = static_cast<key_type>(rng());
+
+    std::printf("n = %zu, one writer thread\n", num_keys);
+    run_scaling<locked_index>("mutex + bst", keys, max_readers);
+    run_scaling<shared_locked_index>("shared_mutex + bst", keys, max_readers);
+    run_scaling<epoch_index>("concurrent_search_tree", keys, max_readers);
+    return 0;
+}
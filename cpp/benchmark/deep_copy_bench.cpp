@@ -0,0 +1,50 @@
+#include <random>
+#include <vector>
+#include "benchmark_util.hpp"
+#include "../bst.hpp"
+
+//copy, size query and teardown of binary_search_tree, on random and on degenerate (one long path) shape.
+//usage : deep_copy_bench
+//every walk follows parent links, so the degenerate tree needs no stack or queue proportional to its depth.
+
+using namespace snowapril;
+
+void run(char const *_label, binary_search_tree<int> & _tree) {
+    char   name[64];
+    size_t rss_before = bench::peak_rss_bytes();
+    binary_search_tree<int>* copy = nullptr;
+    double elapsed = bench::measure_ns([&] { copy = new binary_search_tree<int>(_tree); });
+    std::snprintf(name, sizeof(name), "%s / copy", _label);
+    bench::report(name, _tree.size(), elapsed);
+
+    size_t num_node = 0U;
+    elapsed = bench::measure_ns([&] { num_node = copy->downside_begin().size(); });
+    std::snprintf(name, sizeof(name), "%s / sub-tree size", _label);
+    bench::report(name, num_node, elapsed);
+
+    elapsed = bench::measure_ns([&] { delete copy; });
+    std::snprintf(name, sizeof(name), "%s / destroy", _label);
+    bench::report(name, num_node, elapsed);
+    std::printf("%-40s %12.2f MB peak growth\n", _label, static_cast<double>(bench::peak_rss_bytes() - rss_before) / (1024.0 * 1024.0));
+}
+
+int main() {
+    std::mt19937 rng(0x5eed);
+    for (size_t num : { 10000U, 1000000U }) {
+        std::printf("n = %zu\n", num);
+        binary_search_tree<int> random_tree;
+        for (size_t i = 0U; i < num; ++i) random_tree.insert(static_cast<int>(rng() >> 1));
+        run("random shape", random_tree);
+        random_tree.clear();
+
+        //joining one node at a time makes every previous maximum the root, which gives one long path.
+        binary_search_tree<int> degenerate_tree;
+        for (size_t i = 0U; i < num; ++i) {
+            binary_search_tree<int> single;
+            single.insert(static_cast<int>(i));
+            degenerate_tree.join(std::move(single));
+        }
+        run("degenerate shape", degenerate_tree);
+    }
+    return 0;
+}
@@ -0,0 +1,54 @@
+#include <random>
+#include <string>
+#include <vector>
+#include "benchmark_util.hpp"
+#include "../bst.hpp"
+
+//copying append against moving insert, emplace and node handle reuse, with heap allocated string keys.
+//usage : emplace_bench
+
+using namespace snowapril;
+
+int main() {
+    std::mt19937 rng(0x5eed);
+    for (size_t num : { 10000U, 300000U }) {
+        //long enough to defeat small string optimization, so every copy allocates.
+        std::vector<std::string> keys(num);
+        for (std::string& key : keys) key = "record-key-" + std::to_string(rng()) + "-" + std::to_string(rng());
+        std::printf("n = %zu\n", num);
+
+        binary_search_tree<std::string> copied;
+        double elapsed = bench::measure_ns([&] { for (std::string const & key : keys) copied.append(key); });
+        bench::report("append (copy)", num, elapsed);
+
+        std::vector<std::string> moved_keys(keys);
+        binary_search_tree<std::string> moved;
+        elapsed = bench::measure_ns([&] { for (std::string& key : moved_keys) moved.insert(std::move(key)); });
+        bench::report("insert (move)", num, elapsed);
+
+        binary_search_tree<std::string> emplaced;
+        elapsed = bench::measure_ns([&] { for (std::string const & key : keys) emplaced.emplace(key.data(), key.size()); });
+        bench::report("emplace", num, elapsed);
+
+        //rename every key by extract and insert, reusing node and string buffer.
+        elapsed = bench::measure_ns([&] {
+            for (std::string const & key : keys) {
+                auto handle = moved.extract(key);
+                handle.value().back() = '#';
+                moved.insert(std::move(handle));
+            }
+        });
+        bench::report("extract, modify, insert", num, elapsed);
+
+        elapsed = bench::measure_ns([&] {
+            for (std::string const & key : keys) {
+                std::string renamed = key;
+                renamed.back() = '#';
+                copied.remove(key);
+                copied.append(renamed);
+            }
+        });
+        bench::report("remove, append", num, elapsed);
+    }
+    return 0;
+}
@@ -0,0 +1,67 @@
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "benchmark_util.hpp"
+#include "../bst.hpp"
+#include "../static_search_tree.hpp"
+
+//one find per key against find_batch, which walks a group of searches in lockstep with prefetch,
+//and sorted find_batch, which resumes each search from the path of previous one.
+//usage : find_batch_bench
+
+using namespace snowapril;
+
+template <typename Tree, typename Iterator>
+void run_find(char const * _label, Tree const & _tree, std::vector<int> const & _queries, std::vector<Iterator>& _out) {
+    double elapsed = bench::measure_ns([&] {
+        _out.clear();
+        for (int query : _queries) _out.push_back(_tree.find(query));
+    });
+    bench::do_not_optimize(_out.data());
+    bench::report(_label, _queries.size(), elapsed);
+}
+
+template <typename Tree, typename Iterator>
+void run_batch(char const * _label, Tree const & _tree, std::vector<int> const & _queries, std::vector<Iterator>& _out) {
+    double elapsed = bench::measure_ns([&] {
+        _out.clear();
+        _tree.find_batch(_queries.begin(), _queries.end(), std::back_inserter(_out));
+    });
+    bench::do_not_optimize(_out.data());
+    bench::report(_label, _queries.size(), elapsed);
+}
+
+int main() {
+    std::mt19937 rng(0x5eed);
+    size_t num_query = 1000000U;
+    for (size_t num_key : { 10000U, 1000000U, 4000000U }) {
+        std::vector<int> keys(num_key);
+        for (int& key : keys) key = static_cast<int>(rng());
+        std::vector<int> queries(num_query);
+        for (int& query : queries) query = keys[rng() % num_key];
+        std::vector<int> sorted_queries(queries);
+        std::sort(sorted_queries.begin(), sorted_queries.end());
+
+        binary_search_tree<int> tree;
+        for (int key : keys) tree.insert(key);
+        static_search_tree<int> static_tree(tree);
+        std::vector<binary_search_tree<int>::inorder_iterator> tree_out;
+        std::vector<static_search_tree<int>::iterator> static_out;
+        tree_out.reserve(num_query);
+        static_out.reserve(num_query);
+
+        std::printf("n = %zu\n", num_key);
+        run_find("binary_search_tree find", tree, queries, tree_out);
+        run_batch("binary_search_tree find_batch", tree, queries, tree_out);
+        run_find("binary_search_tree find, sorted", tree, sorted_queries, tree_out);
+        double elapsed = bench::measure_ns([&] {
+            tree_out.clear();
+            tree.find_batch(sorted_input, sorted_queries.begin(), sorted_queries.end(), std::back_inserter(tree_out));
+        });
+        bench::do_not_optimize(tree_out.data());
+        bench::report("binary_search_tree find_batch, sorted", num_query, elapsed);
+        run_find("static_search_tree find", static_tree, queries, static_out);
+        run_batch("static_search_tree find_batch", static_tree, queries, static_out);
+    }
+    return 0;
+}
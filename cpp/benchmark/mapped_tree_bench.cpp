@@ -0,0 +1,46 @@
+#include <cstdio>
+#include <random>
+#include <string>
+#include <vector>
+#include "benchmark_util.hpp"
+#include "../bst.hpp"
+#include "../mapped_search_tree.hpp"
+
+//startup cost of rebuilding binary_search_tree by append against opening saved tree with mmap.
+//usage : mapped_tree_bench [file path, default mapped_tree_bench.idx]
+//the file is removed at exit. lookups on the mapped tree fault its pages in lazily.
+
+using namespace snowapril;
+
+int main(int argc, char** argv) {
+    std::string  path = argc > 1 ? argv[1] : "mapped_tree_bench.idx";
+    std::mt19937 rng(0x5eed);
+    for (size_t num : { 10000U, 1000000U }) {
+        std::vector<int> keys(num), queries(num);
+        for (int& key : keys)    key = static_cast<int>(rng() >> 1);
+        for (int& key : queries) key = keys[rng() % num];
+        std::printf("n = %zu\n", num);
+
+        binary_search_tree<int> rebuilt;
+        double elapsed = bench::measure_ns([&] { for (int key : keys) rebuilt.append(key); });
+        bench::report("binary_search_tree / rebuild by append", num, elapsed);
+
+        elapsed = bench::measure_ns([&] { save_mapped_tree(path, rebuilt); });
+        bench::report("save_mapped_tree", num, elapsed);
+
+        mapped_search_tree<int> mapped;
+        elapsed = bench::measure_ns([&] { mapped = mapped_search_tree<int>(path); });
+        std::printf("%-40s %12.2f us total\n", "mapped_search_tree / open", elapsed / 1000.0);
+
+        size_t found = 0U;
+        elapsed = bench::measure_ns([&] { for (int key : queries) found += mapped.contains(key) ? 1U : 0U; });
+        bench::report("mapped_search_tree / first lookups", num, elapsed);
+        elapsed = bench::measure_ns([&] { for (int key : queries) found += mapped.contains(key) ? 1U : 0U; });
+        bench::report("mapped_search_tree / resident lookups", num, elapsed);
+        elapsed = bench::measure_ns([&] { for (int key : queries) found += rebuilt.contains(key) ? 1U : 0U; });
+        bench::report("binary_search_tree / lookups", num, elapsed);
+        bench::do_not_optimize(found);
+    }
+    std::remove(path.c_str());
+    return 0;
+}
@@ -0,0 +1,66 @@
+#include <algorithm>
+#include <iterator>
+#include <random>
+#include <vector>
+#include "benchmark_util.hpp"
+#include "../bst.hpp"
+
+//order statistic queries of order_statistic_tree against linear scans of plain binary_search_tree.
+//usage : order_statistic_bench
+//also reports the cost of keeping subtree size on random insert and remove.
+
+using namespace snowapril;
+
+template <typename Tree>
+void run_updates(char const *_label, std::vector<int> const & _keys) {
+    char name[64];
+    Tree tree;
+    double elapsed = bench::measure_ns([&] { for (int key : _keys) tree.append(key); });
+    std::snprintf(name, sizeof(name), "%s / random insert", _label);
+    bench::report(name, _keys.size(), elapsed);
+
+    elapsed = bench::measure_ns([&] { for (size_t i = 0U; i < _keys.size(); i += 2U) tree.remove(_keys[i]); });
+    std::snprintf(name, sizeof(name), "%s / random remove", _label);
+    bench::report(name, _keys.size() / 2U, elapsed);
+}
+
+int main() {
+    std::mt19937 rng(0x5eed);
+    for (size_t num : { 10000U, 1000000U }) {
+        std::vector<int> keys(num);
+        for (int& key : keys) key = static_cast<int>(rng() >> 1);
+        std::printf("n = %zu\n", num);
+        run_updates<binary_search_tree<int>>("binary_search_tree", keys);
+        run_updates<order_statistic_tree<int>>("order_statistic_tree", keys);
+
+        std::vector<int> sorted_keys(keys);
+        std::sort(sorted_keys.begin(), sorted_keys.end());
+        binary_search_tree<int>   plain(sorted_input, sorted_keys.begin(), sorted_keys.end());
+        order_statistic_tree<int> counted(sorted_input, sorted_keys.begin(), sorted_keys.end());
+        const size_t num_query = 1000U;
+        char name[64];
+        size_t sum = 0U;
+
+        double elapsed = bench::measure_ns([&] {
+            for (size_t i = 0U; i < num_query; ++i) sum += static_cast<size_t>(std::distance(plain.begin(), plain.lower_bound(keys[rng() % num])));
+        });
+        std::snprintf(name, sizeof(name), "binary_search_tree / rank by scan");
+        bench::report(name, num_query, elapsed);
+
+        elapsed = bench::measure_ns([&] { for (size_t i = 0U; i < num_query; ++i) sum += counted.rank(keys[rng() % num]); });
+        std::snprintf(name, sizeof(name), "order_statistic_tree / rank");
+        bench::report(name, num_query, elapsed);
+
+        elapsed = bench::measure_ns([&] {
+            for (size_t i = 0U; i < num_query; ++i) sum += static_cast<size_t>(*std::next(plain.begin(), static_cast<ptrdiff_t>(rng() % plain.size())));
+        });
+        std::snprintf(name, sizeof(name), "binary_search_tree / select by scan");
+        bench::report(name, num_query, elapsed);
+
+        elapsed = bench::measure_ns([&] { for (size_t i = 0U; i < num_query; ++i) sum += static_cast<size_t>(*counted.select(rng() % counted.size())); });
+        std::snprintf(name, sizeof(name), "order_statistic_tree / select");
+        bench::report(name, num_query, elapsed);
+        bench::do_not_optimize(sum);
+    }
+    return 0;
+}
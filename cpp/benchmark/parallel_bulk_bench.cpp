@@ -0,0 +1,104 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <random>
+#include <thread>
+#include <vector>
+#include "benchmark_util.hpp"
+#include "../bst.hpp"
+
+//sequential against parallel bulk operations of binary_search_tree.
+//usage : parallel_bulk_bench [num_keys] [max_threads]
+//each row group runs build, deep copy, full traversal, union of two trees and teardown,
+//first with the sequential members and then on task_pool of 1, 2, 4 ... threads.
+
+using namespace snowapril;
+
+using tree_type = binary_search_tree<long long>;
+
+void run_sequential(std::vector<long long> const & _keys, std::vector<long long> const & _other_keys) {
+    char name[64];
+    tree_type tree;
+    double elapsed = bench::measure_ns([&] { tree.bulk_load(_keys.begin(), _keys.end()); });
+    std::snprintf(name, sizeof(name), "sequential / build");
+    bench::report(name, _keys.size(), elapsed);
+
+    elapsed = bench::measure_ns([&] { tree_type copy(tree); bench::do_not_optimize(copy.size()); });
+    std::snprintf(name, sizeof(name), "sequential / copy + destroy");
+    bench::report(name, _keys.size(), elapsed);
+
+    long long sum = 0;
+    elapsed = bench::measure_ns([&] { for (long long key : tree) sum += key; });
+    std::snprintf(name, sizeof(name), "sequential / for each");
+    bench::report(name, _keys.size(), elapsed);
+    bench::do_not_optimize(sum);
+
+    tree_type other;
+    other.bulk_load(_other_keys.begin(), _other_keys.end());
+    elapsed = bench::measure_ns([&] {
+        for (long long key : other) {
+            if (!tree.contains(key)) tree.append(key);
+        }
+    });
+    std::snprintf(name, sizeof(name), "sequential / union by insert");
+    bench::report(name, _other_keys.size(), elapsed);
+
+    elapsed = bench::measure_ns([&] { tree.clear(); });
+    std::snprintf(name, sizeof(name), "sequential / clear");
+    bench::report(name, _keys.size() + _other_keys.size(), elapsed);
+}
+
+void run_parallel(size_t _num_threads, std::vector<long long> const & _keys, std::vector<long long> const & _other_keys) {
+    char name[64];
+    task_pool pool(_num_threads - 1U);
+    tree_type tree;
+    double elapsed = bench::measure_ns([&] { tree.parallel_bulk_load(pool, _keys.begin(), _keys.end()); });
+    std::snprintf(name, sizeof(name), "%zu threads / build", _num_threads);
+    bench::report(name, _keys.size(), elapsed);
+
+    elapsed = bench::measure_ns([&] {
+        tree_type copy;
+        copy.parallel_copy(pool, tree);
+        copy.parallel_clear(pool);
+    });
+    std::snprintf(name, sizeof(name), "%zu threads / copy + destroy", _num_threads);
+    bench::report(name, _keys.size(), elapsed);
+
+    std::atomic<long long> sum { 0 };
+    elapsed = bench::measure_ns([&] {
+        tree.parallel_for_each(pool, [&sum](long long _key) { sum.fetch_add(_key, std::memory_order_relaxed); });
+    });
+    std::snprintf(name, sizeof(name), "%zu threads / for each", _num_threads);
+    bench::report(name, _keys.size(), elapsed);
+    bench::do_not_optimize(sum.load());
+
+    tree_type other;
+    other.parallel_bulk_load(pool, _other_keys.begin(), _other_keys.end());
+    elapsed = bench::measure_ns([&] { tree.parallel_union(pool, std::move(other)); });
+    std::snprintf(name, sizeof(name), "%zu threads / union", _num_threads);
+    bench::report(name, _other_keys.size(), elapsed);
+
+    elapsed = bench::measure_ns([&] { tree.parallel_clear(pool); });
+    std::snprintf(name, sizeof(name), "%zu threads / clear", _num_threads);
+    bench::report(name, _keys.size() + _other_keys.size(), elapsed);
+}
+
+int main(int argc, char** argv) {
+    size_t num_keys    = argc > 1 ? static_cast<size_t>(std::strtoull(argv[1], nullptr, 10)) : 10000000U;
+    size_t max_threads = argc > 2 ? static_cast<size_t>(std::strtoull(argv[2], nullptr, 10)) : std::max<size_t>(1U, std::thread::hardware_concurrency());
+
+    //two sorted key sets which overlap by half.
+    std::mt19937_64 rng(0x5eed);
+    std::vector<long long> keys(num_keys), other_keys(num_keys);
+    for (long long& key : keys)       key = static_cast<long long>(rng() >> 1);
+    for (size_t i = 0U; i < num_keys; ++i) other_keys[i] = (i % 2U) ? keys[i] : static_cast<long long>(rng() >> 1);
+    std::sort(keys.begin(), keys.end());
+    std::sort(other_keys.begin(), other_keys.end());
+
+    std::printf("n = %zu\n", num_keys);
+    run_sequential(keys, other_keys);
+    for (size_t num_threads = 1U; num_threads <= max_threads; num_threads *= 2U) {
+        run_parallel(num_threads, keys, other_keys);
+    }
+    return 0;
+}
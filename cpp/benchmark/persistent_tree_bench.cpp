@@ -0,0 +1,98 @@
+#include <random>
+#include <vector>
+#include "benchmark_util.hpp"
+#include "../bst.hpp"
+#include "../persistent_search_tree.hpp"
+#include "../red_black_tree.hpp"
+
+//snapshot of persistent_search_tree against deep copy of binary_search_tree, and cost of update with and without
+//live snapshot. with a snapshot taken before every update, each update copies its whole path.
+//usage : persistent_tree_bench
+
+using namespace snowapril;
+
+//node allocator which counts live nodes, to show how many nodes an update allocates.
+static size_t num_live_node = 0U;
+
+template <typename Type>
+struct counting_allocator : std::allocator<Type> {
+    template <typename Other>
+    struct rebind { using other = counting_allocator<Other>; };
+    counting_allocator() = default;
+    template <typename Other>
+    counting_allocator(counting_allocator<Other> const &) { }
+    Type* allocate(size_t _num) { num_live_node += _num; return std::allocator<Type>::allocate(_num); }
+    void  deallocate(Type* _ptr, size_t _num) { num_live_node -= _num; std::allocator<Type>::deallocate(_ptr, _num); }
+};
+
+using counted_tree = persistent_search_tree<int, std::less<int>, counting_allocator<persistent_node_<int>>>;
+
+int main() {
+    std::mt19937 rng(0x5eed);
+    size_t num_update = 200000U;
+    for (size_t num_key : { 100000U, 1000000U }) {
+        std::vector<int> keys(num_key);
+        for (int& key : keys) key = static_cast<int>(rng());
+        std::vector<int> updates(num_update);
+        for (int& update : updates) update = static_cast<int>(rng());
+        std::printf("n = %zu\n", num_key);
+
+        binary_search_tree<int> bst_tree;
+        counted_tree            tree;
+        for (int key : keys) {
+            bst_tree.insert(key);
+            tree.insert(key);
+        }
+        size_t num_snapshot = 100U;
+        double elapsed = bench::measure_ns([&] {
+            for (size_t i = 0U; i < num_snapshot / 10U; ++i) bench::do_not_optimize(binary_search_tree<int>(bst_tree).size());
+        });
+        bench::report("binary_search_tree deep copy", num_snapshot / 10U, elapsed);
+        elapsed = bench::measure_ns([&] {
+            for (size_t i = 0U; i < num_snapshot; ++i) bench::do_not_optimize(tree.snapshot().size());
+        });
+        bench::report("persistent_search_tree snapshot", num_snapshot, elapsed);
+
+        red_black_tree<int> rb_tree(keys.begin(), keys.end());
+        elapsed = bench::measure_ns([&] {
+            for (int update : updates) rb_tree.insert(update);
+            for (int update : updates) rb_tree.remove(update);
+        });
+        bench::report("red_black_tree insert + remove", 2U * num_update, elapsed);
+
+        elapsed = bench::measure_ns([&] {
+            for (int update : updates) tree.insert(update);
+            for (int update : updates) tree.remove(update);
+        });
+        bench::report("persistent, no snapshot", 2U * num_update, elapsed);
+
+        //every update keeps the version before it alive until the next one, like a reader holding a snapshot.
+        size_t num_allocated = 0U;
+        elapsed = bench::measure_ns([&] {
+            counted_tree last_version;
+            for (int update : updates) {
+                last_version = tree.snapshot();
+                size_t live = num_live_node;
+                tree.insert(update);
+                num_allocated += num_live_node - live;
+            }
+            for (int update : updates) {
+                last_version = tree.snapshot();
+                tree.remove(update);
+            }
+        });
+        bench::report("persistent, snapshot per update", 2U * num_update, elapsed);
+        std::printf("  nodes allocated per insert : %.1f (height %zu)\n",
+                    static_cast<double>(num_allocated) / static_cast<double>(num_update), tree.height());
+
+        std::vector<int> queries(num_update);
+        for (int& query : queries) query = keys[rng() % num_key];
+        size_t found = 0U;
+        elapsed = bench::measure_ns([&] { for (int query : queries) found += rb_tree.contains(query) ? 1U : 0U; });
+        bench::report("red_black_tree lookup", num_update, elapsed);
+        elapsed = bench::measure_ns([&] { for (int query : queries) found += tree.contains(query) ? 1U : 0U; });
+        bench::report("persistent_search_tree lookup", num_update, elapsed);
+        bench::do_not_optimize(found);
+    }
+    return 0;
+}
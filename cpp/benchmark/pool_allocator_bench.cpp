@@ -0,0 +1,49 @@
+#include <algorithm>
+#include <optional>
+#include <random>
+#include <vector>
+#include "benchmark_util.hpp"
+#include "../bst.hpp"
+#include "../pool_allocator.hpp"
+
+using namespace snowapril;
+
+template <typename Tree>
+void run_churn(char const *_label, std::vector<int> const & _keys) {
+    char name[64];
+    double elapsed;
+    {
+        //teardown is timed by destroying the only owner of every node and of the pool.
+        std::optional<Tree> holder(std::in_place);
+        Tree& tree = *holder;
+        elapsed = bench::measure_ns([&] { for (int key : _keys) tree.append(key); });
+        std::snprintf(name, sizeof(name), "%s / append", _label);
+        bench::report(name, _keys.size(), elapsed);
+
+        elapsed = bench::measure_ns([&] {
+            for (size_t i = 0; i < _keys.size(); i += 2) tree.remove(_keys[i]);
+            for (size_t i = 0; i < _keys.size(); i += 2) tree.append(_keys[i]);
+        });
+        std::snprintf(name, sizeof(name), "%s / remove+append churn", _label);
+        bench::report(name, _keys.size(), elapsed);
+        bench::do_not_optimize(tree.size());
+
+        elapsed = bench::measure_ns([&] { holder.reset(); });
+        std::snprintf(name, sizeof(name), "%s / teardown", _label);
+        bench::report(name, _keys.size(), elapsed);
+    }
+}
+
+int main() {
+    std::mt19937 rng(0x5eed);
+    for (size_t num : { 10000U, 100000U, 1000000U }) {
+        std::vector<int> keys(num);
+        for (size_t i = 0; i < num; ++i) keys[i] = static_cast<int>(i);
+        std::shuffle(keys.begin(), keys.end(), rng);
+
+        std::printf("n = %zu\n", num);
+        run_churn<binary_search_tree<int>>("std::allocator", keys);
+        run_churn<binary_search_tree<int, std::less<int>, pool_allocator<bst_node_<int>>>>("pool_allocator", keys);
+    }
+    return 0;
+}
@@ -0,0 +1,88 @@
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "benchmark_util.hpp"
+#include "../quad_tree.hpp"
+
+using namespace snowapril;
+
+using tree_type  = quad_tree<unsigned, double>;
+using entry_type = tree_type::value_type;
+using rect_type  = tree_type::rect_type;
+using point_type = tree_type::point_type;
+
+int main() {
+    std::mt19937 rng(0x5eed);
+    std::uniform_real_distribution<double> coord(0.0, 1000.0);
+    rect_type world{ 0.0, 0.0, 1000.0, 1000.0 };
+
+    for (size_t num : { 100000U, 1000000U }) {
+        std::vector<entry_type> entries(num);
+        for (size_t i = 0; i < num; ++i) entries[i] = entry_type{ point_type{ coord(rng), coord(rng) }, static_cast<unsigned>(i) };
+
+        std::printf("n = %zu\n", num);
+        tree_type tree(world, 32U);
+        double elapsed = bench::measure_ns([&] { tree.insert(entries.begin(), entries.end()); });
+        bench::report("quad_tree / bulk insert", num, elapsed);
+
+        const size_t num_query = 2000U;
+        std::vector<rect_type>  rects(num_query);
+        std::vector<point_type> points(num_query);
+        for (size_t i = 0; i < num_query; ++i) {
+            double x = coord(rng), y = coord(rng);
+            rects[i]  = rect_type{ x, y, x + 10.0, y + 10.0 };
+            points[i] = point_type{ x, y };
+        }
+
+        size_t checksum = 0U;
+        elapsed = bench::measure_ns([&] {
+            tree.query_range_batch(rects.begin(), rects.end(), [&checksum](size_t, entry_type const & _entry) { checksum += _entry.value; });
+        });
+        std::printf("%-40s %12.0f queries/s\n", "quad_tree / range", num_query / (elapsed * 1e-9));
+
+        size_t linear_checksum = 0U;
+        elapsed = bench::measure_ns([&] {
+            for (rect_type const & rect : rects)
+                for (entry_type const & entry : entries)
+                    if (rect.contains(entry.point)) linear_checksum += entry.value;
+        });
+        std::printf("%-40s %12.0f queries/s\n", "linear scan / range", num_query / (elapsed * 1e-9));
+        if (checksum != linear_checksum) std::printf("range checksum mismatch!\n");
+
+        std::vector<entry_type> found;
+        elapsed = bench::measure_ns([&] {
+            for (point_type const & point : points) tree.query_radius(point, 5.0, std::back_inserter(found));
+        });
+        std::printf("%-40s %12.0f queries/s\n", "quad_tree / radius", num_query / (elapsed * 1e-9));
+        bench::do_not_optimize(found);
+
+        double knn_checksum = 0.0;
+        elapsed = bench::measure_ns([&] {
+            for (point_type const & point : points) knn_checksum += tree.nearest(point, 8U).back().point.x;
+        });
+        std::printf("%-40s %12.0f queries/s\n", "quad_tree / 8-nearest", num_query / (elapsed * 1e-9));
+
+        const size_t num_linear_knn = 50U;
+        double linear_knn_checksum = 0.0, sampled_checksum = 0.0;
+        std::vector<std::pair<double, size_t>> dist(num);
+        elapsed = bench::measure_ns([&] {
+            for (size_t q = 0; q < num_linear_knn; ++q) {
+                for (size_t i = 0; i < num; ++i) {
+                    double dx = entries[i].point.x - points[q].x, dy = entries[i].point.y - points[q].y;
+                    dist[i] = std::make_pair(dx * dx + dy * dy, i);
+                }
+                std::nth_element(dist.begin(), dist.begin() + 7, dist.end());
+                linear_knn_checksum += std::max_element(dist.begin(), dist.begin() + 8)->first;
+            }
+        });
+        std::printf("%-40s %12.0f queries/s\n", "linear scan / 8-nearest", num_linear_knn / (elapsed * 1e-9));
+        for (size_t q = 0; q < num_linear_knn; ++q) {
+            entry_type last = tree.nearest(points[q], 8U).back();
+            double dx = last.point.x - points[q].x, dy = last.point.y - points[q].y;
+            sampled_checksum += dx * dx + dy * dy;
+        }
+        if (std::abs(sampled_checksum - linear_knn_checksum) > 1e-6) std::printf("k-nearest checksum mismatch!\n");
+        bench::do_not_optimize(knn_checksum);
+    }
+    return 0;
+}
@@ -0,0 +1,61 @@
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "benchmark_util.hpp"
+#include "../bst.hpp"
+
+//node reusing set algebra of binary_search_tree against appending elements one by one.
+//usage : set_algebra_bench
+//a balanced tree of n keys is merged with balanced trees of m keys for growing m, half of which are already in the big one.
+
+using namespace snowapril;
+
+using tree_type = binary_search_tree<int>;
+
+tree_type make_tree(std::vector<int> _keys) {
+    std::sort(_keys.begin(), _keys.end());
+    tree_type tree;
+    tree.bulk_load(_keys.begin(), _keys.end());
+    return tree;
+}
+
+int main() {
+    const size_t     num_keys = 1000000U;
+    std::mt19937     rng(0x5eed);
+    std::vector<int> keys(num_keys);
+    for (int& key : keys) key = static_cast<int>(rng());
+
+    for (size_t num_small : { 100U, 10000U, 1000000U }) {
+        std::vector<int> small_keys(num_small);
+        for (size_t i = 0U; i < num_small; ++i) small_keys[i] = (i % 2U) ? keys[rng() % num_keys] : static_cast<int>(rng());
+        char name[64];
+        std::printf("n = %zu, m = %zu\n", num_keys, num_small);
+
+        tree_type big = make_tree(keys), small = make_tree(small_keys);
+        double elapsed = bench::measure_ns([&] {
+            for (int key : small) {
+                if (!big.contains(key)) big.append(key);
+            }
+        });
+        std::snprintf(name, sizeof(name), "append one by one / union");
+        bench::report(name, num_small, elapsed);
+
+        big = make_tree(keys), small = make_tree(small_keys);
+        elapsed = bench::measure_ns([&] { big.set_union(std::move(small)); });
+        std::snprintf(name, sizeof(name), "set_union");
+        bench::report(name, num_small, elapsed);
+
+        big = make_tree(keys), small = make_tree(small_keys);
+        elapsed = bench::measure_ns([&] { big.set_intersection(std::move(small)); });
+        std::snprintf(name, sizeof(name), "set_intersection");
+        bench::report(name, num_small, elapsed);
+        bench::do_not_optimize(big.size());
+
+        big = make_tree(keys), small = make_tree(small_keys);
+        elapsed = bench::measure_ns([&] { big.set_difference(std::move(small)); });
+        std::snprintf(name, sizeof(name), "set_difference");
+        bench::report(name, num_small, elapsed);
+        bench::do_not_optimize(big.size());
+    }
+    return 0;
+}
@@ -0,0 +1,63 @@
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "benchmark_util.hpp"
+#include "../bst.hpp"
+#include "../red_black_tree.hpp"
+#include "../splay_tree.hpp"
+
+//lookup under uniform and zipfian key popularity. splay tree keeps hot keys near the root, static shape does not.
+//average number of visited nodes per lookup is taken from counting_tree_stats_.
+//usage : splay_tree_bench
+
+using namespace snowapril;
+
+using counted_bst   = binary_search_tree<int, std::less<int>, std::allocator<bst_node_<int>>, counting_tree_stats_>;
+using counted_splay = splay_tree<int, std::less<int>, std::allocator<bst_node_<int>>, counting_tree_stats_>;
+
+template <typename Tree>
+void run(char const * _label, std::vector<int> const & _keys, std::vector<int> const & _queries) {
+    Tree tree;
+    for (int key : _keys) tree.insert(key);
+    size_t found = 0U;
+    double elapsed = bench::measure_ns([&] { for (int query : _queries) found += tree.contains(query) ? 1U : 0U; });
+    bench::do_not_optimize(found);
+    bench::report(_label, _queries.size(), elapsed);
+}
+
+template <typename Tree>
+double average_path(std::vector<int> const & _keys, std::vector<int> const & _queries) {
+    Tree tree;
+    for (int key : _keys) tree.insert(key);
+    tree.reset_stats();
+    for (int query : _queries) bench::do_not_optimize(tree.contains(query));
+    return tree.stats().average_path_length();
+}
+
+int main() {
+    std::mt19937 rng(0x5eed);
+    size_t num_query = 1000000U;
+    for (size_t num_key : { 100000U, 1000000U }) {
+        std::vector<int> keys(num_key);
+        for (int& key : keys) key = static_cast<int>(rng());
+        //popularity rank is independent of key order, so hot keys are scattered over the tree.
+        std::vector<int> ranked_keys(keys);
+        std::shuffle(ranked_keys.begin(), ranked_keys.end(), rng);
+
+        std::vector<int> uniform_queries(num_query), zipf_queries(num_query);
+        for (int& query : uniform_queries) query = keys[rng() % num_key];
+        bench::zipf_generator zipf(num_key, 0.99);
+        for (int& query : zipf_queries) query = ranked_keys[zipf(rng)];
+
+        for (auto const & workload : { std::make_pair("uniform", &uniform_queries), std::make_pair("zipf(0.99)", &zipf_queries) }) {
+            std::vector<int> const & queries = *workload.second;
+            std::printf("n = %zu, %s lookup\n", num_key, workload.first);
+            run<binary_search_tree<int>>("binary_search_tree", keys, queries);
+            run<red_black_tree<int>>("red_black_tree", keys, queries);
+            run<splay_tree<int>>("splay_tree", keys, queries);
+            std::printf("  average path : binary_search_tree %.1f, splay_tree %.1f nodes\n",
+                        average_path<counted_bst>(keys, queries), average_path<counted_splay>(keys, queries));
+        }
+    }
+    return 0;
+}
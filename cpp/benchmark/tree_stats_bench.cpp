@@ -0,0 +1,77 @@
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "benchmark_util.hpp"
+#include "../bplus_tree.hpp"
+#include "../bst.hpp"
+#include "../red_black_tree.hpp"
+
+//cost of statistics policy on insert and lookup, and path histogram of random against degenerate insertion order.
+//balancing trees fed the same ascending keys report the rotations, splits and merges that keep their paths short.
+//usage : tree_stats_bench
+
+using namespace snowapril;
+
+template <typename Tree>
+void run(char const * _label, std::vector<int> const & _keys, std::vector<int> const & _queries) {
+    Tree tree;
+    double elapsed = bench::measure_ns([&] { for (int key : _keys) tree.insert(key); });
+    bench::report((std::string(_label) + " insert").c_str(), _keys.size(), elapsed);
+    size_t found = 0U;
+    elapsed = bench::measure_ns([&] { for (int query : _queries) found += tree.contains(query) ? 1U : 0U; });
+    bench::do_not_optimize(found);
+    bench::report((std::string(_label) + " lookup").c_str(), _queries.size(), elapsed);
+}
+
+void print_histogram(char const * _label, tree_stats_snapshot const & _stats) {
+    std::printf("%s : max depth %llu, average path %.1f, %llu comparisons\n", _label,
+                static_cast<unsigned long long>(_stats.max_depth), _stats.average_path_length(),
+                static_cast<unsigned long long>(_stats.num_compare));
+    for (size_t bucket = 0U; bucket < tree_stats_snapshot::num_path_bucket; ++bucket) {
+        if (_stats.path_histogram[bucket] == 0U) continue;
+        size_t low = bucket ? static_cast<size_t>(1U) << (bucket - 1U) : 0U;
+        std::printf("  path [%zu, %zu) : %llu\n", low, bucket ? low * 2U : 1U, static_cast<unsigned long long>(_stats.path_histogram[bucket]));
+    }
+}
+
+int main() {
+    std::printf("binary_search_tree %zu bytes, instrumented_search_tree %zu bytes\n",
+                sizeof(binary_search_tree<int>), sizeof(instrumented_search_tree<int>));
+    std::mt19937 rng(0x5eed);
+    for (size_t num : { 100000U, 1000000U }) {
+        std::vector<int> keys(num);
+        for (int& key : keys) key = static_cast<int>(rng());
+        std::vector<int> queries(keys);
+        std::shuffle(queries.begin(), queries.end(), rng);
+        std::printf("n = %zu\n", num);
+        run<binary_search_tree<int>>("no_tree_stats_", keys, queries);
+        run<instrumented_search_tree<int>>("counting_tree_stats_", keys, queries);
+    }
+
+    //degenerating tree shows up in high buckets long before average latency does.
+    size_t num = 2000U;
+    instrumented_search_tree<int> random_tree, degenerate_tree;
+    for (size_t i = 0U; i < num; ++i) {
+        random_tree.insert(static_cast<int>(rng()));
+        degenerate_tree.insert(static_cast<int>(i));
+    }
+    print_histogram("random order", random_tree.stats());
+    print_histogram("ascending order", degenerate_tree.stats());
+
+    red_black_tree<int, std::less<int>, std::allocator<rb_node_<int>>, counting_tree_stats_> rb_tree;
+    bplus_tree<int, std::less<int>, std::allocator<int>, counting_tree_stats_>                bplus;
+    for (size_t i = 0U; i < num; ++i) {
+        rb_tree.insert(static_cast<int>(i));
+        bplus.insert(static_cast<int>(i));
+    }
+    for (size_t i = 0U; i < num; i += 2U) {
+        rb_tree.remove(static_cast<int>(i));
+        bplus.remove(static_cast<int>(i));
+    }
+    print_histogram("red_black_tree ascending order", rb_tree.stats());
+    std::printf("  %llu rotations\n", static_cast<unsigned long long>(rb_tree.stats().num_rotation));
+    print_histogram("bplus_tree ascending order", bplus.stats());
+    std::printf("  %llu splits, %llu merges, %llu borrows\n", static_cast<unsigned long long>(bplus.stats().num_split),
+                static_cast<unsigned long long>(bplus.stats().num_merge), static_cast<unsigned long long>(bplus.stats().num_rotation));
+    return 0;
+}
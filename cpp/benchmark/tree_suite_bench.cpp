@@ -0,0 +1,265 @@
+#include <algorithm>
+#include <cstdlib>
+#include <cstring>
+#include <numeric>
+#include <random>
+#include <set>
+#include <type_traits>
+#include <vector>
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/wait.h>
+#endif
+#include "benchmark_util.hpp"
+#include "../bst.hpp"
+#include "../red_black_tree.hpp"
+#include "../bplus_tree.hpp"
+#include "../splay_tree.hpp"
+#include "../compact_search_tree.hpp"
+#include "../persistent_search_tree.hpp"
+#include "../static_search_tree.hpp"
+#include "../concurrent_search_tree.hpp"
+#include "../concurrent_skip_list.hpp"
+
+//whole-suite comparison of tree containers against std::set.
+//usage : tree_suite_bench [max_size] [container filter]
+//every (container, distribution, size) case runs in a forked child process on POSIX,
+//so peak RSS column belongs to that case only. it includes generated key vectors.
+//bytes/elem is growth of resident set while building the container divided by the number of stored keys.
+//static_search_tree is built from the whole key vector at once and cannot remove, concurrent containers cannot
+//be copied, and copy of persistent_search_tree is O(1) snapshot. columns which do not apply print '-'.
+//concurrent containers run from one thread here. (see concurrent_tree_bench for scaling with threads)
+
+using namespace snowapril;
+
+using key_type = int;
+
+using key_vector = std::vector<key_type>;
+
+//uniform spelling of build / erase / lookup / traversal for each container. specializations below override only
+//what their container spells differently. lookup takes mutable tree because splay_tree restructures on access.
+template <typename Tree>
+struct generic_ops_ {
+    static constexpr bool can_erase = true;
+    static void insert_all(Tree& _tree, key_vector const & _keys) { for (key_type key : _keys) _tree.insert(key); }
+    static void erase_all(Tree& _tree, key_vector const & _keys)  { for (key_type key : _keys) _tree.remove(key); }
+    static size_t count_hits(Tree& _tree, key_vector const & _queries) {
+        size_t hits = 0U;
+        for (key_type key : _queries) hits += _tree.contains(key);
+        return hits;
+    }
+    static long long sum(Tree const & _tree) {
+        long long result = 0;
+        for (key_type key : _tree) result += key;
+        return result;
+    }
+};
+
+template <typename Tree>
+struct container_ops_ : generic_ops_<Tree> { };
+
+template <>
+struct container_ops_<std::set<key_type>> : generic_ops_<std::set<key_type>> {
+    static void erase_all(std::set<key_type>& _tree, key_vector const & _keys) { for (key_type key : _keys) _tree.erase(key); }
+    static size_t count_hits(std::set<key_type>& _tree, key_vector const & _queries) {
+        size_t hits = 0U;
+        for (key_type key : _queries) hits += _tree.find(key) != _tree.end();
+        return hits;
+    }
+};
+
+template <>
+struct container_ops_<binary_search_tree<key_type>> : generic_ops_<binary_search_tree<key_type>> {
+    static void insert_all(binary_search_tree<key_type>& _tree, key_vector const & _keys) { for (key_type key : _keys) _tree.append(key); }
+};
+
+//built once from the whole key vector, so insert column is construction time.
+template <>
+struct container_ops_<static_search_tree<key_type>> : generic_ops_<static_search_tree<key_type>> {
+    static constexpr bool can_erase = false;
+    static void insert_all(static_search_tree<key_type>& _tree, key_vector const & _keys) { _tree = static_search_tree<key_type>(_keys.begin(), _keys.end()); }
+};
+
+template <>
+struct container_ops_<concurrent_search_tree<key_type>> : generic_ops_<concurrent_search_tree<key_type>> {
+    //lookups go through one reader handle, like a reader thread would hold it.
+    static size_t count_hits(concurrent_search_tree<key_type>& _tree, key_vector const & _queries) {
+        concurrent_search_tree<key_type>::reader reader = _tree.make_reader();
+        size_t hits = 0U;
+        for (key_type key : _queries) hits += reader.contains(key);
+        return hits;
+    }
+    static long long sum(concurrent_search_tree<key_type> const & _tree) {
+        long long result = 0;
+        _tree.make_reader().for_each([&result](key_type _key) { result += _key; });
+        return result;
+    }
+};
+
+template <>
+struct container_ops_<concurrent_skip_list<key_type>> : generic_ops_<concurrent_skip_list<key_type>> {
+    static long long sum(concurrent_skip_list<key_type> const & _tree) {
+        long long result = 0;
+        _tree.for_each([&result](key_type _key) { result += _key; });
+        return result;
+    }
+};
+
+enum class distribution { sequential, random, zipfian, adversarial };
+
+char const *distribution_name(distribution _dist) {
+    switch (_dist) {
+    case distribution::sequential:  return "sequential";
+    case distribution::random:      return "random";
+    case distribution::zipfian:     return "zipf(0.99)";
+    case distribution::adversarial: return "zigzag";
+    }
+    return "";
+}
+
+//generate n insertion keys and n lookup keys.
+//sequential  : 0, 1, 2, ... in ascending order.
+//random      : uniform 32 bit keys, lookups hit inserted keys.
+//zipfian     : ranks drawn from zipf(0.99) mapped to shuffled keys, so hot keys are spread over key space.
+//adversarial : sorted keys taken alternately from both ends (0, n-1, 1, n-2, ...). unbalanced trees degenerate
+//              and balanced trees rebalance on every insertion.
+void generate_keys(distribution _dist, size_t _num, std::vector<key_type>& _keys, std::vector<key_type>& _queries) {
+    std::mt19937 rng(0x5eed);
+    _keys.resize(_num);
+    _queries.resize(_num);
+    switch (_dist) {
+    case distribution::sequential:
+        std::iota(_keys.begin(), _keys.end(), 0);
+        for (key_type& key : _queries) key = static_cast<key_type>(rng() % _num);
+        break;
+    case distribution::random:
+        for (key_type& key : _keys) key = static_cast<key_type>(rng());
+        for (key_type& key : _queries) key = _keys[rng() % _num];
+        break;
+    case distribution::zipfian: {
+        std::vector<key_type> universe(_num);
+        std::iota(universe.begin(), universe.end(), 0);
+        std::shuffle(universe.begin(), universe.end(), rng);
+        bench::zipf_generator zipf(_num, 0.99);
+        for (key_type& key : _keys) key = universe[zipf(rng)];
+        for (key_type& key : _queries) key = universe[zipf(rng)];
+        break;
+    }
+    case distribution::adversarial:
+        for (size_t i = 0U; i < _num; ++i)
+            _keys[i] = static_cast<key_type>((i & 1U) ? _num - 1U - i / 2U : i / 2U);
+        for (key_type& key : _queries) key = static_cast<key_type>(rng() % _num);
+        break;
+    }
+}
+
+//print one cell of ns column, or '-' if the operation does not apply to the container.
+void print_cell(bool _applies, double _value) {
+    if (_applies) std::printf(" %9.1f", _value);
+    else          std::printf(" %9s", "-");
+}
+
+template <typename Tree>
+void run_case(char const *_label, distribution _dist, size_t _num) {
+    using ops = container_ops_<Tree>;
+    constexpr bool can_copy = std::is_copy_constructible<Tree>::value;
+    key_vector keys, queries;
+    generate_keys(_dist, _num, keys, queries);
+
+    size_t rss_before = bench::current_rss_bytes();
+    double insert_ns, find_ns, traverse_ns, copy_ns = 0.0, remove_ns = 0.0;
+    size_t num_stored, rss_after;
+    {
+        Tree tree;
+        insert_ns  = bench::measure_ns([&] { ops::insert_all(tree, keys); });
+        rss_after  = bench::current_rss_bytes();
+        num_stored = tree.size();
+
+        size_t hits = 0U;
+        find_ns = bench::measure_ns([&] { hits = ops::count_hits(tree, queries); });
+        bench::do_not_optimize(hits);
+
+        long long sum = 0;
+        traverse_ns = bench::measure_ns([&] { sum = ops::sum(tree); });
+        bench::do_not_optimize(sum);
+
+        if constexpr (can_copy) {
+            copy_ns = bench::measure_ns([&] {
+                Tree copied(tree);
+                bench::do_not_optimize(copied.size());
+            });
+        }
+
+        if constexpr (ops::can_erase) {
+            remove_ns = bench::measure_ns([&] { ops::erase_all(tree, keys); });
+        }
+    }
+
+    double per_op     = static_cast<double>(_num);
+    double per_stored = static_cast<double>(num_stored);
+    double bytes_elem = (rss_before && rss_after > rss_before) ? static_cast<double>(rss_after - rss_before) / per_stored : 0.0;
+    std::printf("%-22s %-11s %9zu", _label, distribution_name(_dist), _num);
+    print_cell(true, insert_ns / per_op);
+    print_cell(true, find_ns / per_op);
+    print_cell(true, traverse_ns / per_stored);
+    print_cell(can_copy, copy_ns / per_stored);
+    print_cell(ops::can_erase, remove_ns / per_op);
+    std::printf(" %10.1f %10.1f\n", static_cast<double>(bench::peak_rss_bytes()) / (1024.0 * 1024.0), bytes_elem);
+    std::fflush(stdout);
+}
+
+//run one case isolated in child process so peak RSS does not leak between cases.
+template <typename Tree>
+void run_isolated(char const *_label, distribution _dist, size_t _num) {
+#if defined(__unix__) || defined(__APPLE__)
+    std::fflush(stdout);
+    pid_t pid = fork();
+    if (pid == 0) {
+        run_case<Tree>(_label, _dist, _num);
+        _exit(0);
+    }
+    int status = 0;
+    if (pid > 0) waitpid(pid, &status, 0);
+    else         run_case<Tree>(_label, _dist, _num);
+#else
+    run_case<Tree>(_label, _dist, _num);
+#endif
+}
+
+int main(int argc, char** argv) {
+    size_t       max_size = argc > 1 ? static_cast<size_t>(std::strtoull(argv[1], nullptr, 10)) : 10000000U;
+    char const * filter   = argc > 2 ? argv[2] : nullptr;
+    //unbalanced trees (binary_search_tree, compact_search_tree, concurrent_search_tree) are quadratic on ordered
+    //input, so they are limited on those distributions.
+    const size_t degenerate_limit = 10000U;
+
+    std::printf("%-22s %-11s %9s %9s %9s %9s %9s %9s %10s %10s\n",
+                "container", "keys", "n", "insert", "find", "traverse", "copy", "remove", "peakMiB", "bytes/elem");
+    std::printf("%-22s %-11s %9s %9s %9s %9s %9s %9s\n", "", "", "", "ns/op", "ns/op", "ns/elem", "ns/elem", "ns/op");
+    for (distribution dist : { distribution::sequential, distribution::random, distribution::zipfian, distribution::adversarial }) {
+        for (size_t num = 1000U; num <= max_size; num *= 10U) {
+            auto selected = [filter](char const *_label) { return filter == nullptr || std::strstr(_label, filter) != nullptr; };
+            if (selected("std::set"))
+                run_isolated<std::set<key_type>>("std::set", dist, num);
+            const bool skewed = dist == distribution::sequential || dist == distribution::adversarial;
+            if (selected("binary_search_tree") && (!skewed || num <= degenerate_limit))
+                run_isolated<binary_search_tree<key_type>>("binary_search_tree", dist, num);
+            if (selected("red_black_tree"))
+                run_isolated<red_black_tree<key_type>>("red_black_tree", dist, num);
+            if (selected("bplus_tree"))
+                run_isolated<bplus_tree<key_type>>("bplus_tree", dist, num);
+            if (selected("splay_tree"))
+                run_isolated<splay_tree<key_type>>("splay_tree", dist, num);
+            if (selected("compact_search_tree") && (!skewed || num <= degenerate_limit))
+                run_isolated<compact_search_tree<key_type>>("compact_search_tree", dist, num);
+            if (selected("persistent_search_tree"))
+                run_isolated<persistent_search_tree<key_type>>("persistent_search_tree", dist, num);
+            if (selected("static_search_tree"))
+                run_isolated<static_search_tree<key_type>>("static_search_tree", dist, num);
+            if (selected("concurrent_search_tree") && (!skewed || num <= degenerate_limit))
+                run_isolated<concurrent_search_tree<key_type>>("concurrent_search_tree", dist, num);
+            if (selected("concurrent_skip_list"))
+                run_isolated<concurrent_skip_list<key_type>>("concurrent_skip_list", dist, num);
+        }
+    }
+    return 0;
+}
@@ -0,0 +1,955 @@
+#ifndef BPLUS_TREE_HPP
+#define BPLUS_TREE_HPP
+
+/**
+* @file      bplus_tree.hpp
+* @author    snowapril
+* @date      2026-10-17 (ongoing)
+* @brief     custom B+ tree data structure which almost similar to STL std::set.
+* @details   header only B+ tree. every key lives in leaf nodes which are doubly linked for ordered range scan,
+             inner nodes keep only separator keys. node size is a few cache lines (node_bytes), so the tree is shallow
+             and each level costs a few cache misses instead of one per binary level.
+             in-node search counts keys less than the query with SSE2/AVX2 compare + movemask for
+             int32_t, int64_t, float and double keys with std::less, and falls back to scalar binary search otherwise.
+             key type must be default constructible and copy assignable because nodes store keys in plain arrays.
+             statistics policy (see tree_stats.hpp) records node splits, merges and borrows besides search paths.
+* @see       tree_stats.hpp
+* @reference https://en.wikipedia.org/wiki/B%2B_tree
+*/
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include "tree_exceptions.hpp"
+#include "tree_stats.hpp"
+#include "tree_util.hpp"
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(__AVX2__)
+#include <immintrin.h>
+#define BPLUS_TREE_SIMD
+#endif
+
+namespace snowapril {
+
+    //scalar in-node search. return the number of keys less than (or not greater than) given key in sorted array.
+    template <typename Type, typename Compare, typename = void>
+    struct bplus_search_ {
+        template <typename Key>
+        static size_t count_less(Type const *_keys, size_t _num, Key const & _key, Compare const & _comp) {
+            return static_cast<size_t>(std::lower_bound(_keys, _keys + _num, _key, _comp) - _keys);
+        }
+        template <typename Key>
+        static size_t count_less_equal(Type const *_keys, size_t _num, Key const & _key, Compare const & _comp) {
+            return static_cast<size_t>(std::upper_bound(_keys, _keys + _num, _key, _comp) - _keys);
+        }
+    };
+
+#ifdef BPLUS_TREE_SIMD
+    //vector kernel which counts lanes of sorted array less than / greater than given key.
+    //every lane of node is compared, which is cheaper than unpredictable binary search branches for a few cache lines.
+    template <typename Type>
+    struct bplus_simd_kernel_;
+
+    inline size_t _bplus_popcount_(unsigned _mask) {
+#if defined(__GNUC__) || defined(__clang__)
+        return static_cast<size_t>(__builtin_popcount(_mask));
+#else
+        size_t count = 0U;
+        for (; _mask; _mask &= _mask - 1U) ++count;
+        return count;
+#endif
+    }
+
+    template <>
+    struct bplus_simd_kernel_<int32_t> {
+        static size_t count_less(int32_t const *_keys, size_t _num, int32_t _key) {
+            size_t count = 0U, i = 0U;
+#ifdef __AVX2__
+            __m256i key8 = _mm256_set1_epi32(_key);
+            for (; i + 8U <= _num; i += 8U) {
+                __m256i lanes = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(_keys + i));
+                count += _bplus_popcount_(static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(key8, lanes)))));
+            }
+#endif
+            __m128i key4 = _mm_set1_epi32(_key);
+            for (; i + 4U <= _num; i += 4U) {
+                __m128i lanes = _mm_loadu_si128(reinterpret_cast<__m128i const*>(_keys + i));
+                count += _bplus_popcount_(static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmplt_epi32(lanes, key4)))));
+            }
+            for (; i < _num; ++i) count += static_cast<size_t>(_keys[i] < _key);
+            return count;
+        }
+        static size_t count_greater(int32_t const *_keys, size_t _num, int32_t _key) {
+            size_t count = 0U, i = 0U;
+#ifdef __AVX2__
+            __m256i key8 = _mm256_set1_epi32(_key);
+            for (; i + 8U <= _num; i += 8U) {
+                __m256i lanes = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(_keys + i));
+                count += _bplus_popcount_(static_cast<unsigned>(_mm256_movemask_ps(_mm256_castsi256_ps(_mm256_cmpgt_epi32(lanes, key8)))));
+            }
+#endif
+            __m128i key4 = _mm_set1_epi32(_key);
+            for (; i + 4U <= _num; i += 4U) {
+                __m128i lanes = _mm_loadu_si128(reinterpret_cast<__m128i const*>(_keys + i));
+                count += _bplus_popcount_(static_cast<unsigned>(_mm_movemask_ps(_mm_castsi128_ps(_mm_cmpgt_epi32(lanes, key4)))));
+            }
+            for (; i < _num; ++i) count += static_cast<size_t>(_key < _keys[i]);
+            return count;
+        }
+    };
+
+    template <>
+    struct bplus_simd_kernel_<float> {
+        static size_t count_less(float const *_keys, size_t _num, float _key) {
+            size_t count = 0U, i = 0U;
+#ifdef __AVX2__
+            __m256 key8 = _mm256_set1_ps(_key);
+            for (; i + 8U <= _num; i += 8U)
+                count += _bplus_popcount_(static_cast<unsigned>(_mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(_keys + i), key8, _CMP_LT_OQ))));
+#endif
+            __m128 key4 = _mm_set1_ps(_key);
+            for (; i + 4U <= _num; i += 4U)
+                count += _bplus_popcount_(static_cast<unsigned>(_mm_movemask_ps(_mm_cmplt_ps(_mm_loadu_ps(_keys + i), key4))));
+            for (; i < _num; ++i) count += static_cast<size_t>(_keys[i] < _key);
+            return count;
+        }
+        static size_t count_greater(float const *_keys, size_t _num, float _key) {
+            size_t count = 0U, i = 0U;
+#ifdef __AVX2__
+            __m256 key8 = _mm256_set1_ps(_key);
+            for (; i + 8U <= _num; i += 8U)
+                count += _bplus_popcount_(static_cast<unsigned>(_mm256_movemask_ps(_mm256_cmp_ps(_mm256_loadu_ps(_keys + i), key8, _CMP_GT_OQ))));
+#endif
+            __m128 key4 = _mm_set1_ps(_key);
+            for (; i + 4U <= _num; i += 4U)
+                count += _bplus_popcount_(static_cast<unsigned>(_mm_movemask_ps(_mm_cmpgt_ps(_mm_loadu_ps(_keys + i), key4))));
+            for (; i < _num; ++i) count += static_cast<size_t>(_key < _keys[i]);
+            return count;
+        }
+    };
+
+    template <>
+    struct bplus_simd_kernel_<double> {
+        static size_t count_less(double const *_keys, size_t _num, double _key) {
+            size_t count = 0U, i = 0U;
+#ifdef __AVX2__
+            __m256d key4 = _mm256_set1_pd(_key);
+            for (; i + 4U <= _num; i += 4U)
+                count += _bplus_popcount_(static_cast<unsigned>(_mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(_keys + i), key4, _CMP_LT_OQ))));
+#endif
+            __m128d key2 = _mm_set1_pd(_key);
+            for (; i + 2U <= _num; i += 2U)
+                count += _bplus_popcount_(static_cast<unsigned>(_mm_movemask_pd(_mm_cmplt_pd(_mm_loadu_pd(_keys + i), key2))));
+            for (; i < _num; ++i) count += static_cast<size_t>(_keys[i] < _key);
+            return count;
+        }
+        static size_t count_greater(double const *_keys, size_t _num, double _key) {
+            size_t count = 0U, i = 0U;
+#ifdef __AVX2__
+            __m256d key4 = _mm256_set1_pd(_key);
+            for (; i + 4U <= _num; i += 4U)
+                count += _bplus_popcount_(static_cast<unsigned>(_mm256_movemask_pd(_mm256_cmp_pd(_mm256_loadu_pd(_keys + i), key4, _CMP_GT_OQ))));
+#endif
+            __m128d key2 = _mm_set1_pd(_key);
+            for (; i + 2U <= _num; i += 2U)
+                count += _bplus_popcount_(static_cast<unsigned>(_mm_movemask_pd(_mm_cmpgt_pd(_mm_loadu_pd(_keys + i), key2))));
+            for (; i < _num; ++i) count += static_cast<size_t>(_key < _keys[i]);
+            return count;
+        }
+    };
+
+#ifdef __AVX2__
+    template <>
+    struct bplus_simd_kernel_<int64_t> {
+        static size_t count_less(int64_t const *_keys, size_t _num, int64_t _key) {
+            size_t count = 0U, i = 0U;
+            __m256i key4 = _mm256_set1_epi64x(_key);
+            for (; i + 4U <= _num; i += 4U) {
+                __m256i lanes = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(_keys + i));
+                count += _bplus_popcount_(static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(key4, lanes)))));
+            }
+            for (; i < _num; ++i) count += static_cast<size_t>(_keys[i] < _key);
+            return count;
+        }
+        static size_t count_greater(int64_t const *_keys, size_t _num, int64_t _key) {
+            size_t count = 0U, i = 0U;
+            __m256i key4 = _mm256_set1_epi64x(_key);
+            for (; i + 4U <= _num; i += 4U) {
+                __m256i lanes = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(_keys + i));
+                count += _bplus_popcount_(static_cast<unsigned>(_mm256_movemask_pd(_mm256_castsi256_pd(_mm256_cmpgt_epi64(lanes, key4)))));
+            }
+            for (; i < _num; ++i) count += static_cast<size_t>(_key < _keys[i]);
+            return count;
+        }
+    };
+#endif
+
+    template <typename Type, typename = void>
+    struct has_bplus_simd_kernel_ : std::false_type { };
+
+    template <typename Type>
+    struct has_bplus_simd_kernel_<Type, std::void_t<decltype(bplus_simd_kernel_<Type>::count_less(nullptr, 0U, Type()))>> : std::true_type { };
+
+    //vectorized in-node search for arithmetic keys ordered by std::less.
+    template <typename Type>
+    struct bplus_search_<Type, std::less<Type>, typename std::enable_if<has_bplus_simd_kernel_<Type>::value>::type> {
+        static size_t count_less(Type const *_keys, size_t _num, Type const & _key, std::less<Type> const &) {
+            return bplus_simd_kernel_<Type>::count_less(_keys, _num, _key);
+        }
+        static size_t count_less_equal(Type const *_keys, size_t _num, Type const & _key, std::less<Type> const &) {
+            return _num - bplus_simd_kernel_<Type>::count_greater(_keys, _num, _key);
+        }
+    };
+#endif
+
+    template <typename Type, typename Compare = std::less<Type>, class node_allocator = std::allocator<Type>,
+              class tree_stats = no_tree_stats_ >
+    class bplus_tree : private tree_stats {
+    public:
+        using value_type      = Type;
+        using key_compare     = Compare;
+        using pointer         = Type const*;
+        using reference       = Type const&;
+        using size_type       = size_t;
+        using difference_type = ptrdiff_t;
+        class iterator;
+        using const_iterator   = iterator;
+        using reverse_iterator = std::reverse_iterator<iterator>;
+        using stats_type       = tree_stats;
+        //byte budget of keys in one node. 256 bytes are four cache lines.
+        static constexpr size_type node_bytes     = 256U;
+        static constexpr size_type leaf_capacity  = std::max<size_type>(4U, node_bytes / sizeof(Type));
+        static constexpr size_type inner_capacity = std::max<size_type>(4U, node_bytes / sizeof(Type));
+    protected:
+        struct node_base_ {
+            bool     is_leaf;
+            uint32_t count = 0U;
+        };
+        struct leaf_node_ : node_base_ {
+            leaf_node_() { this->is_leaf = true; }
+            Type        keys[leaf_capacity];
+            leaf_node_ *prev_leaf = nullptr;
+            leaf_node_ *next_leaf = nullptr;
+        };
+        struct inner_node_ : node_base_ {
+            inner_node_() { this->is_leaf = false; }
+            Type        keys[inner_capacity];           // keys[i] is not greater than every key in children[i + 1]
+            node_base_ *children[inner_capacity + 1U];
+        };
+        struct path_entry_ {
+            inner_node_* node;
+            size_type    child;
+        };
+        using leaf_allocator  = typename std::allocator_traits<node_allocator>::template rebind_alloc<leaf_node_>;
+        using inner_allocator = typename std::allocator_traits<node_allocator>::template rebind_alloc<inner_node_>;
+        using search_type     = bplus_search_<Type, Compare>;
+        static constexpr size_type min_leaf_count  = leaf_capacity / 2U;
+        static constexpr size_type min_inner_count = inner_capacity / 2U;
+        static constexpr size_type max_height      = 64U;
+    public:
+        bplus_tree() = default; // default constructor
+        explicit bplus_tree(Compare const &); // constructor with comparator
+        template <typename GenericIterator>
+        bplus_tree(GenericIterator, GenericIterator); //constructor with two standard iterators
+        bplus_tree(std::initializer_list<Type> const &); // constructor with initializer_list
+        bplus_tree(bplus_tree<Type, Compare, node_allocator, tree_stats> const &); // copy constructor
+        bplus_tree<Type, Compare, node_allocator, tree_stats> & operator=(bplus_tree<Type, Compare, node_allocator, tree_stats> const &); // copy assignment operator
+        bplus_tree(bplus_tree<Type, Compare, node_allocator, tree_stats> &&); // move constructor
+        bplus_tree<Type, Compare, node_allocator, tree_stats> & operator=(bplus_tree<Type, Compare, node_allocator, tree_stats> &&); // move assignment operator
+        ~bplus_tree(); // destructor
+
+            class iterator {
+                friend class bplus_tree<Type, Compare, node_allocator, tree_stats>;
+            public:
+                using iterator_category = std::bidirectional_iterator_tag;
+                using value_type        = Type;
+                using pointer           = Type const*;
+                using reference         = Type const&;
+                using difference_type   = ptrdiff_t;
+            public:
+                iterator() = default;
+                iterator(leaf_node_*, size_type, bplus_tree const *);
+                Type const& operator*()     const;
+                Type const* operator->()    const;
+                bool        operator==(iterator const &) const;
+                bool        operator!=(iterator const &) const;
+                //move to next key, following leaf link at the end of leaf.
+                iterator&   operator++();
+                iterator    operator++(int);
+                //move to previous key. decrementing end() gives the largest element.
+                iterator&   operator--();
+                iterator    operator--(int);
+            private:
+                leaf_node_       *leaf  = nullptr;
+                size_type         index = 0U;
+                bplus_tree const *tree  = nullptr;
+            };
+        public:
+            //return whether if tree is empty.
+            bool                empty() const;
+            //return the number of keys in this tree.
+            size_type           size() const;
+            //return the number of levels. (0 if empty)
+            size_type           height() const;
+            iterator            begin() const;
+            iterator            end() const;
+            reverse_iterator    rbegin() const;
+            reverse_iterator    rend() const;
+            key_compare         key_comp() const;
+            //remove every key in this tree.
+            void                clear();
+            //insert given key. return iterator of the key and whether insertion took place.
+            std::pair<iterator, bool> insert(Type const &);
+            //remove given key. return the number of removed keys.
+            size_type           remove(Type const &);
+            //lookup methods accept any key type if Compare is transparent, otherwise key is converted to Type.
+            template <typename Key = Type>
+            iterator            find(Key const &) const;
+            template <typename Key = Type>
+            bool                contains(Key const &) const;
+            //return iterator of the first key not less than given key.
+            template <typename Key = Type>
+            iterator            lower_bound(Key const &) const;
+            //return iterator of the first key greater than given key.
+            template <typename Key = Type>
+            iterator            upper_bound(Key const &) const;
+            //return copy of statistics counters. (all zero unless tree_stats is counting_tree_stats_)
+            tree_stats_snapshot stats() const;
+            void                reset_stats();
+        private:
+            tree_stats const & _internal_stats() const;
+            template <typename Key>
+            using lookup_key_t = typename std::conditional<is_transparent_compare_<Compare>::value, Key, Type>::type;
+            //descend to the leaf which may contain given key. record visited inner nodes if path is given.
+            template <typename Key>
+            leaf_node_* _internal_descend(Key const &, path_entry_*, size_type*) const;
+            //insert separator and right node into parents recorded in path, splitting them if full.
+            void _internal_insert_into_parent(path_entry_*, size_type, Type const &, node_base_*);
+            //restore minimum occupancy of underflowed leaf by borrowing from or merging with sibling.
+            void _internal_fix_leaf(leaf_node_*, path_entry_*, size_type);
+            //restore minimum occupancy of underflowed inner node.
+            void _internal_fix_inner(inner_node_*, path_entry_*, size_type);
+            //remove key at first index and child at second index from inner node.
+            static void _internal_erase_from_inner(inner_node_*, size_type, size_type);
+            node_base_* _internal_copy(node_base_ const*, leaf_node_*&);
+            void _internal_destroy(node_base_*);
+            leaf_node_*  _internal_new_leaf();
+            inner_node_* _internal_new_inner();
+            void _internal_free_leaf(leaf_node_*);
+            void _internal_free_inner(inner_node_*);
+        private:
+            leaf_allocator  leaf_alloc;
+            inner_allocator inner_alloc;
+            Compare         comp;
+            node_base_*     root       = nullptr;
+            leaf_node_*     first_leaf = nullptr;
+            leaf_node_*     last_leaf  = nullptr;
+            size_type       num_key    = 0U;
+            size_type       num_level  = 0U;
+    };
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    bplus_tree<Type, Compare, node_allocator, tree_stats>::bplus_tree(Compare const & _comp) : comp(_comp) { }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    template <typename GenericIterator>
+    bplus_tree<Type, Compare, node_allocator, tree_stats>::bplus_tree(GenericIterator _begin_iter, GenericIterator _end_iter) {
+        for (; _begin_iter != _end_iter; ++_begin_iter) {
+            insert(*_begin_iter);
+        }
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    bplus_tree<Type, Compare, node_allocator, tree_stats>::bplus_tree(std::initializer_list<Type> const & _i_list) {
+        for (const auto& _value : _i_list) {
+            insert(_value);
+        }
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    bplus_tree<Type, Compare, node_allocator, tree_stats>::bplus_tree(bplus_tree<Type, Compare, node_allocator, tree_stats> const & _l_tree)
+        : tree_stats(), leaf_alloc(std::allocator_traits<leaf_allocator>::select_on_container_copy_construction(_l_tree.leaf_alloc)),
+          inner_alloc(std::allocator_traits<inner_allocator>::select_on_container_copy_construction(_l_tree.inner_alloc)),
+          comp(_l_tree.comp) {
+        leaf_node_* prev_leaf = nullptr;
+        root       = _internal_copy(_l_tree.root, prev_leaf);
+        last_leaf  = prev_leaf;
+        num_key    = _l_tree.num_key;
+        num_level  = _l_tree.num_level;
+        _internal_stats().reset_depth(_l_tree._internal_stats().recorded_depth());
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    bplus_tree<Type, Compare, node_allocator, tree_stats> & bplus_tree<Type, Compare, node_allocator, tree_stats>::operator=(bplus_tree<Type, Compare, node_allocator, tree_stats> const & _l_tree) {
+        if (this != &_l_tree) {
+            //copy first, so this tree is unchanged if copy throws.
+            bplus_tree<Type, Compare, node_allocator, tree_stats> copy(_l_tree);
+            *this = std::move(copy);
+        }
+        return *this;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    bplus_tree<Type, Compare, node_allocator, tree_stats>::bplus_tree(bplus_tree<Type, Compare, node_allocator, tree_stats> && _r_tree)
+        : leaf_alloc(_r_tree.leaf_alloc), inner_alloc(_r_tree.inner_alloc), comp(_r_tree.comp) {
+        std::swap(root,       _r_tree.root);
+        std::swap(first_leaf, _r_tree.first_leaf);
+        std::swap(last_leaf,  _r_tree.last_leaf);
+        std::swap(num_key,    _r_tree.num_key);
+        std::swap(num_level,  _r_tree.num_level);
+        _internal_stats().reset_depth(_r_tree._internal_stats().recorded_depth());
+        _r_tree._internal_stats().reset_depth(0U);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    bplus_tree<Type, Compare, node_allocator, tree_stats> & bplus_tree<Type, Compare, node_allocator, tree_stats>::operator=(bplus_tree<Type, Compare, node_allocator, tree_stats> && _r_tree) {
+        if (this != &_r_tree) {
+            clear();
+            leaf_alloc  = _r_tree.leaf_alloc;
+            inner_alloc = _r_tree.inner_alloc;
+            comp        = _r_tree.comp;
+            std::swap(root,       _r_tree.root);
+            std::swap(first_leaf, _r_tree.first_leaf);
+            std::swap(last_leaf,  _r_tree.last_leaf);
+            std::swap(num_key,    _r_tree.num_key);
+            std::swap(num_level,  _r_tree.num_level);
+            _internal_stats().reset_depth(_r_tree._internal_stats().recorded_depth());
+            _r_tree._internal_stats().reset_depth(0U);
+        }
+        return *this;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    bplus_tree<Type, Compare, node_allocator, tree_stats>::~bplus_tree() {
+        clear();
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    bool bplus_tree<Type, Compare, node_allocator, tree_stats>::empty() const {
+        return num_key == 0U;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename bplus_tree<Type, Compare, node_allocator, tree_stats>::size_type bplus_tree<Type, Compare, node_allocator, tree_stats>::size() const {
+        return num_key;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename bplus_tree<Type, Compare, node_allocator, tree_stats>::size_type bplus_tree<Type, Compare, node_allocator, tree_stats>::height() const {
+        return num_level;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename bplus_tree<Type, Compare, node_allocator, tree_stats>::iterator bplus_tree<Type, Compare, node_allocator, tree_stats>::begin() const {
+        return iterator(first_leaf, 0U, this);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename bplus_tree<Type, Compare, node_allocator, tree_stats>::iterator bplus_tree<Type, Compare, node_allocator, tree_stats>::end() const {
+        return iterator(nullptr, 0U, this);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename bplus_tree<Type, Compare, node_allocator, tree_stats>::reverse_iterator bplus_tree<Type, Compare, node_allocator, tree_stats>::rbegin() const {
+        return reverse_iterator(end());
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename bplus_tree<Type, Compare, node_allocator, tree_stats>::reverse_iterator bplus_tree<Type, Compare, node_allocator, tree_stats>::rend() const {
+        return reverse_iterator(begin());
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename bplus_tree<Type, Compare, node_allocator, tree_stats>::key_compare bplus_tree<Type, Compare, node_allocator, tree_stats>::key_comp() const {
+        return comp;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    void bplus_tree<Type, Compare, node_allocator, tree_stats>::clear() {
+        if (root) _internal_destroy(root);
+        root       = nullptr;
+        first_leaf = last_leaf = nullptr;
+        num_key    = 0U;
+        num_level  = 0U;
+        _internal_stats().reset_depth(0U);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    std::pair<typename bplus_tree<Type, Compare, node_allocator, tree_stats>::iterator, bool> bplus_tree<Type, Compare, node_allocator, tree_stats>::insert(Type const & _value) {
+        if (root == nullptr) {
+            leaf_node_* leaf = _internal_new_leaf();
+            leaf->keys[0] = _value;
+            leaf->count   = 1U;
+            root = first_leaf = last_leaf = leaf;
+            num_key   = 1U;
+            num_level = 1U;
+            _internal_stats().record_search(0U);
+            _internal_stats().record_insert();
+            return std::make_pair(iterator(leaf, 0U, this), true);
+        }
+
+        path_entry_ path[max_height];
+        size_type   depth = 0U;
+        leaf_node_* leaf  = _internal_descend(_value, path, &depth);
+        size_type   pos   = search_type::count_less(leaf->keys, leaf->count, _value, comp);
+        //key goes into the leaf below the inner nodes of the path, so the leaf is recorded as the level it is
+        //linked at, and max depth stays at height.
+        _internal_stats().record_search(depth);
+        _internal_stats().record_compare(1U);
+        if (pos < leaf->count && !comp(_value, leaf->keys[pos]))
+            return std::make_pair(iterator(leaf, pos, this), false);
+        ++num_key;
+        _internal_stats().record_insert();
+
+        if (leaf->count < leaf_capacity) {
+            std::copy_backward(leaf->keys + pos, leaf->keys + leaf->count, leaf->keys + leaf->count + 1U);
+            leaf->keys[pos] = _value;
+            ++leaf->count;
+            return std::make_pair(iterator(leaf, pos, this), true);
+        }
+
+        //split full leaf. left keeps lower half, right takes upper half and is linked after left.
+        leaf_node_* right_leaf = _internal_new_leaf();
+        size_type   left_count = (leaf_capacity + 1U) / 2U;
+        Type        merged[leaf_capacity + 1U];
+        std::copy(leaf->keys, leaf->keys + pos, merged);
+        merged[pos] = _value;
+        std::copy(leaf->keys + pos, leaf->keys + leaf_capacity, merged + pos + 1U);
+        std::copy(merged, merged + left_count, leaf->keys);
+        std::copy(merged + left_count, merged + leaf_capacity + 1U, right_leaf->keys);
+        leaf->count       = static_cast<uint32_t>(left_count);
+        right_leaf->count = static_cast<uint32_t>(leaf_capacity + 1U - left_count);
+
+        right_leaf->next_leaf = leaf->next_leaf;
+        right_leaf->prev_leaf = leaf;
+        if (leaf->next_leaf) leaf->next_leaf->prev_leaf = right_leaf;
+        else                 last_leaf = right_leaf;
+        leaf->next_leaf = right_leaf;
+        _internal_stats().record_split(1U);
+        LOG("split leaf", leaf);
+
+        _internal_insert_into_parent(path, depth, right_leaf->keys[0], right_leaf);
+        iterator ret_iter = (pos < left_count) ? iterator(leaf, pos, this) : iterator(right_leaf, pos - left_count, this);
+        return std::make_pair(ret_iter, true);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename bplus_tree<Type, Compare, node_allocator, tree_stats>::size_type bplus_tree<Type, Compare, node_allocator, tree_stats>::remove(Type const & _value) {
+        if (root == nullptr) return 0U;
+
+        path_entry_ path[max_height];
+        size_type   depth = 0U;
+        leaf_node_* leaf  = _internal_descend(_value, path, &depth);
+        size_type   pos   = search_type::count_less(leaf->keys, leaf->count, _value, comp);
+        _internal_stats().record_search(depth + 1U);
+        if (pos == leaf->count || comp(_value, leaf->keys[pos])) return 0U;
+
+        std::copy(leaf->keys + pos + 1U, leaf->keys + leaf->count, leaf->keys + pos);
+        --leaf->count;
+        --num_key;
+        _internal_stats().record_remove();
+        //separator keys in parents may still equal the removed key. they keep partitioning correctly, so they are left as is.
+        if (leaf->count < min_leaf_count) {
+            _internal_fix_leaf(leaf, path, depth);
+        }
+        return 1U;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    template <typename Key>
+    typename bplus_tree<Type, Compare, node_allocator, tree_stats>::iterator bplus_tree<Type, Compare, node_allocator, tree_stats>::find(Key const & _key) const {
+        if (root == nullptr) return end();
+        lookup_key_t<Key> const & key = _key;
+        leaf_node_* leaf = _internal_descend(key, nullptr, nullptr);
+        _internal_stats().record_search(num_level);
+        size_type   pos  = search_type::count_less(leaf->keys, leaf->count, key, comp);
+        if (pos == leaf->count || comp(key, leaf->keys[pos])) return end();
+        return iterator(leaf, pos, this);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    template <typename Key>
+    bool bplus_tree<Type, Compare, node_allocator, tree_stats>::contains(Key const & _key) const {
+        return find(_key) != end();
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    template <typename Key>
+    typename bplus_tree<Type, Compare, node_allocator, tree_stats>::iterator bplus_tree<Type, Compare, node_allocator, tree_stats>::lower_bound(Key const & _key) const {
+        if (root == nullptr) return end();
+        lookup_key_t<Key> const & key = _key;
+        leaf_node_* leaf = _internal_descend(key, nullptr, nullptr);
+        _internal_stats().record_search(num_level);
+        size_type   pos  = search_type::count_less(leaf->keys, leaf->count, key, comp);
+        if (pos == leaf->count) return iterator(leaf->next_leaf, 0U, this);
+        return iterator(leaf, pos, this);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    template <typename Key>
+    typename bplus_tree<Type, Compare, node_allocator, tree_stats>::iterator bplus_tree<Type, Compare, node_allocator, tree_stats>::upper_bound(Key const & _key) const {
+        if (root == nullptr) return end();
+        lookup_key_t<Key> const & key = _key;
+        leaf_node_* leaf = _internal_descend(key, nullptr, nullptr);
+        _internal_stats().record_search(num_level);
+        size_type   pos  = search_type::count_less_equal(leaf->keys, leaf->count, key, comp);
+        if (pos == leaf->count) return iterator(leaf->next_leaf, 0U, this);
+        return iterator(leaf, pos, this);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    template <typename Key>
+    typename bplus_tree<Type, Compare, node_allocator, tree_stats>::leaf_node_* bplus_tree<Type, Compare, node_allocator, tree_stats>::_internal_descend(Key const & _key, path_entry_* _path, size_type* _depth) const {
+        node_base_* node = root;
+        while (!node->is_leaf) {
+            inner_node_* inner = static_cast<inner_node_*>(node);
+            size_type    child = search_type::count_less_equal(inner->keys, inner->count, _key, comp);
+            if (_path) _path[(*_depth)++] = path_entry_{ inner, child };
+            node = inner->children[child];
+            TREE_PREFETCH(node);
+        }
+        return static_cast<leaf_node_*>(node);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    void bplus_tree<Type, Compare, node_allocator, tree_stats>::_internal_insert_into_parent(path_entry_* _path, size_type _depth, Type const & _separator, node_base_* _right_node) {
+        Type        separator  = _separator;
+        node_base_* right_node = _right_node;
+        while (_depth) {
+            inner_node_* parent = _path[_depth - 1U].node;
+            size_type    index  = _path[_depth - 1U].child;
+            --_depth;
+            if (parent->count < inner_capacity) {
+                std::copy_backward(parent->keys + index, parent->keys + parent->count, parent->keys + parent->count + 1U);
+                std::copy_backward(parent->children + index + 1U, parent->children + parent->count + 1U, parent->children + parent->count + 2U);
+                parent->keys[index]           = separator;
+                parent->children[index + 1U]  = right_node;
+                ++parent->count;
+                return;
+            }
+
+            //split full inner node. middle key moves up instead of being copied.
+            Type        merged_keys[inner_capacity + 1U];
+            node_base_* merged_children[inner_capacity + 2U];
+            std::copy(parent->keys, parent->keys + index, merged_keys);
+            merged_keys[index] = separator;
+            std::copy(parent->keys + index, parent->keys + inner_capacity, merged_keys + index + 1U);
+            std::copy(parent->children, parent->children + index + 1U, merged_children);
+            merged_children[index + 1U] = right_node;
+            std::copy(parent->children + index + 1U, parent->children + inner_capacity + 1U, merged_children + index + 2U);
+
+            size_type    mid         = (inner_capacity + 1U) / 2U;
+            inner_node_* right_inner = _internal_new_inner();
+            std::copy(merged_keys, merged_keys + mid, parent->keys);
+            std::copy(merged_children, merged_children + mid + 1U, parent->children);
+            parent->count = static_cast<uint32_t>(mid);
+            std::copy(merged_keys + mid + 1U, merged_keys + inner_capacity + 1U, right_inner->keys);
+            std::copy(merged_children + mid + 1U, merged_children + inner_capacity + 2U, right_inner->children);
+            right_inner->count = static_cast<uint32_t>(inner_capacity - mid);
+            _internal_stats().record_split(1U);
+            LOG("split inner", parent);
+
+            separator  = merged_keys[mid];
+            right_node = right_inner;
+        }
+
+        inner_node_* new_root = _internal_new_inner();
+        new_root->keys[0]     = separator;
+        new_root->children[0] = root;
+        new_root->children[1] = right_node;
+        new_root->count       = 1U;
+        root = new_root;
+        ++num_level;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    void bplus_tree<Type, Compare, node_allocator, tree_stats>::_internal_fix_leaf(leaf_node_* _leaf, path_entry_* _path, size_type _depth) {
+        if (_depth == 0U) {
+            //root leaf may hold any number of keys. drop it when it becomes empty.
+            if (_leaf->count == 0U) {
+                _internal_free_leaf(_leaf);
+                root = first_leaf = last_leaf = nullptr;
+                num_level = 0U;
+            }
+            return;
+        }
+
+        inner_node_* parent = _path[_depth - 1U].node;
+        size_type    index  = _path[_depth - 1U].child;
+        leaf_node_*  left   = index > 0U            ? static_cast<leaf_node_*>(parent->children[index - 1U]) : nullptr;
+        leaf_node_*  right  = index < parent->count ? static_cast<leaf_node_*>(parent->children[index + 1U]) : nullptr;
+
+        if (left && left->count > min_leaf_count) {
+            std::copy_backward(_leaf->keys, _leaf->keys + _leaf->count, _leaf->keys + _leaf->count + 1U);
+            _leaf->keys[0] = left->keys[left->count - 1U];
+            ++_leaf->count;
+            --left->count;
+            parent->keys[index - 1U] = _leaf->keys[0];
+            _internal_stats().record_rotation(1U);
+            return;
+        }
+        if (right && right->count > min_leaf_count) {
+            _leaf->keys[_leaf->count++] = right->keys[0];
+            std::copy(right->keys + 1U, right->keys + right->count, right->keys);
+            --right->count;
+            parent->keys[index] = right->keys[0];
+            _internal_stats().record_rotation(1U);
+            return;
+        }
+
+        //merge right one of the pair into left one and unlink it.
+        leaf_node_* merge_left  = left ? left  : _leaf;
+        leaf_node_* merge_right = left ? _leaf : right;
+        size_type   key_index   = left ? index - 1U : index;
+        std::copy(merge_right->keys, merge_right->keys + merge_right->count, merge_left->keys + merge_left->count);
+        merge_left->count += merge_right->count;
+        merge_left->next_leaf = merge_right->next_leaf;
+        if (merge_right->next_leaf) merge_right->next_leaf->prev_leaf = merge_left;
+        else                        last_leaf = merge_left;
+        _internal_free_leaf(merge_right);
+        _internal_stats().record_merge(1U);
+        LOG("merge leaf", merge_left);
+
+        _internal_erase_from_inner(parent, key_index, key_index + 1U);
+        _internal_fix_inner(parent, _path, _depth - 1U);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    void bplus_tree<Type, Compare, node_allocator, tree_stats>::_internal_fix_inner(inner_node_* _node, path_entry_* _path, size_type _depth) {
+        while (true) {
+            if (_depth == 0U) {
+                //root inner node without key has a single child which becomes new root.
+                if (_node->count == 0U) {
+                    root = _node->children[0];
+                    _internal_free_inner(_node);
+                    --num_level;
+                }
+                return;
+            }
+            if (_node->count >= min_inner_count) return;
+
+            inner_node_* parent = _path[_depth - 1U].node;
+            size_type    index  = _path[_depth - 1U].child;
+            inner_node_* left   = index > 0U            ? static_cast<inner_node_*>(parent->children[index - 1U]) : nullptr;
+            inner_node_* right  = index < parent->count ? static_cast<inner_node_*>(parent->children[index + 1U]) : nullptr;
+
+            if (left && left->count > min_inner_count) {
+                //rotate right through parent separator.
+                std::copy_backward(_node->keys, _node->keys + _node->count, _node->keys + _node->count + 1U);
+                std::copy_backward(_node->children, _node->children + _node->count + 1U, _node->children + _node->count + 2U);
+                _node->keys[0]     = parent->keys[index - 1U];
+                _node->children[0] = left->children[left->count];
+                parent->keys[index - 1U] = left->keys[left->count - 1U];
+                --left->count;
+                ++_node->count;
+                _internal_stats().record_rotation(1U);
+                return;
+            }
+            if (right && right->count > min_inner_count) {
+                //rotate left through parent separator.
+                _node->keys[_node->count]          = parent->keys[index];
+                _node->children[_node->count + 1U] = right->children[0];
+                ++_node->count;
+                parent->keys[index] = right->keys[0];
+                std::copy(right->keys + 1U, right->keys + right->count, right->keys);
+                std::copy(right->children + 1U, right->children + right->count + 1U, right->children);
+                --right->count;
+                _internal_stats().record_rotation(1U);
+                return;
+            }
+
+            inner_node_* merge_left  = left ? left  : _node;
+            inner_node_* merge_right = left ? _node : right;
+            size_type    key_index   = left ? index - 1U : index;
+            merge_left->keys[merge_left->count] = parent->keys[key_index];
+            std::copy(merge_right->keys, merge_right->keys + merge_right->count, merge_left->keys + merge_left->count + 1U);
+            std::copy(merge_right->children, merge_right->children + merge_right->count + 1U, merge_left->children + merge_left->count + 1U);
+            merge_left->count += merge_right->count + 1U;
+            _internal_free_inner(merge_right);
+            _internal_stats().record_merge(1U);
+            LOG("merge inner", merge_left);
+
+            _internal_erase_from_inner(parent, key_index, key_index + 1U);
+            _node = parent;
+            --_depth;
+        }
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    void bplus_tree<Type, Compare, node_allocator, tree_stats>::_internal_erase_from_inner(inner_node_* _node, size_type _key_index, size_type _child_index) {
+        std::copy(_node->keys + _key_index + 1U, _node->keys + _node->count, _node->keys + _key_index);
+        std::copy(_node->children + _child_index + 1U, _node->children + _node->count + 1U, _node->children + _child_index);
+        --_node->count;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename bplus_tree<Type, Compare, node_allocator, tree_stats>::node_base_* bplus_tree<Type, Compare, node_allocator, tree_stats>::_internal_copy(node_base_ const* _node, leaf_node_*& _prev_leaf) {
+        //recursion depth is bounded by height, which is logarithmic with base of node fanout.
+        if (_node == nullptr) return nullptr;
+        if (_node->is_leaf) {
+            leaf_node_ const* leaf     = static_cast<leaf_node_ const*>(_node);
+            leaf_node_*       new_leaf = _internal_new_leaf();
+            try {
+                std::copy(leaf->keys, leaf->keys + leaf->count, new_leaf->keys);
+            }
+            catch (...) {
+                _internal_free_leaf(new_leaf);
+                throw;
+            }
+            new_leaf->count     = leaf->count;
+            new_leaf->prev_leaf = _prev_leaf;
+            if (_prev_leaf) _prev_leaf->next_leaf = new_leaf;
+            else            first_leaf = new_leaf;
+            _prev_leaf = new_leaf;
+            return new_leaf;
+        }
+        inner_node_ const* inner     = static_cast<inner_node_ const*>(_node);
+        inner_node_*       new_inner = _internal_new_inner();
+        size_type          num_copied = 0U;
+        try {
+            std::copy(inner->keys, inner->keys + inner->count, new_inner->keys);
+            new_inner->count = inner->count;
+            for (; num_copied <= inner->count; ++num_copied) {
+                new_inner->children[num_copied] = _internal_copy(inner->children[num_copied], _prev_leaf);
+            }
+        }
+        catch (...) {
+            //sub-trees copied so far are not linked to the tree yet, so they are released here.
+            for (size_type i = 0U; i < num_copied; ++i) {
+                _internal_destroy(new_inner->children[i]);
+            }
+            _internal_free_inner(new_inner);
+            throw;
+        }
+        return new_inner;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    void bplus_tree<Type, Compare, node_allocator, tree_stats>::_internal_destroy(node_base_* _node) {
+        if (_node->is_leaf) {
+            _internal_free_leaf(static_cast<leaf_node_*>(_node));
+            return;
+        }
+        inner_node_* inner = static_cast<inner_node_*>(_node);
+        for (size_type i = 0U; i <= inner->count; ++i) {
+            _internal_destroy(inner->children[i]);
+        }
+        _internal_free_inner(inner);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename bplus_tree<Type, Compare, node_allocator, tree_stats>::leaf_node_* bplus_tree<Type, Compare, node_allocator, tree_stats>::_internal_new_leaf() {
+        leaf_node_* leaf = std::allocator_traits<leaf_allocator>::allocate(leaf_alloc, 1U);
+        std::allocator_traits<leaf_allocator>::construct(leaf_alloc, leaf);
+        _internal_stats().record_alloc_call();
+        _internal_stats().record_alloc(1U);
+        return leaf;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename bplus_tree<Type, Compare, node_allocator, tree_stats>::inner_node_* bplus_tree<Type, Compare, node_allocator, tree_stats>::_internal_new_inner() {
+        inner_node_* inner = std::allocator_traits<inner_allocator>::allocate(inner_alloc, 1U);
+        std::allocator_traits<inner_allocator>::construct(inner_alloc, inner);
+        _internal_stats().record_alloc_call();
+        _internal_stats().record_alloc(1U);
+        return inner;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    void bplus_tree<Type, Compare, node_allocator, tree_stats>::_internal_free_leaf(leaf_node_* _leaf) {
+        std::allocator_traits<leaf_allocator>::destroy(leaf_alloc, _leaf);
+        std::allocator_traits<leaf_allocator>::deallocate(leaf_alloc, _leaf, 1U);
+        _internal_stats().record_free(1U);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    void bplus_tree<Type, Compare, node_allocator, tree_stats>::_internal_free_inner(inner_node_* _inner) {
+        std::allocator_traits<inner_allocator>::destroy(inner_alloc, _inner);
+        std::allocator_traits<inner_allocator>::deallocate(inner_alloc, _inner, 1U);
+        _internal_stats().record_free(1U);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    tree_stats_snapshot bplus_tree<Type, Compare, node_allocator, tree_stats>::stats() const {
+        return _internal_stats().snapshot();
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    void bplus_tree<Type, Compare, node_allocator, tree_stats>::reset_stats() {
+        tree_stats::reset();
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    tree_stats const & bplus_tree<Type, Compare, node_allocator, tree_stats>::_internal_stats() const {
+        return *this;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    bplus_tree<Type, Compare, node_allocator, tree_stats>::iterator::iterator(leaf_node_* _leaf, size_type _index, bplus_tree const * _tree) : leaf(_leaf), index(_index), tree(_tree) { }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    Type const& bplus_tree<Type, Compare, node_allocator, tree_stats>::iterator::operator*() const {
+        return leaf->keys[index];
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    Type const* bplus_tree<Type, Compare, node_allocator, tree_stats>::iterator::operator->() const {
+        return &leaf->keys[index];
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    bool bplus_tree<Type, Compare, node_allocator, tree_stats>::iterator::operator==(iterator const & _iter) const {
+        return leaf == _iter.leaf && index == _iter.index;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    bool bplus_tree<Type, Compare, node_allocator, tree_stats>::iterator::operator!=(iterator const & _iter) const {
+        return !(*this == _iter);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename bplus_tree<Type, Compare, node_allocator, tree_stats>::iterator& bplus_tree<Type, Compare, node_allocator, tree_stats>::iterator::operator++() {
+        if (++index == leaf->count) {
+            leaf  = leaf->next_leaf;
+            index = 0U;
+        }
+        return *this;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename bplus_tree<Type, Compare, node_allocator, tree_stats>::iterator bplus_tree<Type, Compare, node_allocator, tree_stats>::iterator::operator++(int) {
+        iterator ret_iter = *this;
+        ++(*this);
+        return ret_iter;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename bplus_tree<Type, Compare, node_allocator, tree_stats>::iterator& bplus_tree<Type, Compare, node_allocator, tree_stats>::iterator::operator--() {
+        if (leaf == nullptr) {
+            leaf  = tree->last_leaf;
+            index = leaf ? leaf->count - 1U : 0U;
+        }
+        else if (index == 0U) {
+            leaf  = leaf->prev_leaf;
+            index = leaf ? leaf->count - 1U : 0U;
+        }
+        else {
+            --index;
+        }
+        return *this;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename bplus_tree<Type, Compare, node_allocator, tree_stats>::iterator bplus_tree<Type, Compare, node_allocator, tree_stats>::iterator::operator--(int) {
+        iterator ret_iter = *this;
+        --(*this);
+        return ret_iter;
+    }
+}
+
+#endif
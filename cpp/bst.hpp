@@ -6,74 +6,122 @@
 * @author    snowapril
 * @date      2018-12-24 (ongoing)
 * @brief     custom binary search tree data structure which almost similar to STL.
-* @details   header only Binary Search Tree data structure. provide only downside_iterator.
+* @details   header only Binary Search Tree data structure. provide downside_iterator and inorder_iterator.
              when given downside_iterator, you can get it's left child using decrement operator 
              and it's right child using increment operator.
+             inorder_iterator walks the tree in sorted order through parent links, without recursion or auxiliary stack.
+             sorted input is bulk-loaded into a perfectly balanced tree in O(n) with single batch allocation.
+             copy, teardown and sub-tree size walk through parent links without recursion or auxiliary memory,
+             so they work on degenerate trees of any depth. copy is allocated as one node block.
+             parallel_* methods split build, copy, traversal, teardown and merge into subtree tasks of task_pool.
+             split, join and set algebra relink nodes of both trees instead of copying values.
+             insert moves r-value into its node, emplace constructs value in place, and remove and extract relink
+             nodes, so values are never copied after insertion. extracted node can be inserted into another tree.
+             node may carry augmented data of its sub-tree, e.g. subtree size for order statistics (order_statistic_tree)
+             or monoid summary (interval_tree, range_aggregate_tree), kept up to date on every structural change.
+             serialize and deserialize stream sorted values in bounded chunks, and rebuild balanced tree without search.
+             find_batch walks a group of searches in lockstep with prefetch, and reuses path prefix for sorted keys.
+             statistics policy counts comparisons, search path lengths, node allocations and deepest search path
+             (see tree_stats.hpp). default policy records nothing and costs nothing.
 * @see       
 * @reference http://tree.phi-sci.com/
 */
 
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+#include <functional>
 #include <initializer_list>
+#include <istream>
+#include <iterator>
 #include <memory>
-#include <queue>
+#include <optional>
+#include <ostream>
+#include <type_traits>
+#include <utility>
 #include <vector>
+#include "task_pool.hpp"
 #include "tree_exceptions.hpp"
+#include "tree_stats.hpp"
 #include "tree_util.hpp"
 
 namespace snowapril {
 
-    template <typename Type>
-    class bst_node_ {
+    //tag type which tells tree constructors that given range is already sorted in ascending order.
+    struct sorted_input_t { explicit sorted_input_t() = default; };
+    constexpr sorted_input_t sorted_input{};
+
+    template <typename Type, typename Augment = no_augment_>
+    class bst_node_ : public Augment {
     public:
+        using augment_type = Augment;
         bst_node_() = default; // default constructor
         bst_node_(Type const &); // constructor with l-value data
         bst_node_(Type&&); // constructor with r-value data
-        bst_node_(bst_node_<Type>*, Type const &); // constructor with parent pointer and l_value data.
-        bst_node_(bst_node_<Type>*, Type&&); // constructor with parent pointer and r_value data.
-        bst_node_(bst_node_<Type>&&); // move constructor
-        bst_node_<Type> & operator=(bst_node_<Type>&&); // move assignment operator
-        bst_node_(bst_node_<Type> const &); // copy constructor 
-        bst_node_<Type> & operator=(bst_node_<Type> const &); // copy assignment operator
+        bst_node_(bst_node_*, Type const &); // constructor with parent pointer and l_value data.
+        bst_node_(bst_node_*, Type&&); // constructor with parent pointer and r_value data.
+        template <typename... Args>
+        bst_node_(std::in_place_t, Args&&...); // constructor with arguments of data, constructed in place.
+        bst_node_(bst_node_&&); // move constructor
+        bst_node_ & operator=(bst_node_&&); // move assignment operator
+        //copy copies value and augmented data, not children. tree copies sub-trees without recursion.
+        bst_node_(bst_node_ const &); // copy constructor
+        bst_node_ & operator=(bst_node_ const &); // copy assignment operator
         ~bst_node_();
         bool operator==(bst_node_ const &) const;
         bool operator!=(bst_node_ const &) const;
     public:
-        bst_node_<Type> *parent_node = nullptr;
-        bst_node_<Type> *left_node   = nullptr;
-        bst_node_<Type> *right_node  = nullptr;
+        bst_node_ *parent_node = nullptr;
+        bst_node_ *left_node   = nullptr;
+        bst_node_ *right_node  = nullptr;
         Type value;
     };
 
-    template <typename Type, class node_allocator = std::allocator< bst_node_< Type > > >
-    class binary_search_tree {
+    //statistics policy is chosen at compile time. counting_tree_stats_ records hot path statistics and
+    //no_tree_stats_ (default) records nothing. policy is private base, so disabled statistics take no space.
+    template <typename Type, typename Compare = std::less<Type>, class node_allocator = std::allocator< bst_node_< Type > >, class tree_stats = no_tree_stats_ >
+    class binary_search_tree : private tree_stats {
     protected:
-        using node_type = bst_node_<Type>;
+        //node type is chosen by allocator, so allocator of augmented bst_node_ gives augmented tree.
+        using node_type = typename std::allocator_traits<node_allocator>::value_type;
     public:
         using value_type      = Type;
+        using key_compare     = Compare;
+        using augment_type    = typename node_type::augment_type;
+        using stats_type      = tree_stats;
         using pointer         = Type*;
         using reference       = Type&;
         using size_type       = size_t;
         using difference_type = ptrdiff_t;
         class iterator_base; 
         class downside_iterator;
+        class inorder_iterator;
+        using iterator         = inorder_iterator;
+        using reverse_iterator = std::reverse_iterator<inorder_iterator>;
 
         binary_search_tree() = default; // default constructor
-        binary_search_tree(iterator_base const &); // constructor with one iterator
+        explicit binary_search_tree(Compare const &); // constructor with comparator
+        binary_search_tree(Compare const &, node_allocator const &); // constructor with comparator and allocator
+        binary_search_tree(iterator_base const &); // constructor with copy of the sub-tree of given iterator
         template <typename GenericIterator>
         binary_search_tree(GenericIterator, GenericIterator); //constructor with two standard iterators
+        template <typename GenericIterator>
+        binary_search_tree(sorted_input_t, GenericIterator, GenericIterator); //constructor with two standard iterators over sorted range
         binary_search_tree(std::initializer_list<Type> const &); // constructor with l-value initializer_list
         binary_search_tree(std::initializer_list<Type>&&); // constructor with r-value initializer_list
         binary_search_tree(Type const *, Type const *); // constructor with two raw pointers
-        binary_search_tree(binary_search_tree<Type, node_allocator> const &); // copy constructor 
-        binary_search_tree<Type, node_allocator> & operator=(binary_search_tree<Type, node_allocator> const &); // copy assignment operator
-        binary_search_tree(binary_search_tree<Type, node_allocator> &&); // move constructor
-        binary_search_tree<Type, node_allocator> & operator=(binary_search_tree<Type, node_allocator> &&); // move assignment operator
+        binary_search_tree(binary_search_tree<Type, Compare, node_allocator, tree_stats> const &); // copy constructor 
+        binary_search_tree(binary_search_tree<Type, Compare, node_allocator, tree_stats> const &, node_allocator const &); // copy constructor with allocator
+        binary_search_tree<Type, Compare, node_allocator, tree_stats> & operator=(binary_search_tree<Type, Compare, node_allocator, tree_stats> const &); // copy assignment operator
+        binary_search_tree(binary_search_tree<Type, Compare, node_allocator, tree_stats> &&); // move constructor
+        binary_search_tree<Type, Compare, node_allocator, tree_stats> & operator=(binary_search_tree<Type, Compare, node_allocator, tree_stats> &&); // move assignment operator
         ~binary_search_tree(); // destructor
 
             class iterator_base {
-                friend class binary_search_tree<Type, node_allocator>;
+                friend class binary_search_tree<Type, Compare, node_allocator, tree_stats>;
             protected:
-                using node_type = bst_node_<Type>;
+                using node_type = typename binary_search_tree::node_type;
             public:
                 using value_type        = Type;
                 using pointer           = Type*;
@@ -113,10 +161,67 @@ namespace snowapril {
                 downside_iterator&      operator+=(unsigned int);
                 downside_iterator&      operator-=(unsigned int);
                 explicit operator bool() const;
-                
+                //return the number of nodes in the sub-tree. O(1) if node keeps subtree size, otherwise O(sub-tree).
                 size_type size() const;
+                //return augmented data of the sub-tree. value must not be modified in a way which changes it.
+                augment_type const & augment() const;
+            };
+
+            class inorder_iterator : public iterator_base {
+                friend class binary_search_tree<Type, Compare, node_allocator, tree_stats>;
+            public:
+                using iterator_category = std::bidirectional_iterator_tag;
+            public:
+                inorder_iterator() = default;
+                inorder_iterator(node_type*, binary_search_tree const *);
+            public:
+                bool                    operator==(inorder_iterator const &) const;
+                bool                    operator!=(inorder_iterator const &) const;
+                //move to in-order successor. amortized O(1) over a full traversal.
+                inorder_iterator&       operator++();
+                inorder_iterator        operator++(int);
+                //move to in-order predecessor. decrementing end() gives the largest element.
+                inorder_iterator&       operator--();
+                inorder_iterator        operator--(int);
+                //return downside_iterator which points same node.
+                downside_iterator       downside() const;
             private:
-                static size_type _internal_size(downside_iterator);
+                binary_search_tree const *tree = nullptr;
+            };
+        private:
+            struct node_block_;
+        public:
+            //node unlinked from tree by extract, which owns its value until it is inserted again or destroyed.
+            class node_handle {
+                friend class binary_search_tree<Type, Compare, node_allocator, tree_stats>;
+            public:
+                using value_type     = Type;
+                using allocator_type = node_allocator;
+            public:
+                node_handle() = default;
+                node_handle(node_handle&&) noexcept; // move constructor
+                node_handle & operator=(node_handle&&) noexcept; // move assignment operator
+                ~node_handle(); // destructor. destroys owned node, if any.
+                //return whether if handle owns no node.
+                bool            empty() const;
+                explicit        operator bool() const;
+                //return value of owned node. it may be modified, including its key, before insertion.
+                Type&           value() const;
+                allocator_type  get_allocator() const;
+            private:
+                node_handle(node_type*, node_allocator const &, std::shared_ptr<node_block_>);
+                void _internal_reset();
+            private:
+                node_type*                    node = nullptr;
+                std::optional<node_allocator> alloc;
+                //node block which holds the node, to keep it alive. nullptr if node was allocated alone.
+                std::shared_ptr<node_block_>  block;
+            };
+            //result of insert with node_handle. node keeps the handle back if equivalent element exists.
+            struct insert_return_type {
+                inorder_iterator position;
+                bool             inserted;
+                node_handle      node;
             };
         public:
             //return whether if tree is empty.
@@ -126,11 +231,70 @@ namespace snowapril {
             //return the number of node in this tree.
             size_type           size() const;
             //return downside_iterator of root node.
-            downside_iterator   begin() const;
+            downside_iterator   downside_begin() const;
+            //return inorder_iterator of the smallest element.
+            inorder_iterator    begin() const;
+            //return past-the-end inorder_iterator.
+            inorder_iterator    end() const;
+            reverse_iterator    rbegin() const;
+            reverse_iterator    rend() const;
+            //return comparator which determines order of elements.
+            key_compare         key_comp() const;
+            //return copy of node allocator. trees whose allocators compare equal can exchange nodes.
+            node_allocator      get_allocator() const;
+            //return copy of statistics counters, which is cheap enough to take on every metrics export.
+            //every counter is zero if statistics policy is no_tree_stats_.
+            tree_stats_snapshot stats() const;
+            //reset statistics counters, including max depth of searched paths.
+            void                reset_stats();
+            //lookup methods accept any key type if Compare is transparent (heterogeneous lookup), otherwise key is converted to Type.
+            //return inorder_iterator of the element equivalent to given key, end() if it does not exist.
+            template <typename Key = Type>
+            inorder_iterator    find(Key const &) const;
+            //return whether if the element equivalent to given key exists.
+            template <typename Key = Type>
+            bool                contains(Key const &) const;
+            //return the number of elements equivalent to given key. (0 or 1)
+            template <typename Key = Type>
+            size_type           count(Key const &) const;
+            //return inorder_iterator of the first element not less than given key.
+            template <typename Key = Type>
+            inorder_iterator    lower_bound(Key const &) const;
+            //return inorder_iterator of the first element greater than given key.
+            template <typename Key = Type>
+            inorder_iterator    upper_bound(Key const &) const;
+            //return pair of lower_bound and upper_bound.
+            template <typename Key = Type>
+            std::pair<inorder_iterator, inorder_iterator> equal_range(Key const &) const;
+            //batched find over forward range of keys. write result of find for each key to given output iterator,
+            //in key order, and return the output iterator past the last result.
+            //searches of batch_lookup_width keys walk in lockstep, one level each per round, and prefetch their next
+            //node, so cache misses of the group overlap instead of following one another.
+            template <typename KeyIterator, typename OutputIterator>
+            OutputIterator      find_batch(KeyIterator, KeyIterator, OutputIterator) const;
+            //batched find over keys in ascending order. each search resumes from the deepest node on the path of
+            //previous search whose sub-tree may hold the key, so shared path prefix is walked once.
+            //key out of order only resumes from a shallower node, so the result is correct for any order.
+            template <typename KeyIterator, typename OutputIterator>
+            OutputIterator      find_batch(sorted_input_t, KeyIterator, KeyIterator, OutputIterator) const;
+            //order statistic queries in O(height). they need nodes which keep subtree size (see order_statistic_tree).
+            //return the number of elements less than given key.
+            template <typename Key = Type>
+            size_type           rank(Key const &) const;
+            //return inorder_iterator of the element at given zero based position in sorted order, end() if out of range.
+            inorder_iterator    select(size_type) const;
+            //return the number of elements in [first key, last key).
+            template <typename Key = Type>
+            size_type           count_range(Key const &, Key const &) const;
             //return the depth of given iterator in this tree.
             size_type           depth(downside_iterator const &) const;
             //return the height(depth + 1) of given iterator in this tree.
             size_type           height(downside_iterator const &) const;
+            //remove every node in this tree and release bulk allocated node blocks.
+            void                clear();
+            //replace contents with given sorted range. build perfectly balanced tree in O(n), duplicated values are skipped.
+            template <typename GenericIterator>
+            void                bulk_load(GenericIterator, GenericIterator);
             //remove sub-tree where given iterator is root node.
             downside_iterator   erase(downside_iterator);
             //remove node which is matched with given value in this tree.
@@ -141,209 +305,687 @@ namespace snowapril {
             void append(Type const &);
             //append node with given value in the sub-tree where given iterator is root node.
             void append(downside_iterator);
+            //insert value if no equivalent element exists. return inorder_iterator of the element equivalent to it
+            //and whether if insertion took place. r-value is moved into new node.
+            std::pair<inorder_iterator, bool> insert(Type const &);
+            std::pair<inorder_iterator, bool> insert(Type&&);
+            //construct value in place from given arguments and insert it like insert.
+            //value is needed for search, so it is constructed first and destroyed again if equivalent element exists.
+            template <typename... Args>
+            std::pair<inorder_iterator, bool> emplace(Args&&...);
+            //unlink node at given position, or equivalent to given key, and return it as node_handle.
+            //value is neither copied nor moved. extract by key returns empty handle if no element is equivalent to it.
+            node_handle extract(inorder_iterator);
+            node_handle extract(Type const &);
+            //link node of given handle, which becomes empty. handle keeps the node if equivalent element exists.
+            //throw different_tree_exception if allocator of handle is not interchangeable with this tree.
+            insert_return_type insert(node_handle&&);
+            //parallel bulk operations. work is split into subtree tasks of given pool down to a depth which gives
+            //a few tasks per thread, and every task runs sequentially below that depth.
+            //replace contents with given sorted random access range. nodes are constructed and linked in parallel.
+            template <typename RandomIterator>
+            void parallel_bulk_load(task_pool &, RandomIterator, RandomIterator);
+            //replace contents with deep copy of given tree. copy keeps the shape and lives in one node block.
+            void parallel_copy(task_pool &, binary_search_tree<Type, Compare, node_allocator, tree_stats> const &);
+            //call given function with every value. calls run concurrently and in no particular order.
+            template <typename Function>
+            void parallel_for_each(task_pool &, Function&&) const;
+            //remove every node, destroying values in parallel.
+            void parallel_clear(task_pool &);
+            //move values of given tree which are not in this tree into this tree, reusing their nodes.
+            //given tree becomes empty. throw different_tree_exception if allocators are not interchangeable.
+            void parallel_union(task_pool &, binary_search_tree<Type, Compare, node_allocator, tree_stats> &&);
+            //keep only values which are also in given tree. given tree becomes empty.
+            void parallel_intersection(task_pool &, binary_search_tree<Type, Compare, node_allocator, tree_stats> &&);
+            //split, join and set algebra relink nodes instead of copying values. trees exchanging nodes share
+            //node blocks, and throw different_tree_exception if allocators are not interchangeable.
+            //move every value not less than given value into returned tree. O(height + size of returned tree).
+            binary_search_tree split(Type const &);
+            //move every value of given tree to the end of this tree. O(height).
+            //throw std::invalid_argument if some value of given tree is not greater than every value of this tree.
+            void join(binary_search_tree<Type, Compare, node_allocator, tree_stats> &&);
+            //move values of given tree which are not in this tree into this tree. duplicated values stay in given tree.
+            void merge(binary_search_tree<Type, Compare, node_allocator, tree_stats> &);
+            //set algebra with given tree, which becomes empty. O(m log(n/m + 1)) for balanced trees of size n and m <= n.
+            void set_union(binary_search_tree<Type, Compare, node_allocator, tree_stats> &&);
+            void set_intersection(binary_search_tree<Type, Compare, node_allocator, tree_stats> &&);
+            //remove values which are in given tree.
+            void set_difference(binary_search_tree<Type, Compare, node_allocator, tree_stats> &&);
+            //binary stream format of sorted values. Type must be trivially copyable, and stream is only readable
+            //on machines of the same byte order. neither method recurses, so degenerate trees are handled as well.
+            //write header and every value in ascending order, in chunks of bounded size. failure is reported by stream state.
+            void serialize(std::ostream &) const;
+            //replace contents with values read from given stream, in chunks of bounded size. tree is rebuilt
+            //perfectly balanced in O(n) without search, whatever shape the serialized tree had. nodes are allocated
+            //per chunk as values arrive, so node count in the header never sizes an allocation by itself.
+            //throw tree_format_exception if stream does not hold serialized tree of this Type, then tree is unchanged.
+            void deserialize(std::istream &);
         private:
-            //implementation of method which removes node in the tree.
-            void _internal_remove(node_type*, Type const &);
-            //implementation of method which appends node in the tree.
-            void _internal_append(node_type*, Type const &);
+            //statistics policy of this tree. hooks are const, so lookup methods record statistics as well.
+            tree_stats const & _internal_stats() const;
+            //implementation of method which removes node in the tree. return parent of removed position.
+            node_type* _internal_remove(node_type*, Type const &);
+            //insert value by search from root, constructing node from given value only if no element is equivalent.
+            template <typename Value>
+            std::pair<inorder_iterator, bool> _internal_insert_unique(Value&&);
+            //link detached node as child of given leaf position, found by search for its value.
+            void _internal_link_leaf(node_type*, node_type*);
+            //unlink given node by relinking its neighbours, without moving any value. return the lowest node whose
+            //sub-tree lost the node, which is the start of path whose augmented data is updated.
+            node_type* _internal_unlink(node_type*);
+            //replace link of given parent, or root, which refers to first node with second node.
+            void _internal_replace_child(node_type*, node_type*, node_type*);
             //implementation of methid which finds location of node with given value
             node_type* _internal_find_parent_node(node_type*, Type const &);
+            //key type used by lookup methods. heterogeneous key is passed through only if Compare is transparent.
+            template <typename Key>
+            using lookup_key_t = typename std::conditional<is_transparent_compare_<Compare>::value, Key, Type>::type;
+            //implementation of lower_bound in the sub-tree where given node is root node.
+            //descent keeps one comparison per level. second argument receives the last visited node.
+            template <typename Key>
+            node_type* _internal_lower_bound(node_type*, node_type*&, Key const &) const;
+            //generic descent for arbitrary comparator.
+            template <typename Key>
+            node_type* _internal_lower_bound(node_type*, node_type*&, Key const &, std::false_type) const;
+            //descent for arithmetic key with standard comparator. both children are loaded and selected with bit mask,
+            //so the loop has no data dependent branch except loop exit.
+            template <typename Key>
+            node_type* _internal_lower_bound(node_type*, node_type*&, Key const &, std::true_type) const;
+            template <typename Key>
+            node_type* _internal_upper_bound(Key const &) const;
+            //build tree from given range. use bulk_load if range is multi-pass and sorted, otherwise append one by one.
+            template <typename GenericIterator>
+            void _internal_build(GenericIterator, GenericIterator, std::input_iterator_tag);
+            template <typename GenericIterator>
+            void _internal_build(GenericIterator, GenericIterator, std::forward_iterator_tag);
+            //link nodes of [begin, end) in contiguous block as perfectly balanced sub-tree. return its root node.
+            static node_type* _internal_link_balanced(node_type*, node_type*, node_type*);
+            //contiguous storage of given number of nodes, returned to allocator on destruction.
+            //node_handle of extracted node shares the block, so the block outlives every tree which held it.
+            struct node_block_ {
+                node_block_(node_allocator const &, size_type);
+                node_block_(node_block_ const &) = delete;
+                node_block_ & operator=(node_block_ const &) = delete;
+                ~node_block_();
+                bool contains(node_type const*) const;
+
+                node_allocator         alloc;
+                size_type              size;
+                node_type*             nodes;
+                //the number of constructed nodes of the block, in every tree and node_handle which holds one.
+                //trees split from one another share blocks and may run on different threads, so it is atomic.
+                std::atomic<size_type> num_live { 0U };
+            };
+            //reference of this tree to a node block, with free slots of the block which this tree recycles.
+            struct block_ref_ {
+                std::shared_ptr<node_block_> block;
+                node_type*                   free_nodes = nullptr;
+            };
+            //index which refers to no block reference.
+            static constexpr size_type no_block = static_cast<size_type>(-1);
+            //allocate node block of given size owned by this tree. return its first node.
+            //nodes constructed in it are counted by _internal_commit_block once the whole block is filled.
+            node_type* _internal_allocate_block(size_type);
+            //count given number of constructed nodes of the block which starts at given node.
+            void _internal_commit_block(node_type*, size_type);
+            //destroy constructed nodes [begin, end) of a block which is not committed yet, on failure of filling it.
+            void _internal_destroy_range(node_type*, node_type*);
+            //drop reference of this tree to the block which starts at given node, after its filling failed.
+            void _internal_release_block(node_type*);
+            //return index of node block reference of this tree which holds given node, no_block if node was
+            //allocated alone. O(log(number of blocks)), references are sorted by address.
+            size_type _internal_find_block(node_type const*) const;
+            //insert given block reference at its address order and return its index. keep free list hint valid.
+            size_type _internal_insert_block(block_ref_&&);
+            void _internal_erase_block(size_type);
+            //return node storage from bulk free list or allocator, and construct node with given arguments.
+            template <typename... Args>
+            node_type* _internal_create_node(Args&&...);
+            //destroy node and return its storage to bulk free list or allocator.
+            void _internal_destroy_node(node_type*);
+            //copy sub-tree of given size into one new node block by walking both trees through parent links,
+            //without recursion or auxiliary memory. return root of the copy, whose parent is nullptr.
+            node_type* _internal_copy_subtree(node_type const*, size_type);
+            //destroy every node of sub-tree in post-order through parent links, without recursion or auxiliary memory.
+            //sub-tree must be detached from its parent. return the number of destroyed nodes.
+            size_type _internal_destroy_subtree(node_type*);
+            //return the left-most and right-most node of the sub-tree where given node is root node.
+            static node_type* _internal_minimum(node_type*);
+            static node_type* _internal_maximum(node_type*);
+            static constexpr bool is_augmented   = !std::is_same<augment_type, no_augment_>::value;
+            static constexpr bool is_size_tracked = std::is_base_of<subtree_size_augment_, node_type>::value;
+            //recompute augmented data of given node, or of every node from given node up to the root.
+            static void _internal_update(node_type*);
+            static void _internal_update_path(node_type*);
+            //same as _internal_update_path after given number of nodes were added below given node.
+            //plain subtree size is adjusted without reading siblings, other augmented data is recomputed.
+            static void _internal_resize_path(node_type*, difference_type);
+            static void _internal_resize_path(node_type*, difference_type, std::true_type);
+            static void _internal_resize_path(node_type*, difference_type, std::false_type);
+            //copy augmented data of node with the same sub-tree shape.
+            static void _internal_copy_augment(node_type*, node_type const*);
+            //return the number of nodes in the sub-tree. O(1) if size is tracked, otherwise counted by parent-link walk
+            //without recursion or auxiliary memory.
+            static size_type _internal_subtree_size(node_type const*);
+            static size_type _internal_subtree_size(node_type const*, std::true_type);
+            static size_type _internal_subtree_size(node_type const*, std::false_type);
+            //link nodes of [begin, end) in pointer array as perfectly balanced sub-tree. return its root node.
+            static node_type* _internal_link_balanced(node_type**, node_type**, node_type*);
+            //link nodes of index range [begin, end) as perfectly balanced sub-tree, where node i is slot i % stream_chunk_size
+            //of block i / stream_chunk_size. (layout built by deserialize) return its root node.
+            static node_type* _internal_link_chunked(node_type* const*, size_type, size_type, node_type*);
+            //push nodes of the sub-tree in ascending order into given vector, without recursion.
+            static void _internal_collect_inorder(node_type*, std::vector<node_type*>&);
+            //return how many levels of the tree are split into tasks for given pool.
+            static size_type _internal_parallel_depth(task_pool const &);
+            //link contiguous block as balanced sub-tree like _internal_link_balanced, forking top levels into tasks.
+            static node_type* _internal_parallel_link(task_pool &, node_type*, node_type*, node_type*, size_type, size_type);
+            //count nodes of sub-tree, recording size of each node above max depth by its heap index (root is 1).
+            size_type _internal_parallel_count(task_pool &, node_type const*, size_type, size_type, size_type, std::vector<size_type>&) const;
+            //copy sub-tree into given slots, which are exactly as many as its nodes. return root of the copy.
+            node_type* _internal_parallel_copy(task_pool &, node_type const*, node_type*, node_type*, size_type, size_type, size_type, std::vector<size_type> const &);
+            enum class merge_mode_ { union_, intersection_, difference_ };
+            //merge recursion deeper than this, which only badly unbalanced trees reach, falls back to flat merge.
+            static constexpr size_type max_merge_depth = 64U;
+            //merged sub-tree and chain of nodes dropped by the merge, linked through right_node.
+            struct merge_result_ {
+                node_type* root         = nullptr;
+                node_type* dropped      = nullptr;
+                node_type* dropped_tail = nullptr;
+                size_type  num_dropped  = 0U;
+                void drop(node_type*);
+                void append_dropped(merge_result_ const &);
+            };
+            //split sub-tree into nodes less than and greater than given value. return detached node equal to it, or nullptr.
+            node_type* _internal_split(node_type*, Type const &, node_type*&, node_type*&) const;
+            //concatenate two sub-trees where every value of first one is less than every value of second one.
+            //maximum of first sub-tree becomes the root, so height grows by at most one.
+            static node_type* _internal_join(node_type*, node_type*);
+            //merge two sub-trees by split on root of first one. O(m log(n/m + 1)) for balanced sub-trees.
+            //sub-problems are forked into pool, if any, above given fork depth.
+            merge_result_ _internal_merge(task_pool*, node_type*, node_type*, merge_mode_, size_type, size_type) const;
+            //merge two sub-trees by flattening both into sorted arrays, then relink kept nodes as balanced sub-tree.
+            merge_result_ _internal_merge_flat(node_type*, node_type*, merge_mode_) const;
+            //share node blocks of given tree, so its nodes can be owned by this tree. blocks without live node are
+            //dropped on the way. O(number of blocks of both trees).
+            //throw different_tree_exception if allocators are not interchangeable.
+            void _internal_share_blocks(binary_search_tree<Type, Compare, node_allocator, tree_stats> const &);
+            //share node blocks and take free lists of given tree.
+            void _internal_adopt_storage(binary_search_tree<Type, Compare, node_allocator, tree_stats> &);
+            //merge block references of given tree into this tree's. free lists are taken only if given to move.
+            void _internal_merge_blocks(std::vector<block_ref_>&, bool);
+            //merge given tree into this tree by given mode, destroy dropped nodes and leave given tree empty.
+            void _internal_set_operation(task_pool*, binary_search_tree<Type, Compare, node_allocator, tree_stats> &, merge_mode_);
+            //fixed size header of serialized tree, followed by num_node values.
+            struct stream_header_ {
+                char     magic[8];
+                uint32_t version;
+                uint32_t byte_order;
+                uint64_t value_size;
+                uint64_t num_node;
+            };
+            static constexpr char     stream_magic[8]     = { 'S', 'N', 'W', 'S', 'T', 'R', 'M', '\0' };
+            static constexpr uint32_t stream_version      = 1U;
+            static constexpr uint32_t stream_byte_order   = 0x01020304U;
+            //values buffered per read or write call of serialize and deserialize.
+            static constexpr size_type stream_chunk_bytes = 64U * 1024U;
+            static constexpr size_type stream_chunk_size  = stream_chunk_bytes / sizeof(Type) ? stream_chunk_bytes / sizeof(Type) : 1U;
+            //node on the path of sorted find_batch, with the nearest ancestors whose left and right sub-tree holds it.
+            //values of its sub-tree lie between values of those ancestors, either of which is nullptr if there is no such one.
+            struct path_entry_ {
+                node_type* node;
+                node_type* lower_node;
+                node_type* upper_node;
+            };
         private:
             node_allocator alloc;
+            Compare    comp;
             node_type* root     = nullptr;
             size_type  num_node = 0U;
+            //node blocks allocated at once by bulk operations, sorted by address. nodes in these blocks are recycled
+            //through free list of their block instead of being returned to allocator one by one. split and merge move
+            //nodes between trees, so every tree which may own nodes of a block shares it. tree drops the block when
+            //its last live node is destroyed, and the block is released when the last tree or handle drops it.
+            std::vector<block_ref_> node_blocks;
+            //index of block reference whose free list new node is taken from. (the one which got the latest slot)
+            size_type free_block = no_block;
     };
 
-    template <typename Type>
-    bst_node_<Type>::bst_node_(Type const & _l_value) : value(_l_value) { }   
+    //binary search tree whose nodes keep subtree size, so rank, select and range count run in O(height).
+    template <typename Type, typename Compare = std::less<Type>>
+    using order_statistic_tree = binary_search_tree<Type, Compare, std::allocator<bst_node_<Type, subtree_size_augment_>>>;
+
+    //binary search tree which records hot path statistics. see stats() and tree_stats.hpp.
+    template <typename Type, typename Compare = std::less<Type>>
+    using instrumented_search_tree = binary_search_tree<Type, Compare, std::allocator<bst_node_<Type>>, counting_tree_stats_>;
 
-    template <typename Type>
-    bst_node_<Type>::bst_node_(Type&& _r_value) : value(move(_r_value)) { }
+    template <typename Type, typename Augment>
+    bst_node_<Type, Augment>::bst_node_(Type const & _l_value) : value(_l_value) { }   
 
-    template <typename Type>
-    bst_node_<Type>::bst_node_(bst_node_<Type> *parent, Type const &_l_value) : parent_node(parent), value(_l_value) { }
-    template <typename Type>
-    bst_node_<Type>::bst_node_(bst_node_<Type> *parent, Type &&_r_value) : parent_node(parent), value(move(_r_value)) { }
+    template <typename Type, typename Augment>
+    bst_node_<Type, Augment>::bst_node_(Type&& _r_value) : value(std::move(_r_value)) { }
 
-    template <typename Type>
-    bst_node_<Type>::bst_node_(bst_node_<Type>&& _r_node) {
+    template <typename Type, typename Augment>
+    bst_node_<Type, Augment>::bst_node_(bst_node_<Type, Augment> *parent, Type const &_l_value) : parent_node(parent), value(_l_value) { }
+    template <typename Type, typename Augment>
+    bst_node_<Type, Augment>::bst_node_(bst_node_<Type, Augment> *parent, Type &&_r_value) : parent_node(parent), value(std::move(_r_value)) { }
+
+    template <typename Type, typename Augment>
+    template <typename... Args>
+    bst_node_<Type, Augment>::bst_node_(std::in_place_t, Args&&... _args) : value(std::forward<Args>(_args)...) { }
+
+    template <typename Type, typename Augment>
+    bst_node_<Type, Augment>::bst_node_(bst_node_<Type, Augment>&& _r_node) {
         left_node   = _r_node.left_node;
         right_node  = _r_node.right_node;
         parent_node = _r_node.parent_node;
-        value       = move(_r_node.value);
-        _r_node.left_node = (_r_node.right_node (_r_node.parent_node = nullptr));
+        value       = std::move(_r_node.value);
+        _r_node.left_node = _r_node.right_node = _r_node.parent_node = nullptr;
     }
 
-    template <typename Type>
-    bst_node_<Type> & bst_node_<Type>::operator=(bst_node_<Type>&& _r_node) {
+    template <typename Type, typename Augment>
+    bst_node_<Type, Augment> & bst_node_<Type, Augment>::operator=(bst_node_<Type, Augment>&& _r_node) {
         if (this != &_r_node) {
             left_node   = _r_node.left_node;
             right_node  = _r_node.right_node;
             parent_node = _r_node.parent_node;
-            value       = move(_r_node.value);
-            _r_node.left_node = (_r_node.right_node (_r_node.parent_node = nullptr));
+            value       = std::move(_r_node.value);
+            _r_node.left_node = _r_node.right_node = _r_node.parent_node = nullptr;
         }
         return *this;
     }
 
-    template <typename Type>
-    bst_node_<Type>::bst_node_(bst_node_<Type> const & _l_node) {
-        value = _l_node.value;
-        if (_l_node.left_node)  left_node  = new bst_node_(*(_l_node.left_node));
-        if (_l_node.right_node) right_node = new bst_node_(*(_l_node.right_node));
-    }
+    template <typename Type, typename Augment>
+    bst_node_<Type, Augment>::bst_node_(bst_node_<Type, Augment> const & _l_node) : Augment(_l_node), value(_l_node.value) { }
 
-    template <typename Type>
-    bst_node_<Type> & bst_node_<Type>::operator=(bst_node_<Type> const & _l_node) {
+    template <typename Type, typename Augment>
+    bst_node_<Type, Augment> & bst_node_<Type, Augment>::operator=(bst_node_<Type, Augment> const & _l_node) {
         if (this != &_l_node) {
+            Augment::operator=(_l_node);
             value = _l_node.value;
-            if (_l_node.left_node)  left_node  = new bst_node_(*(_l_node.left_node));
-            if (_l_node.right_node) right_node = new bst_node_(*(_l_node.right_node));
         }
 
         return *this;
     }
 
-    template <typename Type>
-    bst_node_<Type>::~bst_node_() {
+    template <typename Type, typename Augment>
+    bst_node_<Type, Augment>::~bst_node_() {
         LOG("destructor", this->value);
     }
 
-    template <typename Type>
-    bool bst_node_<Type>::operator==(bst_node_ const & _node) const {
+    template <typename Type, typename Augment>
+    bool bst_node_<Type, Augment>::operator==(bst_node_ const & _node) const {
         return value == _node.value;
     }
-    template <typename Type>
-    bool bst_node_<Type>::operator!=(bst_node_ const & _node) const {
+    template <typename Type, typename Augment>
+    bool bst_node_<Type, Augment>::operator!=(bst_node_ const & _node) const {
         return value != _node.value;
     }
 
-    template <typename Type, class node_allocator>
-    binary_search_tree<Type, node_allocator>::binary_search_tree(iterator_base const &_iter) {
-        if (root) {
-            alloc.destroy(root);
-            alloc.deallocate(root, 1);
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    binary_search_tree<Type, Compare, node_allocator, tree_stats>::binary_search_tree(Compare const & _comp) : comp(_comp) { }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    binary_search_tree<Type, Compare, node_allocator, tree_stats>::binary_search_tree(Compare const & _comp, node_allocator const & _alloc) : alloc(_alloc), comp(_comp) { }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    binary_search_tree<Type, Compare, node_allocator, tree_stats>::binary_search_tree(iterator_base const &_iter) {
+        if (_iter.node) {
+            num_node = _internal_subtree_size(_iter.node);
+            root     = _internal_copy_subtree(_iter.node, num_node);
         }
-        root = alloc.allocate(1, 0);
-        root = alloc.construct(*_iter);
     }
 
-    template <typename Type, class node_allocator>
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
     template <typename GenericIterator>
-    binary_search_tree<Type, node_allocator>::binary_search_tree(GenericIterator _begin_iter, GenericIterator _end_iter) {
-        if (root) {
-            alloc.destroy(root);
-            alloc.deallocate(root, 1);
-        }
-        for_each(_begin_iter, _end_iter, [this](const Type& _value) {
-            this->append(_value);
-        });        
+    binary_search_tree<Type, Compare, node_allocator, tree_stats>::binary_search_tree(GenericIterator _begin_iter, GenericIterator _end_iter) {
+        _internal_build(_begin_iter, _end_iter, typename std::iterator_traits<GenericIterator>::iterator_category());
     }
 
-    template <typename Type, class node_allocator>
-    binary_search_tree<Type, node_allocator>::binary_search_tree(std::initializer_list<Type> const & _i_list) {
-        if (root) {
-            alloc.destroy(root);
-            alloc.deallocate(root, 1);
-        }
-        for (const auto& _value : _i_list) {
-            this->append(_value);
-        }
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    template <typename GenericIterator>
+    binary_search_tree<Type, Compare, node_allocator, tree_stats>::binary_search_tree(sorted_input_t, GenericIterator _begin_iter, GenericIterator _end_iter) {
+        bulk_load(_begin_iter, _end_iter);
     }
 
-    template <typename Type, class node_allocator>
-    binary_search_tree<Type, node_allocator>::binary_search_tree(std::initializer_list<Type>&& _r_i_list) {
-        if (root) {
-            alloc.destroy(root);
-            alloc.deallocate(root, 1);
-        }
-        auto i_list = move(_r_i_list);
-        for (const auto& _value : i_list) {
-            this->append(_value);
-        }
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    binary_search_tree<Type, Compare, node_allocator, tree_stats>::binary_search_tree(std::initializer_list<Type> const & _i_list) {
+        _internal_build(_i_list.begin(), _i_list.end(), std::random_access_iterator_tag());
     }
 
-    template <typename Type, class node_allocator>
-    binary_search_tree<Type, node_allocator>::binary_search_tree(Type const *_begin_iter, Type const *_end_iter) {
-        if (root) {
-            alloc.destroy(root);
-            alloc.deallocate(root, 1);
-        }
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    binary_search_tree<Type, Compare, node_allocator, tree_stats>::binary_search_tree(std::initializer_list<Type>&& _r_i_list) {
+        _internal_build(_r_i_list.begin(), _r_i_list.end(), std::random_access_iterator_tag());
+    }
 
-        for (Type const *iter = _begin_iter; iter != _end_iter; ++iter) {
-            this->append(*iter);
-        }
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    binary_search_tree<Type, Compare, node_allocator, tree_stats>::binary_search_tree(Type const *_begin_iter, Type const *_end_iter) {
+        _internal_build(_begin_iter, _end_iter, std::random_access_iterator_tag());
     }
 
-    template <typename Type, class node_allocator>
-    binary_search_tree<Type, node_allocator>::binary_search_tree(binary_search_tree<Type, node_allocator> const & _l_tree) {
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    binary_search_tree<Type, Compare, node_allocator, tree_stats>::binary_search_tree(binary_search_tree<Type, Compare, node_allocator, tree_stats> const & _l_tree)
+        : binary_search_tree(_l_tree, std::allocator_traits<node_allocator>::select_on_container_copy_construction(_l_tree.alloc)) { }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    binary_search_tree<Type, Compare, node_allocator, tree_stats>::binary_search_tree(binary_search_tree<Type, Compare, node_allocator, tree_stats> const & _l_tree, node_allocator const & _alloc)
+        : alloc(_alloc), comp(_l_tree.comp) {
         if (_l_tree.root) {
-            root = alloc.allocate(1, 0);
-            alloc.construct(root, *_l_tree.root);
+            root     = _internal_copy_subtree(_l_tree.root, _l_tree.num_node);
+            num_node = _l_tree.num_node;
+            _internal_stats().reset_depth(_l_tree._internal_stats().recorded_depth());
         }
-        num_node = _l_tree.num_node;
     }
 
-    template <typename Type, class node_allocator>
-    binary_search_tree<Type, node_allocator> & binary_search_tree<Type, node_allocator>::operator=(binary_search_tree<Type, node_allocator> const & _l_tree) {
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    binary_search_tree<Type, Compare, node_allocator, tree_stats> & binary_search_tree<Type, Compare, node_allocator, tree_stats>::operator=(binary_search_tree<Type, Compare, node_allocator, tree_stats> const & _l_tree) {
         if (this != &_l_tree) {
-            if (_l_tree.root) {
-                root = alloc.allocate(1, 0);
-                alloc.construct(root, *_l_tree.root);
-            }
-            num_node = _l_tree.num_node;
+            //copy first, so this tree is unchanged if copy throws.
+            binary_search_tree<Type, Compare, node_allocator, tree_stats> copy(_l_tree);
+            *this = std::move(copy);
         }
         return *this;
     }
     
-    template <typename Type, class node_allocator>
-    binary_search_tree<Type, node_allocator>::binary_search_tree(binary_search_tree<Type, node_allocator> && _r_tree) {
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    binary_search_tree<Type, Compare, node_allocator, tree_stats>::binary_search_tree(binary_search_tree<Type, Compare, node_allocator, tree_stats> && _r_tree) : alloc(_r_tree.alloc), comp(_r_tree.comp) {
+        node_blocks.swap(_r_tree.node_blocks);
+        free_block = _r_tree.free_block;
+        _r_tree.free_block = no_block;
         root = _r_tree.root;
         _r_tree.root = nullptr;
         num_node = _r_tree.num_node;
         _r_tree.num_node = 0U;
+        _internal_stats().reset_depth(_r_tree._internal_stats().recorded_depth());
+        _r_tree._internal_stats().reset_depth(0U);
     }
 
-    template <typename Type, class node_allocator>
-    binary_search_tree<Type, node_allocator> & binary_search_tree<Type, node_allocator>::operator=(binary_search_tree<Type, node_allocator> && _r_tree) {
-        if (this != _r_tree) {
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    binary_search_tree<Type, Compare, node_allocator, tree_stats> & binary_search_tree<Type, Compare, node_allocator, tree_stats>::operator=(binary_search_tree<Type, Compare, node_allocator, tree_stats> && _r_tree) {
+        if (this != &_r_tree) {
+            clear();
+            alloc = _r_tree.alloc;
+            comp  = _r_tree.comp;
+            node_blocks.swap(_r_tree.node_blocks);
+            free_block = _r_tree.free_block;
+            _r_tree.free_block = no_block;
             root = _r_tree.root;
             _r_tree.root = nullptr;
             num_node = _r_tree.num_node;
             _r_tree.num_node = 0U;
+            _internal_stats().reset_depth(_r_tree._internal_stats().recorded_depth());
+            _r_tree._internal_stats().reset_depth(0U);
         }
         return *this;
     } 
 
-    template <typename Type, class node_allocator>
-    binary_search_tree<Type, node_allocator>::~binary_search_tree() {
-        if (root) {
-            erase(downside_iterator(root));
-        }
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    binary_search_tree<Type, Compare, node_allocator, tree_stats>::~binary_search_tree() {
+        clear();
     }
     
-    template <typename Type, class node_allocator>
-    bool binary_search_tree<Type, node_allocator>::empty() const {
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    bool binary_search_tree<Type, Compare, node_allocator, tree_stats>::empty() const {
         return num_node == 0U;
     }
     
-    template <typename Type, class node_allocator>
-    bool binary_search_tree<Type, node_allocator>::is_root(downside_iterator const & _iter) const {
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    bool binary_search_tree<Type, Compare, node_allocator, tree_stats>::is_root(downside_iterator const & _iter) const {
         return root == *_iter;
     }
     
-    template <typename Type, class node_allocator>
-    typename binary_search_tree<Type, node_allocator>::size_type binary_search_tree<Type, node_allocator>::size() const {
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::size_type binary_search_tree<Type, Compare, node_allocator, tree_stats>::size() const {
         return num_node;
     }
     
-    template <typename Type, class node_allocator>
-    typename binary_search_tree<Type, node_allocator>::downside_iterator binary_search_tree<Type, node_allocator>::begin() const {
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::downside_iterator binary_search_tree<Type, Compare, node_allocator, tree_stats>::downside_begin() const {
         return downside_iterator(root);
     }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::inorder_iterator binary_search_tree<Type, Compare, node_allocator, tree_stats>::begin() const {
+        return inorder_iterator(root ? _internal_minimum(root) : nullptr, this);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::inorder_iterator binary_search_tree<Type, Compare, node_allocator, tree_stats>::end() const {
+        return inorder_iterator(nullptr, this);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::reverse_iterator binary_search_tree<Type, Compare, node_allocator, tree_stats>::rbegin() const {
+        return reverse_iterator(end());
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::reverse_iterator binary_search_tree<Type, Compare, node_allocator, tree_stats>::rend() const {
+        return reverse_iterator(begin());
+    }
     
-    template <typename Type, class node_allocator>
-    typename binary_search_tree<Type, node_allocator>::size_type binary_search_tree<Type, node_allocator>::depth(downside_iterator const & _iter) const {    
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::key_compare binary_search_tree<Type, Compare, node_allocator, tree_stats>::key_comp() const {
+        return comp;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    node_allocator binary_search_tree<Type, Compare, node_allocator, tree_stats>::get_allocator() const {
+        return alloc;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    tree_stats_snapshot binary_search_tree<Type, Compare, node_allocator, tree_stats>::stats() const {
+        return _internal_stats().snapshot();
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    void binary_search_tree<Type, Compare, node_allocator, tree_stats>::reset_stats() {
+        tree_stats::reset();
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    tree_stats const & binary_search_tree<Type, Compare, node_allocator, tree_stats>::_internal_stats() const {
+        return *this;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    template <typename Key>
+    typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::inorder_iterator binary_search_tree<Type, Compare, node_allocator, tree_stats>::find(Key const & _key) const {
+        lookup_key_t<Key> const & key = _key;
+        node_type* last_node;
+        node_type* node = _internal_lower_bound(root, last_node, key);
+        _internal_stats().record_compare(node ? 1U : 0U);
+        if (node && comp(key, node->value)) node = nullptr;
+        return inorder_iterator(node, this);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    template <typename Key>
+    bool binary_search_tree<Type, Compare, node_allocator, tree_stats>::contains(Key const & _key) const {
+        lookup_key_t<Key> const & key = _key;
+        node_type* last_node;
+        node_type* node = _internal_lower_bound(root, last_node, key);
+        _internal_stats().record_compare(node ? 1U : 0U);
+        return node && !comp(key, node->value);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    template <typename Key>
+    typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::size_type binary_search_tree<Type, Compare, node_allocator, tree_stats>::count(Key const & _key) const {
+        return contains(_key) ? 1U : 0U;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    template <typename Key>
+    typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::inorder_iterator binary_search_tree<Type, Compare, node_allocator, tree_stats>::lower_bound(Key const & _key) const {
+        lookup_key_t<Key> const & key = _key;
+        node_type* last_node;
+        return inorder_iterator(_internal_lower_bound(root, last_node, key), this);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    template <typename Key>
+    typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::inorder_iterator binary_search_tree<Type, Compare, node_allocator, tree_stats>::upper_bound(Key const & _key) const {
+        lookup_key_t<Key> const & key = _key;
+        return inorder_iterator(_internal_upper_bound(key), this);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    template <typename Key>
+    std::pair<typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::inorder_iterator, typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::inorder_iterator>
+    binary_search_tree<Type, Compare, node_allocator, tree_stats>::equal_range(Key const & _key) const {
+        lookup_key_t<Key> const & key = _key;
+        node_type* last_node;
+        node_type* lower_node = _internal_lower_bound(root, last_node, key);
+        node_type* upper_node = lower_node;
+        _internal_stats().record_compare(lower_node ? 1U : 0U);
+        if (lower_node && !comp(key, lower_node->value)) {
+            //values are unique, so upper bound is in-order successor of lower bound.
+            inorder_iterator iter(lower_node, this);
+            upper_node = (++iter).node;
+        }
+        return std::make_pair(inorder_iterator(lower_node, this), inorder_iterator(upper_node, this));
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    template <typename KeyIterator, typename OutputIterator>
+    OutputIterator binary_search_tree<Type, Compare, node_allocator, tree_stats>::find_batch(KeyIterator _begin_iter, KeyIterator _end_iter, OutputIterator _out_iter) const {
+        using key_type = lookup_key_t<typename std::iterator_traits<KeyIterator>::value_type>;
+        KeyIterator keys[batch_lookup_width];
+        node_type*  nodes[batch_lookup_width];
+        node_type*  bound_nodes[batch_lookup_width];
+        size_type   num_visits[batch_lookup_width];
+        while (_begin_iter != _end_iter) {
+            size_type num_lane = 0U;
+            for (; num_lane < batch_lookup_width && _begin_iter != _end_iter; ++num_lane, ++_begin_iter) {
+                keys[num_lane]        = _begin_iter;
+                nodes[num_lane]       = root;
+                bound_nodes[num_lane] = nullptr;
+                num_visits[num_lane]  = 0U;
+            }
+            //every round moves each unfinished search one level down, and prefetches the node it goes to.
+            //by the time the round comes back to a search, its node has been loaded behind the other searches.
+            for (size_type num_active = root ? num_lane : 0U; num_active; ) {
+                for (size_type lane = 0U; lane < num_lane; ++lane) {
+                    node_type* node = nodes[lane];
+                    if (node == nullptr) continue;
+                    key_type const & key = *keys[lane];
+                    bool go_right = comp(node->value, key);
+                    bound_nodes[lane] = go_right ? bound_nodes[lane] : node;
+                    node              = go_right ? node->right_node : node->left_node;
+                    nodes[lane]       = node;
+                    ++num_visits[lane];
+                    if (node) TREE_PREFETCH(node);
+                    else      --num_active;
+                }
+            }
+            for (size_type lane = 0U; lane < num_lane; ++lane) {
+                key_type const & key  = *keys[lane];
+                node_type*       node = bound_nodes[lane];
+                _internal_stats().record_search(num_visits[lane]);
+                _internal_stats().record_compare(node ? 1U : 0U);
+                if (node && comp(key, node->value)) node = nullptr;
+                *_out_iter++ = inorder_iterator(node, this);
+            }
+        }
+        return _out_iter;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    template <typename KeyIterator, typename OutputIterator>
+    OutputIterator binary_search_tree<Type, Compare, node_allocator, tree_stats>::find_batch(sorted_input_t, KeyIterator _begin_iter, KeyIterator _end_iter, OutputIterator _out_iter) const {
+        using key_type = lookup_key_t<typename std::iterator_traits<KeyIterator>::value_type>;
+        std::vector<path_entry_> path;
+        for (; _begin_iter != _end_iter; ++_begin_iter) {
+            key_type const & key = *_begin_iter;
+            //sub-tree of each node on the path holds the range of previous key. pop nodes whose range this key leaves,
+            //which for ascending keys is only reaching the upper bound, and resume from the deepest remaining one.
+            while (!path.empty() && ((path.back().upper_node && !comp(key, path.back().upper_node->value)) ||
+                                     (path.back().lower_node && !comp(path.back().lower_node->value, key)))) {
+                path.pop_back();
+            }
+            node_type* node       = root;
+            node_type* lower_node = nullptr;
+            node_type* upper_node = nullptr;
+            if (!path.empty()) {
+                node       = path.back().node;
+                lower_node = path.back().lower_node;
+                upper_node = path.back().upper_node;
+                path.pop_back();
+            }
+            //no value of the sub-tree is equal to or greater than key if upper node is the answer.
+            node_type* bound_node = upper_node;
+            size_type  num_visit  = 0U;
+            for (; node; ++num_visit) {
+                path.push_back(path_entry_{ node, lower_node, upper_node });
+                if (comp(node->value, key)) {
+                    lower_node = node;
+                    node       = node->right_node;
+                }
+                else {
+                    bound_node = upper_node = node;
+                    node       = node->left_node;
+                }
+            }
+            _internal_stats().record_search(num_visit);
+            _internal_stats().record_compare(bound_node ? 1U : 0U);
+            if (bound_node && comp(key, bound_node->value)) bound_node = nullptr;
+            *_out_iter++ = inorder_iterator(bound_node, this);
+        }
+        return _out_iter;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    template <typename Key>
+    typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::size_type binary_search_tree<Type, Compare, node_allocator, tree_stats>::rank(Key const & _key) const {
+        static_assert(is_size_tracked, "rank needs node which keeps subtree size");
+        lookup_key_t<Key> const & key = _key;
+        size_type  num_less  = 0U;
+        size_type  num_visit = 0U;
+        node_type* node      = root;
+        for (; node; ++num_visit) {
+            if (comp(node->value, key)) {
+                num_less += _internal_subtree_size(node->left_node) + 1U;
+                node      = node->right_node;
+            }
+            else {
+                node = node->left_node;
+            }
+        }
+        _internal_stats().record_search(num_visit);
+        return num_less;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::inorder_iterator binary_search_tree<Type, Compare, node_allocator, tree_stats>::select(size_type _index) const {
+        static_assert(is_size_tracked, "select needs node which keeps subtree size");
+        node_type* node = root;
+        while (node) {
+            size_type left_size = _internal_subtree_size(node->left_node);
+            if (_index == left_size) break;
+            if (_index < left_size) {
+                node = node->left_node;
+            }
+            else {
+                _index -= left_size + 1U;
+                node    = node->right_node;
+            }
+        }
+        return inorder_iterator(node, this);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    template <typename Key>
+    typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::size_type binary_search_tree<Type, Compare, node_allocator, tree_stats>::count_range(Key const & _first_key, Key const & _last_key) const {
+        lookup_key_t<Key> const & first_key = _first_key;
+        lookup_key_t<Key> const & last_key  = _last_key;
+        if (!comp(first_key, last_key)) return 0U;
+        return rank(last_key) - rank(first_key);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::size_type binary_search_tree<Type, Compare, node_allocator, tree_stats>::depth(downside_iterator const & _iter) const {    
         size_type   ret_depth    = 0U;
         node_type*  next_pointer = _iter.node;
 
@@ -356,13 +998,60 @@ namespace snowapril {
         return ret_depth;
     }
     
-    template <typename Type, class node_allocator>
-    typename binary_search_tree<Type, node_allocator>::size_type binary_search_tree<Type, node_allocator>::height(downside_iterator const & _iter) const {
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::size_type binary_search_tree<Type, Compare, node_allocator, tree_stats>::height(downside_iterator const & _iter) const {
         return depth(_iter) + 1U;
     }
     
-    template <typename Type, class node_allocator>
-    typename binary_search_tree<Type, node_allocator>::downside_iterator binary_search_tree<Type, node_allocator>::erase(downside_iterator _iter) {
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    void binary_search_tree<Type, Compare, node_allocator, tree_stats>::clear() {
+        if (root) {
+            erase(downside_iterator(root));
+        }
+        num_node = 0U;
+        node_blocks.clear();
+        free_block = no_block;
+        _internal_stats().reset_depth(0U);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    template <typename GenericIterator>
+    void binary_search_tree<Type, Compare, node_allocator, tree_stats>::bulk_load(GenericIterator _begin_iter, GenericIterator _end_iter) {
+        clear();
+
+        size_type num_unique = 0U;
+        for (GenericIterator iter = _begin_iter, prev_iter = _begin_iter; iter != _end_iter; prev_iter = iter++) {
+            if (iter == _begin_iter || comp(*prev_iter, *iter)) ++num_unique;
+        }
+        if (num_unique == 0U) return;
+
+        //construct values in in-order position of one contiguous block, then link the block as balanced tree.
+        node_type* block = _internal_allocate_block(num_unique);
+        node_type* node  = block;
+        try {
+            for (GenericIterator iter = _begin_iter, prev_iter = _begin_iter; iter != _end_iter; prev_iter = iter++) {
+                if (iter == _begin_iter || comp(*prev_iter, *iter)) {
+                    alloc.construct(node, *iter);
+                    ++node;
+                }
+            }
+        }
+        catch (...) {
+            _internal_destroy_range(block, node);
+            _internal_release_block(block);
+            throw;
+        }
+        _internal_commit_block(block, num_unique);
+        root = _internal_link_balanced(block, block + num_unique, nullptr);
+        num_node = num_unique;
+        //perfectly balanced tree of n nodes has floor(log2(n)) + 1 levels.
+        _internal_stats().record_alloc(num_unique);
+        _internal_stats().reset_depth(tree_stats_snapshot::bucket_of(num_unique));
+        LOG("bulk load", num_node);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::downside_iterator binary_search_tree<Type, Compare, node_allocator, tree_stats>::erase(downside_iterator _iter) {
         node_type* parent_node = _iter.node->parent_node;
         if (parent_node) {
             if (parent_node->left_node == _iter.node)
@@ -370,215 +1059,1444 @@ namespace snowapril {
             else
                 parent_node->right_node = nullptr;
         }
-        
-        std::queue<node_type*>  q;
-        q.push(_iter.node);
-        while (!q.empty()) {
-            node_type* p = q.front();
-            q.pop();
-            --num_node;
-            if (p->left_node)  q.push(p->left_node);
-            if (p->right_node) q.push(p->right_node);
-            LOG("del", p);
-            alloc.destroy(p);
-            alloc.deallocate(p, 1);
+        else if (_iter.node == root) {
+            root = nullptr;
         }
+        size_type num_erased = _internal_destroy_subtree(_iter.node);
+        num_node -= num_erased;
+        _internal_resize_path(parent_node, -static_cast<difference_type>(num_erased));
         return downside_iterator(parent_node);
     }
     
-    template <typename Type, class node_allocator>
-    typename binary_search_tree<Type, node_allocator>::downside_iterator binary_search_tree<Type, node_allocator>::remove(Type const &_value) {
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::downside_iterator binary_search_tree<Type, Compare, node_allocator, tree_stats>::remove(Type const &_value) {
         if (root) {
-            _internal_remove(root, _value);
+            return downside_iterator(_internal_remove(root, _value));
         }
+        return downside_iterator();
     }
     
-    template <typename Type, class node_allocator>
-    typename binary_search_tree<Type, node_allocator>::downside_iterator binary_search_tree<Type, node_allocator>::remove(downside_iterator _iter, Type const &_value) {
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::downside_iterator binary_search_tree<Type, Compare, node_allocator, tree_stats>::remove(downside_iterator _iter, Type const &_value) {
         if (_iter.node) {
-            _internal_remove(root, _value);
+            return downside_iterator(_internal_remove(_iter.node, _value));
         }
+        return downside_iterator();
     }
 
-    template <typename Type, class node_allocator>
-    void binary_search_tree<Type, node_allocator>::_internal_remove(node_type* _node, Type const &_value) {
-        while (_node) {
-            if (_node->value > _value)
-                _node = _node->left_node;
-            else if (_node->value < _value)
-                _node = _node->right_node;
-            else
-                break;
-        }
-        if (_node) {
-            if (_node->left_node == nullptr) {
-                node_type* parent_node = _node->parent_node;
-                if (parent_node) {
-                    if (parent_node->left_node == _node)
-                        parent_node->left_node  = _node->right_node;
-                    else
-                        parent_node->right_node = _node->right_node;
-                }
-                else
-                    root = _node->right_node;
-                if (_node->right_node) 
-                    _node->right_node->parent_node = parent_node;
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::node_type* binary_search_tree<Type, Compare, node_allocator, tree_stats>::_internal_remove(node_type* _node, Type const &_value) {
+        node_type* last_node;
+        _node = _internal_lower_bound(_node, last_node, _value);
+        _internal_stats().record_compare(_node ? 1U : 0U);
+        if (_node == nullptr || comp(_value, _node->value)) return nullptr;
+        LOG("deleted value", _node->value);
+        node_type* parent_node = _internal_unlink(_node);
+        _internal_destroy_node(_node);
+        return parent_node;
+    }
 
-                alloc.destroy(_node);
-                alloc.deallocate(_node, 1);
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::node_type* binary_search_tree<Type, Compare, node_allocator, tree_stats>::_internal_unlink(node_type* _node) {
+        node_type* parent_node = _node->parent_node;
+        if (_node->left_node == nullptr || _node->right_node == nullptr) {
+            node_type* child_node = _node->left_node ? _node->left_node : _node->right_node;
+            _internal_replace_child(parent_node, _node, child_node);
+            if (child_node) child_node->parent_node = parent_node;
+        }
+        else {
+            //in-order predecessor is spliced out of its position and takes the place of given node.
+            node_type* swap_node = _internal_maximum(_node->left_node);
+            if (swap_node != _node->left_node) {
+                parent_node = swap_node->parent_node;
+                parent_node->right_node = swap_node->left_node;
+                if (swap_node->left_node) swap_node->left_node->parent_node = parent_node;
+                swap_node->left_node = _node->left_node;
+                swap_node->left_node->parent_node = swap_node;
             }
             else {
-                node_type* swap_node = _node->left_node;
-                while (swap_node->right_node)   
-                    swap_node = swap_node->right_node;
-                if (swap_node == _node->left_node) swap_node->parent_node->left_node  = nullptr;
-                else                               swap_node->parent_node->right_node = nullptr;
-                LOG("del", swap_node);
-                LOG("deleted value", _node->value);
-                _node->value = swap_node->value;
-                alloc.destroy(swap_node);
-                alloc.deallocate(swap_node, 1);
+                parent_node = swap_node;
             }
-            -- num_node;
+            swap_node->right_node = _node->right_node;
+            swap_node->right_node->parent_node = swap_node;
+            swap_node->parent_node = _node->parent_node;
+            _internal_replace_child(_node->parent_node, _node, swap_node);
+            //swap node is on the path from parent node to root and now roots the old sub-tree of given node.
+            _internal_copy_augment(swap_node, _node);
         }
+        _node->parent_node = _node->left_node = _node->right_node = nullptr;
+        --num_node;
+        _internal_resize_path(parent_node, -1);
+        _internal_stats().record_remove();
+        return parent_node;
     }
 
-    template <typename Type, class node_allocator>
-    void binary_search_tree<Type, node_allocator>::append(Type const &_value) {
-        if (root) {
-            _internal_append(root, _value);
-        }
-        else {
-            ++num_node;
-            root = alloc.allocate(1, 0);
-            alloc.construct(root, _value);
-            LOG("root",  root);
-        }
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    void binary_search_tree<Type, Compare, node_allocator, tree_stats>::_internal_replace_child(node_type* _parent, node_type* _old_node, node_type* _new_node) {
+        if (_parent == nullptr)                 root                = _new_node;
+        else if (_parent->left_node == _old_node) _parent->left_node  = _new_node;
+        else                                     _parent->right_node = _new_node;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    void binary_search_tree<Type, Compare, node_allocator, tree_stats>::append(Type const &_value) {
+        insert(_value);
     }
     
-    template <typename Type, class node_allocator>
-    void binary_search_tree<Type, node_allocator>::append(downside_iterator _iter) {
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    void binary_search_tree<Type, Compare, node_allocator, tree_stats>::append(downside_iterator _iter) {
         if (_iter) {
             if (root) {
                 value_type value = _iter.node->value;
                 node_type* parent_node = _internal_find_parent_node(root, value);
                 if (parent_node) {
-                    node_type* new_node = alloc.allocate(1, 0);
-                    alloc.construct(new_node, *(_iter.node));
-                    if (parent_node->value > value)
+                    size_type  num_copy = _iter.size();
+                    node_type* new_node = _internal_copy_subtree(_iter.node, num_copy);
+                    if (comp(value, parent_node->value))
                         parent_node->left_node  = new_node;
                     else
                         parent_node->right_node = new_node;
                     new_node->parent_node = parent_node;
+                    num_node += num_copy;
+                    _internal_resize_path(parent_node, static_cast<difference_type>(num_copy));
                 }
             }
             else {
-                root = alloc.allocate(1, 0);
-                alloc.construct(root, *(_iter.node));
+                num_node = _iter.size();
+                root     = _internal_copy_subtree(_iter.node, num_node);
                 LOG("num_node", num_node);
             }
-            num_node += _iter.size();
         }
     }
     
-    template <typename Type, class node_allocator>
-    void binary_search_tree<Type, node_allocator>::_internal_append(node_type* _node, Type const &_value) {
-        _node = _internal_find_parent_node(_node, _value);
-        if (_node) {
-            ++num_node;
-            if (_node->value > _value) {
-                _node->left_node = alloc.allocate(1, 0);
-                alloc.construct(_node->left_node, _node, _value);
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    std::pair<typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::inorder_iterator, bool> binary_search_tree<Type, Compare, node_allocator, tree_stats>::insert(Type const & _value) {
+        return _internal_insert_unique(_value);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    std::pair<typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::inorder_iterator, bool> binary_search_tree<Type, Compare, node_allocator, tree_stats>::insert(Type&& _value) {
+        return _internal_insert_unique(std::move(_value));
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    template <typename... Args>
+    std::pair<typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::inorder_iterator, bool> binary_search_tree<Type, Compare, node_allocator, tree_stats>::emplace(Args&&... _args) {
+        node_type* new_node = _internal_create_node(std::in_place, std::forward<Args>(_args)...);
+        node_type* parent_node;
+        node_type* bound_node = _internal_lower_bound(root, parent_node, new_node->value);
+        _internal_stats().record_compare(bound_node ? 1U : 0U);
+        if (bound_node && !comp(new_node->value, bound_node->value)) {
+            _internal_destroy_node(new_node);
+            return std::make_pair(inorder_iterator(bound_node, this), false);
+        }
+        _internal_link_leaf(parent_node, new_node);
+        return std::make_pair(inorder_iterator(new_node, this), true);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::node_handle binary_search_tree<Type, Compare, node_allocator, tree_stats>::extract(inorder_iterator _iter) {
+        node_type* node = _iter.node;
+        _internal_unlink(node);
+        size_type block_index = _internal_find_block(node);
+        return node_handle(node, alloc, block_index != no_block ? node_blocks[block_index].block : nullptr);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::node_handle binary_search_tree<Type, Compare, node_allocator, tree_stats>::extract(Type const & _key) {
+        inorder_iterator iter = find(_key);
+        return iter != end() ? extract(iter) : node_handle();
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::insert_return_type binary_search_tree<Type, Compare, node_allocator, tree_stats>::insert(node_handle&& _handle) {
+        if (_handle.empty()) return insert_return_type{ end(), false, node_handle() };
+        if (!(*_handle.alloc == alloc)) {
+            throw different_tree_exception("different_tree_exception : node handle was extracted from tree with other allocator.");
+        }
+        node_type* parent_node;
+        node_type* bound_node = _internal_lower_bound(root, parent_node, _handle.node->value);
+        _internal_stats().record_compare(bound_node ? 1U : 0U);
+        if (bound_node && !comp(_handle.node->value, bound_node->value)) {
+            return insert_return_type{ inorder_iterator(bound_node, this), false, std::move(_handle) };
+        }
+        //node of a block is recycled through free list of this tree from now on, so this tree shares the block.
+        if (_handle.block && _internal_find_block(_handle.node) == no_block) {
+            _internal_insert_block(block_ref_{ _handle.block, nullptr });
+        }
+        node_type* node = _handle.node;
+        _handle.node = nullptr;
+        _handle._internal_reset();
+        _internal_link_leaf(parent_node, node);
+        return insert_return_type{ inorder_iterator(node, this), true, node_handle() };
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    template <typename Value>
+    std::pair<typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::inorder_iterator, bool> binary_search_tree<Type, Compare, node_allocator, tree_stats>::_internal_insert_unique(Value&& _value) {
+        node_type* parent_node;
+        node_type* bound_node = _internal_lower_bound(root, parent_node, static_cast<Type const &>(_value));
+        _internal_stats().record_compare(bound_node ? 1U : 0U);
+        if (bound_node && !comp(_value, bound_node->value)) {
+            return std::make_pair(inorder_iterator(bound_node, this), false);
+        }
+        node_type* new_node = _internal_create_node(std::forward<Value>(_value));
+        _internal_link_leaf(parent_node, new_node);
+        return std::make_pair(inorder_iterator(new_node, this), true);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    void binary_search_tree<Type, Compare, node_allocator, tree_stats>::_internal_link_leaf(node_type* _parent, node_type* _node) {
+        _node->parent_node = _parent;
+        _node->left_node   = _node->right_node = nullptr;
+        if (_parent == nullptr)                    root                = _node;
+        else if (comp(_node->value, _parent->value)) _parent->left_node  = _node;
+        else                                        _parent->right_node = _node;
+        ++num_node;
+        _internal_update(_node);
+        _internal_resize_path(_parent, 1);
+        _internal_stats().record_compare(_parent ? 1U : 0U);
+        _internal_stats().record_insert();
+        LOG("add on", _parent);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::node_type* binary_search_tree<Type, Compare, node_allocator, tree_stats>::_internal_find_parent_node(node_type* _node, Type const &_value) {
+        node_type* prev_node  = nullptr;
+        node_type* bound_node = _internal_lower_bound(_node, prev_node, _value);
+        _internal_stats().record_compare(bound_node ? 1U : 0U);
+        if (bound_node && !comp(_value, bound_node->value))
+            return nullptr;
+
+        return prev_node;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    template <typename Key>
+    typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::node_type* binary_search_tree<Type, Compare, node_allocator, tree_stats>::_internal_lower_bound(node_type* _node, node_type*& _last_node, Key const & _key) const {
+        using branchless = std::integral_constant<bool, is_branchless_compare_<Type, Compare>::value && std::is_arithmetic<Key>::value>;
+        return _internal_lower_bound(_node, _last_node, _key, branchless());
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    template <typename Key>
+    typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::node_type* binary_search_tree<Type, Compare, node_allocator, tree_stats>::_internal_lower_bound(node_type* _node, node_type*& _last_node, Key const & _key, std::false_type) const {
+        node_type* bound_node = nullptr;
+        size_type  num_visit  = 0U;
+        _last_node = nullptr;
+        for (; _node; ++num_visit) {
+            _last_node = _node;
+            bool go_right = comp(_node->value, _key);
+            bound_node = go_right ? bound_node : _node;
+            _node      = go_right ? _node->right_node : _node->left_node;
+        }
+        _internal_stats().record_search(num_visit);
+        return bound_node;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    template <typename Key>
+    typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::node_type* binary_search_tree<Type, Compare, node_allocator, tree_stats>::_internal_lower_bound(node_type* _node, node_type*& _last_node, Key const & _key, std::true_type) const {
+        Key const  key         = _key;
+        uintptr_t  bound_bits  = 0U;
+        size_type  num_visit   = 0U;
+        _last_node = nullptr;
+        for (; _node; ++num_visit) {
+            uintptr_t node_bits  = reinterpret_cast<uintptr_t>(_node);
+            uintptr_t left_bits  = reinterpret_cast<uintptr_t>(_node->left_node);
+            uintptr_t right_bits = reinterpret_cast<uintptr_t>(_node->right_node);
+            uintptr_t right_mask = static_cast<uintptr_t>(0U) - static_cast<uintptr_t>(comp(_node->value, key));
+            _last_node = _node;
+            bound_bits = (bound_bits & right_mask) | (node_bits  & ~right_mask);
+            _node      = reinterpret_cast<node_type*>((right_bits & right_mask) | (left_bits & ~right_mask));
+        }
+        _internal_stats().record_search(num_visit);
+        return reinterpret_cast<node_type*>(bound_bits);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    template <typename Key>
+    typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::node_type* binary_search_tree<Type, Compare, node_allocator, tree_stats>::_internal_upper_bound(Key const & _key) const {
+        node_type* node       = root;
+        node_type* bound_node = nullptr;
+        size_type  num_visit  = 0U;
+        for (; node; ++num_visit) {
+            bool go_left = comp(_key, node->value);
+            bound_node = go_left ? node : bound_node;
+            node       = go_left ? node->left_node : node->right_node;
+        }
+        _internal_stats().record_search(num_visit);
+        return bound_node;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    template <typename GenericIterator>
+    void binary_search_tree<Type, Compare, node_allocator, tree_stats>::_internal_build(GenericIterator _begin_iter, GenericIterator _end_iter, std::input_iterator_tag) {
+        for (; _begin_iter != _end_iter; ++_begin_iter) {
+            this->append(*_begin_iter);
+        }
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    template <typename GenericIterator>
+    void binary_search_tree<Type, Compare, node_allocator, tree_stats>::_internal_build(GenericIterator _begin_iter, GenericIterator _end_iter, std::forward_iterator_tag) {
+        if (std::is_sorted(_begin_iter, _end_iter, comp))
+            bulk_load(_begin_iter, _end_iter);
+        else
+            _internal_build(_begin_iter, _end_iter, std::input_iterator_tag());
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::node_type* binary_search_tree<Type, Compare, node_allocator, tree_stats>::_internal_link_balanced(node_type* _begin_node, node_type* _end_node, node_type* _parent) {
+        //recursion depth is log2(n) because range is halved on each level.
+        if (_begin_node == _end_node) return nullptr;
+        node_type* mid_node = _begin_node + (_end_node - _begin_node) / 2;
+        mid_node->parent_node = _parent;
+        mid_node->left_node   = _internal_link_balanced(_begin_node, mid_node, mid_node);
+        mid_node->right_node  = _internal_link_balanced(mid_node + 1, _end_node, mid_node);
+        _internal_update(mid_node);
+        return mid_node;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    template <typename RandomIterator>
+    void binary_search_tree<Type, Compare, node_allocator, tree_stats>::parallel_bulk_load(task_pool & _pool, RandomIterator _begin_iter, RandomIterator _end_iter) {
+        clear();
+        size_type num_value = static_cast<size_type>(_end_iter - _begin_iter);
+        if (num_value == 0U) return;
+
+        //count unique values of each chunk, so every chunk knows where its nodes start in the block.
+        size_type num_chunk = std::min<size_type>(num_value, _pool.concurrency() * 4U);
+        std::vector<size_type> chunk_offsets(num_chunk + 1U, 0U);
+        auto is_unique = [&](size_type _index) {
+            return _index == 0U || comp(_begin_iter[_index - 1U], _begin_iter[_index]);
+        };
+        _pool.parallel_for(0U, num_chunk, 1U, [&](size_t _begin_chunk, size_t _end_chunk) {
+            for (size_t chunk = _begin_chunk; chunk < _end_chunk; ++chunk) {
+                size_type count = 0U;
+                for (size_type i = chunk * num_value / num_chunk; i < (chunk + 1U) * num_value / num_chunk; ++i) {
+                    count += is_unique(i) ? 1U : 0U;
+                }
+                chunk_offsets[chunk + 1U] = count;
             }
-            else {
-                _node->right_node = alloc.allocate(1, 0);
-                alloc.construct(_node->right_node, _node, _value);
+        });
+        for (size_type chunk = 0U; chunk < num_chunk; ++chunk) {
+            chunk_offsets[chunk + 1U] += chunk_offsets[chunk];
+        }
+        size_type num_unique = chunk_offsets[num_chunk];
+
+        //every chunk records how many nodes it constructed, so a failed fill destroys exactly those.
+        node_type* block = _internal_allocate_block(num_unique);
+        std::vector<size_type> chunk_filled(num_chunk, 0U);
+        try {
+            _pool.parallel_for(0U, num_chunk, 1U, [&](size_t _begin_chunk, size_t _end_chunk) {
+                for (size_t chunk = _begin_chunk; chunk < _end_chunk; ++chunk) {
+                    node_type* node = block + chunk_offsets[chunk];
+                    for (size_type i = chunk * num_value / num_chunk; i < (chunk + 1U) * num_value / num_chunk; ++i) {
+                        if (!is_unique(i)) continue;
+                        alloc.construct(node++, _begin_iter[i]);
+                        ++chunk_filled[chunk];
+                    }
+                }
+            });
+        }
+        catch (...) {
+            for (size_type chunk = 0U; chunk < num_chunk; ++chunk) {
+                _internal_destroy_range(block + chunk_offsets[chunk], block + chunk_offsets[chunk] + chunk_filled[chunk]);
+            }
+            _internal_release_block(block);
+            throw;
+        }
+        _internal_commit_block(block, num_unique);
+        root = _internal_parallel_link(_pool, block, block + num_unique, nullptr, 0U, _internal_parallel_depth(_pool));
+        num_node = num_unique;
+        _internal_stats().record_alloc(num_unique);
+        _internal_stats().reset_depth(tree_stats_snapshot::bucket_of(num_unique));
+        LOG("parallel bulk load", num_node);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    void binary_search_tree<Type, Compare, node_allocator, tree_stats>::parallel_copy(task_pool & _pool, binary_search_tree<Type, Compare, node_allocator, tree_stats> const & _other) {
+        if (this == &_other) return;
+        parallel_clear(_pool);
+        comp = _other.comp;
+        if (_other.root == nullptr) return;
+
+        //sizes of top sub-trees tell each copy task where its nodes go in the block, so tasks never share a slot.
+        size_type              max_depth = _internal_parallel_depth(_pool);
+        std::vector<size_type> sizes(static_cast<size_t>(2U) << max_depth, 0U);
+        size_type              num_copy  = _internal_parallel_count(_pool, _other.root, 1U, 0U, max_depth, sizes);
+
+        node_type* block = _internal_allocate_block(num_copy);
+        try {
+            root = _internal_parallel_copy(_pool, _other.root, block, nullptr, 1U, 0U, max_depth, sizes);
+        }
+        catch (...) {
+            //every copy task destroyed the nodes it made before rethrowing.
+            _internal_release_block(block);
+            throw;
+        }
+        _internal_commit_block(block, num_copy);
+        num_node = num_copy;
+        //copy tasks run concurrently, so their nodes are counted here at once. copy has the shape of given tree.
+        _internal_stats().record_alloc(num_copy);
+        _internal_stats().reset_depth(_other._internal_stats().recorded_depth());
+        LOG("parallel copy", num_node);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    template <typename Function>
+    void binary_search_tree<Type, Compare, node_allocator, tree_stats>::parallel_for_each(task_pool & _pool, Function&& _func) const {
+        size_type max_depth = _internal_parallel_depth(_pool);
+        //generic lambda takes itself as argument to recurse without std::function.
+        auto visit = [&](auto& _self, node_type const* _node, size_type _depth) -> void {
+            if (_node == nullptr) return;
+            if (_depth >= max_depth) {
+                std::vector<node_type const*> stack { _node };
+                while (!stack.empty()) {
+                    node_type const* node = stack.back();
+                    stack.pop_back();
+                    _func(static_cast<Type const &>(node->value));
+                    if (node->right_node) stack.push_back(node->right_node);
+                    if (node->left_node)  stack.push_back(node->left_node);
+                }
+                return;
+            }
+            _func(static_cast<Type const &>(_node->value));
+            _pool.invoke([&] { _self(_self, _node->left_node,  _depth + 1U); },
+                         [&] { _self(_self, _node->right_node, _depth + 1U); });
+        };
+        visit(visit, root, 0U);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    void binary_search_tree<Type, Compare, node_allocator, tree_stats>::parallel_clear(task_pool & _pool) {
+        //individually allocated nodes are collected per task, and given back to allocator after every task finished
+        //unless allocator is std::allocator, which is known to be thread safe.
+        //block nodes are uncounted from their block, which other trees or node handles may still hold. nodes of a
+        //sub-tree mostly come from the same block, so each task adds up a run of them before touching the counter.
+        constexpr bool concurrent_deallocate = std::is_same<node_allocator, std::allocator<node_type>>::value;
+        size_type max_depth = _internal_parallel_depth(_pool);
+        std::vector<std::vector<node_type*>> loose_nodes(static_cast<size_t>(2U) << max_depth);
+        struct freed_run_ {
+            node_block_* block   = nullptr;
+            size_type    num_run = 0U;
+            void flush() { if (block) block->num_live.fetch_sub(num_run, std::memory_order_acq_rel); block = nullptr; num_run = 0U; }
+        };
+        auto release = [&](node_type* _node, std::vector<node_type*>& _loose, freed_run_& _run) {
+            alloc.destroy(_node);
+            size_type block_index = _internal_find_block(_node);
+            if (block_index != no_block) {
+                node_block_* block = node_blocks[block_index].block.get();
+                if (block != _run.block) _run.flush();
+                _run.block = block;
+                ++_run.num_run;
+                return;
+            }
+            if (concurrent_deallocate)    alloc.deallocate(_node, 1U);
+            else                          _loose.push_back(_node);
+        };
+        auto destroy = [&](auto& _self, node_type* _node, size_type _index, size_type _depth) -> void {
+            if (_node == nullptr) return;
+            freed_run_ run;
+            if (_depth >= max_depth) {
+                std::vector<node_type*> stack { _node };
+                while (!stack.empty()) {
+                    node_type* node = stack.back();
+                    stack.pop_back();
+                    if (node->left_node)  stack.push_back(node->left_node);
+                    if (node->right_node) stack.push_back(node->right_node);
+                    release(node, loose_nodes[_index], run);
+                }
+                run.flush();
+                return;
+            }
+            node_type* left_node  = _node->left_node;
+            node_type* right_node = _node->right_node;
+            _pool.invoke([&] { _self(_self, left_node,  _index * 2U,      _depth + 1U); },
+                         [&] { _self(_self, right_node, _index * 2U + 1U, _depth + 1U); });
+            release(_node, loose_nodes[_index], run);
+            run.flush();
+        };
+        destroy(destroy, root, 1U, 0U);
+
+        for (std::vector<node_type*> const & loose : loose_nodes) {
+            for (node_type* node : loose) alloc.deallocate(node, 1U);
+        }
+        _internal_stats().record_free(num_node);
+        _internal_stats().reset_depth(0U);
+        node_blocks.clear();
+        free_block = no_block;
+        root       = nullptr;
+        num_node   = 0U;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    void binary_search_tree<Type, Compare, node_allocator, tree_stats>::parallel_union(task_pool & _pool, binary_search_tree<Type, Compare, node_allocator, tree_stats> && _other) {
+        _internal_set_operation(&_pool, _other, merge_mode_::union_);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    void binary_search_tree<Type, Compare, node_allocator, tree_stats>::parallel_intersection(task_pool & _pool, binary_search_tree<Type, Compare, node_allocator, tree_stats> && _other) {
+        _internal_set_operation(&_pool, _other, merge_mode_::intersection_);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    binary_search_tree<Type, Compare, node_allocator, tree_stats> binary_search_tree<Type, Compare, node_allocator, tree_stats>::split(Type const & _value) {
+        binary_search_tree<Type, Compare, node_allocator, tree_stats> greater_tree(comp);
+        greater_tree.alloc = alloc;
+        greater_tree._internal_share_blocks(*this);
+
+        node_type *less_root, *greater_root;
+        node_type* equal_node = _internal_split(root, _value, less_root, greater_root);
+        if (equal_node) {
+            equal_node->right_node = greater_root;
+            if (greater_root) greater_root->parent_node = equal_node;
+            greater_root = equal_node;
+            _internal_update(equal_node);
+        }
+        root = less_root;
+        greater_tree.root = greater_root;
+        //moved nodes are counted unless subtree size is tracked, so then split also costs O(size of returned tree).
+        greater_tree.num_node = _internal_subtree_size(greater_root);
+        num_node -= greater_tree.num_node;
+        //both parts are made of nodes whose paths were observed in this tree.
+        greater_tree._internal_stats().reset_depth(_internal_stats().recorded_depth());
+        LOG("split", greater_tree.num_node);
+        return greater_tree;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    void binary_search_tree<Type, Compare, node_allocator, tree_stats>::join(binary_search_tree<Type, Compare, node_allocator, tree_stats> && _other) {
+        if (this == &_other || _other.root == nullptr) return;
+        if (root && !comp(_internal_maximum(root)->value, _internal_minimum(_other.root)->value)) {
+            throw std::invalid_argument("every value of joined tree must be greater than values of this tree");
+        }
+        _internal_adopt_storage(_other);
+        root = _internal_join(root, _other.root);
+        num_node += _other.num_node;
+        _internal_stats().record_depth(_other._internal_stats().recorded_depth());
+        _other.root     = nullptr;
+        _other.num_node = 0U;
+        _other._internal_stats().reset_depth(0U);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    void binary_search_tree<Type, Compare, node_allocator, tree_stats>::merge(binary_search_tree<Type, Compare, node_allocator, tree_stats> & _other) {
+        if (this == &_other) return;
+        _internal_share_blocks(_other);
+        merge_result_ result = _internal_merge(nullptr, root, _other.root, merge_mode_::union_, 0U, 0U);
+        root = result.root;
+        if (root) root->parent_node = nullptr;
+        num_node += _other.num_node - result.num_dropped;
+
+        //nodes dropped by union are duplicates from given tree. they go back to it as balanced tree.
+        std::vector<node_type*> duplicated_nodes;
+        for (node_type* node = result.dropped; node; node = node->right_node) duplicated_nodes.push_back(node);
+        std::sort(duplicated_nodes.begin(), duplicated_nodes.end(), [this](node_type* _lhs, node_type* _rhs) {
+            return comp(_lhs->value, _rhs->value);
+        });
+        _other.root     = _internal_link_balanced(duplicated_nodes.data(), duplicated_nodes.data() + duplicated_nodes.size(), nullptr);
+        _other.num_node = duplicated_nodes.size();
+        _internal_stats().record_depth(_other._internal_stats().recorded_depth());
+        _other._internal_stats().reset_depth(tree_stats_snapshot::bucket_of(_other.num_node));
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    void binary_search_tree<Type, Compare, node_allocator, tree_stats>::set_union(binary_search_tree<Type, Compare, node_allocator, tree_stats> && _other) {
+        _internal_set_operation(nullptr, _other, merge_mode_::union_);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    void binary_search_tree<Type, Compare, node_allocator, tree_stats>::set_intersection(binary_search_tree<Type, Compare, node_allocator, tree_stats> && _other) {
+        _internal_set_operation(nullptr, _other, merge_mode_::intersection_);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    void binary_search_tree<Type, Compare, node_allocator, tree_stats>::set_difference(binary_search_tree<Type, Compare, node_allocator, tree_stats> && _other) {
+        _internal_set_operation(nullptr, _other, merge_mode_::difference_);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    void binary_search_tree<Type, Compare, node_allocator, tree_stats>::serialize(std::ostream & _stream) const {
+        static_assert(std::is_trivially_copyable<Type>::value, "serialize writes values as raw bytes, so Type must be trivially copyable");
+        stream_header_ header;
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, stream_magic, sizeof(header.magic));
+        header.version    = stream_version;
+        header.byte_order = stream_byte_order;
+        header.value_size = sizeof(Type);
+        header.num_node   = num_node;
+        _stream.write(reinterpret_cast<char const*>(&header), sizeof(header));
+
+        //in-order walk through parent links, so memory is one chunk whatever the shape of the tree.
+        std::vector<Type> chunk;
+        chunk.reserve(std::min(stream_chunk_size, num_node));
+        for (inorder_iterator iter = begin(); iter != end() && _stream; ++iter) {
+            chunk.push_back(*iter);
+            if (chunk.size() == stream_chunk_size) {
+                _stream.write(reinterpret_cast<char const*>(chunk.data()), static_cast<std::streamsize>(chunk.size() * sizeof(Type)));
+                chunk.clear();
             }
-            LOG("add on", _node);
-            LOG("\tleft", _node->left_node);
-            LOG("\tright", _node->right_node);
         }
+        if (!chunk.empty()) {
+            _stream.write(reinterpret_cast<char const*>(chunk.data()), static_cast<std::streamsize>(chunk.size() * sizeof(Type)));
+        }
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    void binary_search_tree<Type, Compare, node_allocator, tree_stats>::deserialize(std::istream & _stream) {
+        static_assert(std::is_trivially_copyable<Type>::value, "deserialize reads values as raw bytes, so Type must be trivially copyable");
+        stream_header_ header;
+        if (!_stream.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+            throw tree_format_exception("tree_format_exception : stream ends before tree header.");
+        }
+        if (std::memcmp(header.magic, stream_magic, sizeof(header.magic)) != 0 || header.version != stream_version) {
+            throw tree_format_exception("tree_format_exception : stream does not hold serialized tree of this version.");
+        }
+        if (header.byte_order != stream_byte_order || header.value_size != sizeof(Type)) {
+            throw tree_format_exception("tree_format_exception : serialized tree has other byte order or value type.");
+        }
+
+        //build into separate tree and move it here at the end, so failure leaves this tree unchanged.
+        binary_search_tree<Type, Compare, node_allocator, tree_stats> loaded(comp);
+        loaded.alloc = alloc;
+        //node count comes from the stream, so it never sizes an allocation by itself. every chunk of values gets
+        //its own block only after it was read, so a forged count fails at the end of stream instead of in allocator.
+        uint64_t                num_value = header.num_node;
+        size_type               num_loaded = 0U;
+        std::vector<node_type*> blocks;
+        try {
+            std::vector<Type> chunk;
+            for (uint64_t num_read = 0U; num_read < num_value; ) {
+                size_type num_chunk = static_cast<size_type>(std::min<uint64_t>(stream_chunk_size, num_value - num_read));
+                chunk.resize(num_chunk);
+                if (!_stream.read(reinterpret_cast<char*>(chunk.data()), static_cast<std::streamsize>(num_chunk * sizeof(Type)))) {
+                    throw tree_format_exception("tree_format_exception : stream ends before every serialized value.");
+                }
+                node_type* block = loaded._internal_allocate_block(num_chunk);
+                node_type* node  = block;
+                try {
+                    for (Type const & value : chunk) {
+                        //values must be strictly ascending, otherwise linked tree would break search order.
+                        node_type const* prev_node = node != block ? node - 1 : (blocks.empty() ? nullptr : blocks.back() + stream_chunk_size - 1U);
+                        if (prev_node && !comp(prev_node->value, value)) {
+                            throw tree_format_exception("tree_format_exception : serialized values are not in ascending order.");
+                        }
+                        loaded.alloc.construct(node, value);
+                        ++node;
+                    }
+                    //grown here, so recording the block after commit cannot throw.
+                    blocks.reserve(blocks.size() + 1U);
+                }
+                catch (...) {
+                    loaded._internal_destroy_range(block, node);
+                    loaded._internal_release_block(block);
+                    throw;
+                }
+                loaded._internal_commit_block(block, num_chunk);
+                blocks.push_back(block);
+                num_loaded += num_chunk;
+                num_read   += num_chunk;
+            }
+        }
+        catch (...) {
+            //nodes of finished chunks are not linked yet, so loaded tree cannot free them by itself.
+            for (size_type i = 0U; i < blocks.size(); ++i) {
+                loaded._internal_destroy_range(blocks[i], blocks[i] + std::min(stream_chunk_size, num_loaded - i * stream_chunk_size));
+                loaded._internal_release_block(blocks[i]);
+            }
+            throw;
+        }
+        //recursion depth of balanced linking is log2(n), independent of the shape of serialized tree.
+        loaded.root     = _internal_link_chunked(blocks.data(), 0U, num_loaded, nullptr);
+        loaded.num_node = num_loaded;
+        *this = std::move(loaded);
+        //counters of loaded tree are not moved, so its blocks and nodes are counted here.
+        for (size_type i = 0U; i < (num_node + stream_chunk_size - 1U) / stream_chunk_size; ++i) _internal_stats().record_alloc_call();
+        _internal_stats().record_alloc(num_node);
+        _internal_stats().reset_depth(tree_stats_snapshot::bucket_of(num_node));
+        LOG("deserialize", num_node);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    void binary_search_tree<Type, Compare, node_allocator, tree_stats>::_internal_set_operation(task_pool* _pool, binary_search_tree<Type, Compare, node_allocator, tree_stats> & _other, merge_mode_ _mode) {
+        if (this == &_other) {
+            if (_mode == merge_mode_::difference_) clear();
+            return;
+        }
+        _internal_adopt_storage(_other);
+        size_type     fork_depth = _pool ? _internal_parallel_depth(*_pool) : 0U;
+        merge_result_ result     = _internal_merge(_pool, root, _other.root, _mode, 0U, fork_depth);
+        num_node = num_node + _other.num_node - result.num_dropped;
+        _internal_stats().record_depth(_other._internal_stats().recorded_depth());
+        _other.root     = nullptr;
+        _other.num_node = 0U;
+        _other._internal_stats().reset_depth(0U);
+        root = result.root;
+        if (root) root->parent_node = nullptr;
+        for (node_type* node = result.dropped, *next_node; node; node = next_node) {
+            next_node = node->right_node;
+            _internal_destroy_node(node);
+        }
+        LOG("set operation", num_node);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::node_type* binary_search_tree<Type, Compare, node_allocator, tree_stats>::_internal_link_balanced(node_type** _begin_node, node_type** _end_node, node_type* _parent) {
+        if (_begin_node == _end_node) return nullptr;
+        node_type** mid_node = _begin_node + (_end_node - _begin_node) / 2;
+        (*mid_node)->parent_node = _parent;
+        (*mid_node)->left_node   = _internal_link_balanced(_begin_node, mid_node, *mid_node);
+        (*mid_node)->right_node  = _internal_link_balanced(mid_node + 1, _end_node, *mid_node);
+        _internal_update(*mid_node);
+        return *mid_node;
     }
 
-    template <typename Type, class node_allocator>
-    typename binary_search_tree<Type, node_allocator>::node_type* binary_search_tree<Type, node_allocator>::_internal_find_parent_node(node_type* _node, Type const &_value) {
-        node_type* prev_node = nullptr;
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::node_type* binary_search_tree<Type, Compare, node_allocator, tree_stats>::_internal_link_chunked(node_type* const* _blocks, size_type _begin, size_type _end, node_type* _parent) {
+        if (_begin == _end) return nullptr;
+        size_type  mid      = _begin + (_end - _begin) / 2U;
+        node_type* mid_node = _blocks[mid / stream_chunk_size] + mid % stream_chunk_size;
+        mid_node->parent_node = _parent;
+        mid_node->left_node   = _internal_link_chunked(_blocks, _begin, mid, mid_node);
+        mid_node->right_node  = _internal_link_chunked(_blocks, mid + 1U, _end, mid_node);
+        _internal_update(mid_node);
+        return mid_node;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    void binary_search_tree<Type, Compare, node_allocator, tree_stats>::_internal_collect_inorder(node_type* _node, std::vector<node_type*>& _nodes) {
+        std::vector<node_type*> stack;
+        while (_node || !stack.empty()) {
+            for (; _node; _node = _node->left_node) stack.push_back(_node);
+            _node = stack.back();
+            stack.pop_back();
+            _nodes.push_back(_node);
+            _node = _node->right_node;
+        }
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::size_type binary_search_tree<Type, Compare, node_allocator, tree_stats>::_internal_parallel_depth(task_pool const & _pool) {
+        //2^depth sub-trees give every thread several tasks to balance uneven sub-tree sizes.
+        size_type depth = 3U;
+        for (size_t num_thread = _pool.concurrency(); num_thread > 1U; num_thread >>= 1U) ++depth;
+        return std::min<size_type>(depth, 16U);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::node_type* binary_search_tree<Type, Compare, node_allocator, tree_stats>::_internal_parallel_link(task_pool & _pool, node_type* _begin_node, node_type* _end_node, node_type* _parent, size_type _depth, size_type _max_depth) {
+        if (_depth >= _max_depth) return _internal_link_balanced(_begin_node, _end_node, _parent);
+        if (_begin_node == _end_node) return nullptr;
+        node_type* mid_node = _begin_node + (_end_node - _begin_node) / 2;
+        mid_node->parent_node = _parent;
+        _pool.invoke([&] { mid_node->left_node  = _internal_parallel_link(_pool, _begin_node, mid_node, mid_node, _depth + 1U, _max_depth); },
+                     [&] { mid_node->right_node = _internal_parallel_link(_pool, mid_node + 1, _end_node, mid_node, _depth + 1U, _max_depth); });
+        _internal_update(mid_node);
+        return mid_node;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::size_type binary_search_tree<Type, Compare, node_allocator, tree_stats>::_internal_parallel_count(task_pool & _pool, node_type const* _node, size_type _index, size_type _depth, size_type _max_depth, std::vector<size_type>& _sizes) const {
+        if (_node == nullptr) return 0U;
+        size_type count = 0U;
+        if (_depth >= _max_depth) {
+            std::vector<node_type const*> stack { _node };
+            while (!stack.empty()) {
+                node_type const* node = stack.back();
+                stack.pop_back();
+                ++count;
+                if (node->left_node)  stack.push_back(node->left_node);
+                if (node->right_node) stack.push_back(node->right_node);
+            }
+        }
+        else {
+            size_type left_count = 0U, right_count = 0U;
+            _pool.invoke([&] { left_count  = _internal_parallel_count(_pool, _node->left_node,  _index * 2U,      _depth + 1U, _max_depth, _sizes); },
+                         [&] { right_count = _internal_parallel_count(_pool, _node->right_node, _index * 2U + 1U, _depth + 1U, _max_depth, _sizes); });
+            count = left_count + right_count + 1U;
+        }
+        _sizes[_index] = count;
+        return count;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::node_type* binary_search_tree<Type, Compare, node_allocator, tree_stats>::_internal_parallel_copy(task_pool & _pool, node_type const* _node, node_type* _slots, node_type* _parent, size_type _index, size_type _depth, size_type _max_depth, std::vector<size_type> const & _sizes) {
+        if (_node == nullptr) return nullptr;
+        if (_depth >= _max_depth) {
+            //pre-order copy with explicit stack, so degenerate sub-tree cannot overflow the call stack.
+            struct frame_ { node_type const* source; node_type* parent; bool is_left; };
+            std::vector<frame_> stack { frame_{ _node, _parent, false } };
+            node_type* begin_slot = _slots;
+            node_type* sub_root   = nullptr;
+            try {
+                while (!stack.empty()) {
+                    frame_ frame = stack.back();
+                    stack.pop_back();
+                    alloc.construct(_slots, frame.source->value);
+                    node_type* node = _slots++;
+                    _internal_copy_augment(node, frame.source);
+                    node->parent_node = frame.parent;
+                    if (sub_root == nullptr)  sub_root = node;
+                    else if (frame.is_left)   frame.parent->left_node  = node;
+                    else                      frame.parent->right_node = node;
+                    if (frame.source->right_node) stack.push_back(frame_{ frame.source->right_node, node, false });
+                    if (frame.source->left_node)  stack.push_back(frame_{ frame.source->left_node,  node, true });
+                }
+            }
+            catch (...) {
+                //pre-order copy fills its slots from the first one, so constructed nodes are [begin, current).
+                _internal_destroy_range(begin_slot, _slots);
+                throw;
+            }
+            return sub_root;
+        }
+        //node goes after every node of its left sub-tree, so the top levels of the copy are in in-order position.
+        size_type  left_size = _node->left_node ? _sizes[_index * 2U] : 0U;
+        node_type* new_node  = _slots + left_size;
+        alloc.construct(new_node, _node->value);
+        _internal_copy_augment(new_node, _node);
+        new_node->parent_node = _parent;
+        try {
+            _pool.invoke([&] { new_node->left_node  = _internal_parallel_copy(_pool, _node->left_node,  _slots,       new_node, _index * 2U,      _depth + 1U, _max_depth, _sizes); },
+                         [&] { new_node->right_node = _internal_parallel_copy(_pool, _node->right_node, new_node + 1, new_node, _index * 2U + 1U, _depth + 1U, _max_depth, _sizes); });
+        }
+        catch (...) {
+            //failed side cleaned up after itself and left no link. the other side is linked here if it finished.
+            if (new_node->left_node)  _internal_destroy_range(_slots, new_node);
+            if (new_node->right_node) _internal_destroy_range(new_node + 1, new_node + 1 + _sizes[_index * 2U + 1U]);
+            _internal_destroy_range(new_node, new_node + 1);
+            throw;
+        }
+        return new_node;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    void binary_search_tree<Type, Compare, node_allocator, tree_stats>::merge_result_::drop(node_type* _node) {
+        _node->right_node = nullptr;
+        if (dropped_tail) dropped_tail->right_node = _node;
+        else              dropped = _node;
+        dropped_tail = _node;
+        ++num_dropped;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    void binary_search_tree<Type, Compare, node_allocator, tree_stats>::merge_result_::append_dropped(merge_result_ const & _other) {
+        if (_other.dropped == nullptr) return;
+        if (dropped_tail) dropped_tail->right_node = _other.dropped;
+        else              dropped = _other.dropped;
+        dropped_tail = _other.dropped_tail;
+        num_dropped += _other.num_dropped;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::node_type* binary_search_tree<Type, Compare, node_allocator, tree_stats>::_internal_split(node_type* _node, Type const & _value, node_type*& _less, node_type*& _greater) const {
+        //walk down the search path once. nodes on the path are hung on the right spine of less tree or left spine
+        //of greater tree, taking the sub-tree on their far side along with them.
+        node_type** less_slot    = &_less;
+        node_type** greater_slot = &_greater;
+        node_type*  less_parent  = nullptr;
+        node_type*  greater_parent = nullptr;
+        node_type*  equal_node   = nullptr;
         while (_node) {
-            prev_node = _node;
-            if (_node->value > _value)
-                _node = _node->left_node;
-            else if (_node->value < _value)
-                _node = _node->right_node;
-            else
-                return nullptr;
+            if (comp(_node->value, _value)) {
+                *less_slot = _node;
+                _node->parent_node = less_parent;
+                less_parent = _node;
+                less_slot   = &_node->right_node;
+                _node       = _node->right_node;
+            }
+            else if (comp(_value, _node->value)) {
+                *greater_slot = _node;
+                _node->parent_node = greater_parent;
+                greater_parent = _node;
+                greater_slot   = &_node->left_node;
+                _node          = _node->left_node;
+            }
+            else {
+                equal_node = _node;
+                *less_slot    = _node->left_node;
+                *greater_slot = _node->right_node;
+                if (_node->left_node)  _node->left_node->parent_node  = less_parent;
+                if (_node->right_node) _node->right_node->parent_node = greater_parent;
+                _node->left_node = _node->right_node = _node->parent_node = nullptr;
+                _internal_update(equal_node);
+                break;
+            }
         }
+        if (equal_node == nullptr) *less_slot = *greater_slot = nullptr;
+        //nodes on both spines lost part of their sub-tree, so their data is recomputed bottom up.
+        _internal_update_path(less_parent);
+        _internal_update_path(greater_parent);
+        return equal_node;
+    }
 
-        return prev_node;
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::node_type* binary_search_tree<Type, Compare, node_allocator, tree_stats>::_internal_join(node_type* _l_tree, node_type* _r_tree) {
+        if (_l_tree == nullptr) return _r_tree;
+        if (_r_tree == nullptr) return _l_tree;
+        //detach maximum of left sub-tree. it has no right child, so its left child takes its place.
+        _l_tree->parent_node = nullptr;
+        node_type* max_node  = _internal_maximum(_l_tree);
+        if (max_node == _l_tree) _l_tree = max_node->left_node;
+        else                     max_node->parent_node->right_node = max_node->left_node;
+        if (max_node->left_node) max_node->left_node->parent_node = max_node->parent_node;
+        _internal_update_path(max_node->parent_node);
+
+        max_node->parent_node = nullptr;
+        max_node->left_node   = _l_tree;
+        max_node->right_node  = _r_tree;
+        if (_l_tree) _l_tree->parent_node = max_node;
+        _r_tree->parent_node = max_node;
+        _internal_update(max_node);
+        return max_node;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::merge_result_ binary_search_tree<Type, Compare, node_allocator, tree_stats>::_internal_merge(task_pool* _pool, node_type* _l_tree, node_type* _r_tree, merge_mode_ _mode, size_type _depth, size_type _fork_depth) const {
+        if (_l_tree == nullptr || _r_tree == nullptr) {
+            //remaining side is kept as a whole, or dropped as a whole.
+            merge_result_ result;
+            node_type* rest_tree = _l_tree ? _l_tree : _r_tree;
+            if (_mode == merge_mode_::union_ || (_mode == merge_mode_::difference_ && _l_tree)) {
+                result.root = rest_tree;
+            }
+            else if (rest_tree) {
+                std::vector<node_type*> rest_nodes;
+                _internal_collect_inorder(rest_tree, rest_nodes);
+                for (node_type* node : rest_nodes) result.drop(node);
+            }
+            return result;
+        }
+        if (_depth >= max_merge_depth) {
+            return _internal_merge_flat(_l_tree, _r_tree, _mode);
+        }
+        //root of left tree splits right tree, then both sides are merged independently.
+        node_type *less_tree, *greater_tree;
+        node_type* equal_node = _internal_split(_r_tree, _l_tree->value, less_tree, greater_tree);
+        node_type* left_node  = _l_tree->left_node;
+        node_type* right_node = _l_tree->right_node;
+        merge_result_ left_result, right_result;
+        auto merge_left  = [&] { left_result  = _internal_merge(_pool, left_node,  less_tree,    _mode, _depth + 1U, _fork_depth); };
+        auto merge_right = [&] { right_result = _internal_merge(_pool, right_node, greater_tree, _mode, _depth + 1U, _fork_depth); };
+        if (_pool && _depth < _fork_depth) _pool->invoke(merge_left, merge_right);
+        else                                { merge_left(); merge_right(); }
+
+        merge_result_ result = left_result;
+        result.append_dropped(right_result);
+        bool keep_root = _mode == merge_mode_::union_ ||
+                         (_mode == merge_mode_::intersection_ ? equal_node != nullptr : equal_node == nullptr);
+        if (keep_root) {
+            _l_tree->left_node  = left_result.root;
+            _l_tree->right_node = right_result.root;
+            if (left_result.root)  left_result.root->parent_node  = _l_tree;
+            if (right_result.root) right_result.root->parent_node = _l_tree;
+            _internal_update(_l_tree);
+            result.root = _l_tree;
+        }
+        else {
+            result.root = _internal_join(left_result.root, right_result.root);
+            result.drop(_l_tree);
+        }
+        if (equal_node) result.drop(equal_node);
+        return result;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::merge_result_ binary_search_tree<Type, Compare, node_allocator, tree_stats>::_internal_merge_flat(node_type* _l_tree, node_type* _r_tree, merge_mode_ _mode) const {
+        std::vector<node_type*> l_nodes, r_nodes, kept_nodes;
+        _internal_collect_inorder(_l_tree, l_nodes);
+        _internal_collect_inorder(_r_tree, r_nodes);
+        kept_nodes.reserve(l_nodes.size() + (_mode == merge_mode_::union_ ? r_nodes.size() : 0U));
+
+        //every node is either kept or dropped. of two equal nodes, the one from left tree is kept unless difference.
+        merge_result_ result;
+        bool keep_l_only = _mode != merge_mode_::intersection_;
+        bool keep_r_only = _mode == merge_mode_::union_;
+        bool keep_equal  = _mode != merge_mode_::difference_;
+        auto l_iter = l_nodes.begin(), r_iter = r_nodes.begin();
+        while (l_iter != l_nodes.end() && r_iter != r_nodes.end()) {
+            if (comp((*l_iter)->value, (*r_iter)->value)) {
+                if (keep_l_only) kept_nodes.push_back(*l_iter);
+                else             result.drop(*l_iter);
+                ++l_iter;
+            }
+            else if (comp((*r_iter)->value, (*l_iter)->value)) {
+                if (keep_r_only) kept_nodes.push_back(*r_iter);
+                else             result.drop(*r_iter);
+                ++r_iter;
+            }
+            else {
+                if (keep_equal) kept_nodes.push_back(*l_iter);
+                else            result.drop(*l_iter);
+                result.drop(*r_iter);
+                ++l_iter;
+                ++r_iter;
+            }
+        }
+        for (; l_iter != l_nodes.end(); ++l_iter) {
+            if (keep_l_only) kept_nodes.push_back(*l_iter);
+            else             result.drop(*l_iter);
+        }
+        for (; r_iter != r_nodes.end(); ++r_iter) {
+            if (keep_r_only) kept_nodes.push_back(*r_iter);
+            else             result.drop(*r_iter);
+        }
+        result.root = _internal_link_balanced(kept_nodes.data(), kept_nodes.data() + kept_nodes.size(), nullptr);
+        return result;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    void binary_search_tree<Type, Compare, node_allocator, tree_stats>::_internal_share_blocks(binary_search_tree<Type, Compare, node_allocator, tree_stats> const & _other) {
+        if (!(alloc == _other.alloc)) {
+            throw different_tree_exception("nodes of trees with different allocators cannot be merged");
+        }
+        std::vector<block_ref_> other_blocks;
+        other_blocks.reserve(_other.node_blocks.size());
+        for (block_ref_ const & ref : _other.node_blocks) other_blocks.push_back(block_ref_{ ref.block, nullptr });
+        _internal_merge_blocks(other_blocks, false);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    void binary_search_tree<Type, Compare, node_allocator, tree_stats>::_internal_adopt_storage(binary_search_tree<Type, Compare, node_allocator, tree_stats> & _other) {
+        if (!(alloc == _other.alloc)) {
+            throw different_tree_exception("nodes of trees with different allocators cannot be merged");
+        }
+        _internal_merge_blocks(_other.node_blocks, true);
+        _other.node_blocks.clear();
+        _other.free_block = no_block;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    void binary_search_tree<Type, Compare, node_allocator, tree_stats>::_internal_merge_blocks(std::vector<block_ref_>& _other_blocks, bool _take_free_nodes) {
+        //both lists are sorted by address, so one pass merges them. block with no live node left is dropped
+        //instead of kept, so blocks emptied by removes in merged shards do not pile up.
+        std::less<node_type const*> less;
+        std::vector<block_ref_>     merged;
+        merged.reserve(node_blocks.size() + _other_blocks.size());
+        auto keep = [&merged](block_ref_&& _ref) {
+            if (_ref.block->num_live.load(std::memory_order_acquire) != 0U) merged.push_back(std::move(_ref));
+        };
+        auto this_iter = node_blocks.begin(), other_iter = _other_blocks.begin();
+        while (this_iter != node_blocks.end() || other_iter != _other_blocks.end()) {
+            if (other_iter == _other_blocks.end() || (this_iter != node_blocks.end() && less(this_iter->block->nodes, other_iter->block->nodes))) {
+                keep(std::move(*this_iter++));
+            }
+            else if (this_iter == node_blocks.end() || less(other_iter->block->nodes, this_iter->block->nodes)) {
+                if (!_take_free_nodes) other_iter->free_nodes = nullptr;
+                keep(std::move(*other_iter++));
+            }
+            else {
+                //the same block. free slots of given tree are appended to this tree's.
+                if (_take_free_nodes && other_iter->free_nodes) {
+                    node_type* tail_node = other_iter->free_nodes;
+                    while (*reinterpret_cast<node_type**>(tail_node)) tail_node = *reinterpret_cast<node_type**>(tail_node);
+                    *reinterpret_cast<node_type**>(tail_node) = this_iter->free_nodes;
+                    this_iter->free_nodes = other_iter->free_nodes;
+                    other_iter->free_nodes = nullptr;
+                }
+                keep(std::move(*this_iter++));
+                ++other_iter;
+            }
+        }
+        node_blocks.swap(merged);
+        free_block = no_block;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    template <typename... Args>
+    typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::node_type* binary_search_tree<Type, Compare, node_allocator, tree_stats>::_internal_create_node(Args&&... _args) {
+        if (free_block != no_block && node_blocks[free_block].free_nodes) {
+            block_ref_& ref      = node_blocks[free_block];
+            node_type*  new_node = ref.free_nodes;
+            ref.free_nodes = *reinterpret_cast<node_type**>(new_node);
+            try {
+                alloc.construct(new_node, std::forward<Args>(_args)...);
+            }
+            catch (...) {
+                *reinterpret_cast<node_type**>(new_node) = ref.free_nodes;
+                ref.free_nodes = new_node;
+                throw;
+            }
+            ref.block->num_live.fetch_add(1U, std::memory_order_relaxed);
+            _internal_stats().record_alloc(1U);
+            return new_node;
+        }
+        node_type* new_node = alloc.allocate(1, 0);
+        _internal_stats().record_alloc_call();
+        try {
+            alloc.construct(new_node, std::forward<Args>(_args)...);
+        }
+        catch (...) {
+            alloc.deallocate(new_node, 1);
+            throw;
+        }
+        _internal_stats().record_alloc(1U);
+        return new_node;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    void binary_search_tree<Type, Compare, node_allocator, tree_stats>::_internal_destroy_node(node_type* _node) {
+        alloc.destroy(_node);
+        _internal_stats().record_free(1U);
+        size_type block_index = _internal_find_block(_node);
+        if (block_index == no_block) {
+            alloc.deallocate(_node, 1);
+            return;
+        }
+        block_ref_& ref = node_blocks[block_index];
+        //the last live node of the block is gone. free slots of this tree go with its reference, and the block
+        //returns to allocator unless another tree or node handle still holds it.
+        if (ref.block->num_live.fetch_sub(1U, std::memory_order_acq_rel) == 1U) {
+            _internal_erase_block(block_index);
+            return;
+        }
+        *reinterpret_cast<node_type**>(_node) = ref.free_nodes;
+        ref.free_nodes = _node;
+        free_block     = block_index;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    binary_search_tree<Type, Compare, node_allocator, tree_stats>::node_block_::node_block_(node_allocator const & _alloc, size_type _size)
+        : alloc(_alloc), size(_size), nodes(alloc.allocate(_size)) { }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    binary_search_tree<Type, Compare, node_allocator, tree_stats>::node_block_::~node_block_() {
+        alloc.deallocate(nodes, size);
     }
 
-    template <typename Type, class node_allocator>
-    binary_search_tree<Type, node_allocator>::iterator_base::iterator_base(node_type* _node) : node(_node) { }
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    bool binary_search_tree<Type, Compare, node_allocator, tree_stats>::node_block_::contains(node_type const* _node) const {
+        std::less<node_type const*> less;
+        return !less(_node, nodes) && less(_node, nodes + size);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::node_type* binary_search_tree<Type, Compare, node_allocator, tree_stats>::_internal_allocate_block(size_type _size) {
+        size_type block_index = _internal_insert_block(block_ref_{ std::make_shared<node_block_>(alloc, _size), nullptr });
+        _internal_stats().record_alloc_call();
+        return node_blocks[block_index].block->nodes;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    void binary_search_tree<Type, Compare, node_allocator, tree_stats>::_internal_commit_block(node_type* _block, size_type _num_node) {
+        node_blocks[_internal_find_block(_block)].block->num_live.fetch_add(_num_node, std::memory_order_relaxed);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    void binary_search_tree<Type, Compare, node_allocator, tree_stats>::_internal_destroy_range(node_type* _begin_node, node_type* _end_node) {
+        for (; _begin_node != _end_node; ++_begin_node) alloc.destroy(_begin_node);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    void binary_search_tree<Type, Compare, node_allocator, tree_stats>::_internal_release_block(node_type* _block) {
+        _internal_erase_block(_internal_find_block(_block));
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::size_type binary_search_tree<Type, Compare, node_allocator, tree_stats>::_internal_find_block(node_type const* _node) const {
+        //the last block which starts at or before given node is the only one which may hold it.
+        auto iter = std::upper_bound(node_blocks.begin(), node_blocks.end(), _node, [](node_type const* _lhs, block_ref_ const & _rhs) {
+            return std::less<node_type const*>()(_lhs, _rhs.block->nodes);
+        });
+        if (iter == node_blocks.begin() || !(iter - 1)->block->contains(_node)) return no_block;
+        return static_cast<size_type>(iter - 1 - node_blocks.begin());
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::size_type binary_search_tree<Type, Compare, node_allocator, tree_stats>::_internal_insert_block(block_ref_&& _ref) {
+        auto iter = std::upper_bound(node_blocks.begin(), node_blocks.end(), _ref.block->nodes, [](node_type const* _lhs, block_ref_ const & _rhs) {
+            return std::less<node_type const*>()(_lhs, _rhs.block->nodes);
+        });
+        size_type block_index = static_cast<size_type>(iter - node_blocks.begin());
+        node_blocks.insert(iter, std::move(_ref));
+        if (free_block != no_block && free_block >= block_index) ++free_block;
+        return block_index;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    void binary_search_tree<Type, Compare, node_allocator, tree_stats>::_internal_erase_block(size_type _block_index) {
+        node_blocks.erase(node_blocks.begin() + static_cast<std::ptrdiff_t>(_block_index));
+        if (free_block == _block_index)                          free_block = no_block;
+        else if (free_block != no_block && free_block > _block_index) --free_block;
+    }
 
-    template <typename Type, class node_allocator>
-    Type& binary_search_tree<Type, node_allocator>::iterator_base::operator*() const {
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::node_type* binary_search_tree<Type, Compare, node_allocator, tree_stats>::_internal_copy_subtree(node_type const* _source, size_type _size) {
+        node_type* block     = _internal_allocate_block(_size);
+        node_type* copy_root = nullptr;
+        node_type* next_slot = block;
+        try {
+            alloc.construct(block, *_source);
+            _internal_stats().record_alloc(1U);
+            copy_root = block;
+            next_slot = block + 1;
+            //walk source and copy in lockstep. child of the copy which is still missing tells which side is next.
+            node_type const* source    = _source;
+            node_type*       copy      = copy_root;
+            while (true) {
+                node_type const* source_child;
+                if (source->left_node && !copy->left_node)        source_child = source->left_node;
+                else if (source->right_node && !copy->right_node) source_child = source->right_node;
+                else {
+                    if (source == _source) break;
+                    source = source->parent_node;
+                    copy   = copy->parent_node;
+                    continue;
+                }
+                alloc.construct(next_slot, *source_child);
+                _internal_stats().record_alloc(1U);
+                next_slot->parent_node = copy;
+                (source_child == source->left_node ? copy->left_node : copy->right_node) = next_slot;
+                source = source_child;
+                copy   = next_slot++;
+            }
+        }
+        catch (...) {
+            //nodes are copied into the block from its first slot, so constructed ones are [block, next slot).
+            _internal_destroy_range(block, next_slot);
+            _internal_release_block(block);
+            throw;
+        }
+        _internal_commit_block(block, _size);
+        return copy_root;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::size_type binary_search_tree<Type, Compare, node_allocator, tree_stats>::_internal_destroy_subtree(node_type* _root) {
+        //descend to a leaf, destroy it and cut it from its parent, which may become a leaf in turn.
+        size_type  num_destroyed = 0U;
+        node_type* node          = _root;
+        while (node) {
+            if (node->left_node) {
+                node = node->left_node;
+            }
+            else if (node->right_node) {
+                node = node->right_node;
+            }
+            else {
+                node_type* parent_node = node == _root ? nullptr : node->parent_node;
+                if (parent_node) (parent_node->left_node == node ? parent_node->left_node : parent_node->right_node) = nullptr;
+                LOG("del", node);
+                _internal_destroy_node(node);
+                ++num_destroyed;
+                node = parent_node;
+            }
+        }
+        return num_destroyed;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::node_type* binary_search_tree<Type, Compare, node_allocator, tree_stats>::_internal_minimum(node_type* _node) {
+        while (_node->left_node)
+            _node = _node->left_node;
+        return _node;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::node_type* binary_search_tree<Type, Compare, node_allocator, tree_stats>::_internal_maximum(node_type* _node) {
+        while (_node->right_node)
+            _node = _node->right_node;
+        return _node;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    void binary_search_tree<Type, Compare, node_allocator, tree_stats>::_internal_update(node_type* _node) {
+        augment_type::update(_node);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    void binary_search_tree<Type, Compare, node_allocator, tree_stats>::_internal_update_path(node_type* _node) {
+        if (!is_augmented) return;
+        for (; _node; _node = _node->parent_node) {
+            augment_type::update(_node);
+        }
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    void binary_search_tree<Type, Compare, node_allocator, tree_stats>::_internal_resize_path(node_type* _node, difference_type _delta) {
+        _internal_resize_path(_node, _delta, std::is_same<augment_type, subtree_size_augment_>());
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    void binary_search_tree<Type, Compare, node_allocator, tree_stats>::_internal_resize_path(node_type* _node, difference_type _delta, std::true_type) {
+        for (; _node; _node = _node->parent_node) {
+            _node->subtree_size += static_cast<size_type>(_delta);
+        }
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    void binary_search_tree<Type, Compare, node_allocator, tree_stats>::_internal_resize_path(node_type* _node, difference_type, std::false_type) {
+        _internal_update_path(_node);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    void binary_search_tree<Type, Compare, node_allocator, tree_stats>::_internal_copy_augment(node_type* _node, node_type const* _source) {
+        static_cast<augment_type&>(*_node) = static_cast<augment_type const &>(*_source);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::size_type binary_search_tree<Type, Compare, node_allocator, tree_stats>::_internal_subtree_size(node_type const* _node) {
+        return _internal_subtree_size(_node, std::integral_constant<bool, is_size_tracked>());
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::size_type binary_search_tree<Type, Compare, node_allocator, tree_stats>::_internal_subtree_size(node_type const* _node, std::true_type) {
+        return _node ? _node->subtree_size : 0U;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::size_type binary_search_tree<Type, Compare, node_allocator, tree_stats>::_internal_subtree_size(node_type const* _node, std::false_type) {
+        //previous node tells where the walk came from: parent (first visit), left child or right child.
+        size_type num_node = 0U;
+        if (_node == nullptr) return num_node;
+        node_type const* exit_node = _node->parent_node;
+        node_type const* prev_node = exit_node;
+        node_type const* node      = _node;
+        while (node != exit_node) {
+            node_type const* next_node;
+            if (prev_node == node->parent_node) {
+                ++num_node;
+                next_node = node->left_node ? node->left_node : (node->right_node ? node->right_node : node->parent_node);
+            }
+            else if (prev_node == node->left_node && node->right_node) {
+                next_node = node->right_node;
+            }
+            else {
+                next_node = node->parent_node;
+            }
+            prev_node = node;
+            node      = next_node;
+        }
+        return num_node;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    binary_search_tree<Type, Compare, node_allocator, tree_stats>::node_handle::node_handle(node_type* _node, node_allocator const & _alloc, std::shared_ptr<node_block_> _block)
+        : node(_node), alloc(_alloc), block(std::move(_block)) { }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    binary_search_tree<Type, Compare, node_allocator, tree_stats>::node_handle::node_handle(node_handle&& _handle) noexcept
+        : node(_handle.node), alloc(std::move(_handle.alloc)), block(std::move(_handle.block)) {
+        _handle.node = nullptr;
+        _handle._internal_reset();
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::node_handle & binary_search_tree<Type, Compare, node_allocator, tree_stats>::node_handle::operator=(node_handle&& _handle) noexcept {
+        if (this != &_handle) {
+            _internal_reset();
+            node  = _handle.node;
+            alloc = std::move(_handle.alloc);
+            block = std::move(_handle.block);
+            _handle.node = nullptr;
+            _handle._internal_reset();
+        }
+        return *this;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    binary_search_tree<Type, Compare, node_allocator, tree_stats>::node_handle::~node_handle() {
+        _internal_reset();
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    bool binary_search_tree<Type, Compare, node_allocator, tree_stats>::node_handle::empty() const {
+        return node == nullptr;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    binary_search_tree<Type, Compare, node_allocator, tree_stats>::node_handle::operator bool() const {
+        return node != nullptr;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    Type& binary_search_tree<Type, Compare, node_allocator, tree_stats>::node_handle::value() const {
+        return node->value;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::node_handle::allocator_type binary_search_tree<Type, Compare, node_allocator, tree_stats>::node_handle::get_allocator() const {
+        return *alloc;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    void binary_search_tree<Type, Compare, node_allocator, tree_stats>::node_handle::_internal_reset() {
+        //node of a block is only destroyed and uncounted. its storage goes back to allocator with the block.
+        if (node) {
+            alloc->destroy(node);
+            if (block) block->num_live.fetch_sub(1U, std::memory_order_acq_rel);
+            else       alloc->deallocate(node, 1);
+            node = nullptr;
+        }
+        alloc.reset();
+        block.reset();
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    binary_search_tree<Type, Compare, node_allocator, tree_stats>::iterator_base::iterator_base(node_type* _node) : node(_node) { }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    Type& binary_search_tree<Type, Compare, node_allocator, tree_stats>::iterator_base::operator*() const {
         return node->value;
     }
 
-    template <typename Type, class node_allocator>
-    Type* binary_search_tree<Type, node_allocator>::iterator_base::operator->() const {
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    Type* binary_search_tree<Type, Compare, node_allocator, tree_stats>::iterator_base::operator->() const {
         return &node->value;
     }
 
-    template <typename Type, class node_allocator>
-    binary_search_tree<Type, node_allocator>::iterator_base::operator bool() const {
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    binary_search_tree<Type, Compare, node_allocator, tree_stats>::iterator_base::operator bool() const {
         return node != nullptr;
     }
 
-    template <typename Type, class node_allocator>
-    binary_search_tree<Type, node_allocator>::downside_iterator::downside_iterator(node_type* _node) : iterator_base(_node) { }
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    binary_search_tree<Type, Compare, node_allocator, tree_stats>::downside_iterator::downside_iterator(node_type* _node) : iterator_base(_node) { }
 
-    template <typename Type, class node_allocator>
-    bool binary_search_tree<Type, node_allocator>::downside_iterator::operator==(downside_iterator const &_iter) const {
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    bool binary_search_tree<Type, Compare, node_allocator, tree_stats>::downside_iterator::operator==(downside_iterator const &_iter) const {
         return this->node == *_iter;
     }
 
-    template <typename Type, class node_allocator>
-    bool binary_search_tree<Type, node_allocator>::downside_iterator::operator!=(downside_iterator const &_iter) const {
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    bool binary_search_tree<Type, Compare, node_allocator, tree_stats>::downside_iterator::operator!=(downside_iterator const &_iter) const {
         return this->node != *_iter;
     }
 
-    template <typename Type, class node_allocator>
-    typename binary_search_tree<Type, node_allocator>::downside_iterator&  binary_search_tree<Type, node_allocator>::downside_iterator::operator++() {
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::downside_iterator&  binary_search_tree<Type, Compare, node_allocator, tree_stats>::downside_iterator::operator++() {
         if (this->node) {
             this->node = (this->node)->right_node;
         }
         return *this;
     }
 
-    template <typename Type, class node_allocator>
-    typename binary_search_tree<Type, node_allocator>::downside_iterator  binary_search_tree<Type, node_allocator>::downside_iterator::operator++(int) {
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::downside_iterator  binary_search_tree<Type, Compare, node_allocator, tree_stats>::downside_iterator::operator++(int) {
         downside_iterator ret_iter = *this;
         ++(*this);
         return ret_iter;
     }
 
-    template <typename Type, class node_allocator>
-    typename binary_search_tree<Type, node_allocator>::downside_iterator&  binary_search_tree<Type, node_allocator>::downside_iterator::operator--() {
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::downside_iterator&  binary_search_tree<Type, Compare, node_allocator, tree_stats>::downside_iterator::operator--() {
         if (this->node) {
             this->node = (this->node)->left_node;
         }
         return *this;
     }
 
-    template <typename Type, class node_allocator>
-    typename binary_search_tree<Type, node_allocator>::downside_iterator  binary_search_tree<Type, node_allocator>::downside_iterator::operator--(int) {
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::downside_iterator  binary_search_tree<Type, Compare, node_allocator, tree_stats>::downside_iterator::operator--(int) {
         downside_iterator ret_iter = *this;
         --(*this);
         return ret_iter;
     }
 
-    template <typename Type, class node_allocator>
-    const typename binary_search_tree<Type, node_allocator>::downside_iterator binary_search_tree<Type, node_allocator>::downside_iterator::operator+(unsigned int num) {
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    const typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::downside_iterator binary_search_tree<Type, Compare, node_allocator, tree_stats>::downside_iterator::operator+(unsigned int num) {
         downside_iterator ret_iter = *this;
         while (num--) {
             ++(ret_iter);
@@ -586,8 +2504,8 @@ namespace snowapril {
         return ret_iter;
     }
     
-    template <typename Type, class node_allocator>
-    const typename binary_search_tree<Type, node_allocator>::downside_iterator binary_search_tree<Type, node_allocator>::downside_iterator::operator-(unsigned int num) {
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    const typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::downside_iterator binary_search_tree<Type, Compare, node_allocator, tree_stats>::downside_iterator::operator-(unsigned int num) {
         downside_iterator ret_iter = *this;
         while (num--) {
             --(ret_iter);
@@ -595,41 +2513,102 @@ namespace snowapril {
         return ret_iter;
     }
 
-    template <typename Type, class node_allocator>
-    typename binary_search_tree<Type, node_allocator>::downside_iterator&  binary_search_tree<Type, node_allocator>::downside_iterator::operator+=(unsigned int num) {
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::downside_iterator&  binary_search_tree<Type, Compare, node_allocator, tree_stats>::downside_iterator::operator+=(unsigned int num) {
         while (num--) {
             ++(*this);
         }
         return *this;
     }
 
-    template <typename Type, class node_allocator>
-    typename binary_search_tree<Type, node_allocator>::downside_iterator&  binary_search_tree<Type, node_allocator>::downside_iterator::operator-=(unsigned int num) {
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::downside_iterator&  binary_search_tree<Type, Compare, node_allocator, tree_stats>::downside_iterator::operator-=(unsigned int num) {
         while (num--) {
             --(*this);
         }
         return *this;
     }
 
-    template <typename Type, class node_allocator>
-    binary_search_tree<Type, node_allocator>::downside_iterator::operator bool() const {
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    binary_search_tree<Type, Compare, node_allocator, tree_stats>::downside_iterator::operator bool() const {
         return this->node != nullptr;
     }
 
-    template <typename Type, class node_allocator>
-    typename binary_search_tree<Type, node_allocator>::size_type binary_search_tree<Type, node_allocator>::downside_iterator::size() const {
-        return _internal_size(*this);
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::size_type binary_search_tree<Type, Compare, node_allocator, tree_stats>::downside_iterator::size() const {
+        return _internal_subtree_size(this->node);
     }
 
-    template <typename Type, class node_allocator>
-    typename binary_search_tree<Type, node_allocator>::size_type binary_search_tree<Type, node_allocator>::downside_iterator::_internal_size(downside_iterator iter) {
-        size_type num_node = 0U;
-        if (iter) {
-            num_node = 1U;
-            if (iter + 1) num_node += _internal_size(iter + 1);
-            if (iter - 1) num_node += _internal_size(iter - 1);
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::augment_type const & binary_search_tree<Type, Compare, node_allocator, tree_stats>::downside_iterator::augment() const {
+        return *this->node;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    binary_search_tree<Type, Compare, node_allocator, tree_stats>::inorder_iterator::inorder_iterator(node_type* _node, binary_search_tree const *_tree) : iterator_base(_node), tree(_tree) { }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    bool binary_search_tree<Type, Compare, node_allocator, tree_stats>::inorder_iterator::operator==(inorder_iterator const &_iter) const {
+        return this->node == _iter.node;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    bool binary_search_tree<Type, Compare, node_allocator, tree_stats>::inorder_iterator::operator!=(inorder_iterator const &_iter) const {
+        return this->node != _iter.node;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::inorder_iterator&  binary_search_tree<Type, Compare, node_allocator, tree_stats>::inorder_iterator::operator++() {
+        if (this->node->right_node) {
+            this->node = _internal_minimum(this->node->right_node);
         }
-        return num_node;
+        else {
+            node_type* parent_node = this->node->parent_node;
+            while (parent_node && this->node == parent_node->right_node) {
+                this->node  = parent_node;
+                parent_node = parent_node->parent_node;
+            }
+            this->node = parent_node;
+        }
+        return *this;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::inorder_iterator  binary_search_tree<Type, Compare, node_allocator, tree_stats>::inorder_iterator::operator++(int) {
+        inorder_iterator ret_iter = *this;
+        ++(*this);
+        return ret_iter;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::inorder_iterator&  binary_search_tree<Type, Compare, node_allocator, tree_stats>::inorder_iterator::operator--() {
+        if (this->node == nullptr) {
+            this->node = tree->root ? _internal_maximum(tree->root) : nullptr;
+        }
+        else if (this->node->left_node) {
+            this->node = _internal_maximum(this->node->left_node);
+        }
+        else {
+            node_type* parent_node = this->node->parent_node;
+            while (parent_node && this->node == parent_node->left_node) {
+                this->node  = parent_node;
+                parent_node = parent_node->parent_node;
+            }
+            this->node = parent_node;
+        }
+        return *this;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::inorder_iterator  binary_search_tree<Type, Compare, node_allocator, tree_stats>::inorder_iterator::operator--(int) {
+        inorder_iterator ret_iter = *this;
+        --(*this);
+        return ret_iter;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename binary_search_tree<Type, Compare, node_allocator, tree_stats>::downside_iterator binary_search_tree<Type, Compare, node_allocator, tree_stats>::inorder_iterator::downside() const {
+        return downside_iterator(this->node);
     }
 }
 
@@ -0,0 +1,582 @@
+#ifndef COMPACT_SEARCH_TREE_HPP
+#define COMPACT_SEARCH_TREE_HPP
+
+/**
+* @file      compact_search_tree.hpp
+* @author    snowapril
+* @date      2026-10-17 (ongoing)
+* @brief     binary search tree with 32-bit index links in one contiguous node arena.
+* @details   header only. nodes live in one vector and refer to each other by 32-bit index instead of pointer,
+             so int node takes 12 bytes without parent link (16 bytes with it) instead of three pointers and
+             allocator header per node. removed slots are recycled through free list threaded on left index.
+             parent link is optional. without it, iterator keeps the path from root as traversal stack. lookups do not
+             fill the path, so they never allocate, and iterator rebuilds it by one search on its first step.
+             arena holds no pointer, so whole tree is relocatable: copy of trivially copyable Type is one memcpy.
+* @see       bst.hpp
+* @reference
+*/
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <limits>
+#include <stdexcept>
+#include <type_traits>
+#include <vector>
+#include "bst.hpp"
+#include "tree_util.hpp"
+
+namespace snowapril {
+
+    //link to parent node, present only if tree keeps parent link.
+    template <bool has_parent>
+    struct compact_parent_link_ { };
+
+    template <>
+    struct compact_parent_link_<true> {
+        uint32_t parent;
+    };
+
+    template <typename Type, typename Compare = std::less<Type>, bool parent_link = false>
+    class compact_search_tree {
+    public:
+        using value_type      = Type;
+        using key_compare     = Compare;
+        using size_type       = size_t;
+        using difference_type = ptrdiff_t;
+        using index_type      = uint32_t;
+        //index which refers to no node.
+        static constexpr index_type null_index = std::numeric_limits<index_type>::max();
+
+        struct node_type : compact_parent_link_<parent_link> {
+            Type       value;
+            index_type left;
+            index_type right;
+        };
+
+        class iterator {
+            friend class compact_search_tree<Type, Compare, parent_link>;
+        public:
+            using iterator_category = std::bidirectional_iterator_tag;
+            using value_type        = Type;
+            using pointer           = Type const*;
+            using reference         = Type const&;
+            using difference_type   = ptrdiff_t;
+        public:
+            iterator() = default;
+            Type const& operator*()  const;
+            Type const* operator->() const;
+            bool        operator==(iterator const &) const;
+            bool        operator!=(iterator const &) const;
+            //move to in-order successor. amortized O(1) over a full traversal.
+            iterator&   operator++();
+            iterator    operator++(int);
+            //move to in-order predecessor. decrementing end() gives the largest element.
+            iterator&   operator--();
+            iterator    operator--(int);
+        private:
+            iterator(compact_search_tree const *, index_type);
+            //descend from current node to the extreme node of its sub-tree in given direction.
+            void _internal_descend(bool);
+            //fill path of iterator returned by lookup, by search for value of current node from root.
+            void _internal_restore_path();
+        private:
+            compact_search_tree const * tree = nullptr;
+            index_type                  node = null_index;
+            //ancestors of current node from root, used only without parent link.
+            std::vector<index_type>     path;
+            //whether if path holds every ancestor. lookup leaves it empty until the iterator moves.
+            bool                        has_path = true;
+        };
+        using const_iterator   = iterator;
+        using reverse_iterator = std::reverse_iterator<iterator>;
+
+        compact_search_tree() = default; // default constructor
+        explicit compact_search_tree(Compare const &); // constructor with comparator
+        template <typename GenericIterator>
+        compact_search_tree(GenericIterator, GenericIterator); // constructor with range, inserted one by one
+        template <typename GenericIterator>
+        compact_search_tree(sorted_input_t, GenericIterator, GenericIterator); // constructor with sorted range
+        compact_search_tree(std::initializer_list<Type>); // constructor with initializer_list
+        //copy and move are copy and move of the arena, one memcpy for trivially copyable Type.
+        compact_search_tree(compact_search_tree const &) = default; // copy constructor
+        compact_search_tree & operator=(compact_search_tree const &) = default; // copy assignment operator
+        compact_search_tree(compact_search_tree &&) = default; // move constructor
+        compact_search_tree & operator=(compact_search_tree &&) = default; // move assignment operator
+        ~compact_search_tree() = default; // destructor
+
+        //return whether if tree is empty.
+        bool        empty() const;
+        //return the number of elements.
+        size_type   size() const;
+        //return bytes held by node arena, including free slots.
+        size_type   memory_bytes() const;
+        iterator    begin() const;
+        iterator    end() const;
+        reverse_iterator rbegin() const;
+        reverse_iterator rend() const;
+        key_compare key_comp() const;
+        //return iterator of the element equivalent to given key, end() if it does not exist.
+        iterator    find(Type const &) const;
+        //return whether if the element equivalent to given key exists.
+        bool        contains(Type const &) const;
+        //return iterator of the first element not less than given key.
+        iterator    lower_bound(Type const &) const;
+        //return iterator of the first element greater than given key.
+        iterator    upper_bound(Type const &) const;
+        //return the height of the tree. (0 for empty tree)
+        size_type   height() const;
+        //call given function with every element in ascending order, with explicit stack.
+        template <typename Function>
+        void        for_each(Function&&) const;
+        //insert given value. return false if equivalent element already exists.
+        //throw std::length_error if the arena would exceed 32-bit index range.
+        bool        insert(Type const &);
+        //remove element equivalent to given key. return the number of removed elements. (0 or 1)
+        size_type   remove(Type const &);
+        //remove every element and release the arena.
+        void        clear();
+        //replace contents with given sorted range as perfectly balanced tree in in-order layout.
+        //duplicated values are skipped.
+        template <typename GenericIterator>
+        void        bulk_load(GenericIterator, GenericIterator);
+        //rebuild as perfectly balanced tree in in-order layout and drop free slots.
+        void        rebuild();
+        //return nodes of the arena and root index, for code which stores or maps the arena as is.
+        node_type const* data() const;
+        index_type  root_index() const;
+    private:
+        //return slot of new node with given value, from free list or end of the arena.
+        index_type  _internal_create_node(Type const &);
+        void        _internal_destroy_node(index_type);
+        //link arena slots of [begin, end) as perfectly balanced sub-tree. return its root index.
+        index_type  _internal_link_balanced(index_type, index_type, index_type);
+        void        _internal_set_parent(index_type, index_type);
+        index_type  _internal_lower_bound(Type const &) const;
+        index_type  _internal_upper_bound(Type const &) const;
+    private:
+        std::vector<node_type> nodes;
+        Compare    comp;
+        index_type root       = null_index;
+        index_type free_nodes = null_index;
+        size_type  num_node   = 0U;
+    };
+
+    template <typename Type, typename Compare, bool parent_link>
+    compact_search_tree<Type, Compare, parent_link>::compact_search_tree(Compare const & _comp) : comp(_comp) { }
+
+    template <typename Type, typename Compare, bool parent_link>
+    template <typename GenericIterator>
+    compact_search_tree<Type, Compare, parent_link>::compact_search_tree(GenericIterator _begin_iter, GenericIterator _end_iter) {
+        for (; _begin_iter != _end_iter; ++_begin_iter) {
+            insert(*_begin_iter);
+        }
+    }
+
+    template <typename Type, typename Compare, bool parent_link>
+    template <typename GenericIterator>
+    compact_search_tree<Type, Compare, parent_link>::compact_search_tree(sorted_input_t, GenericIterator _begin_iter, GenericIterator _end_iter) {
+        bulk_load(_begin_iter, _end_iter);
+    }
+
+    template <typename Type, typename Compare, bool parent_link>
+    compact_search_tree<Type, Compare, parent_link>::compact_search_tree(std::initializer_list<Type> _i_list) {
+        for (Type const & value : _i_list) {
+            insert(value);
+        }
+    }
+
+    template <typename Type, typename Compare, bool parent_link>
+    bool compact_search_tree<Type, Compare, parent_link>::empty() const {
+        return num_node == 0U;
+    }
+
+    template <typename Type, typename Compare, bool parent_link>
+    typename compact_search_tree<Type, Compare, parent_link>::size_type compact_search_tree<Type, Compare, parent_link>::size() const {
+        return num_node;
+    }
+
+    template <typename Type, typename Compare, bool parent_link>
+    typename compact_search_tree<Type, Compare, parent_link>::size_type compact_search_tree<Type, Compare, parent_link>::memory_bytes() const {
+        return nodes.capacity() * sizeof(node_type);
+    }
+
+    template <typename Type, typename Compare, bool parent_link>
+    typename compact_search_tree<Type, Compare, parent_link>::iterator compact_search_tree<Type, Compare, parent_link>::begin() const {
+        iterator iter(this, root);
+        if (root != null_index) iter._internal_descend(false);
+        return iter;
+    }
+
+    template <typename Type, typename Compare, bool parent_link>
+    typename compact_search_tree<Type, Compare, parent_link>::iterator compact_search_tree<Type, Compare, parent_link>::end() const {
+        return iterator(this, null_index);
+    }
+
+    template <typename Type, typename Compare, bool parent_link>
+    typename compact_search_tree<Type, Compare, parent_link>::reverse_iterator compact_search_tree<Type, Compare, parent_link>::rbegin() const {
+        return reverse_iterator(end());
+    }
+
+    template <typename Type, typename Compare, bool parent_link>
+    typename compact_search_tree<Type, Compare, parent_link>::reverse_iterator compact_search_tree<Type, Compare, parent_link>::rend() const {
+        return reverse_iterator(begin());
+    }
+
+    template <typename Type, typename Compare, bool parent_link>
+    typename compact_search_tree<Type, Compare, parent_link>::key_compare compact_search_tree<Type, Compare, parent_link>::key_comp() const {
+        return comp;
+    }
+
+    template <typename Type, typename Compare, bool parent_link>
+    typename compact_search_tree<Type, Compare, parent_link>::iterator compact_search_tree<Type, Compare, parent_link>::find(Type const & _key) const {
+        iterator iter = lower_bound(_key);
+        return (iter.node != null_index && !comp(_key, nodes[iter.node].value)) ? iter : end();
+    }
+
+    template <typename Type, typename Compare, bool parent_link>
+    bool compact_search_tree<Type, Compare, parent_link>::contains(Type const & _key) const {
+        index_type node = _internal_lower_bound(_key);
+        return node != null_index && !comp(_key, nodes[node].value);
+    }
+
+    template <typename Type, typename Compare, bool parent_link>
+    typename compact_search_tree<Type, Compare, parent_link>::iterator compact_search_tree<Type, Compare, parent_link>::lower_bound(Type const & _key) const {
+        iterator iter(this, _internal_lower_bound(_key));
+        iter.has_path = parent_link || iter.node == null_index;
+        return iter;
+    }
+
+    template <typename Type, typename Compare, bool parent_link>
+    typename compact_search_tree<Type, Compare, parent_link>::iterator compact_search_tree<Type, Compare, parent_link>::upper_bound(Type const & _key) const {
+        iterator iter(this, _internal_upper_bound(_key));
+        iter.has_path = parent_link || iter.node == null_index;
+        return iter;
+    }
+
+    template <typename Type, typename Compare, bool parent_link>
+    typename compact_search_tree<Type, Compare, parent_link>::size_type compact_search_tree<Type, Compare, parent_link>::height() const {
+        //breadth-first walk one level at a time.
+        size_type               num_level = 0U;
+        std::vector<index_type> level, next_level;
+        if (root != null_index) level.push_back(root);
+        while (!level.empty()) {
+            ++num_level;
+            next_level.clear();
+            for (index_type node : level) {
+                if (nodes[node].left  != null_index) next_level.push_back(nodes[node].left);
+                if (nodes[node].right != null_index) next_level.push_back(nodes[node].right);
+            }
+            level.swap(next_level);
+        }
+        return num_level;
+    }
+
+    template <typename Type, typename Compare, bool parent_link>
+    template <typename Function>
+    void compact_search_tree<Type, Compare, parent_link>::for_each(Function&& _func) const {
+        std::vector<index_type> stack;
+        index_type node = root;
+        while (node != null_index || !stack.empty()) {
+            for (; node != null_index; node = nodes[node].left) stack.push_back(node);
+            node = stack.back();
+            stack.pop_back();
+            _func(static_cast<Type const &>(nodes[node].value));
+            node = nodes[node].right;
+        }
+    }
+
+    template <typename Type, typename Compare, bool parent_link>
+    bool compact_search_tree<Type, Compare, parent_link>::insert(Type const & _value) {
+        index_type parent  = null_index;
+        bool       go_left = false;
+        for (index_type node = root; node != null_index; ) {
+            parent = node;
+            if (comp(_value, nodes[node].value))      { go_left = true;  node = nodes[node].left;  }
+            else if (comp(nodes[node].value, _value)) { go_left = false; node = nodes[node].right; }
+            else                                       return false;
+        }
+        //arena may grow here, so parent is referred by index only.
+        index_type new_node = _internal_create_node(_value);
+        _internal_set_parent(new_node, parent);
+        if (parent == null_index) root = new_node;
+        else if (go_left)         nodes[parent].left  = new_node;
+        else                      nodes[parent].right = new_node;
+        ++num_node;
+        return true;
+    }
+
+    template <typename Type, typename Compare, bool parent_link>
+    typename compact_search_tree<Type, Compare, parent_link>::size_type compact_search_tree<Type, Compare, parent_link>::remove(Type const & _key) {
+        index_type* link = &root;
+        index_type  parent = null_index;
+        while (*link != null_index) {
+            node_type& node = nodes[*link];
+            if (comp(_key, node.value))      { parent = *link; link = &node.left;  }
+            else if (comp(node.value, _key)) { parent = *link; link = &node.right; }
+            else                             break;
+        }
+        if (*link == null_index) return 0U;
+
+        index_type removed = *link;
+        node_type& node    = nodes[removed];
+        index_type replacement;
+        if (node.left == null_index || node.right == null_index) {
+            replacement = node.left != null_index ? node.left : node.right;
+        }
+        else {
+            //in-order predecessor takes the place of removed node, so no value is copied.
+            index_type* pred_link   = &node.left;
+            index_type  pred_parent = removed;
+            while (nodes[*pred_link].right != null_index) {
+                pred_parent = *pred_link;
+                pred_link   = &nodes[*pred_link].right;
+            }
+            replacement = *pred_link;
+            if (pred_parent != removed) {
+                *pred_link = nodes[replacement].left;
+                _internal_set_parent(nodes[replacement].left, pred_parent);
+                nodes[replacement].left = node.left;
+                _internal_set_parent(node.left, replacement);
+            }
+            nodes[replacement].right = node.right;
+            _internal_set_parent(node.right, replacement);
+        }
+        _internal_set_parent(replacement, parent);
+        *link = replacement;
+        _internal_destroy_node(removed);
+        --num_node;
+        return 1U;
+    }
+
+    template <typename Type, typename Compare, bool parent_link>
+    void compact_search_tree<Type, Compare, parent_link>::clear() {
+        std::vector<node_type>().swap(nodes);
+        root       = null_index;
+        free_nodes = null_index;
+        num_node   = 0U;
+    }
+
+    template <typename Type, typename Compare, bool parent_link>
+    template <typename GenericIterator>
+    void compact_search_tree<Type, Compare, parent_link>::bulk_load(GenericIterator _begin_iter, GenericIterator _end_iter) {
+        clear();
+        for (GenericIterator iter = _begin_iter, prev_iter = _begin_iter; iter != _end_iter; prev_iter = iter++) {
+            if (iter == _begin_iter || comp(*prev_iter, *iter)) {
+                if (nodes.size() >= null_index) throw std::length_error("compact_search_tree exceeds 32-bit index range");
+                nodes.push_back(node_type{ { }, *iter, null_index, null_index });
+            }
+        }
+        num_node = nodes.size();
+        root     = _internal_link_balanced(0U, static_cast<index_type>(nodes.size()), null_index);
+        LOG("compact bulk load", num_node);
+    }
+
+    template <typename Type, typename Compare, bool parent_link>
+    void compact_search_tree<Type, Compare, parent_link>::rebuild() {
+        std::vector<node_type> sorted_nodes;
+        sorted_nodes.reserve(num_node);
+        for_each([&sorted_nodes](Type const & _value) {
+            sorted_nodes.push_back(node_type{ { }, _value, null_index, null_index });
+        });
+        nodes.swap(sorted_nodes);
+        free_nodes = null_index;
+        root       = _internal_link_balanced(0U, static_cast<index_type>(nodes.size()), null_index);
+    }
+
+    template <typename Type, typename Compare, bool parent_link>
+    typename compact_search_tree<Type, Compare, parent_link>::node_type const* compact_search_tree<Type, Compare, parent_link>::data() const {
+        return nodes.data();
+    }
+
+    template <typename Type, typename Compare, bool parent_link>
+    typename compact_search_tree<Type, Compare, parent_link>::index_type compact_search_tree<Type, Compare, parent_link>::root_index() const {
+        return root;
+    }
+
+    template <typename Type, typename Compare, bool parent_link>
+    typename compact_search_tree<Type, Compare, parent_link>::index_type compact_search_tree<Type, Compare, parent_link>::_internal_create_node(Type const & _value) {
+        if (free_nodes != null_index) {
+            index_type node = free_nodes;
+            free_nodes = nodes[node].left;
+            nodes[node].value = _value;
+            nodes[node].left  = nodes[node].right = null_index;
+            return node;
+        }
+        if (nodes.size() >= null_index) throw std::length_error("compact_search_tree exceeds 32-bit index range");
+        nodes.push_back(node_type{ { }, _value, null_index, null_index });
+        return static_cast<index_type>(nodes.size() - 1U);
+    }
+
+    template <typename Type, typename Compare, bool parent_link>
+    void compact_search_tree<Type, Compare, parent_link>::_internal_destroy_node(index_type _node) {
+        //slot keeps its value until reused. free list is threaded on left index.
+        nodes[_node].left  = free_nodes;
+        nodes[_node].right = null_index;
+        free_nodes = _node;
+    }
+
+    template <typename Type, typename Compare, bool parent_link>
+    typename compact_search_tree<Type, Compare, parent_link>::index_type compact_search_tree<Type, Compare, parent_link>::_internal_link_balanced(index_type _begin, index_type _end, index_type _parent) {
+        //recursion depth is log2(n) because range is halved on each level.
+        if (_begin == _end) return null_index;
+        index_type middle = _begin + (_end - _begin) / 2U;
+        _internal_set_parent(middle, _parent);
+        nodes[middle].left  = _internal_link_balanced(_begin, middle, middle);
+        nodes[middle].right = _internal_link_balanced(middle + 1U, _end, middle);
+        return middle;
+    }
+
+    template <typename Type, typename Compare, bool parent_link>
+    void compact_search_tree<Type, Compare, parent_link>::_internal_set_parent(index_type _node, index_type _parent) {
+        if constexpr (parent_link) {
+            if (_node != null_index) nodes[_node].parent = _parent;
+        }
+        else {
+            (void)_node, (void)_parent;
+        }
+    }
+
+    template <typename Type, typename Compare, bool parent_link>
+    typename compact_search_tree<Type, Compare, parent_link>::index_type compact_search_tree<Type, Compare, parent_link>::_internal_lower_bound(Type const & _key) const {
+        index_type bound = null_index;
+        for (index_type node = root; node != null_index; ) {
+            if (comp(nodes[node].value, _key)) node = nodes[node].right;
+            else                               { bound = node; node = nodes[node].left; }
+        }
+        return bound;
+    }
+
+    template <typename Type, typename Compare, bool parent_link>
+    typename compact_search_tree<Type, Compare, parent_link>::index_type compact_search_tree<Type, Compare, parent_link>::_internal_upper_bound(Type const & _key) const {
+        index_type bound = null_index;
+        for (index_type node = root; node != null_index; ) {
+            if (!comp(_key, nodes[node].value)) node = nodes[node].right;
+            else                                { bound = node; node = nodes[node].left; }
+        }
+        return bound;
+    }
+
+    template <typename Type, typename Compare, bool parent_link>
+    compact_search_tree<Type, Compare, parent_link>::iterator::iterator(compact_search_tree const * _tree, index_type _node) : tree(_tree), node(_node) { }
+
+    template <typename Type, typename Compare, bool parent_link>
+    Type const& compact_search_tree<Type, Compare, parent_link>::iterator::operator*() const {
+        return tree->nodes[node].value;
+    }
+
+    template <typename Type, typename Compare, bool parent_link>
+    Type const* compact_search_tree<Type, Compare, parent_link>::iterator::operator->() const {
+        return &tree->nodes[node].value;
+    }
+
+    template <typename Type, typename Compare, bool parent_link>
+    bool compact_search_tree<Type, Compare, parent_link>::iterator::operator==(iterator const & _iter) const {
+        return node == _iter.node;
+    }
+
+    template <typename Type, typename Compare, bool parent_link>
+    bool compact_search_tree<Type, Compare, parent_link>::iterator::operator!=(iterator const & _iter) const {
+        return node != _iter.node;
+    }
+
+    template <typename Type, typename Compare, bool parent_link>
+    void compact_search_tree<Type, Compare, parent_link>::iterator::_internal_descend(bool _to_right) {
+        node_type const * nodes = tree->nodes.data();
+        while (true) {
+            index_type next = _to_right ? nodes[node].right : nodes[node].left;
+            if (next == null_index) return;
+            if (!parent_link) path.push_back(node);
+            node = next;
+        }
+    }
+
+    template <typename Type, typename Compare, bool parent_link>
+    void compact_search_tree<Type, Compare, parent_link>::iterator::_internal_restore_path() {
+        //values are unique, so search for value of current node ends at the node itself.
+        node_type const * nodes = tree->nodes.data();
+        Type const & value = nodes[node].value;
+        path.clear();
+        for (index_type ancestor = tree->root; ancestor != node; ) {
+            path.push_back(ancestor);
+            ancestor = tree->comp(value, nodes[ancestor].value) ? nodes[ancestor].left : nodes[ancestor].right;
+        }
+        has_path = true;
+    }
+
+    template <typename Type, typename Compare, bool parent_link>
+    typename compact_search_tree<Type, Compare, parent_link>::iterator& compact_search_tree<Type, Compare, parent_link>::iterator::operator++() {
+        node_type const * nodes = tree->nodes.data();
+        if (!has_path) _internal_restore_path();
+        if (nodes[node].right != null_index) {
+            if (!parent_link) path.push_back(node);
+            node = nodes[node].right;
+            _internal_descend(false);
+            return *this;
+        }
+        //climb while current node is right child. the first ancestor reached from its left is the successor.
+        while (true) {
+            index_type parent;
+            if constexpr (parent_link) parent = nodes[node].parent;
+            else {
+                parent = path.empty() ? null_index : path.back();
+                if (!path.empty()) path.pop_back();
+            }
+            if (parent == null_index || nodes[parent].left == node) {
+                node = parent;
+                return *this;
+            }
+            node = parent;
+        }
+    }
+
+    template <typename Type, typename Compare, bool parent_link>
+    typename compact_search_tree<Type, Compare, parent_link>::iterator compact_search_tree<Type, Compare, parent_link>::iterator::operator++(int) {
+        iterator ret_iter = *this;
+        ++(*this);
+        return ret_iter;
+    }
+
+    template <typename Type, typename Compare, bool parent_link>
+    typename compact_search_tree<Type, Compare, parent_link>::iterator& compact_search_tree<Type, Compare, parent_link>::iterator::operator--() {
+        node_type const * nodes = tree->nodes.data();
+        if (node == null_index) {
+            node = tree->root;
+            path.clear();
+            has_path = true;
+            if (node != null_index) _internal_descend(true);
+            return *this;
+        }
+        if (!has_path) _internal_restore_path();
+        if (nodes[node].left != null_index) {
+            if (!parent_link) path.push_back(node);
+            node = nodes[node].left;
+            _internal_descend(true);
+            return *this;
+        }
+        while (true) {
+            index_type parent;
+            if constexpr (parent_link) parent = nodes[node].parent;
+            else {
+                parent = path.empty() ? null_index : path.back();
+                if (!path.empty()) path.pop_back();
+            }
+            if (parent == null_index || nodes[parent].right == node) {
+                node = parent;
+                return *this;
+            }
+            node = parent;
+        }
+    }
+
+    template <typename Type, typename Compare, bool parent_link>
+    typename compact_search_tree<Type, Compare, parent_link>::iterator compact_search_tree<Type, Compare, parent_link>::iterator::operator--(int) {
+        iterator ret_iter = *this;
+        --(*this);
+        return ret_iter;
+    }
+}
+
+#endif
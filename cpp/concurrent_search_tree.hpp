@@ -0,0 +1,466 @@
+#ifndef CONCURRENT_SEARCH_TREE_HPP
+#define CONCURRENT_SEARCH_TREE_HPP
+
+/**
+* @file      concurrent_search_tree.hpp
+* @author    snowapril
+* @date      2026-10-17 (ongoing)
+* @brief     binary search tree which allows many lock-free readers concurrently with writer.
+* @details   header only unbalanced binary search tree with same ordering rule as binary_search_tree.
+             readers never block and never write shared memory except their own padded epoch slot.
+             published nodes are never modified. writers are serialized by mutex, copy the path from root to
+             the changed node (and the spine down to successor on removal), then publish new root with
+             one atomic pointer store, so every read section works on one consistent version of the tree.
+             nodes have no parent link because shared subtrees could not point back to both versions.
+             unlinked nodes are retired with current global epoch and freed only after every reader which
+             could have seen them left its read section. (epoch based reclamation)
+* @see       bst.hpp
+* @reference Keir Fraser, "Practical lock-freedom", 2004 (epoch based reclamation)
+*/
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "tree_exceptions.hpp"
+#include "tree_util.hpp"
+
+namespace snowapril {
+
+    template <typename Type>
+    struct concurrent_node_ {
+        template <typename... Args>
+        explicit concurrent_node_(Args&&... _args) : value(std::forward<Args>(_args)...) { }
+
+        //every field is immutable once the node is published to readers.
+        Type const        value;
+        concurrent_node_* left_node  = nullptr;
+        concurrent_node_* right_node = nullptr;
+    };
+
+    template <typename Type, typename Compare = std::less<Type>, class node_allocator = std::allocator<concurrent_node_<Type>> >
+    class concurrent_search_tree {
+    protected:
+        using node_type = concurrent_node_<Type>;
+    public:
+        using value_type  = Type;
+        using key_compare = Compare;
+        using size_type   = size_t;
+        class reader;
+
+        explicit concurrent_search_tree(size_type = 128U, Compare const & = Compare()); // constructor with maximum number of readers
+        concurrent_search_tree(concurrent_search_tree const &) = delete;
+        concurrent_search_tree & operator=(concurrent_search_tree const &) = delete;
+        ~concurrent_search_tree(); // destructor. no reader may be alive.
+
+            //handle of one reader thread. owns one epoch slot of the tree until destruction.
+            //handle itself is not thread safe, every thread should make its own one.
+            class reader {
+                friend class concurrent_search_tree<Type, Compare, node_allocator>;
+            public:
+                reader(reader &&);
+                reader & operator=(reader &&) = delete;
+                reader(reader const &) = delete;
+                reader & operator=(reader const &) = delete;
+                ~reader();
+                //return whether if tree contains given key.
+                template <typename Key = Type>
+                bool contains(Key const &);
+                //copy the first value not less than given key into second argument. return false if there is no such value.
+                template <typename Key = Type>
+                bool lower_bound(Key const &, Type &);
+                //call given function with every value in ascending order, inside one read section.
+                template <typename Function>
+                void for_each(Function&&);
+            private:
+                reader(concurrent_search_tree const *, size_type);
+                //announce current global epoch before touching any node.
+                void enter() const;
+                //leave read section so retired nodes seen in it can be freed.
+                void leave() const;
+                //scope of one read section. leaves even if user function throws.
+                struct read_section_ {
+                    explicit read_section_(reader const & _reader) : owner(_reader) { owner.enter(); }
+                    ~read_section_() { owner.leave(); }
+                    reader const & owner;
+                };
+            private:
+                concurrent_search_tree const *tree = nullptr;
+                size_type                     slot = 0U;
+                std::vector<node_type*>       traverse_stack;
+            };
+        public:
+            //register calling thread as reader. throw reader_limit_exception if every slot is taken.
+            reader      make_reader() const;
+            //insert given value. return false if equal value already exists.
+            bool        insert(Type const &);
+            //remove given value. return the number of removed values.
+            size_type   remove(Type const &);
+            //return the number of values. exact only when no writer is running.
+            size_type   size() const;
+            bool        empty() const;
+            //return the number of nodes waiting for readers to leave before being freed.
+            size_type   retired_count() const;
+            //wait until every reader active now leaves, then free every retired node.
+            void        synchronize();
+            key_compare key_comp() const;
+        private:
+            template <typename Key>
+            using lookup_key_t = typename std::conditional<is_transparent_compare_<Compare>::value, Key, Type>::type;
+            struct alignas(64) epoch_slot_ {
+                std::atomic<uint64_t> epoch  { 0U };     // 0 if owner is outside of read section
+                std::atomic<bool>     in_use { false };
+            };
+            //copy nodes of writer_path bottom-up over given subtree, then swap new root in with one release store.
+            //originals of copied nodes and writer_unlinked are retired only after the store, and reclaimed periodically.
+            void _internal_publish(node_type*);
+            //create node of the version being built. it is freed by _internal_discard_unpublished if the write fails.
+            node_type* _internal_create_unpublished(node_type*, Type const &, node_type*);
+            //free every node created for the version which failed to publish. published tree is left untouched.
+            void _internal_discard_unpublished();
+            //mark node which is (or is about to be) unreachable from new root. node is freed by reclamation.
+            void _internal_retire(node_type*);
+            //advance global epoch and free retired nodes which no active reader can reach.
+            //retired list is in epoch order, so only its reclaimable prefix is visited, and a stalled reader
+            //costs one epoch scan per write instead of one walk over the whole list.
+            void _internal_reclaim();
+            //return the smallest epoch announced by active readers. (UINT64_MAX if none)
+            uint64_t _internal_min_active_epoch() const;
+            template <typename... Args>
+            node_type* _internal_create_node(Args&&...);
+            void _internal_destroy_node(node_type*);
+        private:
+            static constexpr size_type reclaim_period = 256U;
+            std::atomic<node_type*>         root { nullptr };
+            std::atomic<size_type>          num_node { 0U };
+            mutable std::atomic<uint64_t>   global_epoch { 1U };
+            std::unique_ptr<epoch_slot_[]>  slots;
+            size_type                       num_slot;
+            std::vector<std::pair<node_type*, uint64_t>> retired;
+            std::vector<std::pair<node_type*, bool>>     writer_path;  // visited node and whether if descent went left
+            std::vector<node_type*>         writer_unlinked;           // nodes dropped by current write besides writer_path
+            std::vector<node_type*>         writer_created;            // nodes of current write which are not published yet
+            mutable std::mutex              writer_lock;
+            node_allocator                  alloc;
+            Compare                         comp;
+    };
+
+    template <typename Type, typename Compare, class node_allocator>
+    concurrent_search_tree<Type, Compare, node_allocator>::concurrent_search_tree(size_type _max_reader, Compare const & _comp)
+        : slots(new epoch_slot_[_max_reader]), num_slot(_max_reader), comp(_comp) { }
+
+    template <typename Type, typename Compare, class node_allocator>
+    concurrent_search_tree<Type, Compare, node_allocator>::~concurrent_search_tree() {
+        for (auto const & entry : retired) {
+            _internal_destroy_node(entry.first);
+        }
+        retired.clear();
+        //teardown with explicit stack. unbalanced tree may be as deep as its size.
+        std::vector<node_type*> stack;
+        if (node_type* node = root.load(std::memory_order_relaxed)) stack.push_back(node);
+        while (!stack.empty()) {
+            node_type* node = stack.back();
+            stack.pop_back();
+            if (node->left_node)  stack.push_back(node->left_node);
+            if (node->right_node) stack.push_back(node->right_node);
+            _internal_destroy_node(node);
+        }
+    }
+
+    template <typename Type, typename Compare, class node_allocator>
+    typename concurrent_search_tree<Type, Compare, node_allocator>::reader concurrent_search_tree<Type, Compare, node_allocator>::make_reader() const {
+        for (size_type i = 0U; i < num_slot; ++i) {
+            bool expected = false;
+            if (!slots[i].in_use.load(std::memory_order_relaxed) &&
+                slots[i].in_use.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+                return reader(this, i);
+            }
+        }
+        throw reader_limit_exception("every reader slot of concurrent_search_tree is in use");
+    }
+
+    template <typename Type, typename Compare, class node_allocator>
+    bool concurrent_search_tree<Type, Compare, node_allocator>::insert(Type const & _value) {
+        std::lock_guard<std::mutex> guard(writer_lock);
+        writer_path.clear();
+        writer_unlinked.clear();
+        writer_created.clear();
+        //only writer replaces root, so writer reads it relaxed.
+        node_type* node = root.load(std::memory_order_relaxed);
+        while (node) {
+            bool go_left = comp(_value, node->value);
+            if (!go_left && !comp(node->value, _value)) return false;
+            writer_path.emplace_back(node, go_left);
+            node = go_left ? node->left_node : node->right_node;
+        }
+        _internal_publish(_internal_create_unpublished(nullptr, _value, nullptr));
+        num_node.fetch_add(1U, std::memory_order_relaxed);
+        return true;
+    }
+
+    template <typename Type, typename Compare, class node_allocator>
+    typename concurrent_search_tree<Type, Compare, node_allocator>::size_type concurrent_search_tree<Type, Compare, node_allocator>::remove(Type const & _value) {
+        std::lock_guard<std::mutex> guard(writer_lock);
+        writer_path.clear();
+        writer_unlinked.clear();
+        writer_created.clear();
+        node_type* target = root.load(std::memory_order_relaxed);
+        while (target) {
+            bool go_left = comp(_value, target->value);
+            if (!go_left && !comp(target->value, _value)) break;
+            writer_path.emplace_back(target, go_left);
+            target = go_left ? target->left_node : target->right_node;
+        }
+        if (target == nullptr) return 0U;
+
+        node_type* replacement = nullptr;
+        writer_unlinked.push_back(target);
+        if (target->left_node == nullptr || target->right_node == nullptr) {
+            replacement = target->left_node ? target->left_node : target->right_node;
+        }
+        else {
+            //successor is leftmost node of right subtree. spine from right child to successor is copied
+            //without successor, and the copy of successor takes place of target.
+            //originals stay reachable until publish, so they are only collected here.
+            node_type* successor = target->right_node;
+            while (successor->left_node) {
+                writer_unlinked.push_back(successor);
+                successor = successor->left_node;
+            }
+            writer_unlinked.push_back(successor);
+            try {
+                node_type* copied = successor->right_node;
+                for (size_type i = writer_unlinked.size() - 1U; i > 1U; --i) {
+                    node_type* spine_node = writer_unlinked[i - 1U];
+                    copied = _internal_create_unpublished(copied, spine_node->value, spine_node->right_node);
+                }
+                replacement = _internal_create_unpublished(target->left_node, successor->value, copied);
+            }
+            catch (...) {
+                _internal_discard_unpublished();
+                throw;
+            }
+        }
+        _internal_publish(replacement);
+        num_node.fetch_sub(1U, std::memory_order_relaxed);
+        return 1U;
+    }
+
+    template <typename Type, typename Compare, class node_allocator>
+    typename concurrent_search_tree<Type, Compare, node_allocator>::size_type concurrent_search_tree<Type, Compare, node_allocator>::size() const {
+        return num_node.load(std::memory_order_relaxed);
+    }
+
+    template <typename Type, typename Compare, class node_allocator>
+    bool concurrent_search_tree<Type, Compare, node_allocator>::empty() const {
+        return size() == 0U;
+    }
+
+    template <typename Type, typename Compare, class node_allocator>
+    typename concurrent_search_tree<Type, Compare, node_allocator>::size_type concurrent_search_tree<Type, Compare, node_allocator>::retired_count() const {
+        std::lock_guard<std::mutex> guard(writer_lock);
+        return retired.size();
+    }
+
+    template <typename Type, typename Compare, class node_allocator>
+    void concurrent_search_tree<Type, Compare, node_allocator>::synchronize() {
+        std::lock_guard<std::mutex> guard(writer_lock);
+        uint64_t target_epoch = global_epoch.fetch_add(1U, std::memory_order_seq_cst) + 1U;
+        //readers which entered after advancing never see retired nodes, so wait only for older ones.
+        while (_internal_min_active_epoch() < target_epoch) {
+            std::this_thread::yield();
+        }
+        for (auto const & entry : retired) {
+            _internal_destroy_node(entry.first);
+        }
+        retired.clear();
+    }
+
+    template <typename Type, typename Compare, class node_allocator>
+    typename concurrent_search_tree<Type, Compare, node_allocator>::key_compare concurrent_search_tree<Type, Compare, node_allocator>::key_comp() const {
+        return comp;
+    }
+
+    template <typename Type, typename Compare, class node_allocator>
+    void concurrent_search_tree<Type, Compare, node_allocator>::_internal_publish(node_type* _subtree) {
+        node_type* child = _subtree;
+        try {
+            for (auto iter = writer_path.rbegin(); iter != writer_path.rend(); ++iter) {
+                child = iter->second ? _internal_create_unpublished(child, iter->first->value, iter->first->right_node)
+                                     : _internal_create_unpublished(iter->first->left_node, iter->first->value, child);
+            }
+            //reserve first, so retiring after the store below cannot fail half way.
+            retired.reserve(retired.size() + writer_path.size() + writer_unlinked.size());
+        }
+        catch (...) {
+            _internal_discard_unpublished();
+            throw;
+        }
+        //every new node is fully built before release store, so reader which sees new root sees whole new version.
+        root.store(child, std::memory_order_release);
+        //originals were reachable from the old root until now. retiring them earlier would let a failed copy
+        //above free nodes which are still published.
+        for (auto const & entry : writer_path) {
+            _internal_retire(entry.first);
+        }
+        for (node_type* node : writer_unlinked) {
+            _internal_retire(node);
+        }
+        writer_created.clear();
+        if (retired.size() >= reclaim_period) {
+            _internal_reclaim();
+        }
+    }
+
+    template <typename Type, typename Compare, class node_allocator>
+    typename concurrent_search_tree<Type, Compare, node_allocator>::node_type* concurrent_search_tree<Type, Compare, node_allocator>::_internal_create_unpublished(node_type* _left, Type const & _value, node_type* _right) {
+        //slot is taken before allocation, so the node is recorded once it exists.
+        writer_created.push_back(nullptr);
+        node_type* node  = _internal_create_node(_value);
+        node->left_node  = _left;
+        node->right_node = _right;
+        writer_created.back() = node;
+        return node;
+    }
+
+    template <typename Type, typename Compare, class node_allocator>
+    void concurrent_search_tree<Type, Compare, node_allocator>::_internal_discard_unpublished() {
+        for (node_type* node : writer_created) {
+            if (node) _internal_destroy_node(node);
+        }
+        writer_created.clear();
+    }
+
+    template <typename Type, typename Compare, class node_allocator>
+    void concurrent_search_tree<Type, Compare, node_allocator>::_internal_retire(node_type* _node) {
+        retired.emplace_back(_node, global_epoch.load(std::memory_order_relaxed));
+    }
+
+    template <typename Type, typename Compare, class node_allocator>
+    void concurrent_search_tree<Type, Compare, node_allocator>::_internal_reclaim() {
+        global_epoch.fetch_add(1U, std::memory_order_seq_cst);
+        uint64_t min_epoch = _internal_min_active_epoch();
+        //reader announced epoch e could only see nodes retired at epoch e or later.
+        auto first_kept = retired.begin();
+        for (; first_kept != retired.end() && first_kept->second < min_epoch; ++first_kept) {
+            _internal_destroy_node(first_kept->first);
+        }
+        retired.erase(retired.begin(), first_kept);
+        LOG("reclaim", retired.size());
+    }
+
+    template <typename Type, typename Compare, class node_allocator>
+    uint64_t concurrent_search_tree<Type, Compare, node_allocator>::_internal_min_active_epoch() const {
+        //pairs with the fence in reader::enter. either this scan sees the announcement,
+        //or the reader sees every unlink done before this scan.
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        uint64_t min_epoch = UINT64_MAX;
+        for (size_type i = 0U; i < num_slot; ++i) {
+            uint64_t epoch = slots[i].epoch.load(std::memory_order_acquire);
+            if (epoch != 0U && epoch < min_epoch) min_epoch = epoch;
+        }
+        return min_epoch;
+    }
+
+    template <typename Type, typename Compare, class node_allocator>
+    template <typename... Args>
+    typename concurrent_search_tree<Type, Compare, node_allocator>::node_type* concurrent_search_tree<Type, Compare, node_allocator>::_internal_create_node(Args&&... _args) {
+        node_type* node = alloc.allocate(1);
+        try         { ::new (static_cast<void*>(node)) node_type(std::forward<Args>(_args)...); }
+        catch (...) { alloc.deallocate(node, 1); throw; }
+        return node;
+    }
+
+    template <typename Type, typename Compare, class node_allocator>
+    void concurrent_search_tree<Type, Compare, node_allocator>::_internal_destroy_node(node_type* _node) {
+        _node->~node_type();
+        alloc.deallocate(_node, 1);
+    }
+
+    template <typename Type, typename Compare, class node_allocator>
+    concurrent_search_tree<Type, Compare, node_allocator>::reader::reader(concurrent_search_tree const * _tree, size_type _slot) : tree(_tree), slot(_slot) { }
+
+    template <typename Type, typename Compare, class node_allocator>
+    concurrent_search_tree<Type, Compare, node_allocator>::reader::reader(reader && _reader)
+        : tree(_reader.tree), slot(_reader.slot), traverse_stack(std::move(_reader.traverse_stack)) {
+        _reader.tree = nullptr;
+    }
+
+    template <typename Type, typename Compare, class node_allocator>
+    concurrent_search_tree<Type, Compare, node_allocator>::reader::~reader() {
+        if (tree) {
+            tree->slots[slot].epoch.store(0U, std::memory_order_release);
+            tree->slots[slot].in_use.store(false, std::memory_order_release);
+        }
+    }
+
+    template <typename Type, typename Compare, class node_allocator>
+    void concurrent_search_tree<Type, Compare, node_allocator>::reader::enter() const {
+        tree->slots[slot].epoch.store(tree->global_epoch.load(std::memory_order_relaxed), std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+    }
+
+    template <typename Type, typename Compare, class node_allocator>
+    void concurrent_search_tree<Type, Compare, node_allocator>::reader::leave() const {
+        tree->slots[slot].epoch.store(0U, std::memory_order_release);
+    }
+
+    template <typename Type, typename Compare, class node_allocator>
+    template <typename Key>
+    bool concurrent_search_tree<Type, Compare, node_allocator>::reader::contains(Key const & _key) {
+        lookup_key_t<Key> const & key = _key;
+        read_section_ section(*this);
+        node_type* node = tree->root.load(std::memory_order_acquire);
+        while (node) {
+            if      (tree->comp(key, node->value)) node = node->left_node;
+            else if (tree->comp(node->value, key)) node = node->right_node;
+            else    break;
+        }
+        return node != nullptr;
+    }
+
+    template <typename Type, typename Compare, class node_allocator>
+    template <typename Key>
+    bool concurrent_search_tree<Type, Compare, node_allocator>::reader::lower_bound(Key const & _key, Type & _result) {
+        lookup_key_t<Key> const & key = _key;
+        read_section_ section(*this);
+        node_type* node       = tree->root.load(std::memory_order_acquire);
+        node_type* last_found = nullptr;
+        while (node) {
+            if (tree->comp(node->value, key)) {
+                node = node->right_node;
+            }
+            else {
+                last_found = node;
+                node = node->left_node;
+            }
+        }
+        if (last_found) _result = last_found->value;
+        return last_found != nullptr;
+    }
+
+    template <typename Type, typename Compare, class node_allocator>
+    template <typename Function>
+    void concurrent_search_tree<Type, Compare, node_allocator>::reader::for_each(Function&& _func) {
+        read_section_ section(*this);
+        traverse_stack.clear();
+        node_type* node = tree->root.load(std::memory_order_acquire);
+        while (node || !traverse_stack.empty()) {
+            while (node) {
+                traverse_stack.push_back(node);
+                node = node->left_node;
+            }
+            node = traverse_stack.back();
+            traverse_stack.pop_back();
+            _func(node->value);
+            node = node->right_node;
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,389 @@
+#ifndef CONCURRENT_SKIP_LIST_HPP
+#define CONCURRENT_SKIP_LIST_HPP
+
+/**
+* @file      concurrent_skip_list.hpp
+* @author    snowapril
+* @date      2026-10-17 (ongoing)
+* @brief     ordered set which allows many concurrent writers and readers.
+* @details   header only lazy skip list. lookups take no lock and write no shared memory.
+             insert and remove lock only the predecessors of the changed node (and the node itself on remove),
+             validate that nothing changed since the unlocked search, and retry otherwise.
+             a node is logically in the set when fully_linked and not marked, so every operation has a single
+             linearization point. removed nodes are reclaimed through epoch_domain.
+             nodes have variable height, so they are allocated with aligned global operator new instead of node allocator.
+             new node is allocated and its key copied before any lock is taken, so a throwing copy never leaves
+             predecessors locked.
+* @see       epoch_domain.hpp
+* @reference Herlihy, Lev, Luchangco, Shavit, "A simple optimistic skiplist algorithm", SIROCCO 2007
+*/
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <new>
+#include <thread>
+#include <type_traits>
+#include <utility>
+#include "epoch_domain.hpp"
+#include "tree_util.hpp"
+
+namespace snowapril {
+
+    template <typename Type>
+    struct alignas(std::atomic<void*>) skip_node_ {
+        //key lives in raw storage so head sentinel needs no key.
+        alignas(Type) unsigned char storage[sizeof(Type)];
+        std::atomic<bool> marked       { false };
+        std::atomic<bool> fully_linked { false };
+        std::atomic<bool> locked       { false };
+        uint32_t          top_level    = 0U;
+
+        Type const& key() const { return *std::launder(reinterpret_cast<Type const*>(storage)); }
+        //tower of (top_level + 1) next pointers is placed right after the node.
+        std::atomic<skip_node_*>* next() { return reinterpret_cast<std::atomic<skip_node_*>*>(this + 1); }
+        void lock() {
+            while (true) {
+                if (!locked.load(std::memory_order_relaxed) && !locked.exchange(true, std::memory_order_acquire)) return;
+                std::this_thread::yield();
+            }
+        }
+        void unlock() { locked.store(false, std::memory_order_release); }
+    };
+
+    template <typename Type, typename Compare = std::less<Type> >
+    class concurrent_skip_list {
+    protected:
+        using node_type = skip_node_<Type>;
+    public:
+        using value_type  = Type;
+        using key_compare = Compare;
+        using size_type   = size_t;
+        static constexpr uint32_t max_level = 32U;
+
+        concurrent_skip_list(); // default constructor
+        explicit concurrent_skip_list(Compare const &); // constructor with comparator
+        concurrent_skip_list(concurrent_skip_list const &) = delete;
+        concurrent_skip_list & operator=(concurrent_skip_list const &) = delete;
+        ~concurrent_skip_list(); // destructor. no operation may be in flight.
+
+        //insert given value. return false if equal value already exists. thread safe.
+        bool        insert(Type const &);
+        //remove given value. return the number of removed values. thread safe.
+        size_type   remove(Type const &);
+        //return whether if given key is in the set. thread safe and lock free.
+        template <typename Key = Type>
+        bool        contains(Key const &) const;
+        //copy the first value not less than given key into second argument. return false if there is no such value. thread safe.
+        template <typename Key = Type>
+        bool        lower_bound(Key const &, Type &) const;
+        //call given function with every value in ascending order. thread safe, but values inserted or
+        //removed during the walk may or may not be visited.
+        template <typename Function>
+        void        for_each(Function&&) const;
+        //return the number of values. exact only when no writer is running.
+        size_type   size() const;
+        bool        empty() const;
+        //remove every value. not thread safe.
+        void        clear();
+        key_compare key_comp() const;
+    private:
+        template <typename Key>
+        using lookup_key_t = typename std::conditional<is_transparent_compare_<Compare>::value, Key, Type>::type;
+        //fill predecessors and successors of given key at every level. return the highest level where key was found, or -1.
+        template <typename Key>
+        int  _internal_find(Key const &, node_type**, node_type**) const;
+        //unlock distinct predecessors locked at levels [0, given level].
+        static void _internal_unlock(node_type**, int);
+        static uint32_t   _internal_random_level();
+        static node_type* _internal_create_node(uint32_t);
+        //free node memory. used as deleter of epoch_domain, so it must not touch the list.
+        static void       _internal_destroy_node(void*);
+        //free node without key. (head sentinel, or node whose key copy threw)
+        static void       _internal_destroy_head(node_type*);
+    private:
+        node_type*             head;
+        std::atomic<size_type> num_node { 0U };
+        Compare                comp;
+    };
+
+    template <typename Type, typename Compare>
+    concurrent_skip_list<Type, Compare>::concurrent_skip_list() : head(_internal_create_node(max_level - 1U)) {
+        head->fully_linked.store(true, std::memory_order_relaxed);
+    }
+
+    template <typename Type, typename Compare>
+    concurrent_skip_list<Type, Compare>::concurrent_skip_list(Compare const & _comp) : head(_internal_create_node(max_level - 1U)), comp(_comp) {
+        head->fully_linked.store(true, std::memory_order_relaxed);
+    }
+
+    template <typename Type, typename Compare>
+    concurrent_skip_list<Type, Compare>::~concurrent_skip_list() {
+        clear();
+        _internal_destroy_head(head);
+    }
+
+    template <typename Type, typename Compare>
+    bool concurrent_skip_list<Type, Compare>::insert(Type const & _value) {
+        epoch_domain::guard guard;
+        node_type* preds[max_level];
+        node_type* succs[max_level];
+        uint32_t   top_level = _internal_random_level();
+        node_type* node      = nullptr;
+        while (true) {
+            int found_level = _internal_find(_value, preds, succs);
+            if (found_level != -1) {
+                node_type* found = succs[found_level];
+                if (!found->marked.load(std::memory_order_acquire)) {
+                    //concurrent insert of same key is in progress. wait until it becomes visible, then report duplicate.
+                    while (!found->fully_linked.load(std::memory_order_acquire)) std::this_thread::yield();
+                    //node was never published, so it is freed directly instead of through epoch_domain.
+                    if (node) _internal_destroy_node(node);
+                    return false;
+                }
+                continue;
+            }
+            //build node while nothing is locked. it is kept for retries, so one insert allocates at most once.
+            if (node == nullptr) {
+                node = _internal_create_node(top_level);
+                try         { ::new (static_cast<void*>(node->storage)) Type(_value); }
+                catch (...) { _internal_destroy_head(node); throw; }
+            }
+
+            int        highest_locked = -1;
+            bool       valid          = true;
+            node_type* prev_pred      = nullptr;
+            for (uint32_t level = 0U; valid && level <= top_level; ++level) {
+                node_type* pred = preds[level];
+                node_type* succ = succs[level];
+                if (pred != prev_pred) {
+                    pred->lock();
+                    prev_pred = pred;
+                }
+                highest_locked = static_cast<int>(level);
+                valid = !pred->marked.load(std::memory_order_acquire) &&
+                        (succ == nullptr || !succ->marked.load(std::memory_order_acquire)) &&
+                        pred->next()[level].load(std::memory_order_acquire) == succ;
+            }
+            if (!valid) {
+                _internal_unlock(preds, highest_locked);
+                continue;
+            }
+
+            for (uint32_t level = 0U; level <= top_level; ++level) {
+                node->next()[level].store(succs[level], std::memory_order_relaxed);
+            }
+            for (uint32_t level = 0U; level <= top_level; ++level) {
+                preds[level]->next()[level].store(node, std::memory_order_release);
+            }
+            //linearization point of successful insert.
+            node->fully_linked.store(true, std::memory_order_release);
+            _internal_unlock(preds, highest_locked);
+            num_node.fetch_add(1U, std::memory_order_relaxed);
+            return true;
+        }
+    }
+
+    template <typename Type, typename Compare>
+    typename concurrent_skip_list<Type, Compare>::size_type concurrent_skip_list<Type, Compare>::remove(Type const & _value) {
+        epoch_domain::guard guard;
+        node_type* preds[max_level];
+        node_type* succs[max_level];
+        node_type* victim    = nullptr;
+        bool       is_marked = false;
+        uint32_t   top_level = 0U;
+        while (true) {
+            int found_level = _internal_find(_value, preds, succs);
+            if (!is_marked) {
+                if (found_level == -1) return 0U;
+                victim = succs[found_level];
+                //node which is still being linked (found below its top level) is not in the set yet,
+                //and marked node is already removed.
+                if (!victim->fully_linked.load(std::memory_order_acquire) || victim->top_level != static_cast<uint32_t>(found_level) ||
+                    victim->marked.load(std::memory_order_acquire)) {
+                    return 0U;
+                }
+                top_level = victim->top_level;
+                victim->lock();
+                if (victim->marked.load(std::memory_order_relaxed)) {
+                    victim->unlock();
+                    return 0U;
+                }
+                //linearization point of successful remove.
+                victim->marked.store(true, std::memory_order_release);
+                is_marked = true;
+            }
+
+            int        highest_locked = -1;
+            bool       valid          = true;
+            node_type* prev_pred      = nullptr;
+            for (uint32_t level = 0U; valid && level <= top_level; ++level) {
+                node_type* pred = preds[level];
+                if (pred != prev_pred) {
+                    pred->lock();
+                    prev_pred = pred;
+                }
+                highest_locked = static_cast<int>(level);
+                valid = !pred->marked.load(std::memory_order_acquire) && pred->next()[level].load(std::memory_order_acquire) == victim;
+            }
+            if (!valid) {
+                _internal_unlock(preds, highest_locked);
+                continue;
+            }
+
+            for (int level = static_cast<int>(top_level); level >= 0; --level) {
+                preds[level]->next()[level].store(victim->next()[level].load(std::memory_order_relaxed), std::memory_order_release);
+            }
+            victim->unlock();
+            _internal_unlock(preds, highest_locked);
+            num_node.fetch_sub(1U, std::memory_order_relaxed);
+            epoch_domain::instance().retire(victim, &_internal_destroy_node);
+            return 1U;
+        }
+    }
+
+    template <typename Type, typename Compare>
+    template <typename Key>
+    bool concurrent_skip_list<Type, Compare>::contains(Key const & _key) const {
+        epoch_domain::guard guard;
+        lookup_key_t<Key> const & key = _key;
+        node_type* preds[max_level];
+        node_type* succs[max_level];
+        int found_level = _internal_find(key, preds, succs);
+        return found_level != -1 && succs[found_level]->fully_linked.load(std::memory_order_acquire) &&
+               !succs[found_level]->marked.load(std::memory_order_acquire);
+    }
+
+    template <typename Type, typename Compare>
+    template <typename Key>
+    bool concurrent_skip_list<Type, Compare>::lower_bound(Key const & _key, Type & _result) const {
+        epoch_domain::guard guard;
+        lookup_key_t<Key> const & key = _key;
+        node_type* preds[max_level];
+        node_type* succs[max_level];
+        _internal_find(key, preds, succs);
+        for (node_type* node = succs[0]; node; node = node->next()[0].load(std::memory_order_acquire)) {
+            if (node->fully_linked.load(std::memory_order_acquire) && !node->marked.load(std::memory_order_acquire)) {
+                _result = node->key();
+                return true;
+            }
+        }
+        return false;
+    }
+
+    template <typename Type, typename Compare>
+    template <typename Function>
+    void concurrent_skip_list<Type, Compare>::for_each(Function&& _func) const {
+        epoch_domain::guard guard;
+        for (node_type* node = head->next()[0].load(std::memory_order_acquire); node; node = node->next()[0].load(std::memory_order_acquire)) {
+            if (node->fully_linked.load(std::memory_order_acquire) && !node->marked.load(std::memory_order_acquire)) {
+                _func(node->key());
+            }
+        }
+    }
+
+    template <typename Type, typename Compare>
+    typename concurrent_skip_list<Type, Compare>::size_type concurrent_skip_list<Type, Compare>::size() const {
+        return num_node.load(std::memory_order_relaxed);
+    }
+
+    template <typename Type, typename Compare>
+    bool concurrent_skip_list<Type, Compare>::empty() const {
+        return size() == 0U;
+    }
+
+    template <typename Type, typename Compare>
+    void concurrent_skip_list<Type, Compare>::clear() {
+        node_type* node = head->next()[0].load(std::memory_order_relaxed);
+        while (node) {
+            node_type* next = node->next()[0].load(std::memory_order_relaxed);
+            _internal_destroy_node(node);
+            node = next;
+        }
+        for (uint32_t level = 0U; level < max_level; ++level) {
+            head->next()[level].store(nullptr, std::memory_order_relaxed);
+        }
+        num_node.store(0U, std::memory_order_relaxed);
+    }
+
+    template <typename Type, typename Compare>
+    typename concurrent_skip_list<Type, Compare>::key_compare concurrent_skip_list<Type, Compare>::key_comp() const {
+        return comp;
+    }
+
+    template <typename Type, typename Compare>
+    template <typename Key>
+    int concurrent_skip_list<Type, Compare>::_internal_find(Key const & _key, node_type** _preds, node_type** _succs) const {
+        int        found_level = -1;
+        node_type* pred        = head;
+        for (int level = static_cast<int>(max_level) - 1; level >= 0; --level) {
+            node_type* curr = pred->next()[level].load(std::memory_order_acquire);
+            while (curr && comp(curr->key(), _key)) {
+                pred = curr;
+                curr = pred->next()[level].load(std::memory_order_acquire);
+            }
+            if (found_level == -1 && curr && !comp(_key, curr->key())) {
+                found_level = level;
+            }
+            _preds[level] = pred;
+            _succs[level] = curr;
+        }
+        return found_level;
+    }
+
+    template <typename Type, typename Compare>
+    void concurrent_skip_list<Type, Compare>::_internal_unlock(node_type** _preds, int _highest_locked) {
+        node_type* prev_pred = nullptr;
+        for (int level = 0; level <= _highest_locked; ++level) {
+            if (_preds[level] != prev_pred) {
+                _preds[level]->unlock();
+                prev_pred = _preds[level];
+            }
+        }
+    }
+
+    template <typename Type, typename Compare>
+    uint32_t concurrent_skip_list<Type, Compare>::_internal_random_level() {
+        //geometric distribution with p = 1/2 from trailing zeros of per-thread xorshift state.
+        static thread_local uint64_t state = 0x9E3779B97F4A7C15ULL ^ reinterpret_cast<uintptr_t>(&state);
+        state ^= state << 13;
+        state ^= state >> 7;
+        state ^= state << 17;
+        uint32_t bits  = static_cast<uint32_t>(state) | (1U << (max_level - 1U));
+        uint32_t level = 0U;
+        while ((bits & 1U) == 0U) {
+            bits >>= 1;
+            ++level;
+        }
+        return level;
+    }
+
+    template <typename Type, typename Compare>
+    typename concurrent_skip_list<Type, Compare>::node_type* concurrent_skip_list<Type, Compare>::_internal_create_node(uint32_t _top_level) {
+        //sizeof(node_type) is a multiple of its alignment, so tower right after the node is aligned as well.
+        void*      memory = ::operator new(sizeof(node_type) + (_top_level + 1U) * sizeof(std::atomic<node_type*>),
+                                           std::align_val_t(alignof(node_type)));
+        node_type* node   = ::new (memory) node_type();
+        node->top_level   = _top_level;
+        for (uint32_t level = 0U; level <= _top_level; ++level) {
+            ::new (static_cast<void*>(node->next() + level)) std::atomic<node_type*>(nullptr);
+        }
+        return node;
+    }
+
+    template <typename Type, typename Compare>
+    void concurrent_skip_list<Type, Compare>::_internal_destroy_node(void* _node) {
+        node_type* node = static_cast<node_type*>(_node);
+        reinterpret_cast<Type*>(node->storage)->~Type();
+        node->~node_type();
+        ::operator delete(_node, std::align_val_t(alignof(node_type)));
+    }
+
+    template <typename Type, typename Compare>
+    void concurrent_skip_list<Type, Compare>::_internal_destroy_head(node_type* _head) {
+        _head->~node_type();
+        ::operator delete(static_cast<void*>(_head), std::align_val_t(alignof(node_type)));
+    }
+}
+
+#endif
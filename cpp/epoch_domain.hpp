@@ -0,0 +1,187 @@
+#ifndef EPOCH_DOMAIN_HPP
+#define EPOCH_DOMAIN_HPP
+
+/**
+* @file      epoch_domain.hpp
+* @author    snowapril
+* @date      2026-10-17
+* @brief     process wide epoch based memory reclamation for concurrent containers.
+* @details   header only. every thread gets one padded record on first use, without explicit registration.
+             operation which dereferences shared nodes runs inside epoch_domain::guard, which announces global epoch
+             in the record of calling thread. unlinked nodes are retired with deleter and current epoch, and freed by
+             the retiring thread once every active guard announced a newer epoch.
+             records are recycled when threads exit, and retired nodes left by exited threads are adopted by others.
+* @see       concurrent_skip_list.hpp
+* @reference Keir Fraser, "Practical lock-freedom", 2004
+*/
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <vector>
+#include "tree_util.hpp"
+
+namespace snowapril {
+
+    class epoch_domain {
+    public:
+        using deleter_type = void (*)(void*);
+    private:
+        struct retired_entry_ {
+            void*        ptr;
+            deleter_type deleter;
+            uint64_t     epoch;
+        };
+        struct alignas(64) record_ {
+            std::atomic<uint64_t>       epoch  { 0U };     // 0 if owner thread is outside of guard
+            std::atomic<bool>           in_use { false };
+            unsigned                    nesting = 0U;
+            std::vector<retired_entry_> retired;
+            record_*                    next = nullptr;
+        };
+        //owner of record for one thread. returns record to domain when the thread exits.
+        struct thread_handle_ {
+            ~thread_handle_();
+            record_* record = nullptr;
+        };
+    public:
+        //scope during which calling thread may hold pointers to shared nodes. guards may nest.
+        class guard {
+        public:
+            guard();
+            guard(guard const &) = delete;
+            guard & operator=(guard const &) = delete;
+            ~guard();
+        private:
+            record_* record;
+        };
+    public:
+        epoch_domain(epoch_domain const &) = delete;
+        epoch_domain & operator=(epoch_domain const &) = delete;
+        //return the domain shared by every concurrent container. it is never destroyed, so it outlives thread exit.
+        static epoch_domain& instance();
+        //hand over object which no new operation can reach. deleter is called once no guard can still hold it.
+        void   retire(void*, deleter_type);
+        //advance global epoch and free retired objects which no active guard can hold.
+        void   collect();
+        //return the number of objects retired by calling thread and not freed yet.
+        size_t pending();
+    private:
+        epoch_domain() = default;
+        record_* _internal_local_record();
+        record_* _internal_acquire_record();
+        void     _internal_release_record(record_*);
+        uint64_t _internal_min_active_epoch();
+        //free entries retired before given epoch and compact the rest in place.
+        static void _internal_free_before(std::vector<retired_entry_>&, uint64_t);
+    private:
+        static constexpr size_t     collect_period = 128U;
+        std::atomic<record_*>       records      { nullptr };
+        std::atomic<uint64_t>       global_epoch { 1U };
+        std::mutex                  orphan_lock;
+        std::vector<retired_entry_> orphans;
+    };
+
+    inline epoch_domain::thread_handle_::~thread_handle_() {
+        if (record) epoch_domain::instance()._internal_release_record(record);
+    }
+
+    inline epoch_domain::guard::guard() : record(epoch_domain::instance()._internal_local_record()) {
+        if (record->nesting++ == 0U) {
+            record->epoch.store(epoch_domain::instance().global_epoch.load(std::memory_order_relaxed), std::memory_order_relaxed);
+            //pairs with the fence in _internal_min_active_epoch. either collector sees this announcement,
+            //or this thread sees every unlink done before the collector scanned.
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+        }
+    }
+
+    inline epoch_domain::guard::~guard() {
+        if (--record->nesting == 0U) {
+            record->epoch.store(0U, std::memory_order_release);
+        }
+    }
+
+    inline epoch_domain& epoch_domain::instance() {
+        static epoch_domain* domain = new epoch_domain();
+        return *domain;
+    }
+
+    inline void epoch_domain::retire(void* _ptr, deleter_type _deleter) {
+        record_* record = _internal_local_record();
+        record->retired.push_back(retired_entry_{ _ptr, _deleter, global_epoch.load(std::memory_order_relaxed) });
+        if (record->retired.size() >= collect_period) {
+            collect();
+        }
+    }
+
+    inline void epoch_domain::collect() {
+        record_* record = _internal_local_record();
+        global_epoch.fetch_add(1U, std::memory_order_seq_cst);
+        uint64_t min_epoch = _internal_min_active_epoch();
+        _internal_free_before(record->retired, min_epoch);
+        std::unique_lock<std::mutex> lock(orphan_lock, std::try_to_lock);
+        if (lock.owns_lock() && !orphans.empty()) {
+            _internal_free_before(orphans, min_epoch);
+        }
+    }
+
+    inline size_t epoch_domain::pending() {
+        return _internal_local_record()->retired.size();
+    }
+
+    inline epoch_domain::record_* epoch_domain::_internal_local_record() {
+        static thread_local thread_handle_ handle;
+        if (handle.record == nullptr) handle.record = _internal_acquire_record();
+        return handle.record;
+    }
+
+    inline epoch_domain::record_* epoch_domain::_internal_acquire_record() {
+        for (record_* record = records.load(std::memory_order_acquire); record; record = record->next) {
+            bool expected = false;
+            if (!record->in_use.load(std::memory_order_relaxed) &&
+                record->in_use.compare_exchange_strong(expected, true, std::memory_order_acquire)) {
+                return record;
+            }
+        }
+        //records are only pushed and never unlinked, so traversal above needs no reclamation.
+        record_* record = new record_();
+        record->in_use.store(true, std::memory_order_relaxed);
+        record->next = records.load(std::memory_order_relaxed);
+        while (!records.compare_exchange_weak(record->next, record, std::memory_order_release, std::memory_order_relaxed)) { }
+        LOG("new epoch record", record);
+        return record;
+    }
+
+    inline void epoch_domain::_internal_release_record(record_* _record) {
+        if (!_record->retired.empty()) {
+            std::lock_guard<std::mutex> lock(orphan_lock);
+            orphans.insert(orphans.end(), _record->retired.begin(), _record->retired.end());
+            _record->retired.clear();
+        }
+        _record->nesting = 0U;
+        _record->epoch.store(0U, std::memory_order_release);
+        _record->in_use.store(false, std::memory_order_release);
+    }
+
+    inline uint64_t epoch_domain::_internal_min_active_epoch() {
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        uint64_t min_epoch = UINT64_MAX;
+        for (record_* record = records.load(std::memory_order_acquire); record; record = record->next) {
+            uint64_t epoch = record->epoch.load(std::memory_order_acquire);
+            if (epoch != 0U && epoch < min_epoch) min_epoch = epoch;
+        }
+        return min_epoch;
+    }
+
+    inline void epoch_domain::_internal_free_before(std::vector<retired_entry_>& _entries, uint64_t _epoch) {
+        size_t num_kept = 0U;
+        for (size_t i = 0U; i < _entries.size(); ++i) {
+            if (_entries[i].epoch < _epoch) _entries[i].deleter(_entries[i].ptr);
+            else                            _entries[num_kept++] = _entries[i];
+        }
+        _entries.resize(num_kept);
+    }
+}
+
+#endif
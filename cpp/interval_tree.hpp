@@ -0,0 +1,195 @@
+#ifndef INTERVAL_TREE_HPP
+#define INTERVAL_TREE_HPP
+
+/**
+* @file      interval_tree.hpp
+* @author    snowapril
+* @date      2026-10-17 (ongoing)
+* @brief     interval tree on top of red_black_tree with monoid augmentation.
+* @details   header only. closed intervals [low, high] are ordered by (low, high) and every node keeps the largest
+             high end point of its sub-tree as monoid summary. overlap query descends only into sub-trees whose
+             largest high end point reaches the query and stops at the first interval starting after it,
+             so it reports k intervals in O(min(n, (k + 1) log n)) and any-overlap test runs in O(log n).
+             red black balancing keeps these bounds on sorted or otherwise adversarial insertion order.
+             Compare must be default constructible and stateless, because summary is combined without tree instance.
+* @see       red_black_tree.hpp
+* @reference Cormen, Leiserson, Rivest, Stein, "Introduction to Algorithms", 3rd ed., 14.3 Interval trees
+*/
+
+#include <functional>
+#include <initializer_list>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+#include "red_black_tree.hpp"
+
+namespace snowapril {
+
+    template <typename Key, typename Compare = std::less<Key>>
+    class interval_tree {
+    public:
+        using key_type      = Key;
+        using interval_type = std::pair<Key, Key>; // closed interval [first, second]
+        using key_compare   = Compare;
+        using size_type     = size_t;
+    private:
+        //lexicographic order of (low, high).
+        struct interval_order_ {
+            bool operator()(interval_type const & _lhs, interval_type const & _rhs) const {
+                if (comp(_lhs.first, _rhs.first)) return true;
+                if (comp(_rhs.first, _lhs.first)) return false;
+                return comp(_lhs.second, _rhs.second);
+            }
+            Compare comp;
+        };
+        //largest high end point of the sub-tree.
+        struct max_high_summary_ {
+            using summary_type = Key;
+            static Key const & of(interval_type const & _interval)        { return _interval.second; }
+            static Key const & combine(Key const & _lhs, Key const & _rhs) { return Compare()(_lhs, _rhs) ? _rhs : _lhs; }
+        };
+        using node_type = rb_node_<interval_type, monoid_augment_<max_high_summary_>>;
+        using tree_type = red_black_tree<interval_type, interval_order_, std::allocator<node_type>>;
+        using node_iterator = typename tree_type::downside_iterator;
+    public:
+        using iterator = typename tree_type::iterator;
+
+        interval_tree() = default; // default constructor
+        interval_tree(std::initializer_list<interval_type>); // constructor with intervals
+
+        //return whether if tree is empty.
+        bool        empty() const;
+        //return the number of intervals.
+        size_type   size() const;
+        //iterate intervals in (low, high) order. intervals must not be modified through iterator.
+        iterator    begin() const;
+        iterator    end() const;
+        //insert interval [low, high]. return false if the same interval already exists.
+        //throw std::invalid_argument if high is less than low.
+        bool        insert(Key const &, Key const &);
+        //remove interval [low, high]. return the number of removed intervals. (0 or 1)
+        size_type   remove(Key const &, Key const &);
+        //return whether if interval [low, high] exists.
+        bool        contains(Key const &, Key const &) const;
+        //remove every interval.
+        void        clear();
+        //return whether if any interval overlaps [low, high]. O(log n).
+        bool        overlaps_any(Key const &, Key const &) const;
+        //call given function with every interval which overlaps [low, high], in (low, high) order.
+        //O(min(n, (k + 1) log n)) for k reported intervals, since sub-trees without overlap are skipped by their max high.
+        template <typename Function>
+        void        for_each_overlap(Key const &, Key const &, Function&&) const;
+        //return every interval which overlaps [low, high], in (low, high) order. O(min(n, (k + 1) log n)) for k results.
+        std::vector<interval_type> overlaps(Key const &, Key const &) const;
+        //call given function with every interval which contains given point. O(min(n, (k + 1) log n)) for k results.
+        template <typename Function>
+        void        for_each_containing(Key const &, Function&&) const;
+    private:
+        static Key const & _internal_max_high(node_iterator const &);
+    private:
+        tree_type tree;
+        Compare   comp;
+    };
+
+    template <typename Key, typename Compare>
+    interval_tree<Key, Compare>::interval_tree(std::initializer_list<interval_type> _i_list) {
+        for (interval_type const & interval : _i_list) {
+            insert(interval.first, interval.second);
+        }
+    }
+
+    template <typename Key, typename Compare>
+    bool interval_tree<Key, Compare>::empty() const {
+        return tree.empty();
+    }
+
+    template <typename Key, typename Compare>
+    typename interval_tree<Key, Compare>::size_type interval_tree<Key, Compare>::size() const {
+        return tree.size();
+    }
+
+    template <typename Key, typename Compare>
+    typename interval_tree<Key, Compare>::iterator interval_tree<Key, Compare>::begin() const {
+        return tree.begin();
+    }
+
+    template <typename Key, typename Compare>
+    typename interval_tree<Key, Compare>::iterator interval_tree<Key, Compare>::end() const {
+        return tree.end();
+    }
+
+    template <typename Key, typename Compare>
+    bool interval_tree<Key, Compare>::insert(Key const & _low, Key const & _high) {
+        if (comp(_high, _low)) throw std::invalid_argument("high end point of interval is less than low end point");
+        return tree.insert(interval_type(_low, _high)).second;
+    }
+
+    template <typename Key, typename Compare>
+    typename interval_tree<Key, Compare>::size_type interval_tree<Key, Compare>::remove(Key const & _low, Key const & _high) {
+        return tree.remove(interval_type(_low, _high));
+    }
+
+    template <typename Key, typename Compare>
+    bool interval_tree<Key, Compare>::contains(Key const & _low, Key const & _high) const {
+        return tree.contains(interval_type(_low, _high));
+    }
+
+    template <typename Key, typename Compare>
+    void interval_tree<Key, Compare>::clear() {
+        tree.clear();
+    }
+
+    template <typename Key, typename Compare>
+    bool interval_tree<Key, Compare>::overlaps_any(Key const & _low, Key const & _high) const {
+        //if left sub-tree reaches low but has no overlap, every interval of right sub-tree starts after high.
+        node_iterator node = tree.downside_begin();
+        while (node) {
+            interval_type const & interval = *node;
+            if (!comp(_high, interval.first) && !comp(interval.second, _low)) return true;
+            node_iterator left_node = node - 1;
+            node = (left_node && !comp(_internal_max_high(left_node), _low)) ? left_node : node + 1;
+        }
+        return false;
+    }
+
+    template <typename Key, typename Compare>
+    template <typename Function>
+    void interval_tree<Key, Compare>::for_each_overlap(Key const & _low, Key const & _high, Function&& _func) const {
+        //in-order walk with explicit stack. sub-trees whose largest high end point is less than low are skipped,
+        //and the walk stops at the first interval which starts after high.
+        std::vector<node_iterator> stack;
+        node_iterator node = tree.downside_begin();
+        while (true) {
+            for (; node && !comp(_internal_max_high(node), _low); node = node - 1) {
+                stack.push_back(node);
+            }
+            if (stack.empty()) return;
+            node = stack.back();
+            stack.pop_back();
+            interval_type const & interval = *node;
+            if (comp(_high, interval.first)) return;
+            if (!comp(interval.second, _low)) _func(interval);
+            node = node + 1;
+        }
+    }
+
+    template <typename Key, typename Compare>
+    std::vector<typename interval_tree<Key, Compare>::interval_type> interval_tree<Key, Compare>::overlaps(Key const & _low, Key const & _high) const {
+        std::vector<interval_type> result;
+        for_each_overlap(_low, _high, [&result](interval_type const & _interval) { result.push_back(_interval); });
+        return result;
+    }
+
+    template <typename Key, typename Compare>
+    template <typename Function>
+    void interval_tree<Key, Compare>::for_each_containing(Key const & _point, Function&& _func) const {
+        for_each_overlap(_point, _point, std::forward<Function>(_func));
+    }
+
+    template <typename Key, typename Compare>
+    Key const & interval_tree<Key, Compare>::_internal_max_high(node_iterator const & _node) {
+        return _node.augment().summary;
+    }
+}
+
+#endif
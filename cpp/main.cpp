@@ -4,11 +4,9 @@
 using namespace std;
 using namespace snowapril;
 
-void dump_tree(auto iter) {
-    if (iter) {
-        cout << *iter << ' ';
-        dump_tree(iter - 1);
-        dump_tree(iter + 1);
+void dump_tree(binary_search_tree<int> const & tree) {
+    for (int value : tree) {
+        cout << value << ' ';
     }
 }
 
@@ -38,7 +36,7 @@ int main(void) {
             cout << "tree size : " << tree.size() << endl;
             break;
         case 3:
-            dump_tree(tree.begin());
+            dump_tree(tree);
             cout << endl;
             break;
         case 4:
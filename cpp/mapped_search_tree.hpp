@@ -0,0 +1,300 @@
+#ifndef MAPPED_SEARCH_TREE_HPP
+#define MAPPED_SEARCH_TREE_HPP
+
+/**
+* @file      mapped_search_tree.hpp
+* @author    snowapril
+* @date      2026-10-17 (ongoing)
+* @brief     on-disk search tree format which is opened with mmap and searched in place.
+* @details   header only, POSIX. file is a 64 bytes header followed by the Eytzinger array of static_search_tree,
+             so any tree which iterates in sorted order is saved in O(n) and opening is one mmap call without
+             deserialization or allocation per node. lookups run directly on mapped pages, which are faulted in
+             lazily. Eytzinger layout keeps top levels of the tree in the first pages of the array, so pages touched
+             by every lookup stay resident and a cold lookup faults in about one page per level below them.
+             Type must be trivially copyable and the file is only readable on machines of the same byte order.
+* @see       static_search_tree.hpp
+* @reference
+*/
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <functional>
+#include <string>
+#include <system_error>
+#include <type_traits>
+#include <utility>
+#include <cerrno>
+#include <cstdio>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include "static_search_tree.hpp"
+#include "tree_exceptions.hpp"
+
+namespace snowapril {
+
+    //fixed size file header. Eytzinger array starts at data_offset, so it is aligned to cache line in the mapping.
+    struct mapped_tree_header_ {
+        static constexpr char     magic_value[8] = { 'S', 'N', 'W', 'T', 'R', 'E', 'E', '\0' };
+        static constexpr uint32_t current_version = 1U;
+        static constexpr uint32_t byte_order_tag  = 0x01020304U;
+        static constexpr uint64_t header_size     = 64U;
+
+        char     magic[8];
+        uint32_t version;
+        uint32_t byte_order;
+        uint64_t value_size;
+        uint64_t value_align;
+        uint64_t num_node;
+        uint64_t data_offset;
+        uint64_t reserved[2];
+    };
+    static_assert(sizeof(mapped_tree_header_) == mapped_tree_header_::header_size, "mapped tree header must be 64 bytes");
+
+    template <typename Type, typename Compare = std::less<Type>>
+    class mapped_search_tree {
+    public:
+        using value_type       = Type;
+        using key_compare      = Compare;
+        using size_type        = size_t;
+        using tree_type        = static_search_tree<Type, Compare>;
+        using iterator         = typename tree_type::iterator;
+        using const_iterator   = iterator;
+        using reverse_iterator = typename tree_type::reverse_iterator;
+        static_assert(std::is_trivially_copyable<Type>::value, "mapped_search_tree requires trivially copyable Type");
+
+        mapped_search_tree() = default; // default constructor
+        //map given file read-only. throw std::system_error if the file cannot be mapped and
+        //tree_format_exception if it is not a tree of this Type.
+        explicit mapped_search_tree(std::string const &, Compare const & = Compare()); // constructor with file path
+        mapped_search_tree(mapped_search_tree const &) = delete;
+        mapped_search_tree & operator=(mapped_search_tree const &) = delete;
+        mapped_search_tree(mapped_search_tree &&) noexcept; // move constructor
+        mapped_search_tree & operator=(mapped_search_tree &&) noexcept; // move assignment operator
+        ~mapped_search_tree(); // destructor. unmaps the file, which invalidates every iterator.
+
+        //return whether if tree is empty.
+        bool             empty() const;
+        //return the number of elements.
+        size_type        size() const;
+        //return the number of mapped bytes, including header.
+        size_type        mapped_bytes() const;
+        iterator         begin() const;
+        iterator         end() const;
+        reverse_iterator rbegin() const;
+        reverse_iterator rend() const;
+        //lookup methods run on mapped pages. same as static_search_tree.
+        template <typename Key = Type>
+        iterator         find(Key const &) const;
+        template <typename Key = Type>
+        bool             contains(Key const &) const;
+        template <typename Key = Type>
+        iterator         lower_bound(Key const &) const;
+        template <typename Key = Type>
+        iterator         upper_bound(Key const &) const;
+        template <typename KeyIterator, typename OutputIterator>
+        OutputIterator   find_batch(KeyIterator, KeyIterator, OutputIterator) const;
+    private:
+        void             _internal_unmap();
+    private:
+        void*     mapping  = nullptr;
+        size_type map_size = 0U;
+        tree_type tree;
+    };
+
+    //write static_search_tree in mapped format. file is written beside given path and renamed over it,
+    //so trees which already mapped the old file keep reading it. throw std::system_error on I/O failure.
+    template <typename Type, typename Compare>
+    void save_mapped_tree(std::string const &, static_search_tree<Type, Compare> const &);
+
+    //write any tree which iterates in sorted order, e.g. binary_search_tree or compact_search_tree.
+    template <typename Tree>
+    void save_mapped_tree(std::string const &, Tree const &);
+
+    template <typename Type, typename Compare>
+    mapped_search_tree<Type, Compare>::mapped_search_tree(std::string const & _path, Compare const & _comp) {
+        int file = ::open(_path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (file < 0) throw std::system_error(errno, std::generic_category(), "cannot open " + _path);
+        struct stat file_stat;
+        if (::fstat(file, &file_stat) != 0) {
+            int error = errno;
+            ::close(file);
+            throw std::system_error(error, std::generic_category(), "cannot stat " + _path);
+        }
+        map_size = static_cast<size_type>(file_stat.st_size);
+        if (map_size < mapped_tree_header_::header_size) {
+            ::close(file);
+            throw tree_format_exception("tree_format_exception : " + _path + " is too small for mapped tree header.");
+        }
+        mapping = ::mmap(nullptr, map_size, PROT_READ, MAP_SHARED, file, 0);
+        int error = errno;
+        //mapping keeps its own reference to the file.
+        ::close(file);
+        if (mapping == MAP_FAILED) {
+            mapping = nullptr;
+            throw std::system_error(error, std::generic_category(), "cannot map " + _path);
+        }
+
+        mapped_tree_header_ header;
+        std::memcpy(&header, mapping, sizeof(header));
+        char const* reason = nullptr;
+        if (std::memcmp(header.magic, mapped_tree_header_::magic_value, sizeof(header.magic)) != 0) reason = "magic number mismatch";
+        else if (header.version != mapped_tree_header_::current_version)                            reason = "unsupported version";
+        else if (header.byte_order != mapped_tree_header_::byte_order_tag)                          reason = "byte order mismatch";
+        else if (header.value_size != sizeof(Type) || header.value_align != alignof(Type))          reason = "value type mismatch";
+        else if (header.data_offset % alignof(Type) != 0U || header.data_offset > map_size)         reason = "data offset out of range";
+        //array holds num_node + 1 slots. compared as num_node >= capacity so a forged num_node cannot wrap around.
+        else if (header.num_node >= (map_size - header.data_offset) / sizeof(Type))                 reason = "file is truncated";
+        if (reason != nullptr) {
+            _internal_unmap();
+            throw tree_format_exception("tree_format_exception : " + _path + " : " + reason + ".");
+        }
+        //lookups jump between distant slots, so read-ahead of neighbour pages would be wasted.
+        ::madvise(mapping, map_size, MADV_RANDOM);
+        tree = tree_type(reinterpret_cast<Type const*>(static_cast<char const*>(mapping) + header.data_offset),
+                         static_cast<size_type>(header.num_node), _comp);
+    }
+
+    template <typename Type, typename Compare>
+    mapped_search_tree<Type, Compare>::mapped_search_tree(mapped_search_tree && _other) noexcept
+        : mapping(std::exchange(_other.mapping, nullptr)), map_size(std::exchange(_other.map_size, 0U)), tree(std::move(_other.tree)) {
+        _other.tree = tree_type();
+    }
+
+    template <typename Type, typename Compare>
+    mapped_search_tree<Type, Compare> & mapped_search_tree<Type, Compare>::operator=(mapped_search_tree && _other) noexcept {
+        if (this != &_other) {
+            _internal_unmap();
+            mapping  = std::exchange(_other.mapping, nullptr);
+            map_size = std::exchange(_other.map_size, 0U);
+            tree     = std::move(_other.tree);
+            _other.tree = tree_type();
+        }
+        return *this;
+    }
+
+    template <typename Type, typename Compare>
+    mapped_search_tree<Type, Compare>::~mapped_search_tree() {
+        _internal_unmap();
+    }
+
+    template <typename Type, typename Compare>
+    bool mapped_search_tree<Type, Compare>::empty() const {
+        return tree.empty();
+    }
+
+    template <typename Type, typename Compare>
+    typename mapped_search_tree<Type, Compare>::size_type mapped_search_tree<Type, Compare>::size() const {
+        return tree.size();
+    }
+
+    template <typename Type, typename Compare>
+    typename mapped_search_tree<Type, Compare>::size_type mapped_search_tree<Type, Compare>::mapped_bytes() const {
+        return map_size;
+    }
+
+    template <typename Type, typename Compare>
+    typename mapped_search_tree<Type, Compare>::iterator mapped_search_tree<Type, Compare>::begin() const {
+        return tree.begin();
+    }
+
+    template <typename Type, typename Compare>
+    typename mapped_search_tree<Type, Compare>::iterator mapped_search_tree<Type, Compare>::end() const {
+        return tree.end();
+    }
+
+    template <typename Type, typename Compare>
+    typename mapped_search_tree<Type, Compare>::reverse_iterator mapped_search_tree<Type, Compare>::rbegin() const {
+        return tree.rbegin();
+    }
+
+    template <typename Type, typename Compare>
+    typename mapped_search_tree<Type, Compare>::reverse_iterator mapped_search_tree<Type, Compare>::rend() const {
+        return tree.rend();
+    }
+
+    template <typename Type, typename Compare>
+    template <typename Key>
+    typename mapped_search_tree<Type, Compare>::iterator mapped_search_tree<Type, Compare>::find(Key const & _key) const {
+        return tree.find(_key);
+    }
+
+    template <typename Type, typename Compare>
+    template <typename Key>
+    bool mapped_search_tree<Type, Compare>::contains(Key const & _key) const {
+        return tree.contains(_key);
+    }
+
+    template <typename Type, typename Compare>
+    template <typename Key>
+    typename mapped_search_tree<Type, Compare>::iterator mapped_search_tree<Type, Compare>::lower_bound(Key const & _key) const {
+        return tree.lower_bound(_key);
+    }
+
+    template <typename Type, typename Compare>
+    template <typename Key>
+    typename mapped_search_tree<Type, Compare>::iterator mapped_search_tree<Type, Compare>::upper_bound(Key const & _key) const {
+        return tree.upper_bound(_key);
+    }
+
+    template <typename Type, typename Compare>
+    template <typename KeyIterator, typename OutputIterator>
+    OutputIterator mapped_search_tree<Type, Compare>::find_batch(KeyIterator _begin_iter, KeyIterator _end_iter, OutputIterator _out_iter) const {
+        return tree.find_batch(_begin_iter, _end_iter, _out_iter);
+    }
+
+    template <typename Type, typename Compare>
+    void mapped_search_tree<Type, Compare>::_internal_unmap() {
+        if (mapping != nullptr) ::munmap(mapping, map_size);
+        mapping  = nullptr;
+        map_size = 0U;
+    }
+
+    template <typename Type, typename Compare>
+    void save_mapped_tree(std::string const & _path, static_search_tree<Type, Compare> const & _tree) {
+        static_assert(std::is_trivially_copyable<Type>::value, "mapped tree format requires trivially copyable Type");
+        static_assert(alignof(Type) <= mapped_tree_header_::header_size, "mapped tree format aligns values to at most 64 bytes");
+        mapped_tree_header_ header;
+        std::memset(&header, 0, sizeof(header));
+        std::memcpy(header.magic, mapped_tree_header_::magic_value, sizeof(header.magic));
+        header.version     = mapped_tree_header_::current_version;
+        header.byte_order  = mapped_tree_header_::byte_order_tag;
+        header.value_size  = sizeof(Type);
+        header.value_align = alignof(Type);
+        header.num_node    = _tree.size();
+        header.data_offset = mapped_tree_header_::header_size;
+
+        std::string temp_path = _path + ".tmp";
+        {
+            std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+            file.write(reinterpret_cast<char const*>(&header), sizeof(header));
+            //slot 0 is the unused dummy of Eytzinger array. it is written too, so slot k is at data_offset + k * sizeof(Type).
+            Type const dummy = Type();
+            file.write(reinterpret_cast<char const*>(&dummy), sizeof(Type));
+            if (!_tree.empty()) {
+                file.write(reinterpret_cast<char const*>(_tree.data() + 1), static_cast<std::streamsize>(_tree.size() * sizeof(Type)));
+            }
+            file.flush();
+            if (!file) {
+                int error = errno;
+                std::remove(temp_path.c_str());
+                throw std::system_error(error, std::generic_category(), "cannot write " + temp_path);
+            }
+        }
+        if (std::rename(temp_path.c_str(), _path.c_str()) != 0) {
+            int error = errno;
+            std::remove(temp_path.c_str());
+            throw std::system_error(error, std::generic_category(), "cannot rename " + temp_path + " to " + _path);
+        }
+    }
+
+    template <typename Tree>
+    void save_mapped_tree(std::string const & _path, Tree const & _tree) {
+        using static_tree = static_search_tree<typename Tree::value_type, typename Tree::key_compare>;
+        save_mapped_tree(_path, static_tree(sorted_input, _tree.begin(), _tree.end(), _tree.key_comp()));
+    }
+}
+
+#endif
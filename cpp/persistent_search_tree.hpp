@@ -0,0 +1,719 @@
+#ifndef PERSISTENT_SEARCH_TREE_HPP
+#define PERSISTENT_SEARCH_TREE_HPP
+
+/**
+* @file      persistent_search_tree.hpp
+* @author    snowapril
+* @date      2026-10-17 (ongoing)
+* @brief     persistent AVL tree with structural sharing, of which copy is O(1) snapshot.
+* @details   header only ordered set. each tree object is one version, and versions share nodes.
+             copy (and snapshot) only takes one more reference of the root, so it is O(1) in time and memory.
+             update copies the nodes on its path and the ones which rotation touches if they are shared with other
+             version, and writes nodes of its own in place. so insert and remove allocate O(log n) nodes while
+             a snapshot is alive, and none beyond the inserted one while the version owns the whole path.
+             node has reference count of the versions and nodes which point to it. node whose count drops to zero
+             is destroyed and releases its children, with explicit stack bounded by the height.
+             AVL balance keeps height under 1.44 * log2(n + 2), so every update and lookup is O(log n) and
+             node keeps no parent link, which could not be shared. iterator keeps the path from root instead.
+             reference count is atomic and shared node is never written, so different versions may be read,
+             updated and destroyed on different threads at the same time. one version is not thread safe itself.
+             node of one version is freed by whichever version drops it last, so copies of node_allocator
+             must be able to free each other's nodes.
+* @see       bst.hpp, compact_search_tree.hpp
+* @reference Driscoll, Sarnak, Sleator, Tarjan, "Making data structures persistent", JCSS 38(1), 1989.
+             Adelson-Velsky, Landis, "An algorithm for the organization of information", 1962.
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "tree_util.hpp"
+
+namespace snowapril {
+
+    template <typename Type>
+    class persistent_node_ {
+    public:
+        persistent_node_(Type const &); // constructor with l-value data
+        persistent_node_(Type&&); // constructor with r-value data
+        persistent_node_(persistent_node_<Type> const &) = delete;
+        persistent_node_<Type> & operator=(persistent_node_<Type> const &) = delete;
+        ~persistent_node_();
+    public:
+        persistent_node_<Type> *left_node  = nullptr;
+        persistent_node_<Type> *right_node = nullptr;
+        //the number of versions and nodes which point to this node.
+        std::atomic<uint32_t>   ref_count{ 1U };
+        //the number of nodes on the longest path from this node to a leaf.
+        uint32_t                height     = 1U;
+        Type value;
+    };
+
+    template <typename Type, typename Compare = std::less<Type>, class node_allocator = std::allocator< persistent_node_< Type > > >
+    class persistent_search_tree {
+    protected:
+        using node_type = persistent_node_<Type>;
+    public:
+        using value_type      = Type;
+        using key_compare     = Compare;
+        using pointer         = Type const*;
+        using reference       = Type const&;
+        using size_type       = size_t;
+        using difference_type = ptrdiff_t;
+        class iterator;
+        using const_iterator         = iterator;
+        using reverse_iterator       = std::reverse_iterator<iterator>;
+        using const_reverse_iterator = reverse_iterator;
+
+        persistent_search_tree() = default; // default constructor
+        explicit persistent_search_tree(Compare const &); // constructor with comparator
+        template <typename GenericIterator>
+        persistent_search_tree(GenericIterator, GenericIterator); //constructor with two standard iterators
+        persistent_search_tree(std::initializer_list<Type> const &); // constructor with initializer_list
+        //copy and copy assignment share every node with the source, O(1).
+        persistent_search_tree(persistent_search_tree<Type, Compare, node_allocator> const &); // copy constructor
+        persistent_search_tree<Type, Compare, node_allocator> & operator=(persistent_search_tree<Type, Compare, node_allocator> const &); // copy assignment operator
+        persistent_search_tree(persistent_search_tree<Type, Compare, node_allocator> &&); // move constructor
+        persistent_search_tree<Type, Compare, node_allocator> & operator=(persistent_search_tree<Type, Compare, node_allocator> &&); // move assignment operator
+        ~persistent_search_tree(); // destructor
+
+            //in-order iterator with the path from root, as shared node cannot have parent link.
+            //it stays valid until its version is updated or destroyed, or as long as a snapshot of the version lives.
+            class iterator {
+                friend class persistent_search_tree<Type, Compare, node_allocator>;
+            public:
+                using iterator_category = std::bidirectional_iterator_tag;
+                using value_type        = Type;
+                using pointer           = Type const*;
+                using reference         = Type const&;
+                using difference_type   = ptrdiff_t;
+            public:
+                iterator() = default;
+                //return reference of value. value is immutable because it determines position and may be shared.
+                Type const& operator*()     const;
+                Type const* operator->()    const;
+                bool        operator==(iterator const &) const;
+                bool        operator!=(iterator const &) const;
+                //move to in-order successor. amortized O(1) over a full traversal.
+                iterator&   operator++();
+                iterator    operator++(int);
+                //move to in-order predecessor. decrementing end() gives the largest element.
+                iterator&   operator--();
+                iterator    operator--(int);
+            private:
+                iterator(node_type const*, persistent_search_tree const *);
+                //descend from current node to the extreme node of its sub-tree in given direction.
+                void _internal_descend(bool);
+            private:
+                node_type const              *node = nullptr;
+                persistent_search_tree const *tree = nullptr;
+                //ancestors of current node from root.
+                std::vector<node_type const*> path;
+            };
+        public:
+            //return O(1) snapshot of this version. later updates of either one are not visible to the other.
+            persistent_search_tree<Type, Compare, node_allocator> snapshot() const;
+            //return whether if tree is empty.
+            bool                empty() const;
+            //return the number of node in this tree.
+            size_type           size() const;
+            //return iterator of the smallest element.
+            iterator            begin() const;
+            //return past-the-end iterator.
+            iterator            end() const;
+            reverse_iterator    rbegin() const;
+            reverse_iterator    rend() const;
+            key_compare         key_comp() const;
+            //return the number of nodes on the longest root-to-leaf path. O(1), node keeps its height.
+            size_type           height() const;
+            //return whether if root is shared with other version, i.e. the next update copies its path.
+            bool                is_shared() const;
+            //call given function with every element in ascending order, without iterator path.
+            template <typename Function>
+            void                for_each(Function&&) const;
+            //drop this version's reference of every node. nodes shared with other version survive.
+            void                clear();
+            //insert given value. return false if equivalent element already exists.
+            bool                insert(Type const &);
+            bool                insert(Type&&);
+            //remove node which is matched with given value. return the number of removed nodes.
+            size_type           remove(Type const &);
+            //return iterator of the element equivalent to given key, end() if it does not exist.
+            template <typename Key = Type>
+            iterator            find(Key const &) const;
+            //return whether if element equivalent to given key exists.
+            template <typename Key = Type>
+            bool                contains(Key const &) const;
+            //return iterator of the first element not less than given key.
+            template <typename Key = Type>
+            iterator            lower_bound(Key const &) const;
+            //return iterator of the first element greater than given key.
+            template <typename Key = Type>
+            iterator            upper_bound(Key const &) const;
+        private:
+            //lookup key type. other type than Type is accepted only with transparent comparator.
+            template <typename Key>
+            using lookup_key_t = typename std::conditional<is_transparent_compare_<Compare>::value, Key, Type>::type;
+            //return iterator of the first element for which given predicate is false, with its path.
+            template <typename Predicate>
+            iterator _internal_bound(Predicate) const;
+            //implementation of method which inserts constructed-on-demand node.
+            template <typename Value>
+            bool _internal_insert(Value&&);
+            //make node of given slot owned by this version alone, copying it if it is shared. slot must be in
+            //node owned by this version alone, or be the root. return the node now in the slot.
+            node_type* _internal_writable(node_type*&);
+            //restore height and AVL balance of given node, owned by this version alone. return new sub-tree root.
+            node_type* _internal_rebalance(node_type*);
+            node_type* _internal_rotate_left(node_type*);
+            node_type* _internal_rotate_right(node_type*);
+            //restore heights and balance of nodes on the path, from given level up to root.
+            void _internal_rebalance_path(node_type** const *, size_type);
+            static uint32_t _internal_height(node_type const*);
+            static void _internal_update_height(node_type*);
+            static void _internal_acquire(node_type*);
+            //drop one reference of given node. node without reference is destroyed and drops its children.
+            void _internal_release(node_type*);
+            template <typename... Args>
+            node_type* _internal_create_node(Args&&...);
+            void _internal_destroy_node(node_type*);
+        private:
+            //AVL tree of 2^64 nodes is shorter than 1.4405 * log2(n + 2) < 93 levels.
+            static constexpr size_type max_height = 96U;
+            node_allocator alloc;
+            Compare        comp;
+            node_type*     root     = nullptr;
+            size_type      num_node = 0U;
+    };
+
+
+    template <typename Type>
+    persistent_node_<Type>::persistent_node_(Type const & _l_value) : value(_l_value) { }
+
+    template <typename Type>
+    persistent_node_<Type>::persistent_node_(Type&& _r_value) : value(std::move(_r_value)) { }
+
+    template <typename Type>
+    persistent_node_<Type>::~persistent_node_() {
+        LOG("destructor", this->value);
+    }
+
+    template <typename Type, typename Compare, class node_allocator>
+    persistent_search_tree<Type, Compare, node_allocator>::persistent_search_tree(Compare const & _comp) : comp(_comp) { }
+
+    template <typename Type, typename Compare, class node_allocator>
+    template <typename GenericIterator>
+    persistent_search_tree<Type, Compare, node_allocator>::persistent_search_tree(GenericIterator _begin_iter, GenericIterator _end_iter) {
+        for (; _begin_iter != _end_iter; ++_begin_iter) {
+            insert(*_begin_iter);
+        }
+    }
+
+    template <typename Type, typename Compare, class node_allocator>
+    persistent_search_tree<Type, Compare, node_allocator>::persistent_search_tree(std::initializer_list<Type> const & _i_list) {
+        for (const auto& _value : _i_list) {
+            insert(_value);
+        }
+    }
+
+    template <typename Type, typename Compare, class node_allocator>
+    persistent_search_tree<Type, Compare, node_allocator>::persistent_search_tree(persistent_search_tree<Type, Compare, node_allocator> const & _l_tree)
+        : alloc(_l_tree.alloc), comp(_l_tree.comp), root(_l_tree.root), num_node(_l_tree.num_node) {
+        _internal_acquire(root);
+    }
+
+    template <typename Type, typename Compare, class node_allocator>
+    persistent_search_tree<Type, Compare, node_allocator> & persistent_search_tree<Type, Compare, node_allocator>::operator=(persistent_search_tree<Type, Compare, node_allocator> const & _l_tree) {
+        if (this != &_l_tree) {
+            //take the new reference first, so assignment between versions with the same root does not free it.
+            _internal_acquire(_l_tree.root);
+            clear();
+            alloc    = _l_tree.alloc;
+            comp     = _l_tree.comp;
+            root     = _l_tree.root;
+            num_node = _l_tree.num_node;
+        }
+        return *this;
+    }
+
+    template <typename Type, typename Compare, class node_allocator>
+    persistent_search_tree<Type, Compare, node_allocator>::persistent_search_tree(persistent_search_tree<Type, Compare, node_allocator> && _r_tree) : alloc(_r_tree.alloc), comp(_r_tree.comp) {
+        root = _r_tree.root;
+        _r_tree.root = nullptr;
+        num_node = _r_tree.num_node;
+        _r_tree.num_node = 0U;
+    }
+
+    template <typename Type, typename Compare, class node_allocator>
+    persistent_search_tree<Type, Compare, node_allocator> & persistent_search_tree<Type, Compare, node_allocator>::operator=(persistent_search_tree<Type, Compare, node_allocator> && _r_tree) {
+        if (this != &_r_tree) {
+            clear();
+            alloc = _r_tree.alloc;
+            comp  = _r_tree.comp;
+            root = _r_tree.root;
+            _r_tree.root = nullptr;
+            num_node = _r_tree.num_node;
+            _r_tree.num_node = 0U;
+        }
+        return *this;
+    }
+
+    template <typename Type, typename Compare, class node_allocator>
+    persistent_search_tree<Type, Compare, node_allocator>::~persistent_search_tree() {
+        clear();
+    }
+
+    template <typename Type, typename Compare, class node_allocator>
+    persistent_search_tree<Type, Compare, node_allocator> persistent_search_tree<Type, Compare, node_allocator>::snapshot() const {
+        return *this;
+    }
+
+    template <typename Type, typename Compare, class node_allocator>
+    bool persistent_search_tree<Type, Compare, node_allocator>::empty() const {
+        return num_node == 0U;
+    }
+
+    template <typename Type, typename Compare, class node_allocator>
+    typename persistent_search_tree<Type, Compare, node_allocator>::size_type persistent_search_tree<Type, Compare, node_allocator>::size() const {
+        return num_node;
+    }
+
+    template <typename Type, typename Compare, class node_allocator>
+    typename persistent_search_tree<Type, Compare, node_allocator>::iterator persistent_search_tree<Type, Compare, node_allocator>::begin() const {
+        iterator iter(root, this);
+        if (root) iter._internal_descend(false);
+        return iter;
+    }
+
+    template <typename Type, typename Compare, class node_allocator>
+    typename persistent_search_tree<Type, Compare, node_allocator>::iterator persistent_search_tree<Type, Compare, node_allocator>::end() const {
+        return iterator(nullptr, this);
+    }
+
+    template <typename Type, typename Compare, class node_allocator>
+    typename persistent_search_tree<Type, Compare, node_allocator>::reverse_iterator persistent_search_tree<Type, Compare, node_allocator>::rbegin() const {
+        return reverse_iterator(end());
+    }
+
+    template <typename Type, typename Compare, class node_allocator>
+    typename persistent_search_tree<Type, Compare, node_allocator>::reverse_iterator persistent_search_tree<Type, Compare, node_allocator>::rend() const {
+        return reverse_iterator(begin());
+    }
+
+    template <typename Type, typename Compare, class node_allocator>
+    typename persistent_search_tree<Type, Compare, node_allocator>::key_compare persistent_search_tree<Type, Compare, node_allocator>::key_comp() const {
+        return comp;
+    }
+
+    template <typename Type, typename Compare, class node_allocator>
+    typename persistent_search_tree<Type, Compare, node_allocator>::size_type persistent_search_tree<Type, Compare, node_allocator>::height() const {
+        return _internal_height(root);
+    }
+
+    template <typename Type, typename Compare, class node_allocator>
+    bool persistent_search_tree<Type, Compare, node_allocator>::is_shared() const {
+        return root && root->ref_count.load(std::memory_order_acquire) != 1U;
+    }
+
+    template <typename Type, typename Compare, class node_allocator>
+    template <typename Function>
+    void persistent_search_tree<Type, Compare, node_allocator>::for_each(Function&& _function) const {
+        node_type const* stack[max_height];
+        size_type        num_stack = 0U;
+        node_type const* node      = root;
+        while (node || num_stack) {
+            for (; node; node = node->left_node) stack[num_stack++] = node;
+            node = stack[--num_stack];
+            _function(node->value);
+            node = node->right_node;
+        }
+    }
+
+    template <typename Type, typename Compare, class node_allocator>
+    void persistent_search_tree<Type, Compare, node_allocator>::clear() {
+        _internal_release(root);
+        root     = nullptr;
+        num_node = 0U;
+    }
+
+    template <typename Type, typename Compare, class node_allocator>
+    bool persistent_search_tree<Type, Compare, node_allocator>::insert(Type const & _value) {
+        return _internal_insert(_value);
+    }
+
+    template <typename Type, typename Compare, class node_allocator>
+    bool persistent_search_tree<Type, Compare, node_allocator>::insert(Type&& _value) {
+        return _internal_insert(std::move(_value));
+    }
+
+    template <typename Type, typename Compare, class node_allocator>
+    typename persistent_search_tree<Type, Compare, node_allocator>::size_type persistent_search_tree<Type, Compare, node_allocator>::remove(Type const & _value) {
+        //find the path read-only first, so removing missing value copies nothing.
+        bool       went_right[max_height];
+        size_type  num_level = 0U;
+        node_type* node      = root;
+        while (node) {
+            if (comp(_value, node->value))      { went_right[num_level++] = false; node = node->left_node; }
+            else if (comp(node->value, _value)) { went_right[num_level++] = true;  node = node->right_node; }
+            else break;
+        }
+        if (node == nullptr) return 0U;
+        //node with two children is replaced by its successor, which is unlinked from its place instead.
+        size_type target_level = num_level;
+        if (node->left_node && node->right_node) {
+            went_right[num_level++] = true;
+            for (node = node->right_node; node->left_node; node = node->left_node) went_right[num_level++] = false;
+        }
+
+        node_type** slots[max_height];
+        node_type** slot = &root;
+        for (size_type level = 0U; level < num_level; ++level) {
+            node = _internal_writable(*slot);
+            slots[level] = slot;
+            slot = went_right[level] ? &node->right_node : &node->left_node;
+        }
+        slots[num_level] = slot;
+        node_type* unlinked = _internal_writable(*slot);
+        *slots[num_level] = unlinked->left_node ? unlinked->left_node : unlinked->right_node;
+        if (num_level != target_level) {
+            node_type* target = *slots[target_level];
+            unlinked->left_node  = target->left_node;
+            unlinked->right_node = target->right_node;
+            unlinked->height     = target->height;
+            *slots[target_level] = unlinked;
+            slots[target_level + 1U] = &unlinked->right_node;
+            unlinked = target;
+        }
+        unlinked->left_node = unlinked->right_node = nullptr;
+        _internal_destroy_node(unlinked);
+        --num_node;
+        _internal_rebalance_path(slots, num_level);
+        return 1U;
+    }
+
+    template <typename Type, typename Compare, class node_allocator>
+    template <typename Key>
+    typename persistent_search_tree<Type, Compare, node_allocator>::iterator persistent_search_tree<Type, Compare, node_allocator>::find(Key const & _key) const {
+        lookup_key_t<Key> const & key = _key;
+        iterator iter = lower_bound(_key);
+        if (iter.node && comp(key, iter.node->value)) return end();
+        return iter;
+    }
+
+    template <typename Type, typename Compare, class node_allocator>
+    template <typename Key>
+    bool persistent_search_tree<Type, Compare, node_allocator>::contains(Key const & _key) const {
+        lookup_key_t<Key> const & key = _key;
+        node_type const* node = root;
+        while (node) {
+            if (comp(key, node->value))      node = node->left_node;
+            else if (comp(node->value, key)) node = node->right_node;
+            else return true;
+        }
+        return false;
+    }
+
+    template <typename Type, typename Compare, class node_allocator>
+    template <typename Key>
+    typename persistent_search_tree<Type, Compare, node_allocator>::iterator persistent_search_tree<Type, Compare, node_allocator>::lower_bound(Key const & _key) const {
+        lookup_key_t<Key> const & key = _key;
+        return _internal_bound([&](Type const & _value) { return comp(_value, key); });
+    }
+
+    template <typename Type, typename Compare, class node_allocator>
+    template <typename Key>
+    typename persistent_search_tree<Type, Compare, node_allocator>::iterator persistent_search_tree<Type, Compare, node_allocator>::upper_bound(Key const & _key) const {
+        lookup_key_t<Key> const & key = _key;
+        return _internal_bound([&](Type const & _value) { return !comp(key, _value); });
+    }
+
+    template <typename Type, typename Compare, class node_allocator>
+    template <typename Predicate>
+    typename persistent_search_tree<Type, Compare, node_allocator>::iterator persistent_search_tree<Type, Compare, node_allocator>::_internal_bound(Predicate _go_right) const {
+        iterator  iter(nullptr, this);
+        size_type bound_level = 0U;
+        for (node_type const* node = root; node; ) {
+            if (_go_right(node->value)) {
+                iter.path.push_back(node);
+                node = node->right_node;
+            }
+            else {
+                //ancestors of the bound node are the path up to here.
+                bound_level = iter.path.size();
+                iter.node   = node;
+                iter.path.push_back(node);
+                node = node->left_node;
+            }
+        }
+        iter.path.resize(iter.node ? bound_level : 0U);
+        return iter;
+    }
+
+    template <typename Type, typename Compare, class node_allocator>
+    template <typename Value>
+    bool persistent_search_tree<Type, Compare, node_allocator>::_internal_insert(Value&& _value) {
+        //find the path read-only first, so inserting existing value copies nothing.
+        bool       went_right[max_height];
+        size_type  num_level = 0U;
+        node_type* node      = root;
+        while (node) {
+            if (comp(_value, node->value))      { went_right[num_level++] = false; node = node->left_node; }
+            else if (comp(node->value, _value)) { went_right[num_level++] = true;  node = node->right_node; }
+            else return false;
+        }
+        node_type* new_node = _internal_create_node(std::forward<Value>(_value));
+        node_type** slots[max_height];
+        node_type** slot = &root;
+        try {
+            for (size_type level = 0U; level < num_level; ++level) {
+                node = _internal_writable(*slot);
+                slots[level] = slot;
+                slot = went_right[level] ? &node->right_node : &node->left_node;
+            }
+        }
+        catch (...) {
+            //nodes copied so far are equivalent to the shared ones, so the version is unchanged.
+            _internal_destroy_node(new_node);
+            throw;
+        }
+        *slot = new_node;
+        ++num_node;
+        LOG("add", new_node);
+        _internal_rebalance_path(slots, num_level);
+        return true;
+    }
+
+    template <typename Type, typename Compare, class node_allocator>
+    typename persistent_search_tree<Type, Compare, node_allocator>::node_type* persistent_search_tree<Type, Compare, node_allocator>::_internal_writable(node_type*& _slot) {
+        node_type* node = _slot;
+        //count of one means only the slot points to it, and the slot is this version's own.
+        //acquire pairs with release of other version which dropped it, whose reads come before our writes.
+        if (node->ref_count.load(std::memory_order_acquire) == 1U) return node;
+        node_type* new_node = _internal_create_node(node->value);
+        new_node->left_node  = node->left_node;
+        new_node->right_node = node->right_node;
+        new_node->height     = node->height;
+        _internal_acquire(new_node->left_node);
+        _internal_acquire(new_node->right_node);
+        _slot = new_node;
+        _internal_release(node);
+        return new_node;
+    }
+
+    template <typename Type, typename Compare, class node_allocator>
+    typename persistent_search_tree<Type, Compare, node_allocator>::node_type* persistent_search_tree<Type, Compare, node_allocator>::_internal_rebalance(node_type* _node) {
+        int64_t balance = static_cast<int64_t>(_internal_height(_node->left_node)) - static_cast<int64_t>(_internal_height(_node->right_node));
+        if (balance > 1) {
+            node_type* left_node = _internal_writable(_node->left_node);
+            if (_internal_height(left_node->left_node) < _internal_height(left_node->right_node)) {
+                _node->left_node = _internal_rotate_left(left_node);
+            }
+            return _internal_rotate_right(_node);
+        }
+        if (balance < -1) {
+            node_type* right_node = _internal_writable(_node->right_node);
+            if (_internal_height(right_node->right_node) < _internal_height(right_node->left_node)) {
+                _node->right_node = _internal_rotate_right(right_node);
+            }
+            return _internal_rotate_left(_node);
+        }
+        _internal_update_height(_node);
+        return _node;
+    }
+
+    template <typename Type, typename Compare, class node_allocator>
+    typename persistent_search_tree<Type, Compare, node_allocator>::node_type* persistent_search_tree<Type, Compare, node_allocator>::_internal_rotate_left(node_type* _node) {
+        //references move along with links, so counts are unchanged. only the nodes written must be owned.
+        node_type* right_node = _internal_writable(_node->right_node);
+        _node->right_node     = right_node->left_node;
+        right_node->left_node = _node;
+        _internal_update_height(_node);
+        _internal_update_height(right_node);
+        return right_node;
+    }
+
+    template <typename Type, typename Compare, class node_allocator>
+    typename persistent_search_tree<Type, Compare, node_allocator>::node_type* persistent_search_tree<Type, Compare, node_allocator>::_internal_rotate_right(node_type* _node) {
+        node_type* left_node  = _internal_writable(_node->left_node);
+        _node->left_node      = left_node->right_node;
+        left_node->right_node = _node;
+        _internal_update_height(_node);
+        _internal_update_height(left_node);
+        return left_node;
+    }
+
+    template <typename Type, typename Compare, class node_allocator>
+    void persistent_search_tree<Type, Compare, node_allocator>::_internal_rebalance_path(node_type** const * _slots, size_type _num_level) {
+        for (size_type level = _num_level; level-- > 0U; ) {
+            node_type* node       = *_slots[level];
+            uint32_t   old_height = node->height;
+            node_type* sub_root;
+            try {
+                sub_root = _internal_rebalance(node);
+            }
+            catch (...) {
+                //copy for rotation failed before any link changed. fix heights above and leave the balance as is,
+                //the tree is still ordered and the next update through here rebalances it.
+                for (++level; level-- > 0U; ) _internal_update_height(*_slots[level]);
+                throw;
+            }
+            *_slots[level] = sub_root;
+            //sub-tree of the same shape and height leaves every ancestor as it is.
+            if (sub_root == node && node->height == old_height) break;
+        }
+    }
+
+    template <typename Type, typename Compare, class node_allocator>
+    uint32_t persistent_search_tree<Type, Compare, node_allocator>::_internal_height(node_type const* _node) {
+        return _node ? _node->height : 0U;
+    }
+
+    template <typename Type, typename Compare, class node_allocator>
+    void persistent_search_tree<Type, Compare, node_allocator>::_internal_update_height(node_type* _node) {
+        _node->height = 1U + std::max(_internal_height(_node->left_node), _internal_height(_node->right_node));
+    }
+
+    template <typename Type, typename Compare, class node_allocator>
+    void persistent_search_tree<Type, Compare, node_allocator>::_internal_acquire(node_type* _node) {
+        //new reference is made from an existing one, so no ordering is needed. (same as std::shared_ptr)
+        if (_node) _node->ref_count.fetch_add(1U, std::memory_order_relaxed);
+    }
+
+    template <typename Type, typename Compare, class node_allocator>
+    void persistent_search_tree<Type, Compare, node_allocator>::_internal_release(node_type* _node) {
+        //each popped node pushes at most two children, one of which is popped next, so the stack holds at most
+        //one pending node per level.
+        node_type* stack[max_height + 1U];
+        size_type  num_stack = 0U;
+        if (_node) stack[num_stack++] = _node;
+        while (num_stack) {
+            node_type* node = stack[--num_stack];
+            if (node->ref_count.fetch_sub(1U, std::memory_order_acq_rel) != 1U) continue;
+            if (node->right_node) stack[num_stack++] = node->right_node;
+            if (node->left_node)  stack[num_stack++] = node->left_node;
+            _internal_destroy_node(node);
+        }
+    }
+
+    template <typename Type, typename Compare, class node_allocator>
+    template <typename... Args>
+    typename persistent_search_tree<Type, Compare, node_allocator>::node_type* persistent_search_tree<Type, Compare, node_allocator>::_internal_create_node(Args&&... _args) {
+        node_type* new_node = alloc.allocate(1);
+        try {
+            alloc.construct(new_node, std::forward<Args>(_args)...);
+        }
+        catch (...) {
+            alloc.deallocate(new_node, 1);
+            throw;
+        }
+        return new_node;
+    }
+
+    template <typename Type, typename Compare, class node_allocator>
+    void persistent_search_tree<Type, Compare, node_allocator>::_internal_destroy_node(node_type* _node) {
+        LOG("del", _node);
+        alloc.destroy(_node);
+        alloc.deallocate(_node, 1);
+    }
+
+    template <typename Type, typename Compare, class node_allocator>
+    persistent_search_tree<Type, Compare, node_allocator>::iterator::iterator(node_type const* _node, persistent_search_tree const * _tree) : node(_node), tree(_tree) { }
+
+    template <typename Type, typename Compare, class node_allocator>
+    void persistent_search_tree<Type, Compare, node_allocator>::iterator::_internal_descend(bool _to_right) {
+        for (node_type const* next = _to_right ? node->right_node : node->left_node; next; next = _to_right ? next->right_node : next->left_node) {
+            path.push_back(node);
+            node = next;
+        }
+    }
+
+    template <typename Type, typename Compare, class node_allocator>
+    Type const& persistent_search_tree<Type, Compare, node_allocator>::iterator::operator*() const {
+        return node->value;
+    }
+
+    template <typename Type, typename Compare, class node_allocator>
+    Type const* persistent_search_tree<Type, Compare, node_allocator>::iterator::operator->() const {
+        return &node->value;
+    }
+
+    template <typename Type, typename Compare, class node_allocator>
+    bool persistent_search_tree<Type, Compare, node_allocator>::iterator::operator==(iterator const & _iter) const {
+        return node == _iter.node;
+    }
+
+    template <typename Type, typename Compare, class node_allocator>
+    bool persistent_search_tree<Type, Compare, node_allocator>::iterator::operator!=(iterator const & _iter) const {
+        return node != _iter.node;
+    }
+
+    template <typename Type, typename Compare, class node_allocator>
+    typename persistent_search_tree<Type, Compare, node_allocator>::iterator& persistent_search_tree<Type, Compare, node_allocator>::iterator::operator++() {
+        if (node->right_node) {
+            path.push_back(node);
+            node = node->right_node;
+            _internal_descend(false);
+            return *this;
+        }
+        //climb while current node is right child. the first ancestor reached from its left is the successor.
+        node_type const* parent_node = nullptr;
+        while (!path.empty()) {
+            parent_node = path.back();
+            path.pop_back();
+            if (parent_node->left_node == node) break;
+            node        = parent_node;
+            parent_node = nullptr;
+        }
+        node = parent_node;
+        return *this;
+    }
+
+    template <typename Type, typename Compare, class node_allocator>
+    typename persistent_search_tree<Type, Compare, node_allocator>::iterator persistent_search_tree<Type, Compare, node_allocator>::iterator::operator++(int) {
+        iterator ret_iter = *this;
+        ++(*this);
+        return ret_iter;
+    }
+
+    template <typename Type, typename Compare, class node_allocator>
+    typename persistent_search_tree<Type, Compare, node_allocator>::iterator& persistent_search_tree<Type, Compare, node_allocator>::iterator::operator--() {
+        if (node == nullptr) {
+            node = tree->root;
+            path.clear();
+            if (node) _internal_descend(true);
+            return *this;
+        }
+        if (node->left_node) {
+            path.push_back(node);
+            node = node->left_node;
+            _internal_descend(true);
+            return *this;
+        }
+        node_type const* parent_node = nullptr;
+        while (!path.empty()) {
+            parent_node = path.back();
+            path.pop_back();
+            if (parent_node->right_node == node) break;
+            node        = parent_node;
+            parent_node = nullptr;
+        }
+        node = parent_node;
+        return *this;
+    }
+
+    template <typename Type, typename Compare, class node_allocator>
+    typename persistent_search_tree<Type, Compare, node_allocator>::iterator persistent_search_tree<Type, Compare, node_allocator>::iterator::operator--(int) {
+        iterator ret_iter = *this;
+        --(*this);
+        return ret_iter;
+    }
+}
+
+#endif
@@ -0,0 +1,224 @@
+#ifndef POOL_ALLOCATOR_HPP
+#define POOL_ALLOCATOR_HPP
+
+/**
+* @file      pool_allocator.hpp
+* @author    snowapril
+* @date      2026-10-17
+* @brief     slab(pool) allocator for fixed size tree nodes.
+* @details   header only node allocator which can be plugged into node_allocator template parameter of tree classes.
+             single node requests are served from contiguous chunks with bump pointer and recycled through intrusive free list.
+             chunks are released all at once when last copy of the allocator is destroyed,
+             so tearing down a whole tree frees a few chunks instead of N separate nodes.
+             copies and rebound copies of allocator share one pool, which keeps separate chunks for every slot size,
+             so they compare equal, A(B(a)) == a holds, and any of them can deallocate each other's nodes.
+             pool is not thread safe. copy of a container gets a fresh pool through select_on_container_copy_construction,
+             so trees copied from each other can be used on different threads, but allocator copies which share
+             one pool must not be used concurrently. trees which exchange nodes (e.g. split, set algebra, node handles)
+             share a pool by passing get_allocator() of one tree to the allocator constructor of the other.
+* @see
+*/
+
+#include <cstddef>
+#include <memory>
+#include <new>
+#include <vector>
+#include "tree_util.hpp"
+
+namespace snowapril {
+
+    namespace detail_ {
+        //chunks and free list of slots with one size and alignment. not templated on value type,
+        //so allocators rebound to types of same slot layout draw from the same chunks.
+        struct pool_size_class_ {
+            pool_size_class_(size_t, size_t, size_t);
+            pool_size_class_(pool_size_class_ const &) = delete;
+            pool_size_class_ & operator=(pool_size_class_ const &) = delete;
+            ~pool_size_class_();
+
+            void* allocate();
+            void  deallocate(void*);
+
+            size_t             slot_size;
+            size_t             slot_align;
+            size_t             slots_per_chunk;
+            std::vector<char*> chunks;
+            void*              free_list = nullptr;
+            char*              chunk_cur = nullptr;
+            char*              chunk_end = nullptr;
+        };
+
+        //pool shared by every copy and rebound copy of one allocator. there are only a few distinct node sizes
+        //per tree, so size classes are searched linearly.
+        struct pool_resource_ {
+            pool_size_class_* size_class(size_t, size_t, size_t);
+
+            std::vector<std::unique_ptr<pool_size_class_>> classes;
+        };
+
+        inline pool_size_class_::pool_size_class_(size_t _slot_size, size_t _slot_align, size_t _slots_per_chunk)
+            : slot_size(_slot_size), slot_align(_slot_align), slots_per_chunk(_slots_per_chunk) { }
+
+        inline pool_size_class_::~pool_size_class_() {
+            for (char* chunk : chunks) {
+                ::operator delete(static_cast<void*>(chunk), std::align_val_t(slot_align));
+            }
+        }
+
+        inline void* pool_size_class_::allocate() {
+            if (free_list) {
+                void* slot = free_list;
+                free_list = *std::launder(static_cast<void**>(slot));
+                return slot;
+            }
+            if (chunk_cur == chunk_end) {
+                //reserved first, so a new chunk is never lost if recording it fails.
+                chunks.reserve(chunks.size() + 1U);
+                char* chunk = static_cast<char*>(::operator new(slots_per_chunk * slot_size, std::align_val_t(slot_align)));
+                chunks.push_back(chunk);
+                chunk_cur = chunk;
+                chunk_end = chunk + slots_per_chunk * slot_size;
+                LOG("new chunk", chunks.size());
+            }
+            void* slot = chunk_cur;
+            chunk_cur += slot_size;
+            return slot;
+        }
+
+        inline void pool_size_class_::deallocate(void* _slot) {
+            ::new (_slot) void*(free_list);
+            free_list = _slot;
+        }
+
+        inline pool_size_class_* pool_resource_::size_class(size_t _slot_size, size_t _slot_align, size_t _slots_per_chunk) {
+            for (std::unique_ptr<pool_size_class_> const & entry : classes) {
+                if (entry->slot_size == _slot_size && entry->slot_align == _slot_align) return entry.get();
+            }
+            classes.push_back(std::make_unique<pool_size_class_>(_slot_size, _slot_align, _slots_per_chunk));
+            return classes.back().get();
+        }
+    }
+
+    template <typename Type, size_t nodes_per_chunk = 512>
+    class pool_allocator {
+    public:
+        using value_type      = Type;
+        using pointer         = Type*;
+        using const_pointer   = Type const*;
+        using reference       = Type&;
+        using const_reference = Type const&;
+        using size_type       = size_t;
+        using difference_type = ptrdiff_t;
+
+        template <typename Other>
+        struct rebind { using other = pool_allocator<Other, nodes_per_chunk>; };
+
+        pool_allocator(); // default constructor
+        pool_allocator(pool_allocator const &) = default; // copy constructor which shares pool
+        pool_allocator<Type, nodes_per_chunk> & operator=(pool_allocator const &) = default; // copy assignment operator which shares pool
+        template <typename Other>
+        pool_allocator(pool_allocator<Other, nodes_per_chunk> const &); // rebind constructor which shares pool
+        ~pool_allocator() = default;
+
+        //return pointer to storage of given number of objects. single object is served from pool.
+        //throw std::bad_array_new_length if the storage would be larger than max_size() objects.
+        Type*   allocate(size_type, void const * = nullptr);
+        //return storage to the pool. storage of multiple objects is returned to global heap.
+        void    deallocate(Type*, size_type);
+        //construct object in-place on given storage.
+        template <typename Other, typename... Args>
+        void    construct(Other*, Args&&...);
+        //call destructor of the object on given storage.
+        template <typename Other>
+        void    destroy(Other*);
+        //return allocator with a fresh pool for copy of a container, so the copy shares no pool with its source.
+        pool_allocator<Type, nodes_per_chunk> select_on_container_copy_construction() const;
+        //return the largest number of objects which one allocate call may request.
+        size_type max_size() const;
+        //return the number of chunks currently owned by the pool for slots of this type.
+        size_type chunk_count() const;
+
+        template <typename Other>
+        bool operator==(pool_allocator<Other, nodes_per_chunk> const &) const;
+        template <typename Other>
+        bool operator!=(pool_allocator<Other, nodes_per_chunk> const &) const;
+    private:
+        //slot also holds the free list link while it is free.
+        static constexpr size_t slot_align = alignof(Type) > alignof(void*) ? alignof(Type) : alignof(void*);
+        static constexpr size_t slot_size  = ((sizeof(Type) > sizeof(void*) ? sizeof(Type) : sizeof(void*)) + slot_align - 1U) / slot_align * slot_align;
+
+        template <typename, size_t> friend class pool_allocator;
+        std::shared_ptr<detail_::pool_resource_> resource;
+        detail_::pool_size_class_*               slots;     // size class of Type in resource
+    };
+
+    template <typename Type, size_t nodes_per_chunk>
+    pool_allocator<Type, nodes_per_chunk>::pool_allocator()
+        : resource(std::make_shared<detail_::pool_resource_>()), slots(resource->size_class(slot_size, slot_align, nodes_per_chunk)) { }
+
+    template <typename Type, size_t nodes_per_chunk>
+    template <typename Other>
+    pool_allocator<Type, nodes_per_chunk>::pool_allocator(pool_allocator<Other, nodes_per_chunk> const & _other)
+        : resource(_other.resource), slots(resource->size_class(slot_size, slot_align, nodes_per_chunk)) { }
+
+    template <typename Type, size_t nodes_per_chunk>
+    Type* pool_allocator<Type, nodes_per_chunk>::allocate(size_type _num, void const *) {
+        if (_num == 1U) {
+            return static_cast<Type*>(slots->allocate());
+        }
+        if (_num > max_size()) throw std::bad_array_new_length();
+        return static_cast<Type*>(::operator new(_num * sizeof(Type), std::align_val_t(alignof(Type))));
+    }
+
+    template <typename Type, size_t nodes_per_chunk>
+    void pool_allocator<Type, nodes_per_chunk>::deallocate(Type* _ptr, size_type _num) {
+        if (_ptr == nullptr) return;
+        if (_num == 1U) {
+            slots->deallocate(_ptr);
+        }
+        else {
+            ::operator delete(static_cast<void*>(_ptr), std::align_val_t(alignof(Type)));
+        }
+    }
+
+    template <typename Type, size_t nodes_per_chunk>
+    template <typename Other, typename... Args>
+    void pool_allocator<Type, nodes_per_chunk>::construct(Other* _ptr, Args&&... _args) {
+        ::new (static_cast<void*>(_ptr)) Other(std::forward<Args>(_args)...);
+    }
+
+    template <typename Type, size_t nodes_per_chunk>
+    template <typename Other>
+    void pool_allocator<Type, nodes_per_chunk>::destroy(Other* _ptr) {
+        _ptr->~Other();
+    }
+
+    template <typename Type, size_t nodes_per_chunk>
+    pool_allocator<Type, nodes_per_chunk> pool_allocator<Type, nodes_per_chunk>::select_on_container_copy_construction() const {
+        return pool_allocator<Type, nodes_per_chunk>();
+    }
+
+    template <typename Type, size_t nodes_per_chunk>
+    typename pool_allocator<Type, nodes_per_chunk>::size_type pool_allocator<Type, nodes_per_chunk>::max_size() const {
+        return static_cast<size_type>(-1) / sizeof(Type);
+    }
+
+    template <typename Type, size_t nodes_per_chunk>
+    typename pool_allocator<Type, nodes_per_chunk>::size_type pool_allocator<Type, nodes_per_chunk>::chunk_count() const {
+        return slots->chunks.size();
+    }
+
+    template <typename Type, size_t nodes_per_chunk>
+    template <typename Other>
+    bool pool_allocator<Type, nodes_per_chunk>::operator==(pool_allocator<Other, nodes_per_chunk> const & _alloc) const {
+        return resource == _alloc.resource;
+    }
+
+    template <typename Type, size_t nodes_per_chunk>
+    template <typename Other>
+    bool pool_allocator<Type, nodes_per_chunk>::operator!=(pool_allocator<Other, nodes_per_chunk> const & _alloc) const {
+        return resource != _alloc.resource;
+    }
+}
+
+#endif
@@ -1,8 +1,432 @@
 #ifndef QUAD_TREE_HPP
 #define QUAD_TREE_HPP
 
+/**
+* @file      quad_tree.hpp
+* @author    snowapril
+* @date      2026-10-17 (ongoing)
+* @brief     custom point quad tree data structure for 2D spatial lookups.
+* @details   header only point region quad tree. support bulk insert, axis aligned rectangle range query,
+             radius query and k-nearest-neighbour query, including batched range query over many rectangles.
+             nodes live in one vector and address their four children by index.
+             leaves keep points in fixed capacity buckets carved out of one contiguous storage, so range scan streams through memory.
+             leaves at maximum depth chain additional buckets instead of splitting (e.g. many duplicated points).
+* @see
+* @reference https://en.wikipedia.org/wiki/Quadtree
+*/
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <iterator>
+#include <queue>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "tree_util.hpp"
+
 namespace snowapril {
 
+    template <typename Scalar>
+    struct point2_ {
+        Scalar x = Scalar();
+        Scalar y = Scalar();
+    };
+
+    template <typename Scalar>
+    struct rect2_ {
+        Scalar min_x = Scalar(), min_y = Scalar();
+        Scalar max_x = Scalar(), max_y = Scalar();
+
+        //return whether if given point is inside of this rectangle. (boundary inclusive)
+        bool contains(point2_<Scalar> const &) const;
+        //return whether if given rectangle is completely inside of this rectangle.
+        bool contains(rect2_<Scalar> const &) const;
+        //return whether if given rectangle overlaps this rectangle.
+        bool intersects(rect2_<Scalar> const &) const;
+        //return squared distance between given point and the closest point of this rectangle.
+        Scalar distance_squared(point2_<Scalar> const &) const;
+    };
+
+    template <typename Type, typename Scalar>
+    struct quad_entry_ {
+        point2_<Scalar> point;
+        Type            value;
+    };
+
+    template <typename Type, typename Scalar = double>
+    class quad_tree {
+    public:
+        using value_type  = quad_entry_<Type, Scalar>;
+        using point_type  = point2_<Scalar>;
+        using rect_type   = rect2_<Scalar>;
+        using size_type   = size_t;
+        using index_type  = uint32_t;
+        static constexpr size_type max_depth_limit = 32U;
+
+        quad_tree(rect_type const &, size_type = 32U, size_type = 20U); // constructor with world bounds, bucket capacity and maximum depth
+        template <typename GenericIterator, typename = typename std::iterator_traits<GenericIterator>::iterator_category>
+        quad_tree(rect_type const &, GenericIterator, GenericIterator, size_type = 32U, size_type = 20U); // constructor with bulk entries
+        quad_tree(quad_tree<Type, Scalar> const &) = default; // copy constructor
+        quad_tree<Type, Scalar> & operator=(quad_tree<Type, Scalar> const &) = default; // copy assignment operator
+        quad_tree(quad_tree<Type, Scalar> &&) = default; // move constructor
+        quad_tree<Type, Scalar> & operator=(quad_tree<Type, Scalar> &&) = default; // move assignment operator
+        ~quad_tree() = default; // destructor
+
+        //return whether if tree is empty.
+        bool        empty() const;
+        //return the number of points in this tree.
+        size_type   size() const;
+        //return world bounds of this tree.
+        rect_type const & bounds() const;
+        //remove every point while keeping world bounds.
+        void        clear();
+        //insert point with value. return false if point is out of world bounds.
+        bool        insert(point_type const &, Type const &);
+        //insert every quad_entry_ in given range. return the number of inserted entries.
+        template <typename GenericIterator, typename = typename std::iterator_traits<GenericIterator>::iterator_category>
+        size_type   insert(GenericIterator, GenericIterator);
+        //call given function with every entry inside of given rectangle.
+        template <typename Function>
+        void        for_each_in_range(rect_type const &, Function&&) const;
+        //copy every entry inside of given rectangle to given output iterator.
+        template <typename OutputIterator>
+        OutputIterator query_range(rect_type const &, OutputIterator) const;
+        //call given function with (query index, entry) for every entry inside of each rectangle in given range.
+        template <typename RectIterator, typename Function>
+        void        query_range_batch(RectIterator, RectIterator, Function&&) const;
+        //copy every entry within given distance from given point to given output iterator.
+        template <typename OutputIterator>
+        OutputIterator query_radius(point_type const &, Scalar, OutputIterator) const;
+        //return at most k entries closest to given point, ordered by ascending distance.
+        std::vector<value_type> nearest(point_type const &, size_type) const;
+    private:
+        struct node_ {
+            rect_type  bounds;
+            index_type first_child = npos;  // index of four consecutive children, npos if leaf.
+            index_type bucket      = npos;  // first bucket of leaf.
+            index_type count       = 0U;    // the number of entries in this leaf.
+            index_type depth       = 0U;
+        };
+        static constexpr index_type npos = UINT32_MAX;
+
+        //return index of quadrant where given point is located in given node.
+        static index_type _internal_quadrant(node_ const &, point_type const &);
+        //split given leaf into four children and move its entries.
+        void        _internal_split(index_type);
+        //append entry into bucket chain of given leaf.
+        void        _internal_push(index_type, value_type const &);
+        //return bucket from free list or grow contiguous storage.
+        index_type  _internal_new_bucket();
+        void        _internal_free_bucket(index_type);
+        //call given function with every entry in bucket chain of given leaf.
+        template <typename Function>
+        void        _internal_visit_leaf(node_ const &, Function&) const;
+    private:
+        rect_type               world;
+        size_type               bucket_capacity;
+        size_type               max_depth;
+        size_type               num_point = 0U;
+        std::vector<node_>      nodes;
+        std::vector<value_type> bucket_storage; // bucket i occupies [i * bucket_capacity, (i + 1) * bucket_capacity)
+        std::vector<index_type> bucket_next;    // next bucket of chain, npos if last.
+        std::vector<index_type> free_buckets;
+    };
+
+    template <typename Scalar>
+    bool rect2_<Scalar>::contains(point2_<Scalar> const & _point) const {
+        return min_x <= _point.x && _point.x <= max_x && min_y <= _point.y && _point.y <= max_y;
+    }
+
+    template <typename Scalar>
+    bool rect2_<Scalar>::contains(rect2_<Scalar> const & _rect) const {
+        return min_x <= _rect.min_x && _rect.max_x <= max_x && min_y <= _rect.min_y && _rect.max_y <= max_y;
+    }
+
+    template <typename Scalar>
+    bool rect2_<Scalar>::intersects(rect2_<Scalar> const & _rect) const {
+        return min_x <= _rect.max_x && _rect.min_x <= max_x && min_y <= _rect.max_y && _rect.min_y <= max_y;
+    }
+
+    template <typename Scalar>
+    Scalar rect2_<Scalar>::distance_squared(point2_<Scalar> const & _point) const {
+        Scalar dx = std::max(std::max(min_x - _point.x, _point.x - max_x), Scalar());
+        Scalar dy = std::max(std::max(min_y - _point.y, _point.y - max_y), Scalar());
+        return dx * dx + dy * dy;
+    }
+
+    template <typename Type, typename Scalar>
+    quad_tree<Type, Scalar>::quad_tree(rect_type const & _world, size_type _bucket_capacity, size_type _max_depth)
+        : world(_world), bucket_capacity(std::max<size_type>(_bucket_capacity, 1U)), max_depth(std::min(_max_depth, max_depth_limit)) {
+        clear();
+    }
+
+    template <typename Type, typename Scalar>
+    template <typename GenericIterator, typename>
+    quad_tree<Type, Scalar>::quad_tree(rect_type const & _world, GenericIterator _begin_iter, GenericIterator _end_iter, size_type _bucket_capacity, size_type _max_depth)
+        : quad_tree(_world, _bucket_capacity, _max_depth) {
+        insert(_begin_iter, _end_iter);
+    }
+
+    template <typename Type, typename Scalar>
+    bool quad_tree<Type, Scalar>::empty() const {
+        return num_point == 0U;
+    }
+
+    template <typename Type, typename Scalar>
+    typename quad_tree<Type, Scalar>::size_type quad_tree<Type, Scalar>::size() const {
+        return num_point;
+    }
+
+    template <typename Type, typename Scalar>
+    typename quad_tree<Type, Scalar>::rect_type const & quad_tree<Type, Scalar>::bounds() const {
+        return world;
+    }
+
+    template <typename Type, typename Scalar>
+    void quad_tree<Type, Scalar>::clear() {
+        nodes.clear();
+        bucket_storage.clear();
+        bucket_next.clear();
+        free_buckets.clear();
+        num_point = 0U;
+
+        node_ root_node;
+        root_node.bounds = world;
+        root_node.bucket = _internal_new_bucket();
+        nodes.push_back(root_node);
+    }
+
+    template <typename Type, typename Scalar>
+    bool quad_tree<Type, Scalar>::insert(point_type const & _point, Type const & _value) {
+        if (!world.contains(_point)) return false;
+
+        index_type index = 0U;
+        while (true) {
+            if (nodes[index].first_child != npos) {
+                index = nodes[index].first_child + _internal_quadrant(nodes[index], _point);
+            }
+            else if (nodes[index].count < bucket_capacity || nodes[index].depth >= max_depth) {
+                _internal_push(index, value_type{ _point, _value });
+                ++num_point;
+                return true;
+            }
+            else {
+                _internal_split(index);
+            }
+        }
+    }
+
+    template <typename Type, typename Scalar>
+    template <typename GenericIterator, typename>
+    typename quad_tree<Type, Scalar>::size_type quad_tree<Type, Scalar>::insert(GenericIterator _begin_iter, GenericIterator _end_iter) {
+        using category = typename std::iterator_traits<GenericIterator>::iterator_category;
+        if (std::is_base_of<std::forward_iterator_tag, category>::value) {
+            size_type num_new = static_cast<size_type>(std::distance(_begin_iter, _end_iter));
+            size_type num_leaf_hint = (num_point + num_new) / bucket_capacity + 1U;
+            bucket_storage.reserve(num_leaf_hint * 2U * bucket_capacity);
+            bucket_next.reserve(num_leaf_hint * 2U);
+            nodes.reserve(num_leaf_hint * 2U);
+        }
+        size_type num_inserted = 0U;
+        for (; _begin_iter != _end_iter; ++_begin_iter) {
+            num_inserted += insert(_begin_iter->point, _begin_iter->value) ? 1U : 0U;
+        }
+        return num_inserted;
+    }
+
+    template <typename Type, typename Scalar>
+    template <typename Function>
+    void quad_tree<Type, Scalar>::for_each_in_range(rect_type const & _rect, Function&& _func) const {
+        //explicit stack never holds more than 3 * depth + 1 nodes.
+        index_type stack[3U * max_depth_limit + 1U];
+        size_type  top = 0U;
+        stack[top++] = 0U;
+        while (top) {
+            node_ const & node = nodes[stack[--top]];
+            if (!_rect.intersects(node.bounds)) continue;
+
+            bool enclosed = _rect.contains(node.bounds);
+            if (node.first_child != npos) {
+                for (index_type i = 0U; i < 4U; ++i) stack[top++] = node.first_child + i;
+            }
+            else if (enclosed) {
+                _internal_visit_leaf(node, _func);
+            }
+            else {
+                auto filter = [&_rect, &_func](value_type const & _entry) {
+                    if (_rect.contains(_entry.point)) _func(_entry);
+                };
+                _internal_visit_leaf(node, filter);
+            }
+        }
+    }
+
+    template <typename Type, typename Scalar>
+    template <typename OutputIterator>
+    OutputIterator quad_tree<Type, Scalar>::query_range(rect_type const & _rect, OutputIterator _out) const {
+        for_each_in_range(_rect, [&_out](value_type const & _entry) { *_out++ = _entry; });
+        return _out;
+    }
+
+    template <typename Type, typename Scalar>
+    template <typename RectIterator, typename Function>
+    void quad_tree<Type, Scalar>::query_range_batch(RectIterator _begin_iter, RectIterator _end_iter, Function&& _func) const {
+        //queries run back to back against the same node array, so upper levels stay cache resident for the whole batch.
+        size_type query_index = 0U;
+        for (; _begin_iter != _end_iter; ++_begin_iter, ++query_index) {
+            for_each_in_range(*_begin_iter, [&_func, query_index](value_type const & _entry) { _func(query_index, _entry); });
+        }
+    }
+
+    template <typename Type, typename Scalar>
+    template <typename OutputIterator>
+    OutputIterator quad_tree<Type, Scalar>::query_radius(point_type const & _center, Scalar _radius, OutputIterator _out) const {
+        rect_type bounding_box{ _center.x - _radius, _center.y - _radius, _center.x + _radius, _center.y + _radius };
+        Scalar    radius_squared = _radius * _radius;
+        for_each_in_range(bounding_box, [&](value_type const & _entry) {
+            Scalar dx = _entry.point.x - _center.x, dy = _entry.point.y - _center.y;
+            if (dx * dx + dy * dy <= radius_squared) *_out++ = _entry;
+        });
+        return _out;
+    }
+
+    template <typename Type, typename Scalar>
+    std::vector<typename quad_tree<Type, Scalar>::value_type> quad_tree<Type, Scalar>::nearest(point_type const & _point, size_type _k) const {
+        using candidate_type = std::pair<Scalar, value_type const*>;
+        using frontier_type  = std::pair<Scalar, index_type>;
+        auto candidate_less = [](candidate_type const & a, candidate_type const & b) { return a.first < b.first; };
+
+        //best-first search ordered by distance from query point to node bounds.
+        std::vector<candidate_type> best;   // max heap of k closest entries so far
+        std::priority_queue<frontier_type, std::vector<frontier_type>, std::greater<frontier_type>> frontier;
+        if (_k == 0U || num_point == 0U) return {};
+        best.reserve(_k + 1U);
+        frontier.emplace(nodes[0].bounds.distance_squared(_point), 0U);
+
+        while (!frontier.empty()) {
+            frontier_type top = frontier.top();
+            frontier.pop();
+            if (best.size() == _k && top.first > best.front().first) break;
+
+            node_ const & node = nodes[top.second];
+            if (node.first_child != npos) {
+                for (index_type i = 0U; i < 4U; ++i) {
+                    index_type child = node.first_child + i;
+                    Scalar     dist  = nodes[child].bounds.distance_squared(_point);
+                    if (best.size() < _k || dist <= best.front().first) frontier.emplace(dist, child);
+                }
+                continue;
+            }
+            auto consider = [&](value_type const & _entry) {
+                Scalar dx = _entry.point.x - _point.x, dy = _entry.point.y - _point.y;
+                Scalar dist = dx * dx + dy * dy;
+                if (best.size() < _k) {
+                    best.emplace_back(dist, &_entry);
+                    std::push_heap(best.begin(), best.end(), candidate_less);
+                }
+                else if (dist < best.front().first) {
+                    std::pop_heap(best.begin(), best.end(), candidate_less);
+                    best.back() = candidate_type(dist, &_entry);
+                    std::push_heap(best.begin(), best.end(), candidate_less);
+                }
+            };
+            _internal_visit_leaf(node, consider);
+        }
+
+        std::sort_heap(best.begin(), best.end(), candidate_less);
+        std::vector<value_type> ret_entries;
+        ret_entries.reserve(best.size());
+        for (candidate_type const & candidate : best) ret_entries.push_back(*candidate.second);
+        return ret_entries;
+    }
+
+    template <typename Type, typename Scalar>
+    typename quad_tree<Type, Scalar>::index_type quad_tree<Type, Scalar>::_internal_quadrant(node_ const & _node, point_type const & _point) {
+        Scalar center_x = _node.bounds.min_x + (_node.bounds.max_x - _node.bounds.min_x) / 2;
+        Scalar center_y = _node.bounds.min_y + (_node.bounds.max_y - _node.bounds.min_y) / 2;
+        return static_cast<index_type>(_point.x >= center_x) | (static_cast<index_type>(_point.y >= center_y) << 1U);
+    }
+
+    template <typename Type, typename Scalar>
+    void quad_tree<Type, Scalar>::_internal_split(index_type _index) {
+        index_type first_child = static_cast<index_type>(nodes.size());
+        rect_type  bounds      = nodes[_index].bounds;
+        Scalar     center_x    = bounds.min_x + (bounds.max_x - bounds.min_x) / 2;
+        Scalar     center_y    = bounds.min_y + (bounds.max_y - bounds.min_y) / 2;
+        for (index_type i = 0U; i < 4U; ++i) {
+            node_ child;
+            child.bounds.min_x = (i & 1U) ? center_x : bounds.min_x;
+            child.bounds.max_x = (i & 1U) ? bounds.max_x : center_x;
+            child.bounds.min_y = (i & 2U) ? center_y : bounds.min_y;
+            child.bounds.max_y = (i & 2U) ? bounds.max_y : center_y;
+            child.depth  = nodes[_index].depth + 1U;
+            child.bucket = _internal_new_bucket();
+            nodes.push_back(child);
+        }
+        LOG("split", _index);
+
+        //splitting happens only below maximum depth, so leaf has exactly one bucket here.
+        index_type bucket = nodes[_index].bucket;
+        index_type count  = nodes[_index].count;
+        nodes[_index].first_child = first_child;
+        nodes[_index].bucket      = npos;
+        nodes[_index].count       = 0U;
+        for (index_type i = 0U; i < count; ++i) {
+            value_type const & entry = bucket_storage[bucket * bucket_capacity + i];
+            _internal_push(first_child + _internal_quadrant(nodes[_index], entry.point), entry);
+        }
+        _internal_free_bucket(bucket);
+    }
+
+    template <typename Type, typename Scalar>
+    void quad_tree<Type, Scalar>::_internal_push(index_type _index, value_type const & _entry) {
+        index_type bucket = nodes[_index].bucket;
+        index_type offset = nodes[_index].count;
+        while (offset >= bucket_capacity) {
+            if (bucket_next[bucket] == npos) {
+                index_type new_bucket = _internal_new_bucket();
+                bucket_next[bucket] = new_bucket;
+            }
+            bucket  = bucket_next[bucket];
+            offset -= static_cast<index_type>(bucket_capacity);
+        }
+        bucket_storage[bucket * bucket_capacity + offset] = _entry;
+        ++nodes[_index].count;
+    }
+
+    template <typename Type, typename Scalar>
+    typename quad_tree<Type, Scalar>::index_type quad_tree<Type, Scalar>::_internal_new_bucket() {
+        if (!free_buckets.empty()) {
+            index_type bucket = free_buckets.back();
+            free_buckets.pop_back();
+            bucket_next[bucket] = npos;
+            return bucket;
+        }
+        index_type bucket = static_cast<index_type>(bucket_next.size());
+        bucket_next.push_back(npos);
+        bucket_storage.resize(bucket_storage.size() + bucket_capacity);
+        return bucket;
+    }
+
+    template <typename Type, typename Scalar>
+    void quad_tree<Type, Scalar>::_internal_free_bucket(index_type _bucket) {
+        free_buckets.push_back(_bucket);
+    }
+
+    template <typename Type, typename Scalar>
+    template <typename Function>
+    void quad_tree<Type, Scalar>::_internal_visit_leaf(node_ const & _node, Function& _func) const {
+        index_type bucket    = _node.bucket;
+        size_type  remaining = _node.count;
+        while (remaining) {
+            size_type          num_entry = std::min(remaining, bucket_capacity);
+            value_type const * entry     = bucket_storage.data() + bucket * bucket_capacity;
+            for (size_type i = 0U; i < num_entry; ++i) _func(entry[i]);
+            remaining -= num_entry;
+            bucket     = bucket_next[bucket];
+        }
+    }
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,224 @@
+#ifndef RANGE_AGGREGATE_TREE_HPP
+#define RANGE_AGGREGATE_TREE_HPP
+
+/**
+* @file      range_aggregate_tree.hpp
+* @author    snowapril
+* @date      2026-10-17 (ongoing)
+* @brief     ordered map with range aggregate query on top of red_black_tree with monoid augmentation.
+* @details   header only. every node keeps the monoid fold of the payloads of its sub-tree, in key order.
+             aggregate over key range walks the two boundary paths below the node where they diverge and
+             combines summaries of sub-trees hanging inside the range, so it runs in O(log n) for any associative
+             monoid, including non invertible ones such as min and max. range enumeration runs in O(log n + k).
+             red black balancing keeps these bounds on sorted or otherwise adversarial insertion order.
+             Monoid provides value_type, static identity() and associative static combine(lhs, rhs).
+* @see       red_black_tree.hpp
+* @reference
+*/
+
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <utility>
+#include "red_black_tree.hpp"
+
+namespace snowapril {
+
+    template <typename Value>
+    struct sum_monoid {
+        using value_type = Value;
+        static Value identity()                                      { return Value(); }
+        static Value combine(Value const & _lhs, Value const & _rhs) { return _lhs + _rhs; }
+    };
+
+    template <typename Value>
+    struct min_monoid {
+        using value_type = Value;
+        static Value identity()                                      { return std::numeric_limits<Value>::max(); }
+        static Value combine(Value const & _lhs, Value const & _rhs) { return std::min(_lhs, _rhs); }
+    };
+
+    template <typename Value>
+    struct max_monoid {
+        using value_type = Value;
+        static Value identity()                                      { return std::numeric_limits<Value>::lowest(); }
+        static Value combine(Value const & _lhs, Value const & _rhs) { return std::max(_lhs, _rhs); }
+    };
+
+    template <typename Key, typename Value, typename Monoid = sum_monoid<Value>, typename Compare = std::less<Key>>
+    class range_aggregate_tree {
+    public:
+        using key_type        = Key;
+        using mapped_type     = Value;
+        using value_type      = std::pair<Key, Value>;
+        using aggregate_type  = typename Monoid::value_type;
+        using key_compare     = Compare;
+        using size_type       = size_t;
+    private:
+        //order of entries by key. transparent, so entries are looked up by key alone.
+        struct entry_order_ {
+            using is_transparent = void;
+            bool operator()(value_type const & _lhs, value_type const & _rhs) const { return comp(_lhs.first, _rhs.first); }
+            bool operator()(value_type const & _lhs, Key const & _rhs)        const { return comp(_lhs.first, _rhs); }
+            bool operator()(Key const & _lhs, value_type const & _rhs)        const { return comp(_lhs, _rhs.first); }
+            Compare comp;
+        };
+        struct payload_summary_ {
+            using summary_type = aggregate_type;
+            static aggregate_type of(value_type const & _entry) { return static_cast<aggregate_type>(_entry.second); }
+            static aggregate_type combine(aggregate_type const & _lhs, aggregate_type const & _rhs) { return Monoid::combine(_lhs, _rhs); }
+        };
+        using node_type     = rb_node_<value_type, monoid_augment_<payload_summary_>>;
+        using tree_type     = red_black_tree<value_type, entry_order_, std::allocator<node_type>>;
+        using node_iterator = typename tree_type::downside_iterator;
+    public:
+        using iterator = typename tree_type::iterator;
+
+        range_aggregate_tree() = default; // default constructor
+
+        //return whether if tree is empty.
+        bool            empty() const;
+        //return the number of entries.
+        size_type       size() const;
+        //iterate entries in key order. entries must not be modified through iterator; use assign instead.
+        iterator        begin() const;
+        iterator        end() const;
+        //return iterator of the entry with given key, end() if it does not exist.
+        iterator        find(Key const &) const;
+        //insert entry. return false and keep old payload if key already exists.
+        bool            insert(Key const &, Value const &);
+        //insert entry, or replace payload of existing entry.
+        void            assign(Key const &, Value const &);
+        //remove entry with given key. return the number of removed entries. (0 or 1)
+        size_type       remove(Key const &);
+        //remove every entry.
+        void            clear();
+        //return monoid fold of payloads with key in [first key, last key), in key order. O(log n).
+        aggregate_type  aggregate(Key const &, Key const &) const;
+        //return monoid fold of every payload. O(1).
+        aggregate_type  aggregate() const;
+        //call given function with every entry with key in [first key, last key), in key order. O(log n + k).
+        template <typename Function>
+        void            for_each_in_range(Key const &, Key const &, Function&&) const;
+    private:
+        static aggregate_type const & _internal_summary(node_iterator const &);
+    private:
+        tree_type tree;
+        Compare   comp;
+    };
+
+    template <typename Key, typename Value, typename Monoid, typename Compare>
+    bool range_aggregate_tree<Key, Value, Monoid, Compare>::empty() const {
+        return tree.empty();
+    }
+
+    template <typename Key, typename Value, typename Monoid, typename Compare>
+    typename range_aggregate_tree<Key, Value, Monoid, Compare>::size_type range_aggregate_tree<Key, Value, Monoid, Compare>::size() const {
+        return tree.size();
+    }
+
+    template <typename Key, typename Value, typename Monoid, typename Compare>
+    typename range_aggregate_tree<Key, Value, Monoid, Compare>::iterator range_aggregate_tree<Key, Value, Monoid, Compare>::begin() const {
+        return tree.begin();
+    }
+
+    template <typename Key, typename Value, typename Monoid, typename Compare>
+    typename range_aggregate_tree<Key, Value, Monoid, Compare>::iterator range_aggregate_tree<Key, Value, Monoid, Compare>::end() const {
+        return tree.end();
+    }
+
+    template <typename Key, typename Value, typename Monoid, typename Compare>
+    typename range_aggregate_tree<Key, Value, Monoid, Compare>::iterator range_aggregate_tree<Key, Value, Monoid, Compare>::find(Key const & _key) const {
+        return tree.find(_key);
+    }
+
+    template <typename Key, typename Value, typename Monoid, typename Compare>
+    bool range_aggregate_tree<Key, Value, Monoid, Compare>::insert(Key const & _key, Value const & _value) {
+        return tree.insert(value_type(_key, _value)).second;
+    }
+
+    template <typename Key, typename Value, typename Monoid, typename Compare>
+    void range_aggregate_tree<Key, Value, Monoid, Compare>::assign(Key const & _key, Value const & _value) {
+        //payload does not take part in the order, so it is replaced in place and summaries are refreshed up the path.
+        iterator iter = tree.find(_key);
+        if (iter != tree.end()) {
+            tree.modify(iter, [&_value](value_type& _entry) { _entry.second = _value; });
+        }
+        else {
+            tree.insert(value_type(_key, _value));
+        }
+    }
+
+    template <typename Key, typename Value, typename Monoid, typename Compare>
+    typename range_aggregate_tree<Key, Value, Monoid, Compare>::size_type range_aggregate_tree<Key, Value, Monoid, Compare>::remove(Key const & _key) {
+        iterator iter = tree.find(_key);
+        if (iter == tree.end()) return 0U;
+        tree.remove(iter);
+        return 1U;
+    }
+
+    template <typename Key, typename Value, typename Monoid, typename Compare>
+    void range_aggregate_tree<Key, Value, Monoid, Compare>::clear() {
+        tree.clear();
+    }
+
+    template <typename Key, typename Value, typename Monoid, typename Compare>
+    typename range_aggregate_tree<Key, Value, Monoid, Compare>::aggregate_type range_aggregate_tree<Key, Value, Monoid, Compare>::aggregate(Key const & _first_key, Key const & _last_key) const {
+        //find the highest node inside the range. paths to both bounds pass through it.
+        node_iterator split_node = tree.downside_begin();
+        while (split_node) {
+            Key const & key = (*split_node).first;
+            if (comp(key, _first_key))      split_node = split_node + 1;
+            else if (!comp(key, _last_key)) split_node = split_node - 1;
+            else                            break;
+        }
+        if (!split_node) return Monoid::identity();
+
+        //left boundary. node not less than first key takes its right sub-tree, all inside the range, along with it.
+        aggregate_type left_result = Monoid::identity();
+        for (node_iterator node = split_node - 1; node; ) {
+            if (comp((*node).first, _first_key)) {
+                node = node + 1;
+                continue;
+            }
+            aggregate_type inside = static_cast<aggregate_type>((*node).second);
+            if (node + 1) inside = Monoid::combine(inside, _internal_summary(node + 1));
+            left_result = Monoid::combine(inside, left_result);
+            node = node - 1;
+        }
+        //right boundary. node less than last key takes its left sub-tree along with it.
+        aggregate_type right_result = Monoid::identity();
+        for (node_iterator node = split_node + 1; node; ) {
+            if (!comp((*node).first, _last_key)) {
+                node = node - 1;
+                continue;
+            }
+            aggregate_type inside = static_cast<aggregate_type>((*node).second);
+            if (node - 1) inside = Monoid::combine(_internal_summary(node - 1), inside);
+            right_result = Monoid::combine(right_result, inside);
+            node = node + 1;
+        }
+        return Monoid::combine(Monoid::combine(left_result, static_cast<aggregate_type>((*split_node).second)), right_result);
+    }
+
+    template <typename Key, typename Value, typename Monoid, typename Compare>
+    typename range_aggregate_tree<Key, Value, Monoid, Compare>::aggregate_type range_aggregate_tree<Key, Value, Monoid, Compare>::aggregate() const {
+        node_iterator root_node = tree.downside_begin();
+        return root_node ? _internal_summary(root_node) : Monoid::identity();
+    }
+
+    template <typename Key, typename Value, typename Monoid, typename Compare>
+    template <typename Function>
+    void range_aggregate_tree<Key, Value, Monoid, Compare>::for_each_in_range(Key const & _first_key, Key const & _last_key, Function&& _func) const {
+        for (iterator iter = tree.lower_bound(_first_key); iter != tree.end() && comp(iter->first, _last_key); ++iter) {
+            _func(static_cast<value_type const &>(*iter));
+        }
+    }
+
+    template <typename Key, typename Value, typename Monoid, typename Compare>
+    typename range_aggregate_tree<Key, Value, Monoid, Compare>::aggregate_type const & range_aggregate_tree<Key, Value, Monoid, Compare>::_internal_summary(node_iterator const & _node) {
+        return _node.augment().summary;
+    }
+}
+
+#endif
@@ -1,8 +1,894 @@
 #ifndef RED_BLACK_TREE_HPP
 #define RED_BLACK_TREE_HPP
 
+/**
+* @file      red_black_tree.hpp
+* @author    snowapril
+* @date      2026-10-17 (ongoing)
+* @brief     custom red black tree data structure which almost similar to STL std::set.
+* @details   header only self-balancing ordered set. lookup, insert and remove are O(log n) in the worst case.
+             node keeps the same three pointer layout as bst_node_ ; color bit is packed into the lowest bit of parent pointer.
+             provide bidirectional in-order iterator which walks through parent links without recursion.
+             node may carry augmented data of its sub-tree like bst_node_ (e.g. monoid summary of interval_tree and
+             range_aggregate_tree). insert and remove refresh it along one path, and rotations keep it locally,
+             so augmented queries run in O(log n) on any insertion order.
+             statistics policy (see tree_stats.hpp) records search paths, node allocation and rotations of rebalancing.
+* @see       tree_stats.hpp
+* @reference Introduction to Algorithms 3rd edition, chapter 13.
+*/
+
+#include <algorithm>
+#include <cstdint>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include "tree_exceptions.hpp"
+#include "tree_stats.hpp"
+#include "tree_util.hpp"
+
 namespace snowapril {
 
+    template <typename Type, typename Augment = no_augment_>
+    class rb_node_ : public Augment {
+    public:
+        using augment_type = Augment;
+        enum color_type : uintptr_t { red = 0U, black = 1U };
+
+        rb_node_(Type const &); // constructor with l-value data
+        rb_node_(Type&&); // constructor with r-value data
+        rb_node_(rb_node_ const &) = delete;
+        rb_node_ & operator=(rb_node_ const &) = delete;
+        ~rb_node_();
+        //return parent node pointer without color bit.
+        rb_node_*       parent() const;
+        //replace parent node pointer while keeping color bit.
+        void            set_parent(rb_node_*);
+        //return color of this node.
+        color_type      color() const;
+        //replace color of this node while keeping parent pointer.
+        void            set_color(color_type);
+    public:
+        uintptr_t       parent_and_color = red;
+        rb_node_       *left_node        = nullptr;
+        rb_node_       *right_node       = nullptr;
+        Type value;
+    };
+
+    template <typename Type, typename Compare = std::less<Type>, class node_allocator = std::allocator< rb_node_< Type > >, class tree_stats = no_tree_stats_ >
+    class red_black_tree : private tree_stats {
+    protected:
+        //node type is chosen by allocator, so allocator of augmented rb_node_ gives augmented tree.
+        using node_type = typename std::allocator_traits<node_allocator>::value_type;
+        static_assert(alignof(node_type) >= 2U, "rb_node_ needs at least one spare low bit in its address for color.");
+    public:
+        using value_type      = Type;
+        using key_compare     = Compare;
+        using stats_type      = tree_stats;
+        using augment_type    = typename node_type::augment_type;
+        using pointer         = Type const*;
+        using reference       = Type const&;
+        using size_type       = size_t;
+        using difference_type = ptrdiff_t;
+        class iterator;
+        using const_iterator         = iterator;
+        using reverse_iterator       = std::reverse_iterator<iterator>;
+        using const_reverse_iterator = reverse_iterator;
+        class downside_iterator;
+
+        red_black_tree() = default; // default constructor
+        explicit red_black_tree(Compare const &); // constructor with comparator
+        template <typename GenericIterator>
+        red_black_tree(GenericIterator, GenericIterator); //constructor with two standard iterators
+        red_black_tree(std::initializer_list<Type> const &); // constructor with initializer_list
+        red_black_tree(red_black_tree<Type, Compare, node_allocator, tree_stats> const &); // copy constructor
+        red_black_tree<Type, Compare, node_allocator, tree_stats> & operator=(red_black_tree<Type, Compare, node_allocator, tree_stats> const &); // copy assignment operator
+        red_black_tree(red_black_tree<Type, Compare, node_allocator, tree_stats> &&); // move constructor
+        red_black_tree<Type, Compare, node_allocator, tree_stats> & operator=(red_black_tree<Type, Compare, node_allocator, tree_stats> &&); // move assignment operator
+        ~red_black_tree(); // destructor
+
+            class iterator {
+                friend class red_black_tree<Type, Compare, node_allocator, tree_stats>;
+            public:
+                using iterator_category = std::bidirectional_iterator_tag;
+                using value_type        = Type;
+                using pointer           = Type const*;
+                using reference         = Type const&;
+                using difference_type   = ptrdiff_t;
+            public:
+                iterator() = default;
+                iterator(node_type*, red_black_tree const *);
+                //return reference of value. value is immutable because it determines position in the tree.
+                Type const& operator*()     const;
+                Type const* operator->()    const;
+                bool        operator==(iterator const &) const;
+                bool        operator!=(iterator const &) const;
+                //move to in-order successor.
+                iterator&   operator++();
+                iterator    operator++(int);
+                //move to in-order predecessor. decrementing end() gives the largest element.
+                iterator&   operator--();
+                iterator    operator--(int);
+            private:
+                node_type            *node = nullptr;
+                red_black_tree const *tree = nullptr;
+            };
+
+            //iterator which only steps down to children, for augmented queries which prune sub-trees.
+            class downside_iterator {
+                friend class red_black_tree<Type, Compare, node_allocator, tree_stats>;
+            public:
+                downside_iterator() = default;
+                explicit downside_iterator(node_type*);
+                Type const& operator*()     const;
+                Type const* operator->()    const;
+                //return downside_iterator which located at (given value) times right step from this iterator.
+                downside_iterator operator+(unsigned int) const;
+                //return downside_iterator which located at (given value) times left  step from this iterator.
+                downside_iterator operator-(unsigned int) const;
+                explicit operator bool() const;
+                //return augmented data of the sub-tree.
+                augment_type const & augment() const;
+            private:
+                node_type *node = nullptr;
+            };
+        public:
+            //return whether if tree is empty.
+            bool                empty() const;
+            //return the number of node in this tree.
+            size_type           size() const;
+            //return iterator of the smallest element.
+            iterator            begin() const;
+            //return past-the-end iterator.
+            iterator            end() const;
+            reverse_iterator    rbegin() const;
+            reverse_iterator    rend() const;
+            //return downside_iterator of root node.
+            downside_iterator   downside_begin() const;
+            //return the number of nodes on the longest root-to-leaf path.
+            size_type           height() const;
+            //remove every node in this tree.
+            void                clear();
+            //exchange nodes, allocator and comparator with given tree. iterators stay valid and follow their nodes.
+            void                swap(red_black_tree<Type, Compare, node_allocator, tree_stats>&) noexcept;
+            //insert given value. return iterator of the element and whether insertion took place.
+            std::pair<iterator, bool> insert(Type const &);
+            std::pair<iterator, bool> insert(Type&&);
+            //remove node which is matched with given value. return the number of removed nodes.
+            size_type           remove(Type const &);
+            //remove node which is pointed by given iterator. return iterator of its successor.
+            //end() removes nothing and returns end().
+            iterator            remove(iterator);
+            //lookup methods accept any key type if Compare is transparent, otherwise key is converted to Type.
+            //return iterator of the element matched with given key, end() if it does not exist.
+            template <typename Key = Type>
+            iterator            find(Key const &) const;
+            //return whether if element matched with given key exists.
+            template <typename Key = Type>
+            bool                contains(Key const &) const;
+            //return iterator of the first element not less than given key, end() if there is no such element.
+            template <typename Key = Type>
+            iterator            lower_bound(Key const &) const;
+            //call given function with mutable reference of the element, then refresh augmented data up to the root.
+            //function must not change the order of the element. O(log n).
+            template <typename Function>
+            void                modify(iterator, Function&&);
+            //return copy of statistics counters. every counter is zero if statistics policy is no_tree_stats_.
+            tree_stats_snapshot stats() const;
+            //reset statistics counters, including max depth of searched paths.
+            void                reset_stats();
+        private:
+            tree_stats const & _internal_stats() const;
+            template <typename Key>
+            using lookup_key_t = typename std::conditional<is_transparent_compare_<Compare>::value, Key, Type>::type;
+            static constexpr bool is_augmented = !std::is_same<augment_type, no_augment_>::value;
+            //recompute augmented data of given node, and of every ancestor for the path version.
+            static void _internal_update(node_type*);
+            static void _internal_update_path(node_type*);
+            //implementation of method which inserts constructed-on-demand node.
+            template <typename Value>
+            std::pair<iterator, bool> _internal_insert(Value&&);
+            //restore red black property after insertion of given node.
+            void _internal_insert_fixup(node_type*);
+            //unlink given node and restore red black property.
+            void _internal_erase_node(node_type*);
+            void _internal_rotate_left(node_type*);
+            void _internal_rotate_right(node_type*);
+            //replace subtree rooted at first node with subtree rooted at second node.
+            void _internal_transplant(node_type*, node_type*);
+            //copy sub-tree of given node under given parent and store it into given child slot before its children,
+            //so nodes copied before an exception are reachable from root and released by clear().
+            void _internal_copy(node_type const*, node_type*, node_type*&);
+            //recursion depth is bounded by height of balanced tree.
+            static size_type _internal_height(node_type const*);
+            void _internal_destroy_node(node_type*);
+            static node_type* _internal_minimum(node_type*);
+            static node_type* _internal_maximum(node_type*);
+        private:
+            node_allocator alloc;
+            Compare        comp;
+            node_type*     root     = nullptr;
+            size_type      num_node = 0U;
+    };
+
+    template <typename Type, typename Augment>
+    rb_node_<Type, Augment>::rb_node_(Type const & _l_value) : value(_l_value) { }
+
+    template <typename Type, typename Augment>
+    rb_node_<Type, Augment>::rb_node_(Type&& _r_value) : value(std::move(_r_value)) { }
+
+    template <typename Type, typename Augment>
+    rb_node_<Type, Augment>::~rb_node_() {
+        LOG("destructor", this->value);
+    }
+
+    template <typename Type, typename Augment>
+    rb_node_<Type, Augment>* rb_node_<Type, Augment>::parent() const {
+        return reinterpret_cast<rb_node_*>(parent_and_color & ~static_cast<uintptr_t>(1U));
+    }
+
+    template <typename Type, typename Augment>
+    void rb_node_<Type, Augment>::set_parent(rb_node_* _parent) {
+        parent_and_color = reinterpret_cast<uintptr_t>(_parent) | (parent_and_color & 1U);
+    }
+
+    template <typename Type, typename Augment>
+    typename rb_node_<Type, Augment>::color_type rb_node_<Type, Augment>::color() const {
+        return static_cast<color_type>(parent_and_color & 1U);
+    }
+
+    template <typename Type, typename Augment>
+    void rb_node_<Type, Augment>::set_color(color_type _color) {
+        parent_and_color = (parent_and_color & ~static_cast<uintptr_t>(1U)) | _color;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    red_black_tree<Type, Compare, node_allocator, tree_stats>::red_black_tree(Compare const & _comp) : comp(_comp) { }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    template <typename GenericIterator>
+    red_black_tree<Type, Compare, node_allocator, tree_stats>::red_black_tree(GenericIterator _begin_iter, GenericIterator _end_iter) {
+        for (; _begin_iter != _end_iter; ++_begin_iter) {
+            insert(*_begin_iter);
+        }
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    red_black_tree<Type, Compare, node_allocator, tree_stats>::red_black_tree(std::initializer_list<Type> const & _i_list) {
+        for (const auto& _value : _i_list) {
+            insert(_value);
+        }
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    red_black_tree<Type, Compare, node_allocator, tree_stats>::red_black_tree(red_black_tree<Type, Compare, node_allocator, tree_stats> const & _l_tree)
+        : tree_stats(), alloc(std::allocator_traits<node_allocator>::select_on_container_copy_construction(_l_tree.alloc)), comp(_l_tree.comp) {
+        try {
+            _internal_copy(_l_tree.root, nullptr, root);
+        }
+        catch (...) {
+            clear();
+            throw;
+        }
+        num_node = _l_tree.num_node;
+        _internal_stats().reset_depth(_l_tree._internal_stats().recorded_depth());
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    red_black_tree<Type, Compare, node_allocator, tree_stats> & red_black_tree<Type, Compare, node_allocator, tree_stats>::operator=(red_black_tree<Type, Compare, node_allocator, tree_stats> const & _l_tree) {
+        if (this != &_l_tree) {
+            //copy first, so this tree is unchanged if copy throws. old nodes are released with the copy.
+            red_black_tree<Type, Compare, node_allocator, tree_stats> copy(_l_tree);
+            swap(copy);
+        }
+        return *this;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    red_black_tree<Type, Compare, node_allocator, tree_stats>::red_black_tree(red_black_tree<Type, Compare, node_allocator, tree_stats> && _r_tree) : alloc(_r_tree.alloc), comp(_r_tree.comp) {
+        root = _r_tree.root;
+        _r_tree.root = nullptr;
+        num_node = _r_tree.num_node;
+        _r_tree.num_node = 0U;
+        _internal_stats().reset_depth(_r_tree._internal_stats().recorded_depth());
+        _r_tree._internal_stats().reset_depth(0U);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    red_black_tree<Type, Compare, node_allocator, tree_stats> & red_black_tree<Type, Compare, node_allocator, tree_stats>::operator=(red_black_tree<Type, Compare, node_allocator, tree_stats> && _r_tree) {
+        if (this != &_r_tree) {
+            clear();
+            alloc = _r_tree.alloc;
+            comp  = _r_tree.comp;
+            root = _r_tree.root;
+            _r_tree.root = nullptr;
+            num_node = _r_tree.num_node;
+            _r_tree.num_node = 0U;
+            _internal_stats().reset_depth(_r_tree._internal_stats().recorded_depth());
+            _r_tree._internal_stats().reset_depth(0U);
+        }
+        return *this;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    red_black_tree<Type, Compare, node_allocator, tree_stats>::~red_black_tree() {
+        clear();
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    bool red_black_tree<Type, Compare, node_allocator, tree_stats>::empty() const {
+        return num_node == 0U;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename red_black_tree<Type, Compare, node_allocator, tree_stats>::size_type red_black_tree<Type, Compare, node_allocator, tree_stats>::size() const {
+        return num_node;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename red_black_tree<Type, Compare, node_allocator, tree_stats>::iterator red_black_tree<Type, Compare, node_allocator, tree_stats>::begin() const {
+        return iterator(root ? _internal_minimum(root) : nullptr, this);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename red_black_tree<Type, Compare, node_allocator, tree_stats>::iterator red_black_tree<Type, Compare, node_allocator, tree_stats>::end() const {
+        return iterator(nullptr, this);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename red_black_tree<Type, Compare, node_allocator, tree_stats>::reverse_iterator red_black_tree<Type, Compare, node_allocator, tree_stats>::rbegin() const {
+        return reverse_iterator(end());
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename red_black_tree<Type, Compare, node_allocator, tree_stats>::reverse_iterator red_black_tree<Type, Compare, node_allocator, tree_stats>::rend() const {
+        return reverse_iterator(begin());
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename red_black_tree<Type, Compare, node_allocator, tree_stats>::downside_iterator red_black_tree<Type, Compare, node_allocator, tree_stats>::downside_begin() const {
+        return downside_iterator(root);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename red_black_tree<Type, Compare, node_allocator, tree_stats>::size_type red_black_tree<Type, Compare, node_allocator, tree_stats>::height() const {
+        return _internal_height(root);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    void red_black_tree<Type, Compare, node_allocator, tree_stats>::clear() {
+        //post-order teardown through parent links, no auxiliary container is needed.
+        node_type* node = root;
+        while (node) {
+            if (node->left_node) {
+                node = node->left_node;
+            }
+            else if (node->right_node) {
+                node = node->right_node;
+            }
+            else {
+                node_type* parent_node = node->parent();
+                if (parent_node) {
+                    if (parent_node->left_node == node) parent_node->left_node  = nullptr;
+                    else                                parent_node->right_node = nullptr;
+                }
+                _internal_destroy_node(node);
+                node = parent_node;
+            }
+        }
+        root     = nullptr;
+        num_node = 0U;
+        _internal_stats().reset_depth(0U);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    void red_black_tree<Type, Compare, node_allocator, tree_stats>::swap(red_black_tree<Type, Compare, node_allocator, tree_stats>& _other) noexcept {
+        using std::swap;
+        swap(alloc,    _other.alloc);
+        swap(comp,     _other.comp);
+        swap(root,     _other.root);
+        swap(num_node, _other.num_node);
+        //counters stay with each tree object, but max depth describes the nodes, so it follows them.
+        size_type depth = _internal_stats().recorded_depth();
+        _internal_stats().reset_depth(_other._internal_stats().recorded_depth());
+        _other._internal_stats().reset_depth(depth);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    std::pair<typename red_black_tree<Type, Compare, node_allocator, tree_stats>::iterator, bool> red_black_tree<Type, Compare, node_allocator, tree_stats>::insert(Type const & _value) {
+        return _internal_insert(_value);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    std::pair<typename red_black_tree<Type, Compare, node_allocator, tree_stats>::iterator, bool> red_black_tree<Type, Compare, node_allocator, tree_stats>::insert(Type&& _value) {
+        return _internal_insert(std::move(_value));
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename red_black_tree<Type, Compare, node_allocator, tree_stats>::size_type red_black_tree<Type, Compare, node_allocator, tree_stats>::remove(Type const & _value) {
+        iterator iter = find(_value);
+        if (iter.node == nullptr) return 0U;
+        _internal_erase_node(iter.node);
+        return 1U;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename red_black_tree<Type, Compare, node_allocator, tree_stats>::iterator red_black_tree<Type, Compare, node_allocator, tree_stats>::remove(iterator _iter) {
+        if (_iter.tree != this) throw different_tree_exception("different_tree_exception : tree instance and given iterator are mismatched.");
+        if (_iter.node == nullptr) return _iter;
+        iterator next_iter = _iter;
+        ++next_iter;
+        _internal_erase_node(_iter.node);
+        return next_iter;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    template <typename Key>
+    typename red_black_tree<Type, Compare, node_allocator, tree_stats>::iterator red_black_tree<Type, Compare, node_allocator, tree_stats>::find(Key const & _key) const {
+        lookup_key_t<Key> const & key = _key;
+        node_type* node      = root;
+        size_type  num_visit = 0U;
+        for (; node; ++num_visit) {
+            if (comp(key, node->value))
+                node = node->left_node;
+            else if (comp(node->value, key))
+                node = node->right_node;
+            else
+                break;
+        }
+        _internal_stats().record_search(node ? num_visit + 1U : num_visit);
+        return iterator(node, this);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    template <typename Key>
+    bool red_black_tree<Type, Compare, node_allocator, tree_stats>::contains(Key const & _key) const {
+        return find(_key).node != nullptr;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    template <typename Key>
+    typename red_black_tree<Type, Compare, node_allocator, tree_stats>::iterator red_black_tree<Type, Compare, node_allocator, tree_stats>::lower_bound(Key const & _key) const {
+        lookup_key_t<Key> const & key = _key;
+        node_type* node       = root;
+        node_type* last_found = nullptr;
+        size_type  num_visit  = 0U;
+        for (; node; ++num_visit) {
+            if (comp(node->value, key)) {
+                node = node->right_node;
+            }
+            else {
+                last_found = node;
+                node = node->left_node;
+            }
+        }
+        _internal_stats().record_search(num_visit);
+        return iterator(last_found, this);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    template <typename Function>
+    void red_black_tree<Type, Compare, node_allocator, tree_stats>::modify(iterator _iter, Function&& _func) {
+        if (_iter.tree != this) throw different_tree_exception("different_tree_exception : tree instance and given iterator are mismatched.");
+        _func(_iter.node->value);
+        _internal_update_path(_iter.node);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    tree_stats_snapshot red_black_tree<Type, Compare, node_allocator, tree_stats>::stats() const {
+        return _internal_stats().snapshot();
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    void red_black_tree<Type, Compare, node_allocator, tree_stats>::reset_stats() {
+        tree_stats::reset();
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    tree_stats const & red_black_tree<Type, Compare, node_allocator, tree_stats>::_internal_stats() const {
+        return *this;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    template <typename Value>
+    std::pair<typename red_black_tree<Type, Compare, node_allocator, tree_stats>::iterator, bool> red_black_tree<Type, Compare, node_allocator, tree_stats>::_internal_insert(Value&& _value) {
+        node_type* parent_node = nullptr;
+        node_type* node        = root;
+        bool       go_left     = true;
+        size_type  num_visit   = 0U;
+        for (; node; ++num_visit) {
+            parent_node = node;
+            go_left = comp(_value, node->value);
+            if (go_left)
+                node = node->left_node;
+            else if (comp(node->value, _value))
+                node = node->right_node;
+            else {
+                _internal_stats().record_search(num_visit + 1U);
+                return std::make_pair(iterator(node, this), false);
+            }
+        }
+        _internal_stats().record_search(num_visit);
+
+        node_type* new_node = alloc.allocate(1);
+        try {
+            alloc.construct(new_node, std::forward<Value>(_value));
+        }
+        catch (...) {
+            alloc.deallocate(new_node, 1);
+            throw;
+        }
+        _internal_stats().record_alloc_call();
+        _internal_stats().record_alloc(1U);
+        _internal_stats().record_insert();
+        new_node->set_parent(parent_node);
+        if (parent_node == nullptr) root                    = new_node;
+        else if (go_left)           parent_node->left_node  = new_node;
+        else                        parent_node->right_node = new_node;
+        ++num_node;
+        LOG("add on", parent_node);
+        //rotations of fixup keep augmented data of the rotated sub-tree, so the path is refreshed once before it.
+        _internal_update_path(new_node);
+
+        _internal_insert_fixup(new_node);
+        return std::make_pair(iterator(new_node, this), true);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    void red_black_tree<Type, Compare, node_allocator, tree_stats>::_internal_insert_fixup(node_type* _node) {
+        while (_node != root && _node->parent()->color() == node_type::red) {
+            node_type* parent_node      = _node->parent();
+            node_type* grandparent_node = parent_node->parent();
+            if (parent_node == grandparent_node->left_node) {
+                node_type* uncle_node = grandparent_node->right_node;
+                if (uncle_node && uncle_node->color() == node_type::red) {
+                    parent_node->set_color(node_type::black);
+                    uncle_node->set_color(node_type::black);
+                    grandparent_node->set_color(node_type::red);
+                    _node = grandparent_node;
+                    continue;
+                }
+                if (_node == parent_node->right_node) {
+                    _node = parent_node;
+                    _internal_rotate_left(_node);
+                    parent_node = _node->parent();
+                }
+                parent_node->set_color(node_type::black);
+                grandparent_node->set_color(node_type::red);
+                _internal_rotate_right(grandparent_node);
+            }
+            else {
+                node_type* uncle_node = grandparent_node->left_node;
+                if (uncle_node && uncle_node->color() == node_type::red) {
+                    parent_node->set_color(node_type::black);
+                    uncle_node->set_color(node_type::black);
+                    grandparent_node->set_color(node_type::red);
+                    _node = grandparent_node;
+                    continue;
+                }
+                if (_node == parent_node->left_node) {
+                    _node = parent_node;
+                    _internal_rotate_right(_node);
+                    parent_node = _node->parent();
+                }
+                parent_node->set_color(node_type::black);
+                grandparent_node->set_color(node_type::red);
+                _internal_rotate_left(grandparent_node);
+            }
+        }
+        root->set_color(node_type::black);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    void red_black_tree<Type, Compare, node_allocator, tree_stats>::_internal_erase_node(node_type* _node) {
+        //child_node may be null, so its parent is tracked separately during fixup.
+        node_type*                     child_node, *child_parent;
+        typename node_type::color_type removed_color = _node->color();
+
+        if (_node->left_node == nullptr) {
+            child_node   = _node->right_node;
+            child_parent = _node->parent();
+            _internal_transplant(_node, child_node);
+        }
+        else if (_node->right_node == nullptr) {
+            child_node   = _node->left_node;
+            child_parent = _node->parent();
+            _internal_transplant(_node, child_node);
+        }
+        else {
+            //relink successor into the place of removed node instead of copying its value.
+            node_type* successor = _internal_minimum(_node->right_node);
+            removed_color = successor->color();
+            child_node    = successor->right_node;
+            if (successor->parent() == _node) {
+                child_parent = successor;
+            }
+            else {
+                child_parent = successor->parent();
+                _internal_transplant(successor, successor->right_node);
+                successor->right_node = _node->right_node;
+                successor->right_node->set_parent(successor);
+            }
+            _internal_transplant(_node, successor);
+            successor->left_node = _node->left_node;
+            successor->left_node->set_parent(successor);
+            successor->set_color(_node->color());
+        }
+        _internal_destroy_node(_node);
+        --num_node;
+        _internal_stats().record_remove();
+        //every node whose sub-tree lost a node is on the path from the lowest relinked node to the root.
+        _internal_update_path(child_parent);
+
+        if (removed_color != node_type::black) return;
+
+        while (child_node != root && (child_node == nullptr || child_node->color() == node_type::black)) {
+            if (child_node == child_parent->left_node) {
+                node_type* sibling_node = child_parent->right_node;
+                if (sibling_node->color() == node_type::red) {
+                    sibling_node->set_color(node_type::black);
+                    child_parent->set_color(node_type::red);
+                    _internal_rotate_left(child_parent);
+                    sibling_node = child_parent->right_node;
+                }
+                if ((sibling_node->left_node  == nullptr || sibling_node->left_node->color()  == node_type::black) &&
+                    (sibling_node->right_node == nullptr || sibling_node->right_node->color() == node_type::black)) {
+                    sibling_node->set_color(node_type::red);
+                    child_node   = child_parent;
+                    child_parent = child_parent->parent();
+                }
+                else {
+                    if (sibling_node->right_node == nullptr || sibling_node->right_node->color() == node_type::black) {
+                        sibling_node->left_node->set_color(node_type::black);
+                        sibling_node->set_color(node_type::red);
+                        _internal_rotate_right(sibling_node);
+                        sibling_node = child_parent->right_node;
+                    }
+                    sibling_node->set_color(child_parent->color());
+                    child_parent->set_color(node_type::black);
+                    if (sibling_node->right_node) sibling_node->right_node->set_color(node_type::black);
+                    _internal_rotate_left(child_parent);
+                    child_node = root;
+                }
+            }
+            else {
+                node_type* sibling_node = child_parent->left_node;
+                if (sibling_node->color() == node_type::red) {
+                    sibling_node->set_color(node_type::black);
+                    child_parent->set_color(node_type::red);
+                    _internal_rotate_right(child_parent);
+                    sibling_node = child_parent->left_node;
+                }
+                if ((sibling_node->left_node  == nullptr || sibling_node->left_node->color()  == node_type::black) &&
+                    (sibling_node->right_node == nullptr || sibling_node->right_node->color() == node_type::black)) {
+                    sibling_node->set_color(node_type::red);
+                    child_node   = child_parent;
+                    child_parent = child_parent->parent();
+                }
+                else {
+                    if (sibling_node->left_node == nullptr || sibling_node->left_node->color() == node_type::black) {
+                        sibling_node->right_node->set_color(node_type::black);
+                        sibling_node->set_color(node_type::red);
+                        _internal_rotate_left(sibling_node);
+                        sibling_node = child_parent->left_node;
+                    }
+                    sibling_node->set_color(child_parent->color());
+                    child_parent->set_color(node_type::black);
+                    if (sibling_node->left_node) sibling_node->left_node->set_color(node_type::black);
+                    _internal_rotate_right(child_parent);
+                    child_node = root;
+                }
+            }
+        }
+        if (child_node) child_node->set_color(node_type::black);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    void red_black_tree<Type, Compare, node_allocator, tree_stats>::_internal_rotate_left(node_type* _node) {
+        node_type* pivot_node = _node->right_node;
+        _node->right_node = pivot_node->left_node;
+        if (pivot_node->left_node) pivot_node->left_node->set_parent(_node);
+        _internal_transplant(_node, pivot_node);
+        pivot_node->left_node = _node;
+        _node->set_parent(pivot_node);
+        _internal_update(_node);
+        _internal_update(pivot_node);
+        _internal_stats().record_rotation(1U);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    void red_black_tree<Type, Compare, node_allocator, tree_stats>::_internal_rotate_right(node_type* _node) {
+        node_type* pivot_node = _node->left_node;
+        _node->left_node = pivot_node->right_node;
+        if (pivot_node->right_node) pivot_node->right_node->set_parent(_node);
+        _internal_transplant(_node, pivot_node);
+        pivot_node->right_node = _node;
+        _node->set_parent(pivot_node);
+        _internal_update(_node);
+        _internal_update(pivot_node);
+        _internal_stats().record_rotation(1U);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    void red_black_tree<Type, Compare, node_allocator, tree_stats>::_internal_transplant(node_type* _old_node, node_type* _new_node) {
+        node_type* parent_node = _old_node->parent();
+        if (parent_node == nullptr)                  root                    = _new_node;
+        else if (parent_node->left_node == _old_node) parent_node->left_node  = _new_node;
+        else                                          parent_node->right_node = _new_node;
+        if (_new_node) _new_node->set_parent(parent_node);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    void red_black_tree<Type, Compare, node_allocator, tree_stats>::_internal_copy(node_type const* _node, node_type* _parent, node_type*& _slot) {
+        //recursion depth is bounded by height of balanced source tree.
+        if (_node == nullptr) return;
+        node_type* new_node = alloc.allocate(1);
+        try {
+            alloc.construct(new_node, _node->value);
+        }
+        catch (...) {
+            alloc.deallocate(new_node, 1);
+            throw;
+        }
+        _internal_stats().record_alloc_call();
+        _internal_stats().record_alloc(1U);
+        //copy has the same shape, so augmented data is copied instead of recomputed.
+        static_cast<augment_type&>(*new_node) = static_cast<augment_type const&>(*_node);
+        new_node->set_parent(_parent);
+        new_node->set_color(_node->color());
+        _slot = new_node;
+        _internal_copy(_node->left_node,  new_node, new_node->left_node);
+        _internal_copy(_node->right_node, new_node, new_node->right_node);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename red_black_tree<Type, Compare, node_allocator, tree_stats>::size_type red_black_tree<Type, Compare, node_allocator, tree_stats>::_internal_height(node_type const* _node) {
+        if (_node == nullptr) return 0U;
+        return 1U + std::max(_internal_height(_node->left_node), _internal_height(_node->right_node));
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    void red_black_tree<Type, Compare, node_allocator, tree_stats>::_internal_update(node_type* _node) {
+        augment_type::update(_node);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    void red_black_tree<Type, Compare, node_allocator, tree_stats>::_internal_update_path(node_type* _node) {
+        if (!is_augmented) return;
+        for (; _node; _node = _node->parent()) {
+            augment_type::update(_node);
+        }
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    void red_black_tree<Type, Compare, node_allocator, tree_stats>::_internal_destroy_node(node_type* _node) {
+        LOG("del", _node);
+        alloc.destroy(_node);
+        alloc.deallocate(_node, 1);
+        _internal_stats().record_free(1U);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename red_black_tree<Type, Compare, node_allocator, tree_stats>::node_type* red_black_tree<Type, Compare, node_allocator, tree_stats>::_internal_minimum(node_type* _node) {
+        while (_node->left_node) _node = _node->left_node;
+        return _node;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename red_black_tree<Type, Compare, node_allocator, tree_stats>::node_type* red_black_tree<Type, Compare, node_allocator, tree_stats>::_internal_maximum(node_type* _node) {
+        while (_node->right_node) _node = _node->right_node;
+        return _node;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    red_black_tree<Type, Compare, node_allocator, tree_stats>::iterator::iterator(node_type* _node, red_black_tree const * _tree) : node(_node), tree(_tree) { }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    Type const& red_black_tree<Type, Compare, node_allocator, tree_stats>::iterator::operator*() const {
+        return node->value;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    Type const* red_black_tree<Type, Compare, node_allocator, tree_stats>::iterator::operator->() const {
+        return &node->value;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    bool red_black_tree<Type, Compare, node_allocator, tree_stats>::iterator::operator==(iterator const & _iter) const {
+        return node == _iter.node;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    bool red_black_tree<Type, Compare, node_allocator, tree_stats>::iterator::operator!=(iterator const & _iter) const {
+        return node != _iter.node;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename red_black_tree<Type, Compare, node_allocator, tree_stats>::iterator& red_black_tree<Type, Compare, node_allocator, tree_stats>::iterator::operator++() {
+        if (node->right_node) {
+            node = _internal_minimum(node->right_node);
+        }
+        else {
+            node_type* parent_node = node->parent();
+            while (parent_node && node == parent_node->right_node) {
+                node        = parent_node;
+                parent_node = parent_node->parent();
+            }
+            node = parent_node;
+        }
+        return *this;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename red_black_tree<Type, Compare, node_allocator, tree_stats>::iterator red_black_tree<Type, Compare, node_allocator, tree_stats>::iterator::operator++(int) {
+        iterator ret_iter = *this;
+        ++(*this);
+        return ret_iter;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename red_black_tree<Type, Compare, node_allocator, tree_stats>::iterator& red_black_tree<Type, Compare, node_allocator, tree_stats>::iterator::operator--() {
+        if (node == nullptr) {
+            node = tree->root ? _internal_maximum(tree->root) : nullptr;
+        }
+        else if (node->left_node) {
+            node = _internal_maximum(node->left_node);
+        }
+        else {
+            node_type* parent_node = node->parent();
+            while (parent_node && node == parent_node->left_node) {
+                node        = parent_node;
+                parent_node = parent_node->parent();
+            }
+            node = parent_node;
+        }
+        return *this;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename red_black_tree<Type, Compare, node_allocator, tree_stats>::iterator red_black_tree<Type, Compare, node_allocator, tree_stats>::iterator::operator--(int) {
+        iterator ret_iter = *this;
+        --(*this);
+        return ret_iter;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    red_black_tree<Type, Compare, node_allocator, tree_stats>::downside_iterator::downside_iterator(node_type* _node) : node(_node) { }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    Type const& red_black_tree<Type, Compare, node_allocator, tree_stats>::downside_iterator::operator*() const {
+        return node->value;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    Type const* red_black_tree<Type, Compare, node_allocator, tree_stats>::downside_iterator::operator->() const {
+        return &node->value;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename red_black_tree<Type, Compare, node_allocator, tree_stats>::downside_iterator red_black_tree<Type, Compare, node_allocator, tree_stats>::downside_iterator::operator+(unsigned int _num) const {
+        node_type* next_node = node;
+        while (_num-- && next_node) next_node = next_node->right_node;
+        return downside_iterator(next_node);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename red_black_tree<Type, Compare, node_allocator, tree_stats>::downside_iterator red_black_tree<Type, Compare, node_allocator, tree_stats>::downside_iterator::operator-(unsigned int _num) const {
+        node_type* next_node = node;
+        while (_num-- && next_node) next_node = next_node->left_node;
+        return downside_iterator(next_node);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    red_black_tree<Type, Compare, node_allocator, tree_stats>::downside_iterator::operator bool() const {
+        return node != nullptr;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename red_black_tree<Type, Compare, node_allocator, tree_stats>::augment_type const & red_black_tree<Type, Compare, node_allocator, tree_stats>::downside_iterator::augment() const {
+        return *node;
+    }
 }
 
-#endif
\ No newline at end of file
+#endif
@@ -0,0 +1,703 @@
+#ifndef SPLAY_TREE_HPP
+#define SPLAY_TREE_HPP
+
+/**
+* @file      splay_tree.hpp
+* @author    snowapril
+* @date      2026-10-17 (ongoing)
+* @brief     self-adjusting splay tree which almost similar to STL std::set.
+* @details   header only. node is bst_node_, so it has the same parent, left and right pointer layout as binary_search_tree.
+             lookup and insert semi-splay the accessed node (or the last visited one on miss) if it lies deeper than
+             1.25 * log2(n) levels, and remove always splays it to the root by zig, zig-zig and zig-zag rotations.
+             semi-splay rotates only the parent on zig-zig and goes on from there, so it halves the access path with
+             about half the rotations of splay and keeps its amortized O(log n) bound. access above that depth
+             already costs O(log n) and leaves the potential unchanged, while hot keys near the root are not
+             reshuffled among each other on every access.
+             deep keys which become hot are brought up by their first access, so skewed access patterns (e.g. zipfian)
+             visit fewer nodes than in static shape, with a fraction of the rotations of splaying on every access.
+             as a consequence, lookup methods are not const. iteration does not splay, and iterators stay valid
+             through splay because nodes are relinked, never moved.
+             sequential access may leave a path of n nodes, so copy, teardown and height walk through parent links
+             without recursion or auxiliary memory.
+             statistics policy (see tree_stats.hpp) records search paths and rotations like binary_search_tree.
+* @see       bst.hpp, tree_stats.hpp
+* @reference Sleator, Tarjan, "Self-Adjusting Binary Search Trees", Journal of the ACM 32(3), 1985.
+             Lee, Martel, "When to use splay trees", Software: Practice and Experience 37(15), 2007.
+*/
+
+#include <algorithm>
+#include <functional>
+#include <initializer_list>
+#include <iterator>
+#include <memory>
+#include <utility>
+#include "bst.hpp"
+#include "tree_exceptions.hpp"
+#include "tree_stats.hpp"
+#include "tree_util.hpp"
+
+namespace snowapril {
+
+    template <typename Type, typename Compare = std::less<Type>, class node_allocator = std::allocator< bst_node_< Type > >, class tree_stats = no_tree_stats_ >
+    class splay_tree : private tree_stats {
+    protected:
+        using node_type = bst_node_<Type>;
+    public:
+        using value_type      = Type;
+        using key_compare     = Compare;
+        using stats_type      = tree_stats;
+        using pointer         = Type const*;
+        using reference       = Type const&;
+        using size_type       = size_t;
+        using difference_type = ptrdiff_t;
+        class iterator;
+        using const_iterator         = iterator;
+        using reverse_iterator       = std::reverse_iterator<iterator>;
+        using const_reverse_iterator = reverse_iterator;
+
+        splay_tree() = default; // default constructor
+        explicit splay_tree(Compare const &); // constructor with comparator
+        template <typename GenericIterator>
+        splay_tree(GenericIterator, GenericIterator); //constructor with two standard iterators
+        splay_tree(std::initializer_list<Type> const &); // constructor with initializer_list
+        splay_tree(splay_tree<Type, Compare, node_allocator, tree_stats> const &); // copy constructor
+        splay_tree<Type, Compare, node_allocator, tree_stats> & operator=(splay_tree<Type, Compare, node_allocator, tree_stats> const &); // copy assignment operator
+        splay_tree(splay_tree<Type, Compare, node_allocator, tree_stats> &&); // move constructor
+        splay_tree<Type, Compare, node_allocator, tree_stats> & operator=(splay_tree<Type, Compare, node_allocator, tree_stats> &&); // move assignment operator
+        ~splay_tree(); // destructor
+
+            class iterator {
+                friend class splay_tree<Type, Compare, node_allocator, tree_stats>;
+            public:
+                using iterator_category = std::bidirectional_iterator_tag;
+                using value_type        = Type;
+                using pointer           = Type const*;
+                using reference         = Type const&;
+                using difference_type   = ptrdiff_t;
+            public:
+                iterator() = default;
+                iterator(node_type*, splay_tree const *);
+                //return reference of value. value is immutable because it determines position in the tree.
+                Type const& operator*()     const;
+                Type const* operator->()    const;
+                bool        operator==(iterator const &) const;
+                bool        operator!=(iterator const &) const;
+                //move to in-order successor.
+                iterator&   operator++();
+                iterator    operator++(int);
+                //move to in-order predecessor. decrementing end() gives the largest element.
+                iterator&   operator--();
+                iterator    operator--(int);
+            private:
+                node_type        *node = nullptr;
+                splay_tree const *tree = nullptr;
+            };
+        public:
+            //return whether if tree is empty.
+            bool                empty() const;
+            //return the number of node in this tree.
+            size_type           size() const;
+            //return iterator of the smallest element. iteration does not splay.
+            iterator            begin() const;
+            //return past-the-end iterator.
+            iterator            end() const;
+            reverse_iterator    rbegin() const;
+            reverse_iterator    rend() const;
+            //return comparator which determines order of elements.
+            key_compare         key_comp() const;
+            //return the number of nodes on the longest root-to-leaf path. O(n) walk without recursion.
+            size_type           height() const;
+            //return the number of nodes on the path from root to the element matched with given value, without splay.
+            //0 if it does not exist.
+            size_type           depth(Type const &) const;
+            //remove every node in this tree.
+            void                clear();
+            //insert given value and semi-splay its node like find. return iterator of the element and whether insertion took place.
+            std::pair<iterator, bool> insert(Type const &);
+            std::pair<iterator, bool> insert(Type&&);
+            //remove node which is matched with given value. return the number of removed nodes.
+            size_type           remove(Type const &);
+            //remove node which is pointed by given iterator. return iterator of its successor. end() removes nothing.
+            iterator            remove(iterator);
+            //return iterator of the element matched with given value, end() if it does not exist.
+            //found node, or the last visited node on miss, is semi-splayed toward the root if it lies deep.
+            iterator            find(Type const &);
+            //return whether if element matched with given value exists. splays like find.
+            bool                contains(Type const &);
+            //return iterator of the first element not less than given value. splays like find.
+            iterator            lower_bound(Type const &);
+            //return copy of statistics counters. every counter is zero if statistics policy is no_tree_stats_.
+            tree_stats_snapshot stats() const;
+            //reset statistics counters, including max depth of searched paths.
+            void                reset_stats();
+        private:
+            tree_stats const & _internal_stats() const;
+            //implementation of method which inserts constructed-on-demand node.
+            template <typename Value>
+            std::pair<iterator, bool> _internal_insert(Value&&);
+            //return the first node not less than given value without splay. second argument receives the last visited node,
+            //and third one the number of visited nodes.
+            node_type* _internal_lower_bound(Type const &, node_type*&, size_type&) const;
+            //semi-splay given node if its access path of given number of nodes is longer than _internal_splay_depth.
+            void _internal_access(node_type*, size_type);
+            //number of levels above which accessed node is left in place. 1.25 * log2(n), a bit below the average
+            //depth of randomly built tree, so hot keys which sink below it are lifted again.
+            size_type _internal_splay_depth() const;
+            //move given node to the root by zig, zig-zig and zig-zag steps.
+            void _internal_splay(node_type*);
+            //halve the path from root to given node. zig-zig rotates only the parent and goes on from the parent.
+            void _internal_semi_splay(node_type*);
+            //rotate given node above its parent.
+            void _internal_rotate(node_type*);
+            //replace link of given parent, or root, which refers to first node with second node.
+            void _internal_replace_child(node_type*, node_type*, node_type*);
+            //splay given node and unlink it by joining its sub-trees under the maximum of left sub-tree.
+            void _internal_erase_node(node_type*);
+            //copy given tree by walking both trees through parent links, without recursion or auxiliary memory.
+            node_type* _internal_copy(node_type const*);
+            //destroy every node of sub-tree in post-order through parent links, without recursion or auxiliary memory.
+            void _internal_destroy_subtree(node_type*);
+            template <typename... Args>
+            node_type* _internal_create_node(Args&&...);
+            void _internal_destroy_node(node_type*);
+            static node_type* _internal_minimum(node_type*);
+            static node_type* _internal_maximum(node_type*);
+        private:
+            node_allocator alloc;
+            Compare        comp;
+            node_type*     root     = nullptr;
+            size_type      num_node = 0U;
+    };
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    splay_tree<Type, Compare, node_allocator, tree_stats>::splay_tree(Compare const & _comp) : comp(_comp) { }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    template <typename GenericIterator>
+    splay_tree<Type, Compare, node_allocator, tree_stats>::splay_tree(GenericIterator _begin_iter, GenericIterator _end_iter) {
+        for (; _begin_iter != _end_iter; ++_begin_iter) {
+            insert(*_begin_iter);
+        }
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    splay_tree<Type, Compare, node_allocator, tree_stats>::splay_tree(std::initializer_list<Type> const & _i_list) {
+        for (const auto& _value : _i_list) {
+            insert(_value);
+        }
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    splay_tree<Type, Compare, node_allocator, tree_stats>::splay_tree(splay_tree<Type, Compare, node_allocator, tree_stats> const & _l_tree)
+        : tree_stats(), alloc(std::allocator_traits<node_allocator>::select_on_container_copy_construction(_l_tree.alloc)), comp(_l_tree.comp) {
+        root     = _internal_copy(_l_tree.root);
+        num_node = _l_tree.num_node;
+        _internal_stats().reset_depth(_l_tree._internal_stats().recorded_depth());
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    splay_tree<Type, Compare, node_allocator, tree_stats> & splay_tree<Type, Compare, node_allocator, tree_stats>::operator=(splay_tree<Type, Compare, node_allocator, tree_stats> const & _l_tree) {
+        if (this != &_l_tree) {
+            //copy first, so this tree is unchanged if copy throws.
+            splay_tree<Type, Compare, node_allocator, tree_stats> copy(_l_tree);
+            *this = std::move(copy);
+        }
+        return *this;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    splay_tree<Type, Compare, node_allocator, tree_stats>::splay_tree(splay_tree<Type, Compare, node_allocator, tree_stats> && _r_tree) : alloc(_r_tree.alloc), comp(_r_tree.comp) {
+        root = _r_tree.root;
+        _r_tree.root = nullptr;
+        num_node = _r_tree.num_node;
+        _r_tree.num_node = 0U;
+        _internal_stats().reset_depth(_r_tree._internal_stats().recorded_depth());
+        _r_tree._internal_stats().reset_depth(0U);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    splay_tree<Type, Compare, node_allocator, tree_stats> & splay_tree<Type, Compare, node_allocator, tree_stats>::operator=(splay_tree<Type, Compare, node_allocator, tree_stats> && _r_tree) {
+        if (this != &_r_tree) {
+            clear();
+            alloc = _r_tree.alloc;
+            comp  = _r_tree.comp;
+            root = _r_tree.root;
+            _r_tree.root = nullptr;
+            num_node = _r_tree.num_node;
+            _r_tree.num_node = 0U;
+            _internal_stats().reset_depth(_r_tree._internal_stats().recorded_depth());
+            _r_tree._internal_stats().reset_depth(0U);
+        }
+        return *this;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    splay_tree<Type, Compare, node_allocator, tree_stats>::~splay_tree() {
+        clear();
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    bool splay_tree<Type, Compare, node_allocator, tree_stats>::empty() const {
+        return num_node == 0U;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename splay_tree<Type, Compare, node_allocator, tree_stats>::size_type splay_tree<Type, Compare, node_allocator, tree_stats>::size() const {
+        return num_node;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename splay_tree<Type, Compare, node_allocator, tree_stats>::iterator splay_tree<Type, Compare, node_allocator, tree_stats>::begin() const {
+        return iterator(root ? _internal_minimum(root) : nullptr, this);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename splay_tree<Type, Compare, node_allocator, tree_stats>::iterator splay_tree<Type, Compare, node_allocator, tree_stats>::end() const {
+        return iterator(nullptr, this);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename splay_tree<Type, Compare, node_allocator, tree_stats>::reverse_iterator splay_tree<Type, Compare, node_allocator, tree_stats>::rbegin() const {
+        return reverse_iterator(end());
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename splay_tree<Type, Compare, node_allocator, tree_stats>::reverse_iterator splay_tree<Type, Compare, node_allocator, tree_stats>::rend() const {
+        return reverse_iterator(begin());
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename splay_tree<Type, Compare, node_allocator, tree_stats>::key_compare splay_tree<Type, Compare, node_allocator, tree_stats>::key_comp() const {
+        return comp;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename splay_tree<Type, Compare, node_allocator, tree_stats>::size_type splay_tree<Type, Compare, node_allocator, tree_stats>::height() const {
+        //pre-order walk through parent links. previous node tells whether the walk came from above or from which child.
+        size_type        max_depth = 0U, depth = 0U;
+        node_type const* prev_node = nullptr;
+        node_type const* node      = root;
+        while (node) {
+            node_type const* next_node;
+            if (prev_node == node->parent_node) {
+                max_depth = std::max(max_depth, ++depth);
+                next_node = node->left_node ? node->left_node : node->right_node ? node->right_node : node->parent_node;
+            }
+            else if (prev_node == node->left_node && node->right_node) {
+                next_node = node->right_node;
+            }
+            else {
+                next_node = node->parent_node;
+            }
+            if (next_node == node->parent_node) --depth;
+            prev_node = node;
+            node      = next_node;
+        }
+        return max_depth;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename splay_tree<Type, Compare, node_allocator, tree_stats>::size_type splay_tree<Type, Compare, node_allocator, tree_stats>::depth(Type const & _value) const {
+        //plain descent, so inspecting the shape neither splays nor counts as a search in statistics.
+        size_type  num_level = 0U;
+        node_type* node      = root;
+        while (node) {
+            ++num_level;
+            if (comp(_value, node->value))      node = node->left_node;
+            else if (comp(node->value, _value)) node = node->right_node;
+            else                                return num_level;
+        }
+        return 0U;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    void splay_tree<Type, Compare, node_allocator, tree_stats>::clear() {
+        if (root) _internal_destroy_subtree(root);
+        root     = nullptr;
+        num_node = 0U;
+        _internal_stats().reset_depth(0U);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    std::pair<typename splay_tree<Type, Compare, node_allocator, tree_stats>::iterator, bool> splay_tree<Type, Compare, node_allocator, tree_stats>::insert(Type const & _value) {
+        return _internal_insert(_value);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    std::pair<typename splay_tree<Type, Compare, node_allocator, tree_stats>::iterator, bool> splay_tree<Type, Compare, node_allocator, tree_stats>::insert(Type&& _value) {
+        return _internal_insert(std::move(_value));
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename splay_tree<Type, Compare, node_allocator, tree_stats>::size_type splay_tree<Type, Compare, node_allocator, tree_stats>::remove(Type const & _value) {
+        iterator iter = find(_value);
+        if (iter.node == nullptr) return 0U;
+        _internal_erase_node(iter.node);
+        return 1U;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename splay_tree<Type, Compare, node_allocator, tree_stats>::iterator splay_tree<Type, Compare, node_allocator, tree_stats>::remove(iterator _iter) {
+        if (_iter.tree != this) throw different_tree_exception("different_tree_exception : tree instance and given iterator are mismatched.");
+        if (_iter.node == nullptr) return _iter;
+        iterator next_iter = _iter;
+        ++next_iter;
+        _internal_erase_node(_iter.node);
+        return next_iter;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename splay_tree<Type, Compare, node_allocator, tree_stats>::iterator splay_tree<Type, Compare, node_allocator, tree_stats>::find(Type const & _value) {
+        node_type* last_node;
+        size_type  num_visit;
+        node_type* node = _internal_lower_bound(_value, last_node, num_visit);
+        _internal_stats().record_compare(node ? 1U : 0U);
+        if (node && comp(_value, node->value)) node = nullptr;
+        _internal_access(node ? node : last_node, num_visit);
+        return iterator(node, this);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    bool splay_tree<Type, Compare, node_allocator, tree_stats>::contains(Type const & _value) {
+        return find(_value).node != nullptr;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename splay_tree<Type, Compare, node_allocator, tree_stats>::iterator splay_tree<Type, Compare, node_allocator, tree_stats>::lower_bound(Type const & _value) {
+        node_type* last_node;
+        size_type  num_visit;
+        node_type* node = _internal_lower_bound(_value, last_node, num_visit);
+        _internal_access(node ? node : last_node, num_visit);
+        return iterator(node, this);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    tree_stats_snapshot splay_tree<Type, Compare, node_allocator, tree_stats>::stats() const {
+        return _internal_stats().snapshot();
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    void splay_tree<Type, Compare, node_allocator, tree_stats>::reset_stats() {
+        tree_stats::reset();
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    tree_stats const & splay_tree<Type, Compare, node_allocator, tree_stats>::_internal_stats() const {
+        return *this;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    template <typename Value>
+    std::pair<typename splay_tree<Type, Compare, node_allocator, tree_stats>::iterator, bool> splay_tree<Type, Compare, node_allocator, tree_stats>::_internal_insert(Value&& _value) {
+        node_type* parent_node;
+        size_type  num_visit;
+        node_type* bound_node = _internal_lower_bound(static_cast<Type const &>(_value), parent_node, num_visit);
+        _internal_stats().record_compare(bound_node ? 1U : 0U);
+        if (bound_node && !comp(_value, bound_node->value)) {
+            _internal_access(bound_node, num_visit);
+            return std::make_pair(iterator(bound_node, this), false);
+        }
+
+        node_type* new_node = _internal_create_node(std::forward<Value>(_value));
+        new_node->parent_node = parent_node;
+        if (parent_node == nullptr)                       root                    = new_node;
+        else if (comp(new_node->value, parent_node->value)) parent_node->left_node  = new_node;
+        else                                               parent_node->right_node = new_node;
+        ++num_node;
+        _internal_stats().record_compare(parent_node ? 1U : 0U);
+        _internal_stats().record_insert();
+        LOG("add on", parent_node);
+
+        _internal_access(new_node, num_visit + 1U);
+        return std::make_pair(iterator(new_node, this), true);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename splay_tree<Type, Compare, node_allocator, tree_stats>::node_type* splay_tree<Type, Compare, node_allocator, tree_stats>::_internal_lower_bound(Type const & _value, node_type*& _last_node, size_type& _num_visit) const {
+        node_type* node       = root;
+        node_type* bound_node = nullptr;
+        _last_node = nullptr;
+        for (_num_visit = 0U; node; ++_num_visit) {
+            _last_node = node;
+            bool go_right = comp(node->value, _value);
+            bound_node = go_right ? bound_node : node;
+            node       = go_right ? node->right_node : node->left_node;
+        }
+        _internal_stats().record_search(_num_visit);
+        return bound_node;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    void splay_tree<Type, Compare, node_allocator, tree_stats>::_internal_access(node_type* _node, size_type _path_length) {
+        if (_path_length > _internal_splay_depth()) _internal_semi_splay(_node);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename splay_tree<Type, Compare, node_allocator, tree_stats>::size_type splay_tree<Type, Compare, node_allocator, tree_stats>::_internal_splay_depth() const {
+        size_type num_level = 0U;
+        for (size_type num = num_node; num; num >>= 1U) ++num_level;
+        return num_level + num_level / 4U;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    void splay_tree<Type, Compare, node_allocator, tree_stats>::_internal_splay(node_type* _node) {
+        if (_node == nullptr) return;
+        size_type num_rotation = 0U;
+        while (node_type* parent_node = _node->parent_node) {
+            node_type* grandparent_node = parent_node->parent_node;
+            if (grandparent_node == nullptr) {
+                //zig : parent is the root.
+                _internal_rotate(_node);
+                num_rotation += 1U;
+            }
+            else if ((parent_node->left_node == _node) == (grandparent_node->left_node == parent_node)) {
+                //zig-zig : rotating parent first halves the depth of every node on the access path.
+                _internal_rotate(parent_node);
+                _internal_rotate(_node);
+                num_rotation += 2U;
+            }
+            else {
+                //zig-zag
+                _internal_rotate(_node);
+                _internal_rotate(_node);
+                num_rotation += 2U;
+            }
+        }
+        _internal_stats().record_rotation(num_rotation);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    void splay_tree<Type, Compare, node_allocator, tree_stats>::_internal_semi_splay(node_type* _node) {
+        if (_node == nullptr) return;
+        size_type num_rotation = 0U;
+        while (node_type* parent_node = _node->parent_node) {
+            node_type* grandparent_node = parent_node->parent_node;
+            if (grandparent_node == nullptr) {
+                _internal_rotate(_node);
+                num_rotation += 1U;
+            }
+            else if ((parent_node->left_node == _node) == (grandparent_node->left_node == parent_node)) {
+                //parent takes the place of grandparent, and the walk goes on from there.
+                _internal_rotate(parent_node);
+                _node = parent_node;
+                num_rotation += 1U;
+            }
+            else {
+                _internal_rotate(_node);
+                _internal_rotate(_node);
+                num_rotation += 2U;
+            }
+        }
+        _internal_stats().record_rotation(num_rotation);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    void splay_tree<Type, Compare, node_allocator, tree_stats>::_internal_rotate(node_type* _node) {
+        node_type* parent_node = _node->parent_node;
+        if (parent_node->left_node == _node) {
+            parent_node->left_node = _node->right_node;
+            if (_node->right_node) _node->right_node->parent_node = parent_node;
+            _node->right_node = parent_node;
+        }
+        else {
+            parent_node->right_node = _node->left_node;
+            if (_node->left_node) _node->left_node->parent_node = parent_node;
+            _node->left_node = parent_node;
+        }
+        _internal_replace_child(parent_node->parent_node, parent_node, _node);
+        _node->parent_node       = parent_node->parent_node;
+        parent_node->parent_node = _node;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    void splay_tree<Type, Compare, node_allocator, tree_stats>::_internal_replace_child(node_type* _parent, node_type* _old_node, node_type* _new_node) {
+        if (_parent == nullptr)                   root                = _new_node;
+        else if (_parent->left_node == _old_node) _parent->left_node  = _new_node;
+        else                                      _parent->right_node = _new_node;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    void splay_tree<Type, Compare, node_allocator, tree_stats>::_internal_erase_node(node_type* _node) {
+        _internal_splay(_node);
+        node_type* left_node  = _node->left_node;
+        node_type* right_node = _node->right_node;
+        if (left_node == nullptr) {
+            root = right_node;
+            if (right_node) right_node->parent_node = nullptr;
+        }
+        else {
+            //left sub-tree becomes the tree, and splaying its maximum leaves the new root without right child.
+            root = left_node;
+            left_node->parent_node = nullptr;
+            node_type* max_node = _internal_maximum(left_node);
+            _internal_splay(max_node);
+            max_node->right_node = right_node;
+            if (right_node) right_node->parent_node = max_node;
+        }
+        _internal_destroy_node(_node);
+        --num_node;
+        _internal_stats().record_remove();
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename splay_tree<Type, Compare, node_allocator, tree_stats>::node_type* splay_tree<Type, Compare, node_allocator, tree_stats>::_internal_copy(node_type const* _source) {
+        if (_source == nullptr) return nullptr;
+        node_type* copy_root = _internal_create_node(_source->value);
+        try {
+            //walk source and copy in lockstep. child of the copy which is still missing tells which side is next.
+            node_type const* source = _source;
+            node_type*       copy   = copy_root;
+            while (true) {
+                node_type const* source_child;
+                if (source->left_node && !copy->left_node)        source_child = source->left_node;
+                else if (source->right_node && !copy->right_node) source_child = source->right_node;
+                else {
+                    if (source == _source) break;
+                    source = source->parent_node;
+                    copy   = copy->parent_node;
+                    continue;
+                }
+                node_type* copy_child = _internal_create_node(source_child->value);
+                copy_child->parent_node = copy;
+                (source_child == source->left_node ? copy->left_node : copy->right_node) = copy_child;
+                source = source_child;
+                copy   = copy_child;
+            }
+        }
+        catch (...) {
+            _internal_destroy_subtree(copy_root);
+            throw;
+        }
+        return copy_root;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    void splay_tree<Type, Compare, node_allocator, tree_stats>::_internal_destroy_subtree(node_type* _root) {
+        //descend to a leaf, destroy it and cut it from its parent, which may become a leaf in turn.
+        node_type* node = _root;
+        while (node) {
+            if (node->left_node) {
+                node = node->left_node;
+            }
+            else if (node->right_node) {
+                node = node->right_node;
+            }
+            else {
+                node_type* parent_node = node == _root ? nullptr : node->parent_node;
+                if (parent_node) (parent_node->left_node == node ? parent_node->left_node : parent_node->right_node) = nullptr;
+                _internal_destroy_node(node);
+                node = parent_node;
+            }
+        }
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    template <typename... Args>
+    typename splay_tree<Type, Compare, node_allocator, tree_stats>::node_type* splay_tree<Type, Compare, node_allocator, tree_stats>::_internal_create_node(Args&&... _args) {
+        node_type* new_node = alloc.allocate(1);
+        try {
+            alloc.construct(new_node, std::forward<Args>(_args)...);
+        }
+        catch (...) {
+            alloc.deallocate(new_node, 1);
+            throw;
+        }
+        _internal_stats().record_alloc_call();
+        _internal_stats().record_alloc(1U);
+        return new_node;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    void splay_tree<Type, Compare, node_allocator, tree_stats>::_internal_destroy_node(node_type* _node) {
+        LOG("del", _node);
+        alloc.destroy(_node);
+        alloc.deallocate(_node, 1);
+        _internal_stats().record_free(1U);
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename splay_tree<Type, Compare, node_allocator, tree_stats>::node_type* splay_tree<Type, Compare, node_allocator, tree_stats>::_internal_minimum(node_type* _node) {
+        while (_node->left_node) _node = _node->left_node;
+        return _node;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename splay_tree<Type, Compare, node_allocator, tree_stats>::node_type* splay_tree<Type, Compare, node_allocator, tree_stats>::_internal_maximum(node_type* _node) {
+        while (_node->right_node) _node = _node->right_node;
+        return _node;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    splay_tree<Type, Compare, node_allocator, tree_stats>::iterator::iterator(node_type* _node, splay_tree const * _tree) : node(_node), tree(_tree) { }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    Type const& splay_tree<Type, Compare, node_allocator, tree_stats>::iterator::operator*() const {
+        return node->value;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    Type const* splay_tree<Type, Compare, node_allocator, tree_stats>::iterator::operator->() const {
+        return &node->value;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    bool splay_tree<Type, Compare, node_allocator, tree_stats>::iterator::operator==(iterator const & _iter) const {
+        return node == _iter.node;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    bool splay_tree<Type, Compare, node_allocator, tree_stats>::iterator::operator!=(iterator const & _iter) const {
+        return node != _iter.node;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename splay_tree<Type, Compare, node_allocator, tree_stats>::iterator& splay_tree<Type, Compare, node_allocator, tree_stats>::iterator::operator++() {
+        if (node->right_node) {
+            node = _internal_minimum(node->right_node);
+        }
+        else {
+            node_type* parent_node = node->parent_node;
+            while (parent_node && node == parent_node->right_node) {
+                node        = parent_node;
+                parent_node = parent_node->parent_node;
+            }
+            node = parent_node;
+        }
+        return *this;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename splay_tree<Type, Compare, node_allocator, tree_stats>::iterator splay_tree<Type, Compare, node_allocator, tree_stats>::iterator::operator++(int) {
+        iterator ret_iter = *this;
+        ++(*this);
+        return ret_iter;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename splay_tree<Type, Compare, node_allocator, tree_stats>::iterator& splay_tree<Type, Compare, node_allocator, tree_stats>::iterator::operator--() {
+        if (node == nullptr) {
+            node = tree->root ? _internal_maximum(tree->root) : nullptr;
+        }
+        else if (node->left_node) {
+            node = _internal_maximum(node->left_node);
+        }
+        else {
+            node_type* parent_node = node->parent_node;
+            while (parent_node && node == parent_node->left_node) {
+                node        = parent_node;
+                parent_node = parent_node->parent_node;
+            }
+            node = parent_node;
+        }
+        return *this;
+    }
+
+    template <typename Type, typename Compare, class node_allocator, class tree_stats>
+    typename splay_tree<Type, Compare, node_allocator, tree_stats>::iterator splay_tree<Type, Compare, node_allocator, tree_stats>::iterator::operator--(int) {
+        iterator ret_iter = *this;
+        --(*this);
+        return ret_iter;
+    }
+}
+
+#endif
@@ -0,0 +1,390 @@
+#ifndef STATIC_SEARCH_TREE_HPP
+#define STATIC_SEARCH_TREE_HPP
+
+/**
+* @file      static_search_tree.hpp
+* @author    snowapril
+* @date      2026-10-17 (ongoing)
+* @brief     immutable search tree stored in implicit Eytzinger layout.
+* @details   header only read-only companion of binary_search_tree. built once from a tree or sorted range,
+             keys are stored in one contiguous array in breadth-first order (children of k are 2k and 2k + 1),
+             so top levels share few cache lines and descent needs no pointer chasing.
+             descent prefetches the cache line holding descendants several levels below current node.
+             find_batch runs descents of a group of keys in lockstep, so prefetches of the group overlap.
+             provide bidirectional in-order iterator which computes successor from array index.
+* @see
+* @reference Khuong and Morin, "Array Layouts for Comparison-Based Searching", 2017.
+*/
+
+#include <algorithm>
+#include <functional>
+#include <iterator>
+#include <type_traits>
+#include <vector>
+#include "bst.hpp"
+#include "tree_util.hpp"
+
+namespace snowapril {
+
+    template <typename Type, typename Compare>
+    class mapped_search_tree;
+
+    template <typename Type, typename Compare = std::less<Type>>
+    class static_search_tree {
+        friend class mapped_search_tree<Type, Compare>;
+    public:
+        using value_type      = Type;
+        using key_compare     = Compare;
+        using pointer         = Type const*;
+        using reference       = Type const&;
+        using size_type       = size_t;
+        using difference_type = ptrdiff_t;
+        class iterator;
+        using const_iterator   = iterator;
+        using reverse_iterator = std::reverse_iterator<iterator>;
+        //the number of elements which fit in one cache line. prefetching index k * stride touches descendants log2(stride) levels below k.
+        static constexpr size_type prefetch_stride = (64U / sizeof(Type)) ? (64U / sizeof(Type)) : 1U;
+
+        static_search_tree() = default; // default constructor
+        template <typename Alloc, typename Stats>
+        explicit static_search_tree(binary_search_tree<Type, Compare, Alloc, Stats> const &); // snapshot of binary_search_tree
+        template <typename GenericIterator>
+        static_search_tree(GenericIterator, GenericIterator, Compare const & = Compare()); // constructor with range, sorted if not already. equivalent elements are kept once
+        template <typename GenericIterator>
+        static_search_tree(sorted_input_t, GenericIterator, GenericIterator, Compare const & = Compare()); // constructor with sorted range
+        //copy of a tree owning its array copies the array. copy of a read-only view copies only the view pointer and
+        //is valid while the viewed array lives. views are only made by mapped_search_tree, which cannot be copied.
+        static_search_tree(static_search_tree<Type, Compare> const &) = default; // copy constructor
+        static_search_tree<Type, Compare> & operator=(static_search_tree<Type, Compare> const &) = default; // copy assignment operator
+        static_search_tree(static_search_tree<Type, Compare> &&) = default; // move constructor
+        static_search_tree<Type, Compare> & operator=(static_search_tree<Type, Compare> &&) = default; // move assignment operator
+        ~static_search_tree() = default; // destructor
+
+            class iterator {
+                friend class static_search_tree<Type, Compare>;
+            public:
+                using iterator_category = std::bidirectional_iterator_tag;
+                using value_type        = Type;
+                using pointer           = Type const*;
+                using reference         = Type const&;
+                using difference_type   = ptrdiff_t;
+            public:
+                iterator() = default;
+                iterator(size_type, static_search_tree const *);
+                Type const& operator*()     const;
+                Type const* operator->()    const;
+                bool        operator==(iterator const &) const;
+                bool        operator!=(iterator const &) const;
+                //move to in-order successor.
+                iterator&   operator++();
+                iterator    operator++(int);
+                //move to in-order predecessor. decrementing end() gives the largest element.
+                iterator&   operator--();
+                iterator    operator--(int);
+                //return position of element in Eytzinger array. (1-based, 0 means end)
+                size_type   index() const;
+            private:
+                size_type                 slot = 0U;
+                static_search_tree const *tree = nullptr;
+            };
+        public:
+            //return whether if tree is empty.
+            bool                empty() const;
+            //return the number of elements in this tree.
+            size_type           size() const;
+            iterator            begin() const;
+            iterator            end() const;
+            reverse_iterator    rbegin() const;
+            reverse_iterator    rend() const;
+            //return pointer to Eytzinger array. element of index k is at data()[k], data()[0] is unused.
+            //the array may be owned by this tree or be a read-only view of memory mapped file.
+            Type const*         data() const;
+            //lookup methods accept any key type if Compare is transparent, otherwise key is converted to Type.
+            template <typename Key = Type>
+            iterator            find(Key const &) const;
+            template <typename Key = Type>
+            bool                contains(Key const &) const;
+            //return iterator of the first element not less than given key.
+            template <typename Key = Type>
+            iterator            lower_bound(Key const &) const;
+            //return iterator of the first element greater than given key.
+            template <typename Key = Type>
+            iterator            upper_bound(Key const &) const;
+            //batched find over forward range of keys. write result of find for each key to given output iterator,
+            //in key order, and return the output iterator past the last result. descents of batch_lookup_width keys
+            //run in lockstep, so their prefetches and cache misses overlap.
+            template <typename KeyIterator, typename OutputIterator>
+            OutputIterator      find_batch(KeyIterator, KeyIterator, OutputIterator) const;
+        private:
+            //read-only view of Eytzinger array owned by someone else. (num_node + 1 elements)
+            static_search_tree(Type const*, size_type, Compare const &);
+            template <typename Key>
+            using lookup_key_t = typename std::conditional<is_transparent_compare_<Compare>::value, Key, Type>::type;
+            //copy given number of sorted elements into Eytzinger array by in-order walk over implicit tree.
+            template <typename GenericIterator>
+            void _internal_fill(GenericIterator, size_type);
+            //return index of the first element for which given predicate is false, 0 if every element satisfies it.
+            template <typename Predicate>
+            size_type _internal_descend(Predicate) const;
+            //return index of the element where descent, which ended at given slot past the leaves, turned left last.
+            static size_type _internal_last_left_turn(size_type);
+            static size_type _internal_leftmost(size_type, size_type);
+            static size_type _internal_rightmost(size_type, size_type);
+        private:
+            Compare           comp;
+            std::vector<Type> slots; // slots[0] is dummy so that children of k are 2k and 2k + 1.
+            Type const*       view     = nullptr; // external array, used while slots is empty
+            size_type         num_node = 0U;
+    };
+
+    template <typename Type, typename Compare>
+    template <typename Alloc, typename Stats>
+    static_search_tree<Type, Compare>::static_search_tree(binary_search_tree<Type, Compare, Alloc, Stats> const & _tree) : comp(_tree.key_comp()) {
+        _internal_fill(_tree.begin(), _tree.size());
+    }
+
+    template <typename Type, typename Compare>
+    template <typename GenericIterator>
+    static_search_tree<Type, Compare>::static_search_tree(GenericIterator _begin_iter, GenericIterator _end_iter, Compare const & _comp) : comp(_comp) {
+        std::vector<Type> sorted(_begin_iter, _end_iter);
+        if (!std::is_sorted(sorted.begin(), sorted.end(), comp)) {
+            std::sort(sorted.begin(), sorted.end(), comp);
+        }
+        //lookups assume unique keys like binary_search_tree, so only the first of equivalent elements is kept.
+        sorted.erase(std::unique(sorted.begin(), sorted.end(), [this](Type const & _lhs, Type const & _rhs) {
+            return !comp(_lhs, _rhs) && !comp(_rhs, _lhs);
+        }), sorted.end());
+        _internal_fill(sorted.begin(), sorted.size());
+    }
+
+    template <typename Type, typename Compare>
+    template <typename GenericIterator>
+    static_search_tree<Type, Compare>::static_search_tree(sorted_input_t, GenericIterator _begin_iter, GenericIterator _end_iter, Compare const & _comp) : comp(_comp) {
+        _internal_fill(_begin_iter, static_cast<size_type>(std::distance(_begin_iter, _end_iter)));
+    }
+
+    template <typename Type, typename Compare>
+    static_search_tree<Type, Compare>::static_search_tree(Type const* _slots, size_type _num_node, Compare const & _comp) : comp(_comp), view(_slots), num_node(_num_node) { }
+
+    template <typename Type, typename Compare>
+    bool static_search_tree<Type, Compare>::empty() const {
+        return num_node == 0U;
+    }
+
+    template <typename Type, typename Compare>
+    typename static_search_tree<Type, Compare>::size_type static_search_tree<Type, Compare>::size() const {
+        return num_node;
+    }
+
+    template <typename Type, typename Compare>
+    typename static_search_tree<Type, Compare>::iterator static_search_tree<Type, Compare>::begin() const {
+        return iterator(num_node ? _internal_leftmost(1U, num_node) : 0U, this);
+    }
+
+    template <typename Type, typename Compare>
+    typename static_search_tree<Type, Compare>::iterator static_search_tree<Type, Compare>::end() const {
+        return iterator(0U, this);
+    }
+
+    template <typename Type, typename Compare>
+    typename static_search_tree<Type, Compare>::reverse_iterator static_search_tree<Type, Compare>::rbegin() const {
+        return reverse_iterator(end());
+    }
+
+    template <typename Type, typename Compare>
+    typename static_search_tree<Type, Compare>::reverse_iterator static_search_tree<Type, Compare>::rend() const {
+        return reverse_iterator(begin());
+    }
+
+    template <typename Type, typename Compare>
+    Type const* static_search_tree<Type, Compare>::data() const {
+        return slots.empty() ? view : slots.data();
+    }
+
+    template <typename Type, typename Compare>
+    template <typename Key>
+    typename static_search_tree<Type, Compare>::iterator static_search_tree<Type, Compare>::find(Key const & _key) const {
+        lookup_key_t<Key> const & key = _key;
+        size_type slot = _internal_descend([this, &key](Type const & _value) { return comp(_value, key); });
+        if (slot && comp(key, data()[slot])) slot = 0U;
+        return iterator(slot, this);
+    }
+
+    template <typename Type, typename Compare>
+    template <typename Key>
+    bool static_search_tree<Type, Compare>::contains(Key const & _key) const {
+        return find(_key).slot != 0U;
+    }
+
+    template <typename Type, typename Compare>
+    template <typename Key>
+    typename static_search_tree<Type, Compare>::iterator static_search_tree<Type, Compare>::lower_bound(Key const & _key) const {
+        lookup_key_t<Key> const & key = _key;
+        return iterator(_internal_descend([this, &key](Type const & _value) { return comp(_value, key); }), this);
+    }
+
+    template <typename Type, typename Compare>
+    template <typename Key>
+    typename static_search_tree<Type, Compare>::iterator static_search_tree<Type, Compare>::upper_bound(Key const & _key) const {
+        lookup_key_t<Key> const & key = _key;
+        return iterator(_internal_descend([this, &key](Type const & _value) { return !comp(key, _value); }), this);
+    }
+
+    template <typename Type, typename Compare>
+    template <typename KeyIterator, typename OutputIterator>
+    OutputIterator static_search_tree<Type, Compare>::find_batch(KeyIterator _begin_iter, KeyIterator _end_iter, OutputIterator _out_iter) const {
+        using key_type = lookup_key_t<typename std::iterator_traits<KeyIterator>::value_type>;
+        Type const* base = data();
+        KeyIterator keys[batch_lookup_width];
+        size_type   slots_of_lane[batch_lookup_width];
+        while (_begin_iter != _end_iter) {
+            size_type num_lane = 0U;
+            for (; num_lane < batch_lookup_width && _begin_iter != _end_iter; ++num_lane, ++_begin_iter) {
+                keys[num_lane]          = _begin_iter;
+                slots_of_lane[num_lane] = 1U;
+            }
+            //every descent has floor(log2(n)) or one more levels, so rounds go on while any lane is above the leaves.
+            for (bool active = num_node != 0U; active; ) {
+                active = false;
+                for (size_type lane = 0U; lane < num_lane; ++lane) {
+                    size_type slot = slots_of_lane[lane];
+                    if (slot > num_node) continue;
+                    TREE_PREFETCH(base + slot * prefetch_stride);
+                    key_type const & key = *keys[lane];
+                    slot = 2U * slot + static_cast<size_type>(comp(base[slot], key));
+                    slots_of_lane[lane] = slot;
+                    active = active || slot <= num_node;
+                }
+            }
+            for (size_type lane = 0U; lane < num_lane; ++lane) {
+                key_type const & key  = *keys[lane];
+                size_type        slot = _internal_last_left_turn(slots_of_lane[lane]);
+                if (slot && comp(key, base[slot])) slot = 0U;
+                *_out_iter++ = iterator(slot, this);
+            }
+        }
+        return _out_iter;
+    }
+
+    template <typename Type, typename Compare>
+    template <typename GenericIterator>
+    void static_search_tree<Type, Compare>::_internal_fill(GenericIterator _begin_iter, size_type _num_node) {
+        num_node = _num_node;
+        slots.assign(num_node + 1U, Type());
+        if (num_node == 0U) return;
+
+        iterator iter(_internal_leftmost(1U, num_node), this);
+        for (size_type i = 0U; i < num_node; ++i, ++iter, ++_begin_iter) {
+            slots[iter.slot] = *_begin_iter;
+        }
+    }
+
+    template <typename Type, typename Compare>
+    template <typename Predicate>
+    typename static_search_tree<Type, Compare>::size_type static_search_tree<Type, Compare>::_internal_descend(Predicate _go_right) const {
+        Type const* base = data();
+        size_type   slot = 1U;
+        while (slot <= num_node) {
+            TREE_PREFETCH(base + slot * prefetch_stride);
+            slot = 2U * slot + static_cast<size_type>(_go_right(base[slot]));
+        }
+        return _internal_last_left_turn(slot);
+    }
+
+    template <typename Type, typename Compare>
+    typename static_search_tree<Type, Compare>::size_type static_search_tree<Type, Compare>::_internal_last_left_turn(size_type _slot) {
+        //trailing one bits are the right turns taken after the last left turn. strip them and the left turn itself.
+#if defined(__GNUC__) || defined(__clang__)
+        _slot >>= __builtin_ctzll(~static_cast<unsigned long long>(_slot)) + 1;
+#else
+        while (_slot & 1U) _slot >>= 1U;
+        _slot >>= 1U;
+#endif
+        return _slot;
+    }
+
+    template <typename Type, typename Compare>
+    typename static_search_tree<Type, Compare>::size_type static_search_tree<Type, Compare>::_internal_leftmost(size_type _slot, size_type _num_node) {
+        while (2U * _slot <= _num_node) _slot = 2U * _slot;
+        return _slot;
+    }
+
+    template <typename Type, typename Compare>
+    typename static_search_tree<Type, Compare>::size_type static_search_tree<Type, Compare>::_internal_rightmost(size_type _slot, size_type _num_node) {
+        while (2U * _slot + 1U <= _num_node) _slot = 2U * _slot + 1U;
+        return _slot;
+    }
+
+    template <typename Type, typename Compare>
+    static_search_tree<Type, Compare>::iterator::iterator(size_type _slot, static_search_tree const * _tree) : slot(_slot), tree(_tree) { }
+
+    template <typename Type, typename Compare>
+    Type const& static_search_tree<Type, Compare>::iterator::operator*() const {
+        return tree->data()[slot];
+    }
+
+    template <typename Type, typename Compare>
+    Type const* static_search_tree<Type, Compare>::iterator::operator->() const {
+        return tree->data() + slot;
+    }
+
+    template <typename Type, typename Compare>
+    bool static_search_tree<Type, Compare>::iterator::operator==(iterator const & _iter) const {
+        return slot == _iter.slot;
+    }
+
+    template <typename Type, typename Compare>
+    bool static_search_tree<Type, Compare>::iterator::operator!=(iterator const & _iter) const {
+        return slot != _iter.slot;
+    }
+
+    template <typename Type, typename Compare>
+    typename static_search_tree<Type, Compare>::iterator& static_search_tree<Type, Compare>::iterator::operator++() {
+        if (2U * slot + 1U <= tree->num_node) {
+            slot = _internal_leftmost(2U * slot + 1U, tree->num_node);
+        }
+        else {
+            //climb while current slot is right child, then once more to its parent.
+            while (slot & 1U) slot >>= 1U;
+            slot >>= 1U;
+        }
+        return *this;
+    }
+
+    template <typename Type, typename Compare>
+    typename static_search_tree<Type, Compare>::iterator static_search_tree<Type, Compare>::iterator::operator++(int) {
+        iterator ret_iter = *this;
+        ++(*this);
+        return ret_iter;
+    }
+
+    template <typename Type, typename Compare>
+    typename static_search_tree<Type, Compare>::iterator& static_search_tree<Type, Compare>::iterator::operator--() {
+        if (slot == 0U) {
+            slot = tree->num_node ? _internal_rightmost(1U, tree->num_node) : 0U;
+        }
+        else if (2U * slot <= tree->num_node) {
+            slot = _internal_rightmost(2U * slot, tree->num_node);
+        }
+        else {
+            //climb while current slot is left child, then once more to its parent.
+            while (slot > 1U && !(slot & 1U)) slot >>= 1U;
+            slot >>= 1U;
+        }
+        return *this;
+    }
+
+    template <typename Type, typename Compare>
+    typename static_search_tree<Type, Compare>::iterator static_search_tree<Type, Compare>::iterator::operator--(int) {
+        iterator ret_iter = *this;
+        --(*this);
+        return ret_iter;
+    }
+
+    template <typename Type, typename Compare>
+    typename static_search_tree<Type, Compare>::size_type static_search_tree<Type, Compare>::iterator::index() const {
+        return slot;
+    }
+}
+
+#endif
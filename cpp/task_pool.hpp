@@ -0,0 +1,269 @@
+#ifndef TASK_POOL_HPP
+#define TASK_POOL_HPP
+
+/**
+* @file      task_pool.hpp
+* @author    snowapril
+* @date      2026-10-17
+* @brief     work stealing fork-join task pool for parallel tree operations.
+* @details   header only. every worker owns a deque. forked task is pushed to the bottom of the deque of forking
+             thread, owner pops from the bottom (latest, cache hot subtree first) and idle workers steal from the top
+             (oldest, largest subtree first). thread which waits for stolen task first steals back from the thief,
+             whose deque holds pieces of that very task (leapfrogging), then runs any other task, and sleeps only
+             when there is no task at all, so nested fork-join never spins. threads outside of the pool share one
+             extra deque. tasks live on the stack of forking thread and deques are fixed size rings, so forking
+             allocates nothing. fork into a full ring runs both functions in place instead.
+             sleeping threads are counted, so push and completion skip the sleep lock while every thread is busy.
+* @see       bst.hpp
+* @reference Blumofe, Leiserson, "Scheduling multithreaded computations by work stealing", 1999
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <array>
+#include <cstddef>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "tree_util.hpp"
+
+namespace snowapril {
+
+    class task_pool {
+    public:
+        //construct pool with given number of worker threads. calling thread also runs tasks while it waits,
+        //so hardware_concurrency() - 1 workers keep every core busy.
+        explicit task_pool(size_t = std::max(1U, std::thread::hardware_concurrency()) - 1U);
+        task_pool(task_pool const &) = delete;
+        task_pool & operator=(task_pool const &) = delete;
+        ~task_pool(); // destructor. joins every worker.
+
+        //return the number of threads which can run tasks at once, including the caller.
+        size_t  concurrency() const;
+        //run both functions, possibly in parallel, and return after both finished.
+        //exception from either function is rethrown after both finished.
+        template <typename Left, typename Right>
+        void    invoke(Left&&, Right&&);
+        //call given function with every index range [begin, end) split into chunks not smaller than grain size.
+        template <typename Function>
+        void    parallel_for(size_t, size_t, size_t, Function&&);
+    private:
+        static constexpr size_t queue_capacity = 512U; // forked tasks one deque holds. power of two
+        static constexpr size_t no_thief       = static_cast<size_t>(-1);
+        struct task_ {
+            virtual void run() = 0;
+            std::atomic<bool>   done  { false };
+            std::atomic<size_t> thief { no_thief };  // deque index of thread which stole this task
+        protected:
+            ~task_() = default;
+        };
+        template <typename Function>
+        struct function_task_ : task_ {
+            explicit function_task_(Function& _func) : func(_func) { }
+            void run() override {
+                try                { func(); }
+                catch (...)        { error = std::current_exception(); }
+                //sequentially consistent, pairs with sleeping count in _internal_wake_waiters.
+                this->done.store(true, std::memory_order_seq_cst);
+            }
+            Function&          func;
+            std::exception_ptr error;
+        };
+        //ring of forked tasks. owner pushes and pops at bottom, thieves take from top.
+        struct alignas(64) worker_queue_ {
+            std::mutex                             lock;
+            std::array<task_*, queue_capacity>     tasks;
+            size_t                                 top    = 0U;
+            size_t                                 bottom = 0U;
+        };
+        //return deque index of calling thread. threads outside of this pool get the shared one.
+        size_t  _internal_queue_index() const;
+        //return false if the deque is full, then caller runs the task itself.
+        bool    _internal_push(size_t, task_*);
+        task_*  _internal_pop(size_t);
+        //steal from given victim first (no_thief for none), then from the other deques.
+        task_*  _internal_steal(size_t, size_t);
+        //run one pending task if there is any, stealing from given victim first. return false if every deque was empty.
+        bool    _internal_run_one(size_t, size_t = no_thief);
+        //sleep until a task is pushed, the pool stops, or given predicate holds.
+        template <typename Predicate>
+        void    _internal_sleep(Predicate&&);
+        //wake sleeping threads, if any, so waiter of finished task or idle worker rechecks its predicate.
+        void    _internal_wake_waiters(bool);
+        void    _internal_worker_loop(size_t);
+    private:
+        std::vector<std::thread>   workers;
+        std::vector<worker_queue_> queues;       // one per worker, and one shared by outside threads
+        std::atomic<size_t>        num_pending  { 0U };
+        std::atomic<size_t>        num_sleeping { 0U };
+        std::atomic<bool>          stopping     { false };
+        std::mutex                 sleep_lock;
+        std::condition_variable    sleep_cond;
+    };
+
+    namespace detail_ {
+        //pool and deque index of calling worker thread. (nullptr for threads outside of every pool)
+        struct task_pool_worker_ {
+            void const* pool  = nullptr;
+            size_t      index = 0U;
+        };
+        inline task_pool_worker_& current_task_pool_worker_() {
+            static thread_local task_pool_worker_ worker;
+            return worker;
+        }
+    }
+
+    inline task_pool::task_pool(size_t _num_workers) : queues(_num_workers + 1U) {
+        workers.reserve(_num_workers);
+        for (size_t i = 0U; i < _num_workers; ++i) {
+            workers.emplace_back([this, i] { _internal_worker_loop(i); });
+        }
+    }
+
+    inline task_pool::~task_pool() {
+        {
+            std::lock_guard<std::mutex> guard(sleep_lock);
+            stopping.store(true, std::memory_order_release);
+        }
+        sleep_cond.notify_all();
+        for (std::thread& worker : workers) {
+            worker.join();
+        }
+    }
+
+    inline size_t task_pool::concurrency() const {
+        return workers.size() + 1U;
+    }
+
+    template <typename Left, typename Right>
+    void task_pool::invoke(Left&& _left, Right&& _right) {
+        if (workers.empty()) {
+            _left();
+            _right();
+            return;
+        }
+        size_t                  index = _internal_queue_index();
+        function_task_<Right>   right_task(_right);
+        if (!_internal_push(index, &right_task)) {
+            //deque is full, which takes forks nested deeper than any balanced tree. fork degrades into plain calls.
+            _left();
+            _right();
+            return;
+        }
+
+        std::exception_ptr left_error;
+        try         { _left(); }
+        catch (...) { left_error = std::current_exception(); }
+
+        //run right task here if nobody stole it, otherwise help the thief with pieces of it, then with any task,
+        //and sleep only when there is nothing to run.
+        while (!right_task.done.load(std::memory_order_acquire)) {
+            if (_internal_run_one(index, right_task.thief.load(std::memory_order_relaxed))) continue;
+            _internal_sleep([&right_task] { return right_task.done.load(std::memory_order_seq_cst); });
+        }
+        if (left_error)       std::rethrow_exception(left_error);
+        if (right_task.error) std::rethrow_exception(right_task.error);
+    }
+
+    template <typename Function>
+    void task_pool::parallel_for(size_t _begin, size_t _end, size_t _grain, Function&& _func) {
+        if (_end - _begin <= std::max<size_t>(_grain, 1U)) {
+            if (_begin < _end) _func(_begin, _end);
+            return;
+        }
+        size_t middle = _begin + (_end - _begin) / 2U;
+        invoke([&] { parallel_for(_begin, middle, _grain, _func); },
+               [&] { parallel_for(middle, _end, _grain, _func); });
+    }
+
+    inline size_t task_pool::_internal_queue_index() const {
+        detail_::task_pool_worker_ const & worker = detail_::current_task_pool_worker_();
+        return worker.pool == this ? worker.index : workers.size();
+    }
+
+    inline bool task_pool::_internal_push(size_t _index, task_* _task) {
+        {
+            worker_queue_& queue = queues[_index];
+            std::lock_guard<std::mutex> guard(queue.lock);
+            if (queue.bottom - queue.top == queue_capacity) return false;
+            queue.tasks[queue.bottom % queue_capacity] = _task;
+            ++queue.bottom;
+        }
+        num_pending.fetch_add(1U, std::memory_order_seq_cst);
+        _internal_wake_waiters(false);
+        return true;
+    }
+
+    inline task_pool::task_* task_pool::_internal_pop(size_t _index) {
+        worker_queue_& queue = queues[_index];
+        std::lock_guard<std::mutex> guard(queue.lock);
+        if (queue.bottom == queue.top) return nullptr;
+        --queue.bottom;
+        return queue.tasks[queue.bottom % queue_capacity];
+    }
+
+    inline task_pool::task_* task_pool::_internal_steal(size_t _index, size_t _victim) {
+        //preferred victim first, then start from the neighbour so thieves spread over victims.
+        for (size_t offset = 0U; offset < queues.size(); ++offset) {
+            size_t victim_index = offset == 0U ? _victim : (_index + offset) % queues.size();
+            if (victim_index == no_thief || (offset != 0U && victim_index == _victim)) continue;
+            worker_queue_& victim = queues[victim_index];
+            std::lock_guard<std::mutex> guard(victim.lock);
+            if (victim.bottom == victim.top) continue;
+            task_* task = victim.tasks[victim.top % queue_capacity];
+            ++victim.top;
+            task->thief.store(_index, std::memory_order_relaxed);
+            return task;
+        }
+        return nullptr;
+    }
+
+    inline bool task_pool::_internal_run_one(size_t _index, size_t _victim) {
+        if (num_pending.load(std::memory_order_acquire) == 0U) return false;
+        task_* task = _internal_pop(_index);
+        //outside threads share one deque, so popping from it may take the task of another thread as well.
+        bool   foreign = task == nullptr || _index == workers.size();
+        if (task == nullptr) task = _internal_steal(_index, _victim);
+        if (task == nullptr) return false;
+        num_pending.fetch_sub(1U, std::memory_order_relaxed);
+        task->run();
+        //only task run by other thread than its forking one may have a waiter asleep.
+        if (foreign) _internal_wake_waiters(true);
+        return true;
+    }
+
+    template <typename Predicate>
+    void task_pool::_internal_sleep(Predicate&& _pred) {
+        std::unique_lock<std::mutex> guard(sleep_lock);
+        //counted before the predicate check, and both are sequentially consistent, so either waker sees
+        //this sleeper or this check sees what the waker published.
+        num_sleeping.fetch_add(1U, std::memory_order_seq_cst);
+        sleep_cond.wait(guard, [&] {
+            return stopping.load(std::memory_order_acquire) || num_pending.load(std::memory_order_seq_cst) != 0U || _pred();
+        });
+        num_sleeping.fetch_sub(1U, std::memory_order_relaxed);
+    }
+
+    inline void task_pool::_internal_wake_waiters(bool _all) {
+        if (num_sleeping.load(std::memory_order_seq_cst) == 0U) return;
+        //taking sleep lock orders this wake against predicate check of thread which is about to sleep.
+        { std::lock_guard<std::mutex> guard(sleep_lock); }
+        //new task may go to any idle worker, but finished task must reach its own waiter among the sleepers.
+        if (_all) sleep_cond.notify_all();
+        else      sleep_cond.notify_one();
+    }
+
+    inline void task_pool::_internal_worker_loop(size_t _index) {
+        detail_::current_task_pool_worker_() = detail_::task_pool_worker_{ this, _index };
+        while (true) {
+            if (_internal_run_one(_index)) continue;
+            _internal_sleep([] { return false; });
+            if (stopping.load(std::memory_order_acquire)) return;
+        }
+    }
+}
+
+#endif
@@ -0,0 +1,119 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <set>
+#include <stdexcept>
+#include <vector>
+#include "ordered_set_check.hpp"
+#include "../bplus_tree.hpp"
+#include "../tree_stats.hpp"
+
+//differential test of bplus_tree against std::set.
+//usage : bplus_tree_test [num_steps]
+//random insert, remove and lookup sequences are compared with std::set (see ordered_set_check.hpp) for every key type
+//with a SIMD in-node search, and for a comparator which takes the scalar fallback. copy of a tree whose key copy
+//throws midway must leave the source untouched and release every node it made. counting statistics policy must see
+//splits while the tree grows and merges while it shrinks, and free every node it allocated.
+//exit code is non zero on the first mismatch.
+
+using namespace snowapril;
+using namespace snowapril::test;
+
+//not std::less, so in-node search falls back to binary search.
+struct scalar_less {
+    bool operator()(int _lhs, int _rhs) const { return _lhs < _rhs; }
+};
+
+//key whose copy assignment throws after a given number of copies. nodes store keys in plain arrays,
+//so copy goes through assignment.
+struct throwing_key {
+    static int countdown;
+    throwing_key() = default;
+    throwing_key(int _value) : value(_value) { }
+    throwing_key(throwing_key const &) = default;
+    throwing_key& operator=(throwing_key const & _other) {
+        if (countdown >= 0 && countdown-- == 0) throw std::runtime_error("throwing_key");
+        value = _other.value;
+        return *this;
+    }
+    bool operator<(throwing_key const & _other) const { return value < _other.value; }
+    int value = 0;
+};
+int throwing_key::countdown = -1;
+
+void run_throwing_copy(size_t _num_value) {
+    begin_case("bplus_tree/throwing_copy", 0U);
+    bplus_tree<throwing_key> source;
+    for (size_t i = 0U; i < _num_value; ++i) {
+        source.insert(throwing_key(static_cast<int>(i * 7U % _num_value)));
+    }
+    for (int at : { 0, 1, static_cast<int>(_num_value / 2U), static_cast<int>(_num_value) - 1 }) {
+        current_context().step = static_cast<size_t>(at);
+        bool thrown = false;
+        throwing_key::countdown = at;
+        try         { bplus_tree<throwing_key> copy(source); }
+        catch (std::runtime_error const &) { thrown = true; }
+        TREE_CHECK(thrown);
+
+        //assignment copies first, so a failed copy keeps the old contents of the target.
+        bplus_tree<throwing_key> target { throwing_key(-1) };
+        thrown = false;
+        throwing_key::countdown = at;
+        try         { target = source; }
+        catch (std::runtime_error const &) { thrown = true; }
+        TREE_CHECK(thrown && target.size() == 1U && target.begin()->value == -1);
+        throwing_key::countdown = -1;
+    }
+    bplus_tree<throwing_key> copy(source);
+    TREE_CHECK(copy.size() == _num_value && source.size() == _num_value);
+    int expected = 0;
+    for (throwing_key const & key : copy) {
+        TREE_CHECK(key.value == expected++);
+    }
+}
+
+void run_stats(size_t _num_value) {
+    using counting_tree = bplus_tree<int, std::less<int>, std::allocator<int>, counting_tree_stats_>;
+    static_assert(sizeof(bplus_tree<int>) < sizeof(counting_tree), "disabled statistics must not take space");
+    run_mutable_suite<counting_tree>("bplus_tree/counting_tree_stats_", _num_value);
+    begin_case("bplus_tree/stats", 0U);
+
+    counting_tree tree;
+    for (size_t i = 0U; i < _num_value; ++i) {
+        tree.insert(static_cast<int>(i * 7U % _num_value));
+    }
+    tree_stats_snapshot stats = tree.stats();
+    //every split allocates one node, and the root leaf and every new root one more.
+    TREE_CHECK(stats.num_insert == _num_value && stats.num_split > 0U && stats.num_merge == 0U);
+    TREE_CHECK(stats.num_alloc == stats.num_split + tree.height() && stats.num_free == 0U);
+    TREE_CHECK(stats.max_depth == tree.height());
+    TREE_CHECK(tree.contains(0) && tree.stats().path_histogram[tree_stats_snapshot::bucket_of(tree.height())] > 0U);
+
+    //two thirds of the keys leave, so leaves run out of keys to lend and have to merge.
+    for (size_t i = 0U; i < _num_value; ++i) {
+        if (i % 3U) tree.remove(static_cast<int>(i));
+    }
+    stats = tree.stats();
+    TREE_CHECK(stats.num_remove == _num_value - (_num_value + 2U) / 3U && stats.num_merge > 0U && stats.num_rotation > 0U);
+    tree.clear();
+    stats = tree.stats();
+    TREE_CHECK(stats.num_free == stats.num_alloc && stats.max_depth == 0U);
+    tree.reset_stats();
+    TREE_CHECK(tree.stats().num_split == 0U && tree.stats().num_merge == 0U);
+
+    //disabled statistics report nothing.
+    bplus_tree<int> plain { 1, 2, 3 };
+    TREE_CHECK(plain.stats().num_insert == 0U && plain.stats().num_split == 0U);
+}
+
+int main(int argc, char* argv[]) {
+    const size_t num_step = argc > 1 ? static_cast<size_t>(std::atoll(argv[1])) : 100000U;
+    run_mutable_suite<bplus_tree<int>>("bplus_tree<int>", num_step);
+    run_mutable_suite<bplus_tree<int64_t>>("bplus_tree<int64_t>", num_step);
+    run_mutable_suite<bplus_tree<double>>("bplus_tree<double>", num_step);
+    run_mutable_suite<bplus_tree<int, scalar_less>>("bplus_tree<int, scalar_less>", num_step);
+    run_throwing_copy(10000U);
+    run_stats(num_step / 10U);
+    std::printf("bplus_tree_test passed\n");
+    return 0;
+}
@@ -0,0 +1,20 @@
+#include <cstdio>
+#include <cstdlib>
+#include "ordered_set_check.hpp"
+#include "../bst.hpp"
+
+//differential test of binary_search_tree against std::set.
+//usage : bst_test [num_steps]
+//random, ascending and descending insert, remove and lookup sequences, plus copies taken on the way.
+//(see ordered_set_check.hpp)
+//exit code is non zero on the first mismatch.
+
+using namespace snowapril;
+using namespace snowapril::test;
+
+int main(int argc, char* argv[]) {
+    const size_t num_step = argc > 1 ? static_cast<size_t>(std::atoll(argv[1])) : 100000U;
+    run_mutable_suite<binary_search_tree<int>>("binary_search_tree", num_step);
+    std::printf("bst_test passed\n");
+    return 0;
+}
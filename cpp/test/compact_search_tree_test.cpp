@@ -0,0 +1,132 @@
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iterator>
+#include <new>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+#include "ordered_set_check.hpp"
+#include "../compact_search_tree.hpp"
+
+//differential test of compact_search_tree against std::set, with and without parent link.
+//usage : compact_search_tree_test [num_steps]
+//random insert, remove and lookup sequences are compared with std::set (see ordered_set_check.hpp). iterators
+//returned by lookup walk forward and backward from their position, which rebuilds the path without parent link,
+//and lookups themselves must not allocate. removed slots must be reused before the arena grows, and bulk_load
+//and rebuild must give a perfectly balanced tree.
+//exit code is non zero on the first mismatch.
+
+using namespace snowapril;
+using namespace snowapril::test;
+
+//global allocation counter, to check that lookups do not touch the heap.
+static size_t num_allocation = 0U;
+
+void* operator new(size_t _size) {
+    ++num_allocation;
+    if (void* memory = std::malloc(_size == 0U ? 1U : _size)) return memory;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* _memory) noexcept {
+    std::free(_memory);
+}
+
+void operator delete(void* _memory, size_t) noexcept {
+    std::free(_memory);
+}
+
+//walk a few steps in both directions from lookup result, compared with std::set.
+template <typename Tree>
+void check_walk(Tree const & _tree, std::set<int> const & _expected, int _key) {
+    auto iter          = _tree.lower_bound(_key);
+    auto expected_iter = _expected.lower_bound(_key);
+    for (int step = 0; step < 4 && iter != _tree.end(); ++step, ++iter, ++expected_iter) {
+        TREE_CHECK(expected_iter != _expected.end() && *iter == *expected_iter);
+    }
+    TREE_CHECK(same_position(iter, _tree.end(), expected_iter, _expected.end()));
+    iter          = _tree.upper_bound(_key);
+    expected_iter = _expected.upper_bound(_key);
+    for (int step = 0; step < 4 && expected_iter != _expected.begin(); ++step) {
+        --iter;
+        --expected_iter;
+        TREE_CHECK(*iter == *expected_iter);
+    }
+}
+
+template <typename Tree>
+void run_compact(char const *_name, unsigned _seed, size_t _num_step, int _key_range) {
+    begin_case(std::string(_name) + "/walk", _seed);
+    std::mt19937  rng(_seed);
+    Tree          tree;
+    std::set<int> expected;
+    for (size_t step = 0U; step < _num_step; ++step) {
+        current_context().step = step;
+        int key = static_cast<int>(rng() % static_cast<unsigned>(_key_range + 2)) - 1;
+        switch (rng() % 4U) {
+        case 0: case 1:
+            TREE_CHECK(tree.insert(key) == expected.insert(key).second);
+            break;
+        case 2:
+            TREE_CHECK(tree.remove(key) == expected.erase(key));
+            break;
+        default: {
+            size_t old_allocation = num_allocation;
+            bool   found          = tree.contains(key);
+            auto   iter           = tree.find(key);
+            auto   lower          = tree.lower_bound(key);
+            auto   upper          = tree.upper_bound(key);
+            TREE_CHECK(num_allocation == old_allocation);
+            TREE_CHECK(found == (iter != tree.end()) && (lower != upper) == found);
+            check_walk(tree, expected, key);
+            break;
+        }
+        }
+    }
+    check_contents(tree, expected);
+
+    //removed slots are reused first, so the same number of inserts does not grow the arena.
+    begin_case(std::string(_name) + "/free_list", _seed);
+    size_t           old_bytes = tree.memory_bytes();
+    std::vector<int> removed(expected.begin(), expected.end());
+    removed.resize(removed.size() / 2U);
+    for (int value : removed) {
+        TREE_CHECK(tree.remove(value) == 1U);
+    }
+    for (int value : removed) {
+        TREE_CHECK(tree.insert(value));
+    }
+    TREE_CHECK(tree.memory_bytes() == old_bytes);
+    check_contents(tree, expected);
+
+    begin_case(std::string(_name) + "/rebuild", _seed);
+    size_t balanced_height = 0U;
+    while ((size_t(1U) << balanced_height) <= expected.size()) ++balanced_height;
+    tree.rebuild();
+    check_contents(tree, expected);
+    TREE_CHECK(tree.height() == balanced_height);
+    std::vector<int> values(expected.begin(), expected.end());
+    Tree loaded(sorted_input, values.begin(), values.end());
+    check_contents(loaded, expected);
+    TREE_CHECK(loaded.height() == balanced_height);
+    for (int key = -1; key <= _key_range; ++key) {
+        check_walk(loaded, expected, key);
+    }
+}
+
+int main(int argc, char* argv[]) {
+    const size_t num_step = argc > 1 ? static_cast<size_t>(std::atoll(argv[1])) : 100000U;
+    using parent_link_tree = compact_search_tree<int, std::less<int>, true>;
+    run_mutable_suite<compact_search_tree<int>>("compact_search_tree", num_step);
+    run_mutable_suite<parent_link_tree>("compact_search_tree/parent_link", num_step);
+    for (unsigned seed = 1U; seed <= 3U; ++seed) {
+        for (int key_range : { 64, 4096 }) {
+            run_compact<compact_search_tree<int>>("compact_search_tree", seed, num_step / 4U, key_range);
+            run_compact<parent_link_tree>("compact_search_tree/parent_link", seed, num_step / 4U, key_range);
+        }
+    }
+    std::printf("compact_search_tree_test passed\n");
+    return 0;
+}
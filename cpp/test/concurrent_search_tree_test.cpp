@@ -0,0 +1,101 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <utility>
+#include <vector>
+#include "concurrent_set_check.hpp"
+#include "../concurrent_search_tree.hpp"
+#include "../tree_exceptions.hpp"
+
+//differential test of concurrent_search_tree against std::set.
+//usage : concurrent_search_tree_test [num_steps] [num_writers]
+//sequential and concurrent checks are shared with other concurrent sets (see concurrent_set_check.hpp).
+//a read section must keep walking the version it entered while writes publish new ones, retired nodes must wait
+//for it to leave, and reader slots must run out and come back as handles are made and destroyed.
+//exit code is non zero on the first mismatch.
+
+using namespace snowapril;
+using namespace snowapril::test;
+
+//concurrent_search_tree reads through a reader handle owned by the calling thread.
+struct search_tree_adaptor {
+    using tree_type = concurrent_search_tree<int>;
+    struct reader_type {
+        explicit reader_type(tree_type const & _tree) : handle(_tree.make_reader()) { }
+        bool contains(int _key)                         { return handle.contains(_key); }
+        bool lower_bound(int _key, int& _value)         { return handle.lower_bound(_key, _value); }
+        template <typename Function>
+        void for_each(Function&& _func)                 { handle.for_each(std::forward<Function>(_func)); }
+        tree_type::reader handle;
+    };
+    static constexpr char const* name = "concurrent_search_tree";
+    tree_type tree { 64U };
+};
+
+//return distinct negative key of given value, in an order unrelated to the value, so the tree stays shallow.
+int scrambled(int _value) {
+    return -static_cast<int>(static_cast<unsigned>(_value) * 2654435761U % 1000003U) - 1;
+}
+
+void run_snapshot(unsigned _seed, int _num_value) {
+    begin_case("concurrent_search_tree/snapshot", _seed);
+    concurrent_search_tree<int> tree(4U);
+    std::vector<int> expected;
+    for (int key = 0; key < _num_value; ++key) {
+        int value = static_cast<int>((static_cast<unsigned>(key) * 2654435761U + _seed) % 1000003U);
+        if (tree.insert(value)) expected.push_back(value);
+    }
+    std::sort(expected.begin(), expected.end());
+
+    //every write from inside the read section publishes a new version, which the walk must not see.
+    concurrent_search_tree<int>::reader reader = tree.make_reader();
+    std::vector<int> walked;
+    reader.for_each([&](int _value) {
+        walked.push_back(_value);
+        TREE_CHECK(tree.remove(_value) == 1U);
+        tree.insert(scrambled(_value));
+    });
+    TREE_CHECK(walked == expected);
+    TREE_CHECK(tree.size() == expected.size() && tree.retired_count() > 0U);
+    for (int value : expected) {
+        TREE_CHECK(!reader.contains(value) && reader.contains(scrambled(value)));
+    }
+    tree.synchronize();
+    TREE_CHECK(tree.retired_count() == 0U);
+}
+
+void run_reader_limit() {
+    begin_case("concurrent_search_tree/reader_limit", 0U);
+    concurrent_search_tree<int> tree(2U);
+    tree.insert(1);
+    std::vector<concurrent_search_tree<int>::reader> readers;
+    readers.push_back(tree.make_reader());
+    readers.push_back(tree.make_reader());
+    bool thrown = false;
+    try         { tree.make_reader(); }
+    catch (reader_limit_exception const &) { thrown = true; }
+    TREE_CHECK(thrown);
+    //moved handle keeps its slot, destroyed handle gives it back.
+    concurrent_search_tree<int>::reader moved(std::move(readers.back()));
+    readers.pop_back();
+    TREE_CHECK(moved.contains(1));
+    thrown = false;
+    try         { tree.make_reader(); }
+    catch (reader_limit_exception const &) { thrown = true; }
+    TREE_CHECK(thrown);
+    readers.clear();
+    TREE_CHECK(tree.make_reader().contains(1));
+}
+
+int main(int argc, char* argv[]) {
+    const size_t num_step   = argc > 1 ? static_cast<size_t>(std::atoll(argv[1])) : 50000U;
+    const size_t num_writer = argc > 2 ? static_cast<size_t>(std::atoll(argv[2])) : 4U;
+    //concurrent_search_tree is unbalanced, so ordered keys use a smaller range to keep the test quick.
+    run_concurrent_suite<search_tree_adaptor>(num_step, num_writer, 512);
+    for (unsigned seed = 1U; seed <= 3U; ++seed) {
+        run_snapshot(seed, 2000);
+    }
+    run_reader_limit();
+    std::printf("concurrent_search_tree_test passed\n");
+    return 0;
+}
@@ -0,0 +1,146 @@
+#ifndef CONCURRENT_SET_CHECK_HPP
+#define CONCURRENT_SET_CHECK_HPP
+
+/**
+* @file      concurrent_set_check.hpp
+* @author    snowapril
+* @date      2026-10-17
+* @brief     differential checks of concurrent ordered sets against std::set, shared by test programs.
+* @details   sequential check runs random insert, remove and lookup sequences from one thread and compares every
+             result with std::set. concurrent check runs writers which own disjoint key stripes, so results of their
+             own operations must match their own std::set exactly, while readers check that every walk is strictly
+             ascending and that keys inserted before the start, which nobody removes, are always found. contents
+             after the writers finish must be the union of the writers' sets.
+             each container is wrapped by an adaptor which names it and gives a reader_type with contains,
+             lower_bound and for_each, used from one thread.
+* @see       test_util.hpp
+*/
+
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include "test_util.hpp"
+
+namespace snowapril {
+namespace test {
+
+    template <typename Reader>
+    std::vector<int> walk(Reader& _reader) {
+        std::vector<int> values;
+        _reader.for_each([&values](int _value) { values.push_back(_value); });
+        return values;
+    }
+
+    template <typename Adaptor>
+    void run_sequential(key_order _order, unsigned _seed, size_t _num_step, int _key_range) {
+        begin_case(std::string(Adaptor::name) + "/" + key_order_name(_order), _seed);
+        std::mt19937 rng(_seed);
+        Adaptor                          adaptor;
+        typename Adaptor::reader_type    reader(adaptor.tree);
+        std::set<int>                    expected;
+        for (size_t step = 0U; step < _num_step; ++step) {
+            current_context().step = step;
+            int key = static_cast<int>(rng() % static_cast<unsigned>(_key_range + 2)) - 1;
+            switch (rng() % 8U) {
+            case 0: case 1: case 2: case 3: {
+                int insert_key = next_key(_order, rng, step, _key_range);
+                TREE_CHECK(adaptor.tree.insert(insert_key) == expected.insert(insert_key).second);
+                break;
+            }
+            case 4: case 5:
+                TREE_CHECK(adaptor.tree.remove(key) == expected.erase(key));
+                break;
+            default: {
+                TREE_CHECK(reader.contains(key) == (expected.count(key) == 1U));
+                int  found = 0;
+                auto expected_iter = expected.lower_bound(key);
+                TREE_CHECK(reader.lower_bound(key, found) == (expected_iter != expected.end()));
+                TREE_CHECK(expected_iter == expected.end() || found == *expected_iter);
+                break;
+            }
+            }
+            if (step % 997U == 0U) {
+                TREE_CHECK(adaptor.tree.size() == expected.size());
+                TREE_CHECK(walk(reader) == std::vector<int>(expected.begin(), expected.end()));
+            }
+        }
+        TREE_CHECK(walk(reader) == std::vector<int>(expected.begin(), expected.end()));
+    }
+
+    template <typename Adaptor>
+    void run_concurrent(unsigned _seed, size_t _num_step, size_t _num_writer, size_t _num_reader) {
+        begin_case(std::string(Adaptor::name) + "/concurrent", _seed);
+        const int key_range  = 4096;
+        const int num_stable = 64;
+        Adaptor adaptor;
+        //stable keys are negative, so no writer ever touches them.
+        for (int key = 0; key < num_stable; ++key) {
+            adaptor.tree.insert(-1 - key * 3);
+        }
+        std::vector<std::set<int>> owned(_num_writer);
+        std::atomic<size_t>        num_running { _num_writer };
+        std::vector<std::thread>   threads;
+        for (size_t writer = 0U; writer < _num_writer; ++writer) {
+            threads.emplace_back([&, writer] {
+                std::mt19937   rng(_seed * 977U + static_cast<unsigned>(writer));
+                std::set<int>& expected = owned[writer];
+                for (size_t step = 0U; step < _num_step; ++step) {
+                    //keys of this writer are congruent to its index.
+                    int key = static_cast<int>((rng() % static_cast<unsigned>(key_range)) * _num_writer + writer);
+                    if (rng() % 2U) TREE_CHECK(adaptor.tree.insert(key) == expected.insert(key).second);
+                    else            TREE_CHECK(adaptor.tree.remove(key) == expected.erase(key));
+                }
+                num_running.fetch_sub(1U, std::memory_order_release);
+            });
+        }
+        for (size_t index = 0U; index < _num_reader; ++index) {
+            threads.emplace_back([&] {
+                typename Adaptor::reader_type reader(adaptor.tree);
+                do {
+                    std::vector<int> values = walk(reader);
+                    TREE_CHECK(std::adjacent_find(values.begin(), values.end(), std::greater_equal<int>()) == values.end());
+                    TREE_CHECK(static_cast<int>(std::count_if(values.begin(), values.end(), [](int _value) { return _value < 0; })) == num_stable);
+                    for (int key = 0; key < num_stable; ++key) {
+                        TREE_CHECK(reader.contains(-1 - key * 3));
+                    }
+                    int found = 0;
+                    TREE_CHECK(reader.lower_bound(-2, found) && found == -1);
+                } while (num_running.load(std::memory_order_acquire) != 0U);
+            });
+        }
+        for (std::thread& thread : threads) {
+            thread.join();
+        }
+        std::set<int> expected;
+        for (int key = 0; key < num_stable; ++key) {
+            expected.insert(-1 - key * 3);
+        }
+        for (std::set<int> const & writer_keys : owned) {
+            expected.insert(writer_keys.begin(), writer_keys.end());
+        }
+        typename Adaptor::reader_type reader(adaptor.tree);
+        TREE_CHECK(adaptor.tree.size() == expected.size());
+        TREE_CHECK(walk(reader) == std::vector<int>(expected.begin(), expected.end()));
+    }
+
+    //run sequential checks with a few seeds and every key order, then concurrent checks with given number of
+    //writers and two readers. unbalanced trees pass a small range for ordered keys to keep the test quick.
+    template <typename Adaptor>
+    void run_concurrent_suite(size_t _num_step, size_t _num_writer, int _ordered_key_range) {
+        const key_order orders[] = { key_order::random, key_order::ascending, key_order::descending };
+        for (unsigned seed = 1U; seed <= 3U; ++seed) {
+            for (key_order order : orders) {
+                run_sequential<Adaptor>(order, seed, _num_step, order == key_order::random ? 4096 : _ordered_key_range);
+            }
+            run_concurrent<Adaptor>(seed, _num_step / 4U, _num_writer, 2U);
+        }
+    }
+}
+}
+
+#endif
@@ -0,0 +1,185 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <set>
+#include <thread>
+#include <vector>
+#include "../concurrent_skip_list.hpp"
+
+//linearizability stress test of concurrent_skip_list.
+//usage : concurrent_skip_list_stress [num_threads] [num_rounds]
+//phase 1 runs rounds in which every thread does one random operation on one of a few hot keys between barriers.
+//        each operation records invocation and response time from a shared clock, and the history of every key is
+//        checked against a sequential set by exhaustive search over orders allowed by real time. linearizability is
+//        local, so checking keys separately is enough. state after each round is read while quiescent.
+//phase 2 runs free concurrent churn where every thread owns its own key stripe, checks read-your-writes for
+//        owned keys, and finally validates the structure against the owners' sequential models.
+//exit code is non zero on any violation.
+
+using namespace snowapril;
+
+enum class op_kind { insert, remove, contains };
+
+struct op_record {
+    op_kind  kind;
+    int      key;
+    bool     result;
+    uint64_t invoke;
+    uint64_t response;
+};
+
+class spin_barrier {
+public:
+    explicit spin_barrier(size_t _num) : num(_num) { }
+    void wait() {
+        size_t gen = generation.load(std::memory_order_acquire);
+        if (arrived.fetch_add(1U, std::memory_order_acq_rel) + 1U == num) {
+            arrived.store(0U, std::memory_order_relaxed);
+            generation.fetch_add(1U, std::memory_order_release);
+            return;
+        }
+        while (generation.load(std::memory_order_acquire) == gen) std::this_thread::yield();
+    }
+private:
+    size_t              num;
+    std::atomic<size_t> arrived    { 0U };
+    std::atomic<size_t> generation { 0U };
+};
+
+//return whether if operations can be ordered consistently with real time and sequential set semantics,
+//starting from given state and ending in given final state. failed (remaining, state) pairs are memoized,
+//so the search is O(2^n * n^2) instead of O(n!).
+bool linearizable(std::vector<op_record> const & _ops, unsigned _remaining, bool _state, bool _final_state, std::vector<char>& _failed) {
+    if (_remaining == 0U) return _state == _final_state;
+    char& failed = _failed[(static_cast<size_t>(_remaining) << 1) | (_state ? 1U : 0U)];
+    if (failed) return false;
+    for (unsigned i = 0U; i < _ops.size(); ++i) {
+        if ((_remaining & (1U << i)) == 0U) continue;
+        //an operation can go first only if no other remaining one finished before it started.
+        bool minimal = true;
+        for (unsigned j = 0U; j < _ops.size() && minimal; ++j) {
+            if (j != i && (_remaining & (1U << j)) && _ops[j].response < _ops[i].invoke) minimal = false;
+        }
+        if (!minimal) continue;
+
+        op_record const & op = _ops[i];
+        bool expected_result = op.kind == op_kind::insert ? !_state : _state;
+        bool next_state      = op.kind == op_kind::insert ? true : (op.kind == op_kind::remove ? false : _state);
+        if (op.result == expected_result && linearizable(_ops, _remaining & ~(1U << i), next_state, _final_state, _failed)) return true;
+    }
+    failed = 1;
+    return false;
+}
+
+bool run_history_phase(size_t _num_threads, size_t _num_rounds) {
+    const int             num_hot_keys = 3;
+    concurrent_skip_list<int> list;
+    std::atomic<uint64_t> clock { 0U };
+    spin_barrier          barrier(_num_threads + 1U);
+    std::vector<op_record> round_ops(_num_threads);
+    std::atomic<bool>     done { false };
+
+    std::vector<std::thread> threads;
+    for (size_t t = 0U; t < _num_threads; ++t) {
+        threads.emplace_back([&, t] {
+            std::mt19937 rng(static_cast<unsigned>(t * 7919U + 1U));
+            while (true) {
+                barrier.wait();
+                if (done.load()) return;
+                op_record record;
+                record.kind   = static_cast<op_kind>(rng() % 3U);
+                record.key    = static_cast<int>(rng() % num_hot_keys);
+                record.invoke = clock.fetch_add(1U);
+                switch (record.kind) {
+                case op_kind::insert:   record.result = list.insert(record.key);        break;
+                case op_kind::remove:   record.result = list.remove(record.key) == 1U;  break;
+                case op_kind::contains: record.result = list.contains(record.key);      break;
+                }
+                record.response = clock.fetch_add(1U);
+                round_ops[t] = record;
+                barrier.wait();
+            }
+        });
+    }
+
+    bool state[num_hot_keys] = { false, false, false };
+    bool ok = true;
+    for (size_t round = 0U; round < _num_rounds && ok; ++round) {
+        barrier.wait();
+        barrier.wait();
+        for (int key = 0; key < num_hot_keys && ok; ++key) {
+            std::vector<op_record> key_ops;
+            for (op_record const & record : round_ops) {
+                if (record.key == key) key_ops.push_back(record);
+            }
+            bool final_state = list.contains(key);
+            std::vector<char> failed(static_cast<size_t>(2U) << key_ops.size(), 0);
+            if (!linearizable(key_ops, (1U << key_ops.size()) - 1U, state[key], final_state, failed)) {
+                std::printf("round %zu : history of key %d is not linearizable\n", round, key);
+                ok = false;
+            }
+            state[key] = final_state;
+        }
+    }
+    done = true;
+    barrier.wait();
+    for (std::thread& thread : threads) thread.join();
+    std::printf("history phase   : %zu threads, %zu rounds, %s\n", _num_threads, _num_rounds, ok ? "linearizable" : "FAILED");
+    return ok;
+}
+
+bool run_churn_phase(size_t _num_threads, size_t _num_ops) {
+    const int                 key_range = 1 << 16;
+    concurrent_skip_list<int> list;
+    std::atomic<bool>         ok { true };
+    std::vector<std::set<int>> models(_num_threads);
+
+    std::vector<std::thread> threads;
+    for (size_t t = 0U; t < _num_threads; ++t) {
+        threads.emplace_back([&, t] {
+            std::mt19937 rng(static_cast<unsigned>(t + 17U));
+            std::set<int>& model = models[t];
+            for (size_t i = 0U; i < _num_ops; ++i) {
+                //keys congruent to t belong to this thread. other keys are only read.
+                int  key   = static_cast<int>((rng() % (key_range / _num_threads)) * _num_threads + t);
+                unsigned op = rng() % 4U;
+                if (op == 0U) {
+                    if (list.insert(key) != model.insert(key).second) ok = false;
+                }
+                else if (op == 1U) {
+                    if (list.remove(key) != model.erase(key)) ok = false;
+                }
+                else if (op == 2U) {
+                    if (list.contains(key) != (model.count(key) == 1U)) ok = false;
+                }
+                else {
+                    //successor may belong to any thread, so only its ordering is checked.
+                    int probe = static_cast<int>(rng() % key_range), found = 0;
+                    if (list.lower_bound(probe, found) && found < probe) ok = false;
+                }
+            }
+        });
+    }
+    for (std::thread& thread : threads) thread.join();
+
+    std::set<int> expected;
+    for (std::set<int> const & model : models) expected.insert(model.begin(), model.end());
+    std::vector<int> actual;
+    list.for_each([&actual](int _key) { actual.push_back(_key); });
+    bool structure_ok = list.size() == expected.size() && std::equal(actual.begin(), actual.end(), expected.begin(), expected.end());
+    bool result = ok.load() && structure_ok;
+    std::printf("churn phase     : %zu threads, %zu ops each, %zu keys left, %s\n", _num_threads, _num_ops, actual.size(), result ? "consistent" : "FAILED");
+    return result;
+}
+
+int main(int argc, char** argv) {
+    size_t num_threads = argc > 1 ? static_cast<size_t>(std::strtoull(argv[1], nullptr, 10)) : std::max<size_t>(4U, std::thread::hardware_concurrency());
+    size_t num_rounds  = argc > 2 ? static_cast<size_t>(std::strtoull(argv[2], nullptr, 10)) : 20000U;
+    num_threads = std::min<size_t>(num_threads, 16U);
+
+    bool ok = run_history_phase(num_threads, num_rounds);
+    ok = run_churn_phase(num_threads, 200000U) && ok;
+    return ok ? 0 : 1;
+}
@@ -0,0 +1,107 @@
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "concurrent_set_check.hpp"
+#include "../concurrent_skip_list.hpp"
+
+//differential test of concurrent_skip_list against std::set.
+//usage : concurrent_skip_list_test [num_steps] [num_writers]
+//sequential and concurrent checks are shared with other concurrent sets (see concurrent_set_check.hpp).
+//string values with transparent comparator check heterogeneous lookup and that clear and destructor release
+//every value. insert whose copy throws must leave the list unchanged and unlocked.
+//(see concurrent_skip_list_stress for the linearizability check)
+//exit code is non zero on the first mismatch.
+
+using namespace snowapril;
+using namespace snowapril::test;
+
+struct skip_list_adaptor {
+    using tree_type = concurrent_skip_list<int>;
+    struct reader_type {
+        explicit reader_type(tree_type const & _tree) : tree(_tree) { }
+        bool contains(int _key)                         { return tree.contains(_key); }
+        bool lower_bound(int _key, int& _value)         { return tree.lower_bound(_key, _value); }
+        template <typename Function>
+        void for_each(Function&& _func)                 { tree.for_each(std::forward<Function>(_func)); }
+        tree_type const & tree;
+    };
+    static constexpr char const* name = "concurrent_skip_list";
+    tree_type tree;
+};
+
+void run_strings(unsigned _seed, size_t _num_step) {
+    begin_case("concurrent_skip_list/string", _seed);
+    std::mt19937 rng(_seed);
+    concurrent_skip_list<std::string, std::less<>> list;
+    std::set<std::string>                          expected;
+    for (size_t step = 0U; step < _num_step; ++step) {
+        current_context().step = step;
+        //long enough to live on heap, so a leaked value shows up under leak checker.
+        std::string value = std::string(24, 'k') + std::to_string(rng() % 512U);
+        if (rng() % 3U) TREE_CHECK(list.insert(value) == expected.insert(value).second);
+        else            TREE_CHECK(list.remove(value) == expected.erase(value));
+        TREE_CHECK(list.contains(value.c_str()) == (expected.count(value) == 1U));
+        std::string found;
+        auto expected_iter = expected.lower_bound(value);
+        TREE_CHECK(list.lower_bound(value.c_str(), found) == (expected_iter != expected.end()));
+        TREE_CHECK(expected_iter == expected.end() || found == *expected_iter);
+    }
+    std::vector<std::string> values;
+    list.for_each([&values](std::string const & _value) { values.push_back(_value); });
+    TREE_CHECK(values == std::vector<std::string>(expected.begin(), expected.end()));
+    list.clear();
+    TREE_CHECK(list.empty() && !list.contains(*expected.begin()));
+    TREE_CHECK(list.insert(*expected.begin()) && list.size() == 1U);
+}
+
+//value whose copy throws after a given number of copies.
+struct throwing_value {
+    static int countdown;
+    throwing_value(int _value) : value(_value) { }
+    throwing_value(throwing_value const & _other) : value(_other.value) {
+        if (countdown >= 0 && countdown-- == 0) throw std::runtime_error("throwing_value");
+    }
+    bool operator<(throwing_value const & _other) const { return value < _other.value; }
+    int value;
+};
+int throwing_value::countdown = -1;
+
+void run_throwing_insert() {
+    begin_case("concurrent_skip_list/throwing_insert", 0U);
+    concurrent_skip_list<throwing_value> list;
+    for (int value = 0; value < 64; value += 2) {
+        list.insert(throwing_value(value));
+    }
+    for (int value = 1; value < 64; value += 2) {
+        current_context().step = static_cast<size_t>(value);
+        bool thrown = false;
+        throwing_value::countdown = 0;
+        try         { list.insert(throwing_value(value)); }
+        catch (std::runtime_error const &) { thrown = true; }
+        throwing_value::countdown = -1;
+        TREE_CHECK(thrown && !list.contains(throwing_value(value)) && list.size() == 32U);
+    }
+    //a predecessor left locked by the failed insert would block these forever.
+    for (int value = 1; value < 64; value += 2) {
+        TREE_CHECK(list.insert(throwing_value(value)));
+        TREE_CHECK(list.remove(throwing_value(value - 1)) == 1U);
+    }
+    TREE_CHECK(list.size() == 32U);
+}
+
+int main(int argc, char* argv[]) {
+    const size_t num_step   = argc > 1 ? static_cast<size_t>(std::atoll(argv[1])) : 50000U;
+    const size_t num_writer = argc > 2 ? static_cast<size_t>(std::atoll(argv[2])) : 4U;
+    run_concurrent_suite<skip_list_adaptor>(num_step, num_writer, 4096);
+    for (unsigned seed = 1U; seed <= 3U; ++seed) {
+        run_strings(seed, num_step / 10U);
+    }
+    run_throwing_insert();
+    std::printf("concurrent_skip_list_test passed\n");
+    return 0;
+}
@@ -0,0 +1,168 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <iterator>
+#include <list>
+#include <random>
+#include <set>
+#include <string>
+#include <vector>
+#include "ordered_set_check.hpp"
+#include "../bst.hpp"
+#include "../pool_allocator.hpp"
+#include "../tree_stats.hpp"
+
+//differential test of find_batch of binary_search_tree against find and std::set.
+//usage : find_batch_test [num_rounds]
+//trees built by insert and by bulk_load, whose nodes live in shared node blocks, are churned between rounds, and
+//batches of every size around batch_lookup_width are looked up with and without sorted_input. sorted batches hold
+//duplicates, and keys out of order or in descending order, which must still give the result of find. keys come
+//from vectors and from lists, and from another type through transparent comparator. statistics policy must count
+//one search per key, and sorted variant must visit fewer nodes for ascending keys.
+//exit code is non zero on the first mismatch.
+
+using namespace snowapril;
+using namespace snowapril::test;
+
+//every result must equal find of its key, and point at the same element as std::set.
+template <typename Tree, typename KeyRange>
+void check_results(Tree const & _tree, std::set<int> const & _expected, KeyRange const & _keys,
+                   std::vector<typename Tree::inorder_iterator> const & _found) {
+    TREE_CHECK(_found.size() == static_cast<size_t>(std::distance(_keys.begin(), _keys.end())));
+    size_t index = 0U;
+    for (auto const & key : _keys) {
+        current_context().step = index;
+        TREE_CHECK(_found[index] == _tree.find(key));
+        TREE_CHECK(same_position(_found[index], _tree.end(), _expected.find(static_cast<int>(key)), _expected.end()));
+        ++index;
+    }
+}
+
+template <typename Tree, typename KeyRange>
+void check_batch(Tree const & _tree, std::set<int> const & _expected, KeyRange const & _keys) {
+    using result_type = typename Tree::inorder_iterator;
+    std::vector<result_type> found;
+    _tree.find_batch(_keys.begin(), _keys.end(), std::back_inserter(found));
+    check_results(_tree, _expected, _keys, found);
+
+    //sorted variant only skips work for ascending keys, so any order must give the same results.
+    std::vector<result_type> sorted_found;
+    _tree.find_batch(sorted_input, _keys.begin(), _keys.end(), std::back_inserter(sorted_found));
+    TREE_CHECK(sorted_found == found);
+
+    //returned output iterator is past the last result.
+    std::vector<result_type> fixed(found.size() + 1U);
+    auto end_iter = _tree.find_batch(_keys.begin(), _keys.end(), fixed.begin());
+    TREE_CHECK(end_iter == fixed.begin() + static_cast<long>(found.size()));
+}
+
+//random keys of given count over the key range and one past both of its ends, in the given order.
+std::vector<int> batch_keys(std::mt19937& _rng, size_t _num_key, int _key_range, key_order _order) {
+    std::vector<int> keys(_num_key);
+    for (int& key : keys) key = static_cast<int>(_rng() % static_cast<unsigned>(_key_range + 2)) - 1;
+    if (_order == key_order::ascending)  std::sort(keys.begin(), keys.end());
+    if (_order == key_order::descending) std::sort(keys.begin(), keys.end(), std::greater<int>());
+    return keys;
+}
+
+template <typename Tree>
+void run_batch(char const *_name, unsigned _seed, size_t _num_round, int _key_range, bool _bulk) {
+    begin_case(std::string(_name) + (_bulk ? "/bulk " : "/insert ") + std::to_string(_key_range), _seed);
+    std::mt19937  rng(_seed);
+    Tree          tree;
+    std::set<int> expected;
+    if (_bulk) {
+        std::vector<int> values = random_values(_seed | 1U, static_cast<size_t>(_key_range) / 2U, _key_range);
+        tree.bulk_load(values.begin(), values.end());
+        expected.insert(values.begin(), values.end());
+    }
+    else {
+        for (int i = 0; i < _key_range / 2; ++i) {
+            int key = static_cast<int>(rng() % static_cast<unsigned>(_key_range));
+            TREE_CHECK(insert_key(tree, key) == expected.insert(key).second);
+        }
+    }
+
+    const size_t width = batch_lookup_width;
+    for (size_t round = 0U; round < _num_round; ++round) {
+        //empty tree once in a while, then built up again by the churn below.
+        if (round % 97U == 96U) {
+            tree.clear();
+            expected.clear();
+        }
+        for (size_t num_key : { size_t(0U), size_t(1U), width - 1U, width, width + 1U, width * 3U + 5U, size_t(rng() % 200U) }) {
+            for (key_order order : { key_order::random, key_order::ascending, key_order::descending }) {
+                std::vector<int> keys = batch_keys(rng, num_key, _key_range, order);
+                check_batch(tree, expected, keys);
+                check_batch(tree, expected, std::list<int>(keys.begin(), keys.end()));
+            }
+        }
+        //ascending keys with runs of duplicates and single keys out of place.
+        std::vector<int> keys = batch_keys(rng, width * 4U, _key_range, key_order::ascending);
+        for (size_t i = 0U; i + 1U < keys.size(); i += 5U) keys[i + 1U] = keys[i];
+        if (!keys.empty()) std::swap(keys[rng() % keys.size()], keys[rng() % keys.size()]);
+        check_batch(tree, expected, keys);
+
+        for (size_t step = 0U; step < 32U; ++step) {
+            int key = static_cast<int>(rng() % static_cast<unsigned>(_key_range));
+            if (rng() % 2U) TREE_CHECK(insert_key(tree, key) == expected.insert(key).second);
+            else            TREE_CHECK(remove_key(tree, key) == expected.erase(key));
+        }
+    }
+    check_contents(tree, expected);
+}
+
+//transparent comparator takes keys of another type as they are.
+void run_transparent(unsigned _seed) {
+    begin_case("binary_search_tree<std::less<>>/transparent", _seed);
+    std::mt19937 rng(_seed);
+    binary_search_tree<int, std::less<>> tree;
+    std::set<int>                        expected;
+    for (int i = 0; i < 2000; ++i) {
+        int key = static_cast<int>(rng() % 4000U);
+        tree.insert(key);
+        expected.insert(key);
+    }
+    std::vector<int> int_keys = batch_keys(rng, 500U, 4000, key_order::random);
+    std::vector<long long> keys(int_keys.begin(), int_keys.end());
+    check_batch(tree, expected, keys);
+    std::sort(keys.begin(), keys.end());
+    check_batch(tree, expected, keys);
+}
+
+//every key of a batch counts as one search, whichever variant walks it.
+void run_stats(unsigned _seed) {
+    begin_case("instrumented_search_tree/stats", _seed);
+    std::mt19937 rng(_seed);
+    instrumented_search_tree<int> tree;
+    for (int i = 0; i < 1000; ++i) tree.insert(static_cast<int>(rng() % 2000U));
+    std::vector<int> keys = batch_keys(rng, 300U, 2000, key_order::ascending);
+    std::vector<instrumented_search_tree<int>::inorder_iterator> found;
+    tree.reset_stats();
+    tree.find_batch(keys.begin(), keys.end(), std::back_inserter(found));
+    TREE_CHECK(tree.stats().num_search == keys.size());
+    tree_stats_snapshot stats = tree.stats();
+    tree.find_batch(sorted_input, keys.begin(), keys.end(), std::back_inserter(found));
+    TREE_CHECK(tree.stats().num_search == keys.size() * 2U);
+    //resumed searches walk only the rest of their paths.
+    TREE_CHECK(tree.stats().num_visit - stats.num_visit < stats.num_visit);
+}
+
+int main(int argc, char* argv[]) {
+    const size_t num_round = argc > 1 ? static_cast<size_t>(std::atoll(argv[1])) : 200U;
+    using pool_tree = binary_search_tree<int, std::less<int>, pool_allocator<bst_node_<int>>>;
+    for (unsigned seed = 1U; seed <= 3U; ++seed) {
+        for (int key_range : { 64, 4096 }) {
+            for (bool bulk : { false, true }) {
+                run_batch<binary_search_tree<int>>("binary_search_tree", seed, num_round, key_range, bulk);
+                run_batch<order_statistic_tree<int>>("order_statistic_tree", seed, num_round, key_range, bulk);
+                run_batch<pool_tree>("binary_search_tree/pool_allocator", seed, num_round, key_range, bulk);
+            }
+        }
+        run_transparent(seed);
+        run_stats(seed);
+    }
+    std::printf("find_batch_test passed\n");
+    return 0;
+}
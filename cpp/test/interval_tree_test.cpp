@@ -0,0 +1,85 @@
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "test_util.hpp"
+#include "../interval_tree.hpp"
+
+//differential test of interval_tree against std::set.
+//usage : interval_tree_test [num_steps]
+//random insert and remove sequences run with low end points in random, ascending and descending order, so max high
+//summaries are checked across every kind of rotation. every overlap, any-overlap and stabbing query is compared
+//with a scan of std::set of the same intervals.
+//exit code is non zero on the first mismatch.
+
+using namespace snowapril;
+using namespace snowapril::test;
+
+using interval = std::pair<int, int>;
+
+std::vector<interval> expected_overlaps(std::set<interval> const & _expected, int _low, int _high) {
+    std::vector<interval> result;
+    for (interval const & item : _expected) {
+        if (item.first <= _high && _low <= item.second) result.push_back(item);
+    }
+    return result;
+}
+
+void run_interval(key_order _order, unsigned _seed, size_t _num_step, int _key_range) {
+    begin_case(std::string("interval_tree/") + key_order_name(_order), _seed);
+    std::mt19937 rng(_seed);
+    interval_tree<int>  tree;
+    std::set<interval>  expected;
+    for (size_t step = 0U; step < _num_step; ++step) {
+        current_context().step = step;
+        int low  = next_key(_order, rng, step, _key_range);
+        int high = low + static_cast<int>(rng() % 32U);
+        if (rng() % 3U) {
+            TREE_CHECK(tree.insert(low, high) == expected.insert(interval(low, high)).second);
+        }
+        else if (!expected.empty()) {
+            auto victim = expected.begin();
+            std::advance(victim, static_cast<long>(rng() % expected.size()));
+            TREE_CHECK(tree.remove(victim->first, victim->second) == 1U);
+            TREE_CHECK(tree.remove(victim->first, victim->second) == 0U);
+            expected.erase(victim);
+        }
+        int query_low  = static_cast<int>(rng() % static_cast<unsigned>(_key_range + 64)) - 32;
+        int query_high = query_low + static_cast<int>(rng() % 48U);
+        std::vector<interval> overlaps = expected_overlaps(expected, query_low, query_high);
+        TREE_CHECK(tree.overlaps(query_low, query_high) == overlaps);
+        TREE_CHECK(tree.overlaps_any(query_low, query_high) == !overlaps.empty());
+        std::vector<interval> containing;
+        tree.for_each_containing(query_low, [&containing](interval const & _item) { containing.push_back(_item); });
+        TREE_CHECK(containing == expected_overlaps(expected, query_low, query_low));
+        TREE_CHECK(tree.contains(low, high) == (expected.count(interval(low, high)) == 1U));
+        if (step % 997U == 0U) {
+            TREE_CHECK(tree.size() == expected.size());
+            TREE_CHECK(same_sequence(tree.begin(), tree.end(), expected));
+        }
+    }
+    bool thrown = false;
+    try         { tree.insert(2, 1); }
+    catch (std::invalid_argument const &) { thrown = true; }
+    TREE_CHECK(thrown);
+    tree.clear();
+    TREE_CHECK(tree.empty() && !tree.overlaps_any(-1000, 1000000));
+}
+
+int main(int argc, char* argv[]) {
+    const size_t num_step = argc > 1 ? static_cast<size_t>(std::atoll(argv[1])) : 10000U;
+    const key_order orders[] = { key_order::random, key_order::ascending, key_order::descending };
+    for (unsigned seed = 1U; seed <= 3U; ++seed) {
+        for (key_order order : orders) {
+            for (int key_range : { 64, 2048 }) {
+                run_interval(order, seed, num_step, key_range);
+            }
+        }
+    }
+    std::printf("interval_tree_test passed\n");
+    return 0;
+}
@@ -0,0 +1,118 @@
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <set>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+#include "ordered_set_check.hpp"
+#include "../bst.hpp"
+#include "../compact_search_tree.hpp"
+#include "../mapped_search_tree.hpp"
+#include "../static_search_tree.hpp"
+#include "../tree_exceptions.hpp"
+
+//differential test of mapped_search_tree against std::set.
+//usage : mapped_search_tree_test [max_log_size]
+//files are saved from static_search_tree, binary_search_tree and compact_search_tree built from random ranges with
+//duplicates, and every lookup on the mapping is compared (see ordered_set_check.hpp). saving over a mapped file
+//must leave the old mapping readable. truncated or foreign files must be rejected with tree_format_exception, and
+//missing ones with std::system_error.
+//exit code is non zero on the first mismatch.
+
+using namespace snowapril;
+using namespace snowapril::test;
+
+void run_mapped(unsigned _seed, size_t _num_value, int _key_range, std::string const & _path) {
+    std::vector<int> values = random_values(_seed, _num_value, _key_range);
+    std::set<int> expected(values.begin(), values.end());
+
+    begin_case("mapped_search_tree/static", _seed);
+    save_mapped_tree(_path, static_search_tree<int>(values.begin(), values.end()));
+    mapped_search_tree<int> old_tree(_path);
+    check_read_only(old_tree, expected, _key_range);
+
+    //file is replaced by rename, so the mapping keeps the old contents.
+    begin_case("mapped_search_tree/bst", _seed);
+    binary_search_tree<int> source;
+    for (int value : values) {
+        source.insert(value);
+    }
+    source.insert(_key_range);
+    std::set<int> expected_source = expected;
+    expected_source.insert(_key_range);
+    save_mapped_tree(_path, source);
+    check_read_only(mapped_search_tree<int>(_path), expected_source, _key_range);
+    check_read_only(old_tree, expected, _key_range);
+
+    begin_case("mapped_search_tree/compact", _seed);
+    compact_search_tree<int> compact(values.begin(), values.end());
+    save_mapped_tree(_path, compact);
+    mapped_search_tree<int> moved(std::move(old_tree));
+    moved = mapped_search_tree<int>(_path);
+    check_read_only(moved, expected, _key_range);
+    TREE_CHECK(old_tree.empty() && old_tree.begin() == old_tree.end());
+}
+
+//write given bytes as file, so broken files can be made from a valid one.
+void write_bytes(std::string const & _path, std::vector<char> const & _bytes) {
+    std::ofstream file(_path, std::ios::binary | std::ios::trunc);
+    file.write(_bytes.data(), static_cast<std::streamsize>(_bytes.size()));
+}
+
+template <typename Type>
+bool throws_format(std::string const & _path) {
+    try         { mapped_search_tree<Type> tree(_path); }
+    catch (tree_format_exception const &) { return true; }
+    return false;
+}
+
+void run_broken(std::string const & _path) {
+    begin_case("mapped_search_tree/broken", 0U);
+    std::vector<int> values { 1, 2, 3, 5, 8, 13, 21, 34, 55 };
+    save_mapped_tree(_path, static_search_tree<int>(sorted_input, values.begin(), values.end()));
+    std::ifstream    file(_path, std::ios::binary);
+    std::vector<char> bytes((std::istreambuf_iterator<char>(file)), std::istreambuf_iterator<char>());
+    file.close();
+
+    TREE_CHECK(throws_format<double>(_path));
+    TREE_CHECK(throws_format<short>(_path));
+    for (size_t size : { size_t(0U), size_t(16U), size_t(63U), bytes.size() - sizeof(int) }) {
+        current_context().step = size;
+        write_bytes(_path, std::vector<char>(bytes.begin(), bytes.begin() + static_cast<long>(size)));
+        TREE_CHECK(throws_format<int>(_path));
+    }
+    //magic, version and byte order fields of the header.
+    for (size_t offset : { size_t(0U), size_t(8U), size_t(12U) }) {
+        current_context().step = offset;
+        std::vector<char> broken = bytes;
+        broken[offset] = static_cast<char>(broken[offset] ^ 0x40);
+        write_bytes(_path, broken);
+        TREE_CHECK(throws_format<int>(_path));
+    }
+    write_bytes(_path, bytes);
+    check_read_only(mapped_search_tree<int>(_path), std::set<int>(values.begin(), values.end()), 60);
+
+    std::filesystem::remove(_path);
+    bool thrown = false;
+    try         { mapped_search_tree<int> tree(_path); }
+    catch (std::system_error const &) { thrown = true; }
+    TREE_CHECK(thrown);
+}
+
+int main(int argc, char* argv[]) {
+    const unsigned max_log_size = argc > 1 ? static_cast<unsigned>(std::atoi(argv[1])) : 16U;
+    const std::string path = (std::filesystem::temp_directory_path() / "mapped_search_tree_test.idx").string();
+    for (unsigned seed = 1U; seed <= 6U; ++seed) {
+        for (unsigned log_size = 0U; log_size <= max_log_size; log_size += 2U) {
+            run_mapped(seed, size_t(1U) << log_size, 1 << (log_size / 2U + 4U), path);
+        }
+    }
+    run_broken(path);
+    std::filesystem::remove(path);
+    std::printf("mapped_search_tree_test passed\n");
+    return 0;
+}
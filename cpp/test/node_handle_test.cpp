@@ -0,0 +1,191 @@
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+#include "ordered_set_check.hpp"
+#include "../bst.hpp"
+#include "../pool_allocator.hpp"
+#include "../tree_exceptions.hpp"
+
+//differential test of emplace, extract and insert of node_handle of binary_search_tree against std::set.
+//usage : node_handle_test [num_steps]
+//nodes are extracted from bulk loaded trees, whose nodes live in shared node blocks, from copies and from trees built
+//by insert, and inserted again into the same tree or another one, with or without a changed key. whole trees are
+//destroyed and rebuilt while handles of their nodes are still alive. values count their copies, moves and live
+//instances, so emplace, extract and insert must neither copy nor move, and every value must be destroyed once.
+//exit code is non zero on the first mismatch.
+
+using namespace snowapril;
+using namespace snowapril::test;
+
+//value which counts its live instances, copies and moves.
+struct tracked {
+    static long num_live;
+    static long num_copy;
+    static long num_move;
+    tracked(int _key) : key(_key) { ++num_live; }
+    tracked(tracked const & _other) : key(_other.key) { ++num_live; ++num_copy; }
+    tracked(tracked&& _other) noexcept : key(_other.key) { ++num_live; ++num_move; }
+    tracked& operator=(tracked const & _other) { key = _other.key; ++num_copy; return *this; }
+    tracked& operator=(tracked&& _other) noexcept { key = _other.key; ++num_move; return *this; }
+    ~tracked() { --num_live; }
+    bool operator<(tracked const & _other) const { return key < _other.key; }
+    bool operator==(int _key) const { return key == _key; }
+    int key;
+};
+long tracked::num_live = 0;
+long tracked::num_copy = 0;
+long tracked::num_move = 0;
+
+template <typename Tree>
+struct handle_state {
+    std::vector<std::unique_ptr<Tree>>    trees;
+    std::vector<std::set<int>>            expected;
+    std::vector<typename Tree::node_handle> handles;
+};
+
+template <typename Tree>
+void rebuild(handle_state<Tree>& _state, size_t _index, std::mt19937& _rng, int _key_range) {
+    std::set<int> keys;
+    for (int i = 0; i < _key_range / 2; ++i) {
+        keys.insert(static_cast<int>(_rng() % static_cast<unsigned>(_key_range)));
+    }
+    std::vector<tracked> values(keys.begin(), keys.end());
+    auto tree = std::make_unique<Tree>(std::less<tracked>(), _state.trees.front()->get_allocator());
+    tree->bulk_load(values.begin(), values.end());
+    _state.trees[_index]    = std::move(tree);
+    _state.expected[_index] = keys;
+}
+
+template <typename Tree>
+void check_live(handle_state<Tree> const & _state) {
+    long num_value = static_cast<long>(_state.handles.size());
+    for (size_t i = 0U; i < _state.trees.size(); ++i) {
+        num_value += static_cast<long>(_state.trees[i]->size());
+    }
+    TREE_CHECK(tracked::num_live == num_value);
+}
+
+template <typename Tree>
+void run_node_handle(char const *_name, unsigned _seed, size_t _num_step, int _key_range) {
+    begin_case(std::string(_name) + "/handles " + std::to_string(_key_range), _seed);
+    std::mt19937 rng(_seed);
+    {
+        handle_state<Tree> state;
+        //tree 0 is built by insert, tree 1 by bulk_load, and tree 2 is a copy of tree 1.
+        state.trees.push_back(std::make_unique<Tree>());
+        state.expected.emplace_back();
+        for (int i = 0; i < _key_range / 2; ++i) {
+            int key = static_cast<int>(rng() % static_cast<unsigned>(_key_range));
+            TREE_CHECK(insert_key(*state.trees[0], key) == state.expected[0].insert(key).second);
+        }
+        state.trees.emplace_back();
+        state.expected.emplace_back();
+        rebuild(state, 1U, rng, _key_range);
+        state.trees.push_back(std::make_unique<Tree>(*state.trees[1], state.trees[0]->get_allocator()));
+        state.expected.push_back(state.expected[1]);
+
+        for (size_t step = 0U; step < _num_step; ++step) {
+            current_context().step = step;
+            size_t         index    = rng() % state.trees.size();
+            Tree&          tree     = *state.trees[index];
+            std::set<int>& expected = state.expected[index];
+            int            key      = static_cast<int>(rng() % static_cast<unsigned>(_key_range));
+            long           old_copy = tracked::num_copy, old_move = tracked::num_move;
+            switch (rng() % 8U) {
+            case 0: case 1: {
+                auto result = tree.emplace(key);
+                TREE_CHECK(result.second == expected.insert(key).second && result.first->key == key);
+                TREE_CHECK(tracked::num_copy == old_copy && tracked::num_move == old_move);
+                break;
+            }
+            case 2: case 3: {
+                typename Tree::node_handle handle = tree.extract(key);
+                TREE_CHECK(handle.empty() == (expected.erase(key) == 0U));
+                if (handle) state.handles.push_back(std::move(handle));
+                TREE_CHECK(tracked::num_copy == old_copy && tracked::num_move == old_move);
+                break;
+            }
+            case 4: case 5: {
+                if (state.handles.empty()) break;
+                size_t victim = rng() % state.handles.size();
+                std::swap(state.handles[victim], state.handles.back());
+                typename Tree::node_handle handle = std::move(state.handles.back());
+                state.handles.pop_back();
+                //key of extracted value may be changed before insertion.
+                if (rng() % 2U) handle.value().key = key;
+                int  handle_key = handle.value().key;
+                auto result     = tree.insert(std::move(handle));
+                TREE_CHECK(result.inserted == expected.insert(handle_key).second);
+                TREE_CHECK(result.inserted == result.node.empty() && result.position->key == handle_key);
+                TREE_CHECK(handle.empty());
+                if (!result.inserted) state.handles.push_back(std::move(result.node));
+                TREE_CHECK(tracked::num_copy == old_copy && tracked::num_move == old_move);
+                break;
+            }
+            case 6:
+                //destroyed handle destroys its value, and releases its node or its share of a node block.
+                if (!state.handles.empty()) state.handles.erase(state.handles.begin() + static_cast<long>(rng() % state.handles.size()));
+                break;
+            default:
+                TREE_CHECK(remove_key(tree, key) == expected.erase(key));
+                //tree dies while handles of its block nodes live, and a new block takes its place.
+                if (rng() % 64U == 0U) rebuild(state, index, rng, _key_range);
+                break;
+            }
+            check_live(state);
+            if (step % 499U == 0U) {
+                for (size_t i = 0U; i < state.trees.size(); ++i) {
+                    check_contents(*state.trees[i], state.expected[i]);
+                }
+            }
+        }
+        for (size_t i = 0U; i < state.trees.size(); ++i) {
+            check_contents(*state.trees[i], state.expected[i]);
+        }
+        //trees die before the handles.
+        state.trees.clear();
+        TREE_CHECK(tracked::num_live == static_cast<long>(state.handles.size()));
+    }
+    TREE_CHECK(tracked::num_live == 0);
+}
+
+//handle can only move between trees whose allocators compare equal, which is the same pool for pool_allocator.
+void run_foreign_pool() {
+    using pool_tree = binary_search_tree<tracked, std::less<tracked>, pool_allocator<bst_node_<tracked>>>;
+    begin_case("binary_search_tree/pool_allocator/foreign", 0U);
+    {
+        std::vector<tracked> values { 1, 2, 3, 4, 5 };
+        pool_tree source;
+        source.bulk_load(values.begin(), values.end());
+        pool_tree shared(std::less<tracked>(), source.get_allocator());
+        pool_tree foreign;
+        pool_tree::node_handle handle = source.extract(3);
+        bool thrown = false;
+        try         { foreign.insert(std::move(handle)); }
+        catch (different_tree_exception const &) { thrown = true; }
+        TREE_CHECK(thrown && !handle.empty() && handle.value().key == 3 && foreign.empty());
+        TREE_CHECK(shared.insert(std::move(handle)).inserted && handle.empty());
+        TREE_CHECK(shared.size() == 1U && source.size() == 4U);
+    }
+    TREE_CHECK(tracked::num_live == 0);
+}
+
+int main(int argc, char* argv[]) {
+    const size_t num_step = argc > 1 ? static_cast<size_t>(std::atoll(argv[1])) : 50000U;
+    using pool_tree = binary_search_tree<tracked, std::less<tracked>, pool_allocator<bst_node_<tracked>>>;
+    for (unsigned seed = 1U; seed <= 3U; ++seed) {
+        for (int key_range : { 64, 4096 }) {
+            run_node_handle<binary_search_tree<tracked>>("binary_search_tree", seed, num_step, key_range);
+            run_node_handle<order_statistic_tree<tracked>>("order_statistic_tree", seed, num_step, key_range);
+            run_node_handle<pool_tree>("binary_search_tree/pool_allocator", seed, num_step, key_range);
+        }
+    }
+    run_foreign_pool();
+    std::printf("node_handle_test passed\n");
+    return 0;
+}
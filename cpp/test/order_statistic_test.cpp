@@ -0,0 +1,114 @@
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <random>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+#include "ordered_set_check.hpp"
+#include "../bst.hpp"
+
+//differential test of rank, select and count_range of order_statistic_tree against std::set.
+//usage : order_statistic_test [num_steps]
+//subtree sizes are kept by every operation which relinks nodes, so random insert and remove are mixed with
+//extract and reinsert, split and join, and bulk_load. every query is compared with the distance in std::set, and
+//rank of select(i) must be i again.
+//exit code is non zero on the first mismatch.
+
+using namespace snowapril;
+using namespace snowapril::test;
+
+using tree_type = order_statistic_tree<int>;
+
+size_t expected_rank(std::set<int> const & _expected, int _key) {
+    return static_cast<size_t>(std::distance(_expected.begin(), _expected.lower_bound(_key)));
+}
+
+void check_order(tree_type const & _tree, std::set<int> const & _expected, std::mt19937& _rng, int _key_range) {
+    check_contents(_tree, _expected);
+    //select walks every position, so a wrong subtree size anywhere shows up.
+    size_t position = 0U;
+    for (int value : _expected) {
+        auto iter = _tree.select(position);
+        TREE_CHECK(iter != _tree.end() && *iter == value && _tree.rank(value) == position);
+        ++position;
+    }
+    TREE_CHECK(_tree.select(position) == _tree.end());
+    TREE_CHECK(_tree.downside_begin() ? _tree.downside_begin().size() == _expected.size() : _expected.empty());
+    for (size_t query = 0U; query < 16U; ++query) {
+        int lo = static_cast<int>(_rng() % static_cast<unsigned>(_key_range + 4)) - 2;
+        int hi = static_cast<int>(_rng() % static_cast<unsigned>(_key_range + 4)) - 2;
+        TREE_CHECK(_tree.rank(lo) == expected_rank(_expected, lo));
+        size_t expected_count = lo < hi ? expected_rank(_expected, hi) - expected_rank(_expected, lo) : 0U;
+        TREE_CHECK(_tree.count_range(lo, hi) == expected_count);
+    }
+}
+
+void run_order_statistic(key_order _order, unsigned _seed, size_t _num_step, int _key_range) {
+    begin_case(std::string("order_statistic_tree/") + key_order_name(_order), _seed);
+    std::mt19937  rng(_seed);
+    tree_type     tree;
+    std::set<int> expected;
+    for (size_t step = 0U; step < _num_step; ++step) {
+        current_context().step = step;
+        int key = static_cast<int>(rng() % static_cast<unsigned>(_key_range));
+        switch (rng() % 16U) {
+        case 0: case 1: case 2: case 3: case 4: case 5: {
+            int insert_key_value = next_key(_order, rng, step, _key_range);
+            TREE_CHECK(insert_key(tree, insert_key_value) == expected.insert(insert_key_value).second);
+            break;
+        }
+        case 6: case 7: case 8:
+            TREE_CHECK(remove_key(tree, key) == expected.erase(key));
+            break;
+        case 9: {
+            //extracted node is changed and linked again at another position.
+            tree_type::node_handle node = tree.extract(key);
+            TREE_CHECK(node.empty() == (expected.erase(key) == 0U));
+            if (node) {
+                node.value() = static_cast<int>(rng() % static_cast<unsigned>(_key_range));
+                bool inserted = expected.insert(node.value()).second;
+                TREE_CHECK(tree.insert(std::move(node)).inserted == inserted);
+            }
+            break;
+        }
+        case 10: {
+            tree_type upper = tree.split(key);
+            TREE_CHECK(upper.size() == expected.size() - expected_rank(expected, key));
+            tree.join(std::move(upper));
+            break;
+        }
+        case 11:
+            if (rng() % 64U == 0U) {
+                std::vector<int> values(expected.begin(), expected.end());
+                tree.bulk_load(values.begin(), values.end());
+            }
+            break;
+        default:
+            TREE_CHECK(tree.rank(key) == expected_rank(expected, key));
+            break;
+        }
+        if (step % 499U == 0U) check_order(tree, expected, rng, _key_range);
+    }
+    check_order(tree, expected, rng, _key_range);
+    tree_type copy(tree);
+    check_order(copy, expected, rng, _key_range);
+}
+
+int main(int argc, char* argv[]) {
+    const size_t num_step = argc > 1 ? static_cast<size_t>(std::atoll(argv[1])) : 50000U;
+    const key_order orders[] = { key_order::random, key_order::ascending, key_order::descending };
+    for (unsigned seed = 1U; seed <= 3U; ++seed) {
+        for (key_order order : orders) {
+            for (int key_range : { 64, 4096 }) {
+                run_order_statistic(order, seed, num_step, key_range);
+            }
+        }
+    }
+    begin_case("order_statistic_tree/empty", 0U);
+    std::mt19937 rng(0U);
+    check_order(tree_type(), std::set<int>(), rng, 4);
+    std::printf("order_statistic_test passed\n");
+    return 0;
+}
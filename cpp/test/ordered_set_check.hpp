@@ -0,0 +1,152 @@
+#ifndef ORDERED_SET_CHECK_HPP
+#define ORDERED_SET_CHECK_HPP
+
+/**
+* @file      ordered_set_check.hpp
+* @author    snowapril
+* @date      2026-10-17
+* @brief     differential checks of ordered set trees against std::set, shared by test programs.
+* @details   mutable trees run random insert, remove and lookup sequences with random, ascending and descending keys,
+             and their contents, walked forward and backward, are compared with std::set every few steps. copies taken
+             on the way must keep their contents while the original keeps changing.
+             read-only trees are compared on every key of their range, including find_batch.
+* @see       test_util.hpp
+*/
+
+#include <algorithm>
+#include <random>
+#include <set>
+#include <string>
+#include <type_traits>
+#include <utility>
+#include <vector>
+#include "test_util.hpp"
+
+namespace snowapril {
+namespace test {
+
+    template <typename Tree, typename = void>
+    struct has_upper_bound : std::false_type { };
+    template <typename Tree>
+    struct has_upper_bound<Tree, std::void_t<decltype(std::declval<Tree&>().upper_bound(0))>> : std::true_type { };
+
+    //trees return either bool or (iterator, bool) from insert, and either count or iterator from remove.
+    template <typename Tree>
+    bool insert_key(Tree& _tree, int _key) {
+        if constexpr (std::is_same<decltype(_tree.insert(_key)), bool>::value) return _tree.insert(_key);
+        else                                                                  return _tree.insert(_key).second;
+    }
+
+    template <typename Tree>
+    size_t remove_key(Tree& _tree, int _key) {
+        size_t old_size = _tree.size();
+        _tree.remove(_key);
+        return old_size - _tree.size();
+    }
+
+    template <typename Tree>
+    void check_contents(Tree& _tree, std::set<int> const & _expected) {
+        TREE_CHECK(_tree.size() == _expected.size());
+        TREE_CHECK(_tree.empty() == _expected.empty());
+        TREE_CHECK(same_sequence(_tree.begin(), _tree.end(), _expected));
+    }
+
+    template <typename Tree>
+    void check_lookup(Tree& _tree, std::set<int> const & _expected, int _key) {
+        TREE_CHECK(_tree.contains(_key) == (_expected.count(_key) == 1U));
+        TREE_CHECK(same_position(_tree.find(_key), _tree.end(), _expected.find(_key), _expected.end()));
+        TREE_CHECK(same_position(_tree.lower_bound(_key), _tree.end(), _expected.lower_bound(_key), _expected.end()));
+        if constexpr (has_upper_bound<Tree>::value) {
+            TREE_CHECK(same_position(_tree.upper_bound(_key), _tree.end(), _expected.upper_bound(_key), _expected.end()));
+        }
+    }
+
+    template <typename Tree>
+    void run_mutable(char const *_name, key_order _order, unsigned _seed, size_t _num_step, int _key_range) {
+        begin_case(std::string(_name) + "/" + key_order_name(_order), _seed);
+        std::mt19937 rng(_seed);
+        Tree          tree;
+        std::set<int> expected;
+        std::vector<std::pair<Tree, std::set<int>>> copies;
+        for (size_t step = 0U; step < _num_step; ++step) {
+            current_context().step = step;
+            int key = static_cast<int>(rng() % static_cast<unsigned>(_key_range + 2)) - 1;
+            switch (rng() % 8U) {
+            case 0: case 1: case 2: case 3: {
+                int insert_key_value = next_key(_order, rng, step, _key_range);
+                TREE_CHECK(insert_key(tree, insert_key_value) == expected.insert(insert_key_value).second);
+                break;
+            }
+            case 4: case 5:
+                TREE_CHECK(remove_key(tree, key) == expected.erase(key));
+                break;
+            default:
+                check_lookup(tree, expected, key);
+                break;
+            }
+            if (step % 997U == 0U) check_contents(tree, expected);
+            if (step % (_num_step / 4U + 1U) == 0U) copies.emplace_back(tree, expected);
+        }
+        check_contents(tree, expected);
+        for (auto& copy : copies) {
+            check_contents(copy.first, copy.second);
+        }
+        //copy assignment over a non empty tree replaces its contents.
+        if (!copies.empty()) {
+            copies.front().first = tree;
+            check_contents(copies.front().first, expected);
+        }
+        Tree moved(std::move(tree));
+        check_contents(moved, expected);
+        moved.clear();
+        check_contents(moved, std::set<int>());
+    }
+
+    //run mutable checks with a few seeds, every key order, and both a small key range, where inserts and removes
+    //of the same keys collide often, and a large one.
+    template <typename Tree>
+    void run_mutable_suite(char const *_name, size_t _num_step) {
+        const key_order orders[] = { key_order::random, key_order::ascending, key_order::descending };
+        for (unsigned seed = 1U; seed <= 3U; ++seed) {
+            for (key_order order : orders) {
+                for (int key_range : { 64, 4096 }) {
+                    run_mutable<Tree>(_name, order, seed, _num_step, key_range);
+                }
+            }
+        }
+    }
+
+    template <typename Tree>
+    void check_read_only(Tree const & _tree, std::set<int> const & _expected, int _key_range) {
+        TREE_CHECK(_tree.size() == _expected.size());
+        TREE_CHECK(same_sequence(_tree.begin(), _tree.end(), _expected));
+        std::vector<int> keys;
+        for (int key = -2; key < _key_range + 2; ++key) {
+            TREE_CHECK(_tree.contains(key) == (_expected.count(key) == 1U));
+            TREE_CHECK(same_position(_tree.find(key), _tree.end(), _expected.find(key), _expected.end()));
+            TREE_CHECK(same_position(_tree.lower_bound(key), _tree.end(), _expected.lower_bound(key), _expected.end()));
+            TREE_CHECK(same_position(_tree.upper_bound(key), _tree.end(), _expected.upper_bound(key), _expected.end()));
+            keys.push_back(key);
+        }
+        std::shuffle(keys.begin(), keys.end(), std::mt19937(current_context().seed));
+        std::vector<typename Tree::iterator> found(keys.size());
+        _tree.find_batch(keys.begin(), keys.end(), found.begin());
+        for (size_t i = 0U; i < keys.size(); ++i) {
+            TREE_CHECK(found[i] == _tree.find(keys[i]));
+        }
+    }
+
+    //return random values with duplicates, sorted for odd seeds.
+    inline std::vector<int> random_values(unsigned _seed, size_t _num_value, int _key_range) {
+        std::mt19937 rng(_seed);
+        std::vector<int> values(_num_value);
+        for (int& value : values) {
+            value = static_cast<int>(rng() % static_cast<unsigned>(_key_range));
+        }
+        if (_seed % 2U) std::sort(values.begin(), values.end());
+        return values;
+    }
+}
+}
+
+#endif
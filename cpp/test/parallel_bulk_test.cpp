@@ -0,0 +1,147 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+#include "ordered_set_check.hpp"
+#include "../bst.hpp"
+#include "../pool_allocator.hpp"
+#include "../task_pool.hpp"
+
+//differential test of parallel bulk operations of binary_search_tree against their sequential versions.
+//usage : parallel_bulk_test [max_log_size]
+//parallel bulk load and parallel copy must build the same shape as bulk load and the source tree, parallel for_each
+//must visit every value once, and parallel union and intersection must give the same sets as std::set_union and
+//std::set_intersection. results keep changing afterwards with random insert and remove, so nodes moved between
+//trees and node blocks shared by them are checked as well. trees on std::allocator free nodes concurrently, trees on
+//pool_allocator defer it.
+//exit code is non zero on the first mismatch.
+
+using namespace snowapril;
+using namespace snowapril::test;
+
+//return (value, depth) of every node in pre-order, which determines the shape of the tree.
+template <typename Tree>
+std::vector<std::pair<int, size_t>> tree_shape(Tree const & _tree) {
+    std::vector<std::pair<int, size_t>>                                shape;
+    std::vector<std::pair<typename Tree::downside_iterator, size_t>> stack;
+    if (_tree.downside_begin()) stack.emplace_back(_tree.downside_begin(), 0U);
+    while (!stack.empty()) {
+        auto entry = stack.back();
+        stack.pop_back();
+        shape.emplace_back(*entry.first, entry.second);
+        auto right = entry.first + 1U;
+        auto left  = entry.first - 1U;
+        if (right) stack.emplace_back(right, entry.second + 1U);
+        if (left)  stack.emplace_back(left, entry.second + 1U);
+    }
+    return shape;
+}
+
+//random insert and remove on given tree, compared with std::set.
+template <typename Tree>
+void churn(Tree& _tree, std::set<int>& _expected, std::mt19937& _rng, int _key_range) {
+    for (size_t step = 0U; step < 256U; ++step) {
+        int key = static_cast<int>(_rng() % static_cast<unsigned>(_key_range));
+        if (_rng() % 2U) TREE_CHECK(insert_key(_tree, key) == _expected.insert(key).second);
+        else             TREE_CHECK(remove_key(_tree, key) == _expected.erase(key));
+    }
+    check_contents(_tree, _expected);
+}
+
+template <typename Tree>
+void run_parallel(char const *_name, task_pool& _pool, unsigned _seed, size_t _num_value) {
+    const int key_range = static_cast<int>(_num_value * 2U + 2U);
+    begin_case(std::string(_name) + "/bulk_load " + std::to_string(_num_value), _seed);
+    std::mt19937 rng(_seed);
+    std::vector<int> values = random_values(_seed | 1U, _num_value, key_range);
+    std::set<int>    expected(values.begin(), values.end());
+    Tree sequential, parallel;
+    sequential.bulk_load(values.begin(), values.end());
+    parallel.parallel_bulk_load(_pool, values.begin(), values.end());
+    check_contents(parallel, expected);
+    TREE_CHECK(tree_shape(parallel) == tree_shape(sequential));
+
+    begin_case(std::string(_name) + "/copy " + std::to_string(_num_value), _seed);
+    //source is changed first, so it is no longer perfectly balanced and its shape has to be copied.
+    churn(sequential, expected, rng, key_range);
+    Tree copy { 1, 2, 3 };
+    copy.parallel_copy(_pool, sequential);
+    check_contents(copy, expected);
+    TREE_CHECK(tree_shape(copy) == tree_shape(sequential));
+    std::set<int> expected_copy = expected;
+    churn(copy, expected_copy, rng, key_range);
+    check_contents(sequential, expected);
+
+    begin_case(std::string(_name) + "/for_each " + std::to_string(_num_value), _seed);
+    std::atomic<long long> sum { 0 };
+    std::atomic<size_t>    count { 0U };
+    copy.parallel_for_each(_pool, [&](int _value) {
+        sum.fetch_add(_value, std::memory_order_relaxed);
+        count.fetch_add(1U, std::memory_order_relaxed);
+    });
+    long long expected_sum = 0;
+    for (int value : expected_copy) expected_sum += value;
+    TREE_CHECK(sum.load() == expected_sum && count.load() == expected_copy.size());
+
+    begin_case(std::string(_name) + "/union " + std::to_string(_num_value), _seed);
+    std::vector<int> other_values = random_values(_seed * 7U, _num_value, key_range);
+    std::sort(other_values.begin(), other_values.end());
+    std::set<int> expected_other(other_values.begin(), other_values.end());
+    //trees exchanging nodes need interchangeable allocators, which is the same pool for pool_allocator.
+    Tree other(std::less<int>(), copy.get_allocator());
+    other.parallel_bulk_load(_pool, other_values.begin(), other_values.end());
+    std::vector<int> expected_union;
+    std::set_union(expected_copy.begin(), expected_copy.end(), expected_other.begin(), expected_other.end(), std::back_inserter(expected_union));
+    Tree sequential_union(copy, copy.get_allocator()), sequential_other(other, copy.get_allocator());
+    sequential_union.set_union(std::move(sequential_other));
+    copy.parallel_union(_pool, std::move(other));
+    TREE_CHECK(other.empty());
+    std::set<int> expected_result(expected_union.begin(), expected_union.end());
+    check_contents(copy, expected_result);
+    check_contents(sequential_union, expected_result);
+    //result holds nodes of both trees, and the emptied tree must stay usable.
+    churn(copy, expected_result, rng, key_range);
+    std::set<int> expected_emptied;
+    churn(other, expected_emptied, rng, key_range);
+
+    begin_case(std::string(_name) + "/intersection " + std::to_string(_num_value), _seed);
+    Tree intersected(std::less<int>(), copy.get_allocator());
+    intersected.parallel_bulk_load(_pool, other_values.begin(), other_values.end());
+    std::vector<int> expected_intersection;
+    std::set_intersection(expected_result.begin(), expected_result.end(), expected_other.begin(), expected_other.end(), std::back_inserter(expected_intersection));
+    intersected.parallel_intersection(_pool, std::move(copy));
+    TREE_CHECK(copy.empty());
+    std::set<int> expected_intersected(expected_intersection.begin(), expected_intersection.end());
+    check_contents(intersected, expected_intersected);
+    churn(intersected, expected_intersected, rng, key_range);
+
+    begin_case(std::string(_name) + "/clear " + std::to_string(_num_value), _seed);
+    intersected.parallel_clear(_pool);
+    check_contents(intersected, std::set<int>());
+    std::set<int> expected_cleared;
+    churn(intersected, expected_cleared, rng, key_range);
+    sequential.parallel_clear(_pool);
+    check_contents(sequential, std::set<int>());
+}
+
+int main(int argc, char* argv[]) {
+    const unsigned max_log_size = argc > 1 ? static_cast<unsigned>(std::atoi(argv[1])) : 16U;
+    using pool_tree = binary_search_tree<int, std::less<int>, pool_allocator<bst_node_<int>>>;
+    for (size_t num_worker : { 0U, 3U }) {
+        task_pool pool(num_worker);
+        for (unsigned seed = 1U; seed <= 3U; ++seed) {
+            run_parallel<binary_search_tree<int>>("binary_search_tree", pool, seed, 0U);
+            for (unsigned log_size = 0U; log_size <= max_log_size; log_size += 4U) {
+                run_parallel<binary_search_tree<int>>("binary_search_tree", pool, seed, size_t(1U) << log_size);
+                run_parallel<pool_tree>("binary_search_tree/pool_allocator", pool, seed, size_t(1U) << log_size);
+            }
+        }
+    }
+    std::printf("parallel_bulk_test passed\n");
+    return 0;
+}
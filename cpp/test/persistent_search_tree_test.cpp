@@ -0,0 +1,224 @@
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <cstdlib>
+#include <memory>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+#include "ordered_set_check.hpp"
+#include "../persistent_search_tree.hpp"
+
+//differential test of persistent_search_tree against std::set.
+//usage : persistent_search_tree_test [num_steps]
+//random insert, remove and lookup sequences are compared with std::set (see ordered_set_check.hpp). versions are
+//taken by snapshot, copy and move on the way, and random ones of them are updated, compared and dropped, so every
+//version must keep its own contents whatever happens to the others. snapshot must not allocate, update of a
+//version which owns its whole path must allocate only the inserted node, and iterators of a version must survive
+//updates of its snapshots. versions of one root are updated and dropped on several threads at once.
+//every node must be freed when the last version goes.
+//exit code is non zero on the first mismatch.
+
+using namespace snowapril;
+using namespace snowapril::test;
+
+//node allocator which counts live nodes. atomic, since versions may free each other's nodes on any thread.
+static std::atomic<long> num_live_node { 0 };
+
+template <typename Type>
+struct counting_allocator : std::allocator<Type> {
+    template <typename Other>
+    struct rebind { using other = counting_allocator<Other>; };
+    counting_allocator() = default;
+    template <typename Other>
+    counting_allocator(counting_allocator<Other> const &) { }
+    Type* allocate(size_t _num) { num_live_node += static_cast<long>(_num); return std::allocator<Type>::allocate(_num); }
+    void  deallocate(Type* _ptr, size_t _num) { num_live_node -= static_cast<long>(_num); std::allocator<Type>::deallocate(_ptr, _num); }
+};
+
+using counted_tree = persistent_search_tree<int, std::less<int>, counting_allocator<persistent_node_<int>>>;
+
+struct version {
+    std::unique_ptr<counted_tree> tree;
+    std::set<int>                 expected;
+    //no node of this version has ever been reachable from another one, so it owns every path.
+    bool                          sole;
+};
+
+void check_version(version const & _version) {
+    check_contents(*_version.tree, _version.expected);
+    std::vector<int> visited;
+    _version.tree->for_each([&](int _value) { visited.push_back(_value); });
+    TREE_CHECK(same_sequence(visited.begin(), visited.end(), _version.expected));
+}
+
+void run_versions(unsigned _seed, size_t _num_step, int _key_range) {
+    begin_case("persistent_search_tree/versions " + std::to_string(_key_range), _seed);
+    std::mt19937 rng(_seed);
+    {
+        std::vector<version> versions;
+        versions.push_back(version{ std::make_unique<counted_tree>(), std::set<int>(), true });
+        for (size_t step = 0U; step < _num_step; ++step) {
+            current_context().step = step;
+            version& current = versions[rng() % versions.size()];
+            int      key     = static_cast<int>(rng() % static_cast<unsigned>(_key_range));
+            switch (rng() % 16U) {
+            case 0: {
+                //snapshot is one more reference of the root, whichever way it is taken.
+                long old_live = num_live_node;
+                version taken { nullptr, current.expected, false };
+                switch (rng() % 3U) {
+                case 0:  taken.tree = std::make_unique<counted_tree>(current.tree->snapshot()); break;
+                case 1:  taken.tree = std::make_unique<counted_tree>(*current.tree); break;
+                default: taken.tree = std::make_unique<counted_tree>(); *taken.tree = *current.tree; break;
+                }
+                TREE_CHECK(num_live_node == old_live);
+                TREE_CHECK(current.tree->empty() || (current.tree->is_shared() && taken.tree->is_shared()));
+                current.sole = current.tree->empty();
+                versions.push_back(std::move(taken));
+                break;
+            }
+            case 1:
+                //dropped version releases only the nodes no other version holds.
+                if (versions.size() > 1U) {
+                    size_t victim = rng() % versions.size();
+                    std::swap(versions[victim], versions.back());
+                    versions.pop_back();
+                }
+                break;
+            case 2: {
+                //cleared version starts over with nodes of its own.
+                if (rng() % 4U == 0U) {
+                    current.tree->clear();
+                    current.expected.clear();
+                    current.sole = true;
+                    break;
+                }
+                //moved version keeps its nodes, and the source is left empty.
+                long old_live = num_live_node;
+                counted_tree moved(std::move(*current.tree));
+                TREE_CHECK(current.tree->empty() && num_live_node == old_live);
+                *current.tree = std::move(moved);
+                break;
+            }
+            case 3: case 4: case 5: case 6: case 7: {
+                bool owned    = current.sole;
+                long old_live = num_live_node;
+                bool inserted = current.tree->insert(key);
+                TREE_CHECK(inserted == current.expected.insert(key).second);
+                TREE_CHECK(!owned || num_live_node == old_live + (inserted ? 1 : 0));
+                break;
+            }
+            case 8: case 9: case 10: {
+                bool   owned    = current.sole;
+                long   old_live = num_live_node;
+                size_t removed = current.tree->remove(key);
+                TREE_CHECK(removed == current.expected.erase(key));
+                TREE_CHECK(!owned || num_live_node == old_live - static_cast<long>(removed));
+                break;
+            }
+            default:
+                check_lookup(*current.tree, current.expected, key);
+                break;
+            }
+            if (step % 997U == 0U) {
+                for (version const & each : versions) check_version(each);
+            }
+        }
+        for (version const & each : versions) check_version(each);
+        //versions die in random order.
+        std::shuffle(versions.begin(), versions.end(), rng);
+        while (!versions.empty()) versions.pop_back();
+    }
+    TREE_CHECK(num_live_node == 0);
+}
+
+//iterators walk their own version while its snapshot is updated and dropped.
+void run_iterator_isolation(unsigned _seed, size_t _num_value) {
+    begin_case("persistent_search_tree/iterator_isolation", _seed);
+    std::mt19937 rng(_seed);
+    {
+        counted_tree  tree;
+        std::set<int> expected;
+        for (size_t i = 0U; i < _num_value; ++i) {
+            int key = static_cast<int>(rng() % static_cast<unsigned>(_num_value * 2U));
+            tree.insert(key);
+            expected.insert(key);
+        }
+        auto iter          = tree.begin();
+        auto expected_iter = expected.begin();
+        {
+            counted_tree other = tree.snapshot();
+            //the snapshot takes the updates, the version below the iterator stays as it was.
+            for (size_t step = 0U; iter != tree.end(); ++step) {
+                current_context().step = step;
+                int key = static_cast<int>(rng() % static_cast<unsigned>(_num_value * 2U));
+                if (rng() % 2U) other.insert(key);
+                else            other.remove(key);
+                TREE_CHECK(expected_iter != expected.end() && *iter == *expected_iter);
+                ++iter;
+                ++expected_iter;
+            }
+            TREE_CHECK(expected_iter == expected.end());
+        }
+        check_contents(tree, expected);
+        TREE_CHECK(!tree.is_shared());
+    }
+    TREE_CHECK(num_live_node == 0);
+}
+
+//versions of one root are updated, read and dropped on different threads at the same time.
+void run_threads(unsigned _seed, size_t _num_thread, size_t _num_step) {
+    begin_case("persistent_search_tree/threads", _seed);
+    {
+        std::mt19937  rng(_seed);
+        counted_tree  base;
+        std::set<int> expected;
+        for (int i = 0; i < 4096; ++i) {
+            int key = static_cast<int>(rng() % 8192U);
+            base.insert(key);
+            expected.insert(key);
+        }
+        std::vector<counted_tree> versions;
+        for (size_t i = 0U; i < _num_thread; ++i) versions.push_back(base.snapshot());
+        std::atomic<size_t> num_failure { 0U };
+        std::vector<std::thread> threads;
+        for (size_t i = 0U; i < _num_thread; ++i) {
+            threads.emplace_back([&, i]() {
+                std::mt19937  thread_rng(_seed * 131U + static_cast<unsigned>(i));
+                counted_tree  tree = std::move(versions[i]);
+                std::set<int> own  = expected;
+                for (size_t step = 0U; step < _num_step; ++step) {
+                    int key = static_cast<int>(thread_rng() % 8192U);
+                    bool ok = thread_rng() % 2U ? tree.insert(key) == own.insert(key).second
+                                                : tree.remove(key) == own.erase(key);
+                    //snapshot of own version is dropped right away, so references come and go concurrently.
+                    if (step % 64U == 0U) ok = ok && tree.snapshot().size() == own.size();
+                    if (!ok) ++num_failure;
+                }
+                if (!std::equal(tree.begin(), tree.end(), own.begin(), own.end())) ++num_failure;
+            });
+        }
+        for (std::thread& thread : threads) thread.join();
+        TREE_CHECK(num_failure == 0U);
+        check_contents(base, expected);
+    }
+    TREE_CHECK(num_live_node == 0);
+}
+
+int main(int argc, char* argv[]) {
+    const size_t num_step = argc > 1 ? static_cast<size_t>(std::atoll(argv[1])) : 100000U;
+    run_mutable_suite<persistent_search_tree<int>>("persistent_search_tree", num_step);
+    for (unsigned seed = 1U; seed <= 3U; ++seed) {
+        for (int key_range : { 64, 4096 }) {
+            run_versions(seed, num_step / 2U, key_range);
+        }
+        run_iterator_isolation(seed, num_step / 20U);
+        run_threads(seed, 4U, num_step / 10U);
+    }
+    std::printf("persistent_search_tree_test passed\n");
+    return 0;
+}
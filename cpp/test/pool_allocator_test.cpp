@@ -0,0 +1,128 @@
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <set>
+#include <string>
+#include <thread>
+#include <vector>
+#include "ordered_set_check.hpp"
+#include "../bst.hpp"
+#include "../pool_allocator.hpp"
+#include "../tree_exceptions.hpp"
+
+//differential test of binary_search_tree on pool_allocator against std::set.
+//usage : pool_allocator_test [num_steps]
+//nodes are recycled through the free list of the pool while random insert and remove sequences run, and copies of
+//the tree must keep their contents. copies get fresh pools, so they are changed on separate threads at once, and
+//node handles are accepted only by trees on the pool they came from, which the allocator constructors share.
+//rebound allocators share one pool.
+//exit code is non zero on the first mismatch.
+
+using namespace snowapril;
+using namespace snowapril::test;
+
+using pool_tree = binary_search_tree<int, std::less<int>, pool_allocator<bst_node_<int>>>;
+
+void run_allocator(unsigned _seed) {
+    begin_case("pool_allocator", _seed);
+    pool_allocator<bst_node_<int>, 4> alloc;
+    pool_allocator<long double, 4>    rebound(alloc);
+    TREE_CHECK(alloc == rebound);
+    TREE_CHECK(alloc == pool_allocator<bst_node_<int>, 4>(rebound));
+    TREE_CHECK(alloc != alloc.select_on_container_copy_construction());
+    TREE_CHECK(alloc != pool_allocator<bst_node_<int>, 4>());
+
+    //freed slots are reused before a new chunk is taken.
+    std::mt19937 rng(_seed);
+    std::vector<bst_node_<int>*> nodes;
+    for (int i = 0; i < 10; ++i) {
+        nodes.push_back(alloc.allocate(1U));
+    }
+    TREE_CHECK(alloc.chunk_count() == 3U);
+    for (int round = 0; round < 100; ++round) {
+        size_t index = rng() % nodes.size();
+        bst_node_<int>* node = nodes[index];
+        alloc.deallocate(node, 1U);
+        nodes[index] = alloc.allocate(1U);
+        TREE_CHECK(nodes[index] == node);
+    }
+    TREE_CHECK(alloc.chunk_count() == 3U);
+    //allocator rebound back from another type frees slots of the same pool.
+    pool_allocator<bst_node_<int>, 4> rebound_back(rebound);
+    for (bst_node_<int>* node : nodes) {
+        rebound_back.deallocate(node, 1U);
+    }
+    bst_node_<int>* array = alloc.allocate(8U);
+    alloc.deallocate(array, 8U);
+    TREE_CHECK(alloc.chunk_count() == 3U);
+}
+
+void run_copy_isolation(unsigned _seed, size_t _num_step, size_t _num_thread) {
+    begin_case("binary_search_tree/pool_allocator/copies", _seed);
+    std::mt19937 rng(_seed);
+    pool_tree     source;
+    std::set<int> expected;
+    for (size_t step = 0U; step < _num_step; ++step) {
+        int key = static_cast<int>(rng() % 4096U);
+        TREE_CHECK(source.insert(key).second == expected.insert(key).second);
+    }
+    //every copy owns its pool, so copies are changed concurrently without sharing any slot.
+    std::vector<pool_tree>     copies(_num_thread, source);
+    std::vector<std::set<int>> expected_copies(_num_thread, expected);
+    std::vector<std::thread>   threads;
+    for (size_t index = 0U; index < _num_thread; ++index) {
+        threads.emplace_back([&, index] {
+            std::mt19937 thread_rng(_seed * 131U + static_cast<unsigned>(index));
+            for (size_t step = 0U; step < _num_step; ++step) {
+                int key = static_cast<int>(thread_rng() % 4096U);
+                if (thread_rng() % 2U) TREE_CHECK(copies[index].insert(key).second == expected_copies[index].insert(key).second);
+                else                   TREE_CHECK(remove_key(copies[index], key) == expected_copies[index].erase(key));
+            }
+        });
+    }
+    for (std::thread& thread : threads) {
+        thread.join();
+    }
+    check_contents(source, expected);
+    for (size_t index = 0U; index < _num_thread; ++index) {
+        check_contents(copies[index], expected_copies[index]);
+    }
+
+    //node handle keeps the pool of its tree, so it goes back to a tree which moved from that one, but not to a copy.
+    if (expected.empty()) return;
+    int key = *expected.begin();
+    pool_tree::node_handle handle = source.extract(key);
+    expected.erase(key);
+    pool_tree copy(source);
+    bool thrown = false;
+    try         { copy.insert(std::move(handle)); }
+    catch (different_tree_exception const &) { thrown = true; }
+    TREE_CHECK(thrown && !handle.empty());
+    pool_tree moved(std::move(source));
+    TREE_CHECK(moved.insert(std::move(handle)).inserted);
+    expected.insert(key);
+    check_contents(moved, expected);
+
+    //copy made with allocator of the source shares its pool, so nodes move both ways.
+    pool_tree shared(moved, moved.get_allocator());
+    TREE_CHECK(shared.get_allocator() == moved.get_allocator() && copy.get_allocator() != moved.get_allocator());
+    check_contents(shared, expected);
+    TREE_CHECK(shared.insert(moved.extract(key)).inserted == false);
+    pool_tree empty(std::less<int>(), moved.get_allocator());
+    TREE_CHECK(empty.insert(shared.extract(key)).inserted);
+    shared.set_union(std::move(empty));
+    check_contents(shared, expected);
+    expected.erase(key);
+    check_contents(moved, expected);
+}
+
+int main(int argc, char* argv[]) {
+    const size_t num_step = argc > 1 ? static_cast<size_t>(std::atoll(argv[1])) : 100000U;
+    for (unsigned seed = 1U; seed <= 3U; ++seed) {
+        run_allocator(seed);
+        run_copy_isolation(seed, num_step / 10U, 4U);
+    }
+    run_mutable_suite<pool_tree>("binary_search_tree/pool_allocator", num_step);
+    std::printf("pool_allocator_test passed\n");
+    return 0;
+}
@@ -0,0 +1,128 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+#include <tuple>
+#include <vector>
+#include "test_util.hpp"
+#include "../quad_tree.hpp"
+
+//differential test of quad_tree against brute force scan of every point.
+//usage : quad_tree_test [num_steps]
+//points with integer coordinates are inserted one by one and in bulk, so duplicates and points on quadrant borders
+//are common. small buckets and a shallow depth limit make leaves split and chain buckets. range, batched range and
+//radius queries must return the same entries as a scan, and nearest must return the k smallest distances.
+//exit code is non zero on the first mismatch.
+
+using namespace snowapril;
+using namespace snowapril::test;
+
+using tree_type  = quad_tree<int, double>;
+using entry_type = tree_type::value_type;
+using entry_key  = std::tuple<double, double, int>;
+
+std::vector<entry_key> sorted_keys(std::vector<entry_type> const & _entries) {
+    std::vector<entry_key> keys;
+    for (entry_type const & entry : _entries) {
+        keys.emplace_back(entry.point.x, entry.point.y, entry.value);
+    }
+    std::sort(keys.begin(), keys.end());
+    return keys;
+}
+
+std::vector<entry_type> expected_range(std::vector<entry_type> const & _entries, tree_type::rect_type const & _rect) {
+    std::vector<entry_type> result;
+    for (entry_type const & entry : _entries) {
+        if (_rect.contains(entry.point)) result.push_back(entry);
+    }
+    return result;
+}
+
+double distance_squared(tree_type::point_type const & _lhs, tree_type::point_type const & _rhs) {
+    return (_lhs.x - _rhs.x) * (_lhs.x - _rhs.x) + (_lhs.y - _rhs.y) * (_lhs.y - _rhs.y);
+}
+
+void check_queries(tree_type const & _tree, std::vector<entry_type> const & _entries, std::mt19937& _rng, int _extent) {
+    auto coordinate = [&_rng, _extent] { return static_cast<double>(static_cast<int>(_rng() % static_cast<unsigned>(_extent + 16)) - 8); };
+    TREE_CHECK(_tree.size() == _entries.size());
+
+    std::vector<tree_type::rect_type> rects;
+    for (int query = 0; query < 8; ++query) {
+        double x = coordinate(), y = coordinate();
+        rects.push_back(tree_type::rect_type{ x, y, x + static_cast<double>(_rng() % 64U), y + static_cast<double>(_rng() % 64U) });
+        std::vector<entry_type> found;
+        _tree.query_range(rects.back(), std::back_inserter(found));
+        TREE_CHECK(sorted_keys(found) == sorted_keys(expected_range(_entries, rects.back())));
+    }
+    std::vector<std::vector<entry_type>> batch(rects.size());
+    _tree.query_range_batch(rects.begin(), rects.end(), [&batch](size_t _index, entry_type const & _entry) { batch[_index].push_back(_entry); });
+    for (size_t index = 0U; index < rects.size(); ++index) {
+        TREE_CHECK(sorted_keys(batch[index]) == sorted_keys(expected_range(_entries, rects[index])));
+    }
+
+    tree_type::point_type center{ coordinate(), coordinate() };
+    double radius = static_cast<double>(_rng() % 48U);
+    std::vector<entry_type> found;
+    _tree.query_radius(center, radius, std::back_inserter(found));
+    std::vector<entry_type> expected;
+    for (entry_type const & entry : _entries) {
+        if (distance_squared(entry.point, center) <= radius * radius) expected.push_back(entry);
+    }
+    TREE_CHECK(sorted_keys(found) == sorted_keys(expected));
+
+    //ties make the chosen entries ambiguous, so nearest is compared by its distances.
+    size_t k = _rng() % 16U;
+    std::vector<entry_type> nearest = _tree.nearest(center, k);
+    std::vector<double> distances, expected_distances;
+    for (entry_type const & entry : nearest) {
+        distances.push_back(distance_squared(entry.point, center));
+    }
+    for (entry_type const & entry : _entries) {
+        expected_distances.push_back(distance_squared(entry.point, center));
+    }
+    std::sort(expected_distances.begin(), expected_distances.end());
+    expected_distances.resize(std::min(k, expected_distances.size()));
+    TREE_CHECK(distances == expected_distances);
+}
+
+void run_quad_tree(unsigned _seed, size_t _num_step, int _extent) {
+    begin_case("quad_tree/extent " + std::to_string(_extent), _seed);
+    std::mt19937 rng(_seed);
+    const tree_type::rect_type world{ 0.0, 0.0, static_cast<double>(_extent), static_cast<double>(_extent) };
+    tree_type               tree(world, 4U, 6U);
+    std::vector<entry_type> entries;
+    for (size_t step = 0U; step < _num_step; ++step) {
+        current_context().step = step;
+        //a few points fall outside of world bounds and must be rejected.
+        tree_type::point_type point{ static_cast<double>(static_cast<int>(rng() % static_cast<unsigned>(_extent + 3)) - 1),
+                                     static_cast<double>(static_cast<int>(rng() % static_cast<unsigned>(_extent + 3)) - 1) };
+        entry_type entry{ point, static_cast<int>(step) };
+        TREE_CHECK(tree.insert(point, entry.value) == world.contains(point));
+        if (world.contains(point)) entries.push_back(entry);
+        if (step % 97U == 0U) check_queries(tree, entries, rng, _extent);
+    }
+    check_queries(tree, entries, rng, _extent);
+
+    begin_case("quad_tree/bulk extent " + std::to_string(_extent), _seed);
+    tree_type bulk(world, entries.begin(), entries.end(), 4U, 6U);
+    check_queries(bulk, entries, rng, _extent);
+    tree_type copy(bulk);
+    bulk.clear();
+    check_queries(bulk, std::vector<entry_type>(), rng, _extent);
+    check_queries(copy, entries, rng, _extent);
+    TREE_CHECK(bulk.insert(entries.begin(), entries.end()) == entries.size());
+    check_queries(bulk, entries, rng, _extent);
+}
+
+int main(int argc, char* argv[]) {
+    const size_t num_step = argc > 1 ? static_cast<size_t>(std::atoll(argv[1])) : 10000U;
+    for (unsigned seed = 1U; seed <= 3U; ++seed) {
+        //small extent piles duplicates into leaves at depth limit.
+        for (int extent : { 16, 1024 }) {
+            run_quad_tree(seed, num_step, extent);
+        }
+    }
+    std::printf("quad_tree_test passed\n");
+    return 0;
+}
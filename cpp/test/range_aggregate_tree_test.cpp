@@ -0,0 +1,92 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <map>
+#include <random>
+#include <set>
+#include <string>
+#include <utility>
+#include <vector>
+#include "test_util.hpp"
+#include "../range_aggregate_tree.hpp"
+
+//differential test of range_aggregate_tree against std::map.
+//usage : range_aggregate_tree_test [num_steps]
+//insert, assign and remove run with sum, min and max monoids, and every range aggregate and range walk is compared
+//with a fold over std::map. keys come in random, ascending and descending order, so summaries are checked across
+//every kind of rotation.
+//exit code is non zero on the first mismatch.
+
+using namespace snowapril;
+using namespace snowapril::test;
+
+template <typename Monoid>
+typename Monoid::value_type expected_aggregate(std::map<int, int> const & _expected, int _first_key, int _last_key) {
+    typename Monoid::value_type result = Monoid::identity();
+    for (auto iter = _expected.lower_bound(_first_key); iter != _expected.end() && iter->first < _last_key; ++iter) {
+        result = Monoid::combine(result, static_cast<typename Monoid::value_type>(iter->second));
+    }
+    return result;
+}
+
+template <typename Monoid>
+void run_range_aggregate(char const *_name, key_order _order, unsigned _seed, size_t _num_step, int _key_range) {
+    begin_case(std::string(_name) + "/" + key_order_name(_order), _seed);
+    std::mt19937 rng(_seed);
+    range_aggregate_tree<int, int, Monoid> tree;
+    std::map<int, int>                     expected;
+    for (size_t step = 0U; step < _num_step; ++step) {
+        current_context().step = step;
+        int key   = next_key(_order, rng, step, _key_range);
+        int value = static_cast<int>(rng() % 2001U) - 1000;
+        switch (rng() % 4U) {
+        case 0:
+            TREE_CHECK(tree.insert(key, value) == expected.emplace(key, value).second);
+            break;
+        case 1:
+            tree.assign(key, value);
+            expected[key] = value;
+            break;
+        case 2: {
+            int victim = static_cast<int>(rng() % static_cast<unsigned>(_key_range));
+            TREE_CHECK(tree.remove(victim) == expected.erase(victim));
+            break;
+        }
+        default: {
+            auto iter = tree.find(key);
+            auto expected_iter = expected.find(key);
+            TREE_CHECK((iter == tree.end()) == (expected_iter == expected.end()));
+            TREE_CHECK(iter == tree.end() || iter->second == expected_iter->second);
+            break;
+        }
+        }
+        int first_key = static_cast<int>(rng() % static_cast<unsigned>(_key_range + 2)) - 1;
+        int last_key  = first_key + static_cast<int>(rng() % static_cast<unsigned>(_key_range / 4 + 2));
+        TREE_CHECK(tree.aggregate(first_key, last_key) == expected_aggregate<Monoid>(expected, first_key, last_key));
+        TREE_CHECK(tree.aggregate(last_key, first_key) == Monoid::identity());
+        std::vector<std::pair<int, int>> entries;
+        tree.for_each_in_range(first_key, last_key, [&entries](std::pair<int, int> const & _entry) { entries.push_back(_entry); });
+        TREE_CHECK(entries == std::vector<std::pair<int, int>>(expected.lower_bound(first_key), expected.lower_bound(std::max(first_key, last_key))));
+        if (step % 997U == 0U) {
+            TREE_CHECK(tree.size() == expected.size());
+            TREE_CHECK(same_sequence(tree.begin(), tree.end(), std::set<std::pair<int, int>>(expected.begin(), expected.end())));
+            TREE_CHECK(tree.aggregate() == expected_aggregate<Monoid>(expected, -1, _key_range));
+        }
+    }
+}
+
+int main(int argc, char* argv[]) {
+    const size_t num_step = argc > 1 ? static_cast<size_t>(std::atoll(argv[1])) : 10000U;
+    const key_order orders[] = { key_order::random, key_order::ascending, key_order::descending };
+    for (unsigned seed = 1U; seed <= 3U; ++seed) {
+        for (key_order order : orders) {
+            for (int key_range : { 64, 2048 }) {
+                run_range_aggregate<sum_monoid<long long>>("range_aggregate_tree/sum", order, seed, num_step, key_range);
+                run_range_aggregate<min_monoid<int>>("range_aggregate_tree/min", order, seed, num_step, key_range);
+                run_range_aggregate<max_monoid<int>>("range_aggregate_tree/max", order, seed, num_step, key_range);
+            }
+        }
+    }
+    std::printf("range_aggregate_tree_test passed\n");
+    return 0;
+}
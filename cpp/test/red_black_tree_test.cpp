@@ -0,0 +1,108 @@
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <set>
+#include <vector>
+#include "ordered_set_check.hpp"
+#include "../red_black_tree.hpp"
+#include "../tree_stats.hpp"
+
+//differential test of red_black_tree against std::set.
+//usage : red_black_tree_test [num_steps]
+//random insert, remove and lookup sequences are compared with std::set (see ordered_set_check.hpp), then elements
+//are removed through iterators while walking, and height must stay within the red black bound 2 log2(n + 1).
+//counting statistics policy must see the rotations of ascending inserts and balance every node it counts.
+//exit code is non zero on the first mismatch.
+
+using namespace snowapril;
+using namespace snowapril::test;
+
+void run_iterator_remove(unsigned _seed, size_t _num_value) {
+    begin_case("red_black_tree/iterator_remove", _seed);
+    std::mt19937 rng(_seed);
+    red_black_tree<int> tree;
+    std::set<int>       expected;
+    for (size_t i = 0U; i < _num_value; ++i) {
+        int key = static_cast<int>(rng() % static_cast<unsigned>(_num_value * 2U));
+        tree.insert(key);
+        expected.insert(key);
+    }
+    TREE_CHECK(static_cast<double>(tree.height()) <= 2.0 * std::log2(static_cast<double>(tree.size()) + 1.0));
+
+    //end() is not an element, so removing it changes nothing.
+    TREE_CHECK(tree.remove(tree.end()) == tree.end());
+    check_contents(tree, expected);
+
+    auto iter = tree.begin();
+    auto expected_iter = expected.begin();
+    while (iter != tree.end()) {
+        current_context().step = static_cast<size_t>(*iter);
+        if (rng() % 3U) {
+            iter = tree.remove(iter);
+            expected_iter = expected.erase(expected_iter);
+        }
+        else {
+            ++iter;
+            ++expected_iter;
+        }
+        TREE_CHECK(same_position(iter, tree.end(), expected_iter, expected.end()));
+    }
+    check_contents(tree, expected);
+    TREE_CHECK(static_cast<double>(tree.height()) <= 2.0 * std::log2(static_cast<double>(tree.size()) + 1.0));
+
+    red_black_tree<int> other { -3, -2, -1 };
+    tree.swap(other);
+    check_contents(tree, std::set<int>{ -3, -2, -1 });
+    check_contents(other, expected);
+    while (!tree.empty()) {
+        tree.remove(tree.begin());
+    }
+    TREE_CHECK(tree.remove(tree.end()) == tree.end() && tree.height() == 0U);
+}
+
+void run_stats(size_t _num_value) {
+    using counting_tree = red_black_tree<int, std::less<int>, std::allocator<rb_node_<int>>, counting_tree_stats_>;
+    static_assert(sizeof(red_black_tree<int>) < sizeof(counting_tree), "disabled statistics must not take space");
+    run_mutable_suite<counting_tree>("red_black_tree/counting_tree_stats_", _num_value);
+    begin_case("red_black_tree/stats", 0U);
+
+    //ascending inserts would give a chain without rotations.
+    counting_tree tree;
+    for (size_t i = 0U; i < _num_value; ++i) {
+        tree.insert(static_cast<int>(i));
+    }
+    tree_stats_snapshot stats = tree.stats();
+    TREE_CHECK(stats.num_insert == _num_value && stats.num_alloc == _num_value && stats.num_rotation > 0U);
+    //max depth is recorded when a node is linked, before rotations lift it.
+    TREE_CHECK(static_cast<double>(stats.max_depth) <= 2.0 * std::log2(static_cast<double>(_num_value) + 1.0) + 1.0);
+    TREE_CHECK(stats.max_depth >= tree.height());
+    TREE_CHECK(tree.contains(0) && tree.stats().num_search == stats.num_search + 1U);
+
+    counting_tree copy(tree);
+    TREE_CHECK(copy.stats().num_alloc == _num_value && copy.stats().max_depth == stats.max_depth);
+    for (size_t i = 0U; i < _num_value; i += 2U) {
+        copy.remove(static_cast<int>(i));
+    }
+    stats = copy.stats();
+    TREE_CHECK(stats.num_remove == (_num_value + 1U) / 2U && stats.num_free == stats.num_remove);
+    copy.clear();
+    TREE_CHECK(copy.stats().num_free == _num_value && copy.stats().max_depth == 0U);
+    tree.reset_stats();
+    TREE_CHECK(tree.stats().num_insert == 0U && tree.stats().num_rotation == 0U);
+
+    //disabled statistics report nothing.
+    red_black_tree<int> plain { 1, 2, 3 };
+    TREE_CHECK(plain.stats().num_insert == 0U && plain.stats().num_rotation == 0U);
+}
+
+int main(int argc, char* argv[]) {
+    const size_t num_step = argc > 1 ? static_cast<size_t>(std::atoll(argv[1])) : 100000U;
+    run_mutable_suite<red_black_tree<int>>("red_black_tree", num_step);
+    for (unsigned seed = 1U; seed <= 3U; ++seed) {
+        run_iterator_remove(seed, num_step / 10U);
+    }
+    run_stats(num_step / 10U);
+    std::printf("red_black_tree_test passed\n");
+    return 0;
+}
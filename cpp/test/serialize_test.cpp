@@ -0,0 +1,174 @@
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <random>
+#include <set>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "ordered_set_check.hpp"
+#include "../bst.hpp"
+#include "../tree_exceptions.hpp"
+
+//round trip test of serialize and deserialize of binary_search_tree against std::set.
+//usage : serialize_test [num_values]
+//trees of sizes around the chunk boundary, random and degenerate ones, are written and read back. loaded tree must
+//hold the same values, be perfectly balanced and keep working under random insert and remove. truncated, corrupted,
+//unordered or foreign streams must throw tree_format_exception and leave the target tree unchanged.
+//exit code is non zero on the first mismatch.
+
+using namespace snowapril;
+using namespace snowapril::test;
+
+//header layout of serialized stream : magic[8], version, byte order, value size, node count.
+constexpr size_t header_size       = 32U;
+constexpr size_t num_node_offset   = 24U;
+constexpr size_t int_chunk_size    = 64U * 1024U / sizeof(int);
+
+//return the number of levels of perfectly balanced tree with given number of nodes.
+size_t balanced_height(size_t _num_node) {
+    size_t height = 0U;
+    while ((size_t(1U) << height) <= _num_node) ++height;
+    return height;
+}
+
+template <typename Tree>
+size_t tree_height(Tree const & _tree) {
+    size_t height = 0U;
+    for (auto iter = _tree.begin(); iter != _tree.end(); ++iter) {
+        height = std::max(height, _tree.height(iter.downside()));
+    }
+    return height;
+}
+
+template <typename Tree>
+std::string serialized(Tree const & _tree) {
+    std::ostringstream stream;
+    _tree.serialize(stream);
+    TREE_CHECK(stream.good());
+    return stream.str();
+}
+
+template <typename Tree>
+void check_round_trip(Tree const & _source, std::set<int> const & _expected, std::mt19937& _rng) {
+    std::string bytes = serialized(_source);
+    TREE_CHECK(bytes.size() == header_size + _expected.size() * sizeof(int));
+    //target holds other values, which are replaced.
+    Tree loaded { -3, -2, -1 };
+    std::istringstream stream(bytes);
+    loaded.deserialize(stream);
+    check_contents(loaded, _expected);
+    TREE_CHECK(tree_height(loaded) == balanced_height(_expected.size()));
+    TREE_CHECK(serialized(loaded) == bytes);
+    std::set<int> churned = _expected;
+    const int key_range = static_cast<int>(_expected.size() * 2U + 2U);
+    for (size_t step = 0U; step < 512U; ++step) {
+        int key = static_cast<int>(_rng() % static_cast<unsigned>(key_range));
+        if (_rng() % 2U) TREE_CHECK(insert_key(loaded, key) == churned.insert(key).second);
+        else             TREE_CHECK(remove_key(loaded, key) == churned.erase(key));
+    }
+    check_contents(loaded, churned);
+}
+
+template <typename Tree>
+void run_round_trip(char const *_name, unsigned _seed, size_t _num_value) {
+    std::mt19937 rng(_seed);
+    begin_case(std::string(_name) + "/random " + std::to_string(_num_value), _seed);
+    Tree          source;
+    std::set<int> expected;
+    for (size_t i = 0U; i < _num_value; ++i) {
+        int value = static_cast<int>(rng() % static_cast<unsigned>(_num_value * 4U + 1U));
+        source.insert(value);
+        expected.insert(value);
+    }
+    check_round_trip(source, expected, rng);
+}
+
+//ascending inserts give a chain as deep as the tree is large, which would overflow stack of a recursive walk.
+template <typename Tree>
+void run_degenerate(char const *_name, size_t _num_value) {
+    begin_case(std::string(_name) + "/degenerate " + std::to_string(_num_value), 0U);
+    std::mt19937  rng(0U);
+    Tree          chain;
+    std::set<int> expected_chain;
+    for (size_t i = 0U; i < _num_value; ++i) {
+        chain.insert(static_cast<int>(i) * 3);
+        expected_chain.insert(static_cast<int>(i) * 3);
+    }
+    check_round_trip(chain, expected_chain, rng);
+}
+
+//deserialize given bytes into a non empty tree, which must throw and keep its contents.
+template <typename Tree>
+bool rejected(std::string const & _bytes) {
+    Tree target { 7, 11, 13 };
+    std::istringstream stream(_bytes);
+    bool thrown = false;
+    try         { target.deserialize(stream); }
+    catch (tree_format_exception const &) { thrown = true; }
+    check_contents(target, std::set<int> { 7, 11, 13 });
+    return thrown;
+}
+
+template <typename Tree>
+void run_broken(char const *_name, size_t _num_value) {
+    begin_case(std::string(_name) + "/broken " + std::to_string(_num_value), 0U);
+    Tree source;
+    for (size_t i = 0U; i < _num_value; ++i) {
+        source.insert(static_cast<int>(i * 7U % _num_value) * 2);
+    }
+    std::string bytes = serialized(source);
+    //every truncation, including ones in the middle of a chunk and at a chunk boundary.
+    for (size_t size : { size_t(0U), size_t(8U), header_size - 1U, header_size + 1U, header_size + int_chunk_size * sizeof(int), bytes.size() - 1U }) {
+        if (size >= bytes.size()) continue;
+        current_context().step = size;
+        TREE_CHECK(rejected<Tree>(bytes.substr(0U, size)));
+    }
+    //magic, version, byte order and value size fields.
+    for (size_t offset : { size_t(0U), size_t(8U), size_t(12U), size_t(16U) }) {
+        current_context().step = offset;
+        std::string broken = bytes;
+        broken[offset] = static_cast<char>(broken[offset] ^ 0x40);
+        TREE_CHECK(rejected<Tree>(broken));
+    }
+    //forged node count far beyond the stream must fail at end of stream, not in allocator.
+    std::string forged = bytes;
+    uint64_t num_node = uint64_t(1U) << 60;
+    std::memcpy(&forged[num_node_offset], &num_node, sizeof(num_node));
+    TREE_CHECK(rejected<Tree>(forged));
+    //values out of order, in the first chunk and across the chunk boundary.
+    for (size_t index : { size_t(1U), int_chunk_size }) {
+        if (index >= _num_value) continue;
+        current_context().step = index;
+        std::string unordered = bytes;
+        int first = 0;
+        std::memcpy(&unordered[header_size + index * sizeof(int)], &first, sizeof(first));
+        TREE_CHECK(rejected<Tree>(unordered));
+    }
+    //stream of other value type.
+    binary_search_tree<long long> wide { 1LL, 2LL, 3LL };
+    TREE_CHECK(rejected<Tree>(serialized(wide)));
+    std::istringstream stream(bytes);
+    Tree loaded;
+    loaded.deserialize(stream);
+    TREE_CHECK(loaded.size() == _num_value && serialized(loaded) == bytes);
+}
+
+int main(int argc, char* argv[]) {
+    const size_t max_value = argc > 1 ? static_cast<size_t>(std::atoll(argv[1])) : 50000U;
+    for (unsigned seed = 1U; seed <= 3U; ++seed) {
+        for (size_t num_value : { size_t(0U), size_t(1U), size_t(17U), int_chunk_size - 1U, int_chunk_size, int_chunk_size + 1U, max_value }) {
+            run_round_trip<binary_search_tree<int>>("binary_search_tree", seed, num_value);
+            run_round_trip<order_statistic_tree<int>>("order_statistic_tree", seed, num_value);
+        }
+    }
+    //building a chain is quadratic, so it is kept short.
+    run_degenerate<binary_search_tree<int>>("binary_search_tree", 10000U);
+    run_degenerate<order_statistic_tree<int>>("order_statistic_tree", 10000U);
+    for (size_t num_value : { size_t(1U), size_t(100U), int_chunk_size * 2U + 3U }) {
+        run_broken<binary_search_tree<int>>("binary_search_tree", num_value);
+    }
+    std::printf("serialize_test passed\n");
+    return 0;
+}
@@ -0,0 +1,188 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <iterator>
+#include <memory>
+#include <random>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+#include "ordered_set_check.hpp"
+#include "../bst.hpp"
+#include "../pool_allocator.hpp"
+
+//differential test of split, join, merge and set algebra of binary_search_tree against std::set and std::set_*.
+//usage : set_algebra_test [num_rounds]
+//operands are built by bulk_load, so they live in node blocks, or by insert, so every node is allocated alone.
+//results hold nodes of both operands, and keep changing afterwards with random insert and remove, which recycles
+//free slots of shared blocks. trees are destroyed in random order, so a block must outlive every tree holding it.
+//exit code is non zero on the first mismatch.
+
+using namespace snowapril;
+using namespace snowapril::test;
+
+//random insert and remove on given tree, compared with std::set.
+template <typename Tree>
+void churn(Tree& _tree, std::set<int>& _expected, std::mt19937& _rng, int _key_range) {
+    for (size_t step = 0U; step < 128U; ++step) {
+        int key = static_cast<int>(_rng() % static_cast<unsigned>(_key_range));
+        if (_rng() % 2U) TREE_CHECK(insert_key(_tree, key) == _expected.insert(key).second);
+        else             TREE_CHECK(remove_key(_tree, key) == _expected.erase(key));
+    }
+    check_contents(_tree, _expected);
+}
+
+//tree with its expected contents, destroyed in random order at the end of a round.
+template <typename Tree>
+struct operand {
+    std::unique_ptr<Tree> tree;
+    std::set<int>         expected;
+};
+
+template <typename Tree, typename Allocator>
+operand<Tree> make_operand(std::mt19937& _rng, Allocator const & _alloc, size_t _num_value, int _lo, int _hi) {
+    operand<Tree> result { std::make_unique<Tree>(std::less<int>(), _alloc), std::set<int>() };
+    std::vector<int> values(_num_value);
+    for (int& value : values) {
+        value = _lo + static_cast<int>(_rng() % static_cast<unsigned>(_hi - _lo));
+    }
+    result.expected.insert(values.begin(), values.end());
+    if (_rng() % 2U) {
+        std::sort(values.begin(), values.end());
+        result.tree->bulk_load(values.begin(), values.end());
+    } else {
+        for (int value : values) {
+            result.tree->insert(value);
+        }
+    }
+    return result;
+}
+
+template <typename Set, typename Operation>
+std::set<int> expected_of(Set const & _lhs, Set const & _rhs, Operation _operation) {
+    std::vector<int> result;
+    _operation(_lhs.begin(), _lhs.end(), _rhs.begin(), _rhs.end(), std::back_inserter(result));
+    return std::set<int>(result.begin(), result.end());
+}
+
+template <typename Tree>
+void run_round(char const *_name, unsigned _seed, size_t _num_value) {
+    std::mt19937 rng(_seed);
+    const int key_range = static_cast<int>(_num_value * 2U + 2U);
+    //every tree of a round shares one allocator, which is one pool for pool_allocator, so they can exchange nodes.
+    const auto alloc = Tree().get_allocator();
+    std::vector<operand<Tree>> operands;
+
+    begin_case(std::string(_name) + "/split " + std::to_string(_num_value), _seed);
+    operands.push_back(make_operand<Tree>(rng, alloc, _num_value, 0, key_range));
+    for (int pivot : { -1, 0, key_range / 3, key_range / 2, key_range }) {
+        operand<Tree>& whole = operands.front();
+        operand<Tree>  upper { std::make_unique<Tree>(whole.tree->split(pivot)), std::set<int>() };
+        upper.expected.insert(whole.expected.lower_bound(pivot), whole.expected.end());
+        whole.expected.erase(whole.expected.lower_bound(pivot), whole.expected.end());
+        check_contents(*whole.tree, whole.expected);
+        check_contents(*upper.tree, upper.expected);
+
+        //join restores the tree, and rejects a range which overlaps it.
+        if (!whole.expected.empty() && !upper.expected.empty()) {
+            Tree overlapping(std::less<int>(), alloc);
+            overlapping.insert(*whole.expected.begin());
+            bool thrown = false;
+            try         { upper.tree->join(std::move(overlapping)); }
+            catch (std::invalid_argument const &) { thrown = true; }
+            TREE_CHECK(thrown);
+            check_contents(*upper.tree, upper.expected);
+        }
+        whole.tree->join(std::move(*upper.tree));
+        whole.expected.insert(upper.expected.begin(), upper.expected.end());
+        check_contents(*whole.tree, whole.expected);
+        check_contents(*upper.tree, std::set<int>());
+    }
+    //split parts keep living on their own, while their blocks are shared.
+    {
+        operand<Tree>& whole = operands.front();
+        operand<Tree>  upper { std::make_unique<Tree>(whole.tree->split(key_range / 2)), std::set<int>() };
+        upper.expected.insert(whole.expected.lower_bound(key_range / 2), whole.expected.end());
+        whole.expected.erase(whole.expected.lower_bound(key_range / 2), whole.expected.end());
+        churn(*whole.tree, whole.expected, rng, key_range);
+        churn(*upper.tree, upper.expected, rng, key_range);
+        operands.push_back(std::move(upper));
+    }
+
+    begin_case(std::string(_name) + "/merge " + std::to_string(_num_value), _seed);
+    {
+        operand<Tree> lhs = make_operand<Tree>(rng, alloc, _num_value, 0, key_range);
+        operand<Tree> rhs = make_operand<Tree>(rng, alloc, _num_value, key_range / 4, key_range);
+        std::set<int> duplicated = expected_of(lhs.expected, rhs.expected, [](auto... _args) { return std::set_intersection(_args...); });
+        lhs.tree->merge(*rhs.tree);
+        lhs.expected.insert(rhs.expected.begin(), rhs.expected.end());
+        rhs.expected = duplicated;
+        check_contents(*lhs.tree, lhs.expected);
+        check_contents(*rhs.tree, rhs.expected);
+        churn(*lhs.tree, lhs.expected, rng, key_range);
+        churn(*rhs.tree, rhs.expected, rng, key_range);
+        operands.push_back(std::move(lhs));
+        operands.push_back(std::move(rhs));
+    }
+
+    const char* names[] = { "union", "intersection", "difference" };
+    for (int operation = 0; operation < 3; ++operation) {
+        begin_case(std::string(_name) + "/" + names[operation] + " " + std::to_string(_num_value), _seed);
+        //operands of very different sizes take the m log(n/m + 1) path from either side.
+        size_t lhs_size = rng() % 2U ? _num_value : _num_value / 16U;
+        operand<Tree> lhs = make_operand<Tree>(rng, alloc, lhs_size, 0, key_range);
+        operand<Tree> rhs = make_operand<Tree>(rng, alloc, _num_value + _num_value / 16U - lhs_size, key_range / 4, key_range);
+        std::set<int> expected;
+        switch (operation) {
+        case 0:
+            expected = expected_of(lhs.expected, rhs.expected, [](auto... _args) { return std::set_union(_args...); });
+            lhs.tree->set_union(std::move(*rhs.tree));
+            break;
+        case 1:
+            expected = expected_of(lhs.expected, rhs.expected, [](auto... _args) { return std::set_intersection(_args...); });
+            lhs.tree->set_intersection(std::move(*rhs.tree));
+            break;
+        default:
+            expected = expected_of(lhs.expected, rhs.expected, [](auto... _args) { return std::set_difference(_args...); });
+            lhs.tree->set_difference(std::move(*rhs.tree));
+            break;
+        }
+        lhs.expected = expected;
+        rhs.expected.clear();
+        check_contents(*lhs.tree, lhs.expected);
+        check_contents(*rhs.tree, rhs.expected);
+        churn(*lhs.tree, lhs.expected, rng, key_range);
+        churn(*rhs.tree, rhs.expected, rng, key_range);
+        //copy of a result lives in its own nodes.
+        operand<Tree> copy { std::make_unique<Tree>(*lhs.tree, alloc), lhs.expected };
+        churn(*copy.tree, copy.expected, rng, key_range);
+        operands.push_back(std::move(lhs));
+        operands.push_back(std::move(rhs));
+        operands.push_back(std::move(copy));
+    }
+
+    begin_case(std::string(_name) + "/destroy " + std::to_string(_num_value), _seed);
+    std::shuffle(operands.begin(), operands.end(), rng);
+    while (!operands.empty()) {
+        for (operand<Tree> const & remaining : operands) {
+            check_contents(*remaining.tree, remaining.expected);
+        }
+        operands.pop_back();
+    }
+}
+
+int main(int argc, char* argv[]) {
+    const unsigned num_round = argc > 1 ? static_cast<unsigned>(std::atoi(argv[1])) : 20U;
+    using pool_tree = binary_search_tree<int, std::less<int>, pool_allocator<bst_node_<int>>>;
+    for (unsigned seed = 1U; seed <= num_round; ++seed) {
+        for (size_t num_value : { 0U, 1U, 17U, 256U, 4096U }) {
+            run_round<binary_search_tree<int>>("binary_search_tree", seed, num_value);
+            run_round<order_statistic_tree<int>>("order_statistic_tree", seed, num_value);
+            run_round<pool_tree>("binary_search_tree/pool_allocator", seed, num_value);
+        }
+    }
+    std::printf("set_algebra_test passed\n");
+    return 0;
+}
@@ -0,0 +1,121 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <set>
+#include <vector>
+#include "ordered_set_check.hpp"
+#include "../splay_tree.hpp"
+#include "../tree_stats.hpp"
+
+//differential test of splay_tree against std::set.
+//usage : splay_tree_test [num_steps]
+//random insert, remove and lookup sequences are compared with std::set (see ordered_set_check.hpp), with and without
+//counting statistics policy. elements are removed through iterators while walking, and removing end() changes
+//nothing. height must equal the largest depth, and neither depth nor height may splay or count as searches.
+//deep key accessed once must be lifted to at most half of its old depth, and no key may sink by its own access.
+//exit code is non zero on the first mismatch.
+
+using namespace snowapril;
+using namespace snowapril::test;
+
+using counting_tree = splay_tree<int, std::less<int>, std::allocator<bst_node_<int>>, counting_tree_stats_>;
+
+//return depth of every element of std::set order, taken without touching the tree shape.
+std::vector<size_t> all_depths(counting_tree const & _tree, std::set<int> const & _expected) {
+    std::vector<size_t> depths;
+    for (int value : _expected) depths.push_back(_tree.depth(value));
+    return depths;
+}
+
+void run_iterator_remove(unsigned _seed, size_t _num_value) {
+    begin_case("splay_tree/iterator_remove", _seed);
+    std::mt19937     rng(_seed);
+    splay_tree<int>  tree;
+    std::set<int>    expected;
+    for (size_t i = 0U; i < _num_value; ++i) {
+        int key = static_cast<int>(rng() % static_cast<unsigned>(_num_value * 2U));
+        tree.insert(key);
+        expected.insert(key);
+    }
+    //end() is not an element, so removing it changes nothing.
+    TREE_CHECK(tree.remove(tree.end()) == tree.end());
+    check_contents(tree, expected);
+
+    auto iter          = tree.begin();
+    auto expected_iter = expected.begin();
+    while (iter != tree.end()) {
+        current_context().step = static_cast<size_t>(*iter);
+        if (rng() % 3U) {
+            iter          = tree.remove(iter);
+            expected_iter = expected.erase(expected_iter);
+        }
+        else {
+            ++iter;
+            ++expected_iter;
+        }
+        TREE_CHECK(same_position(iter, tree.end(), expected_iter, expected.end()));
+    }
+    check_contents(tree, expected);
+    while (!tree.empty()) {
+        tree.remove(tree.begin());
+    }
+    TREE_CHECK(tree.remove(tree.end()) == tree.end() && tree.height() == 0U);
+}
+
+void run_shape(unsigned _seed, size_t _num_value) {
+    begin_case("splay_tree/shape", _seed);
+    std::mt19937  rng(_seed);
+    counting_tree tree;
+    std::set<int> expected;
+    //ascending inserts leave a long left path, since new maximum stays above the threshold depth.
+    for (size_t i = 0U; i < _num_value; ++i) {
+        int key = static_cast<int>(i) * 2;
+        tree.insert(key);
+        expected.insert(key);
+    }
+    for (size_t step = 0U; step < _num_value; ++step) {
+        current_context().step = step;
+        int key = static_cast<int>(rng() % static_cast<unsigned>(_num_value * 2U));
+        if (rng() % 4U == 0U) {
+            TREE_CHECK(remove_key(tree, key) == expected.erase(key));
+            continue;
+        }
+        //depth, height and their walks are read only, so shape and statistics stay as they were.
+        tree_stats_snapshot before = tree.stats();
+        std::vector<size_t> depths = all_depths(tree, expected);
+        size_t              height = tree.height();
+        TREE_CHECK(tree.depth(-1) == 0U && tree.depth(key | 1) == 0U);
+        TREE_CHECK(all_depths(tree, expected) == depths && tree.height() == height);
+        TREE_CHECK(tree.stats().num_search == before.num_search && tree.stats().num_rotation == before.num_rotation);
+        TREE_CHECK(height == (depths.empty() ? 0U : *std::max_element(depths.begin(), depths.end())));
+
+        size_t old_depth = tree.depth(key);
+        TREE_CHECK((old_depth != 0U) == (expected.count(key) == 1U));
+        TREE_CHECK(tree.contains(key) == (old_depth != 0U));
+        size_t new_depth = tree.depth(key);
+        size_t num_level = 0U;
+        for (size_t num = tree.size(); num; num >>= 1U) ++num_level;
+        if (old_depth > num_level + num_level / 4U) {
+            //semi-splay halves the access path, zig-zag steps may lift the node further.
+            TREE_CHECK(new_depth <= old_depth / 2U + 1U && tree.stats().num_rotation > before.num_rotation);
+        }
+        else {
+            //descent goes on below a match to the leaf, so shallow key may still be moved, but never down.
+            TREE_CHECK(new_depth <= old_depth);
+        }
+    }
+    check_contents(tree, expected);
+}
+
+int main(int argc, char* argv[]) {
+    const size_t num_step = argc > 1 ? static_cast<size_t>(std::atoll(argv[1])) : 100000U;
+    run_mutable_suite<splay_tree<int>>("splay_tree", num_step);
+    run_mutable_suite<counting_tree>("splay_tree/counting_tree_stats_", num_step / 4U);
+    for (unsigned seed = 1U; seed <= 3U; ++seed) {
+        run_iterator_remove(seed, num_step / 10U);
+        run_shape(seed, 2000U);
+    }
+    std::printf("splay_tree_test passed\n");
+    return 0;
+}
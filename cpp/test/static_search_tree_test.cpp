@@ -0,0 +1,71 @@
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <functional>
+#include <set>
+#include <vector>
+#include "ordered_set_check.hpp"
+#include "../bst.hpp"
+#include "../static_search_tree.hpp"
+
+//differential test of static_search_tree against std::set.
+//usage : static_search_tree_test [max_log_size]
+//trees are built from random ranges with duplicates, from sorted unique ranges and from binary_search_tree
+//snapshots, with sizes of every power of four up to the given limit, so the last level of the implicit tree is
+//filled to every degree. every key of the range and past both ends is looked up, singly and in batches.
+//exit code is non zero on the first mismatch.
+
+using namespace snowapril;
+using namespace snowapril::test;
+
+void run_static(unsigned _seed, size_t _num_value, int _key_range) {
+    std::vector<int> values = random_values(_seed, _num_value, _key_range);
+    std::set<int> expected(values.begin(), values.end());
+
+    begin_case("static_search_tree/range", _seed);
+    static_search_tree<int> tree(values.begin(), values.end());
+    check_read_only(tree, expected, _key_range);
+
+    begin_case("static_search_tree/sorted", _seed);
+    std::vector<int> unique_values(expected.begin(), expected.end());
+    check_read_only(static_search_tree<int>(sorted_input, unique_values.begin(), unique_values.end()), expected, _key_range);
+
+    begin_case("static_search_tree/snapshot", _seed);
+    binary_search_tree<int> source;
+    for (int value : values) {
+        source.insert(value);
+    }
+    check_read_only(static_search_tree<int>(source), expected, _key_range);
+
+    //copy owns its own array, so it outlives the source.
+    begin_case("static_search_tree/copy", _seed);
+    static_search_tree<int> copy;
+    {
+        static_search_tree<int> dying(tree);
+        copy = dying;
+    }
+    check_read_only(copy, expected, _key_range);
+
+    begin_case("static_search_tree/greater", _seed);
+    static_search_tree<int, std::greater<int>> reversed(values.begin(), values.end());
+    TREE_CHECK(reversed.size() == expected.size());
+    TREE_CHECK(std::equal(reversed.begin(), reversed.end(), expected.rbegin(), expected.rend()));
+    for (int key = -1; key <= _key_range; ++key) {
+        auto iter = reversed.lower_bound(key);
+        auto expected_iter = std::lower_bound(expected.rbegin(), expected.rend(), key, std::greater<int>());
+        TREE_CHECK(same_position(iter, reversed.end(), expected_iter, expected.rend()));
+    }
+}
+
+int main(int argc, char* argv[]) {
+    const unsigned max_log_size = argc > 1 ? static_cast<unsigned>(std::atoi(argv[1])) : 16U;
+    for (unsigned seed = 1U; seed <= 6U; ++seed) {
+        for (unsigned log_size = 0U; log_size <= max_log_size; log_size += 2U) {
+            run_static(seed, size_t(1U) << log_size, 1 << (log_size / 2U + 4U));
+        }
+    }
+    begin_case("static_search_tree/empty", 0U);
+    check_read_only(static_search_tree<int>(), std::set<int>(), 4);
+    std::printf("static_search_tree_test passed\n");
+    return 0;
+}
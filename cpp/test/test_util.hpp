@@ -0,0 +1,99 @@
+#ifndef TEST_UTIL_HPP
+#define TEST_UTIL_HPP
+
+/**
+* @file      test_util.hpp
+* @author    snowapril
+* @date      2026-10-17
+* @brief     minimal checking helpers shared by differential test programs.
+* @details   each test is a standalone translation unit which runs random operation sequences against a tree and
+             a standard container side by side. the first mismatch prints the case, seed and step and exits non zero.
+             build it with optimization, e.g. g++ -std=c++17 -O2 -I.. bst_test.cpp
+*/
+
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+
+namespace snowapril {
+namespace test {
+
+    //what is running now. printed with every failure, so a mismatch can be replayed from its seed and step.
+    struct test_context {
+        std::string   name;
+        unsigned      seed = 0U;
+        size_t        step = 0U;
+    };
+
+    inline test_context& current_context() {
+        static test_context context;
+        return context;
+    }
+
+    inline void begin_case(std::string const & _name, unsigned _seed) {
+        test_context& context = current_context();
+        context.name = _name;
+        context.seed = _seed;
+        context.step = 0U;
+    }
+
+    [[noreturn]] inline void fail(char const *_file, int _line, char const *_expr) {
+        test_context const & context = current_context();
+        std::fprintf(stderr, "%s:%d: check failed: %s\n  case %s, seed %u, step %zu\n",
+                     _file, _line, _expr, context.name.c_str(), context.seed, context.step);
+        std::exit(EXIT_FAILURE);
+    }
+
+    //key distributions of operation sequences. random keys from a small range make inserts and removes collide,
+    //ascending and descending ones are adversarial input for unbalanced trees.
+    enum class key_order { random, ascending, descending };
+
+    inline char const* key_order_name(key_order _order) {
+        switch (_order) {
+        case key_order::ascending:  return "ascending";
+        case key_order::descending: return "descending";
+        default:                    return "random";
+        }
+    }
+
+    //return key of given step. ordered sequences wrap around key range, so later rounds hit existing keys.
+    inline int next_key(key_order _order, std::mt19937& _rng, size_t _step, int _key_range) {
+        switch (_order) {
+        case key_order::ascending:  return static_cast<int>(_step % static_cast<size_t>(_key_range));
+        case key_order::descending: return _key_range - 1 - static_cast<int>(_step % static_cast<size_t>(_key_range));
+        default:                    return static_cast<int>(_rng() % static_cast<unsigned>(_key_range));
+        }
+    }
+
+    //return whether if forward and backward walks of given range both match given standard container.
+    template <typename Iterator, typename Container>
+    bool same_sequence(Iterator _begin, Iterator _end, Container const & _expected) {
+        auto expected = _expected.begin();
+        for (Iterator iter = _begin; iter != _end; ++iter, ++expected) {
+            if (expected == _expected.end() || !(*iter == *expected)) return false;
+        }
+        if (expected != _expected.end()) return false;
+        auto reverse_expected = _expected.rbegin();
+        for (Iterator iter = _end; iter != _begin; ++reverse_expected) {
+            --iter;
+            if (reverse_expected == _expected.rend() || !(*iter == *reverse_expected)) return false;
+        }
+        return reverse_expected == _expected.rend();
+    }
+
+    //return whether if iterator of a tree and iterator of a standard container point to the same element,
+    //or both are past the end.
+    template <typename Iterator, typename ExpectedIterator>
+    bool same_position(Iterator _iter, Iterator _end, ExpectedIterator _expected, ExpectedIterator _expected_end) {
+        if ((_iter == _end) != (_expected == _expected_end)) return false;
+        return _iter == _end || *_iter == *_expected;
+    }
+}
+}
+
+//check given condition and exit with the current case on failure. active in release builds as well.
+#define TREE_CHECK(...) ((__VA_ARGS__) ? static_cast<void>(0) : ::snowapril::test::fail(__FILE__, __LINE__, #__VA_ARGS__))
+
+#endif
@@ -10,6 +10,20 @@ namespace snowapril {
         explicit different_tree_exception(const char *_what_arg)        : std::runtime_error(_what_arg) {};
         virtual ~different_tree_exception() throw() {};
     };
+
+    class reader_limit_exception : public std::runtime_error {
+    public:
+        explicit reader_limit_exception(const std::string& _what_arg) : std::runtime_error(_what_arg) {};
+        explicit reader_limit_exception(const char *_what_arg)        : std::runtime_error(_what_arg) {};
+        virtual ~reader_limit_exception() throw() {};
+    };
+
+    class tree_format_exception : public std::runtime_error {
+    public:
+        explicit tree_format_exception(const std::string& _what_arg) : std::runtime_error(_what_arg) {};
+        explicit tree_format_exception(const char *_what_arg)        : std::runtime_error(_what_arg) {};
+        virtual ~tree_format_exception() throw() {};
+    };
 }
 
 #endif
\ No newline at end of file
@@ -0,0 +1,233 @@
+#ifndef TREE_STATS_HPP
+#define TREE_STATS_HPP
+
+/**
+* @file      tree_stats.hpp
+* @author    snowapril
+* @date      2026-10-17 (ongoing)
+* @brief     compile time selectable statistics policies of tree hot paths.
+* @details   header only. tree calls hooks of its statistics policy on search, link, unlink, node construction and
+             rotation, and B+ tree calls split and merge hooks on node overflow and underflow. no_tree_stats_ has empty hooks and no state, and tree keeps it as empty base, so disabled
+             statistics add neither instruction nor byte to the tree.
+             counting_tree_stats_ keeps relaxed atomic counters updated with plain load and store instead of
+             read-modify-write, so hooks cost as much as ordinary increments and metrics exporter may take
+             snapshot from any thread at any time. tree is not thread safe for writers anyway, but concurrent readers
+             of one tree may lose some counts of each other.
+             path length histogram has log2 buckets, so tree which degenerates shows up as counts in buckets
+             far above log2(size) long before average latency moves. it is the degeneration signal to watch, best
+             read per export window with reset in between. max_depth is only the high-water mark of those paths,
+             not the current height of the tree.
+* @see       bst.hpp
+*/
+
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+
+namespace snowapril {
+
+    //copy of every statistics counter at one moment.
+    struct tree_stats_snapshot {
+        //bucket 0 counts empty paths and bucket k counts paths of [2^(k-1), 2^k) nodes.
+        static constexpr size_t num_path_bucket = 64U;
+
+        uint64_t num_search     = 0U; //descents from root by lookup, insert and remove
+        uint64_t num_visit      = 0U; //nodes visited by those descents
+        uint64_t num_compare    = 0U; //comparisons made by descents and their equivalence checks
+        uint64_t num_insert     = 0U; //nodes linked by insert
+        uint64_t num_remove     = 0U; //nodes unlinked by remove and extract
+        uint64_t num_alloc      = 0U; //nodes constructed, including bulk built and copied ones
+        uint64_t num_free       = 0U; //nodes destroyed
+        uint64_t num_alloc_call = 0U; //calls to allocator, for single node or node block
+        uint64_t num_rotation   = 0U; //rotations of balancing or self-adjusting trees, and borrows of B+ tree
+        uint64_t num_split      = 0U; //overflowed B+ tree nodes split in two
+        uint64_t num_merge      = 0U; //underflowed B+ tree nodes merged with sibling
+        //nodes on the deepest path seen by search, insert or bulk build since last reset, clear or rebuild.
+        //it is history, not shape. remove never lowers it, and split, join and set operations carry it over
+        //from the source trees, so it may stay above current height until the next reset.
+        uint64_t max_depth      = 0U;
+        std::array<uint64_t, num_path_bucket> path_histogram {};
+
+        //return bucket of path histogram which counts paths of given number of nodes.
+        static size_t bucket_of(size_t);
+        //return average number of nodes visited per search.
+        double average_path_length() const;
+    };
+
+    //statistics disabled. every hook is empty, so calls vanish after inlining.
+    struct no_tree_stats_ {
+        static constexpr bool enabled = false;
+        void record_search(size_t) const { }
+        void record_compare(size_t) const { }
+        void record_insert() const { }
+        void record_remove() const { }
+        void record_alloc(size_t) const { }
+        void record_free(size_t) const { }
+        void record_alloc_call() const { }
+        void record_rotation(size_t) const { }
+        void record_split(size_t) const { }
+        void record_merge(size_t) const { }
+        void record_depth(size_t) const { }
+        void reset_depth(size_t) const { }
+        size_t recorded_depth() const { return 0U; }
+        tree_stats_snapshot snapshot() const { return tree_stats_snapshot(); }
+        void reset() { }
+    };
+
+    //statistics enabled. counters are relaxed atomics written by single writer through load and store.
+    class counting_tree_stats_ {
+    public:
+        static constexpr bool enabled = true;
+        counting_tree_stats_() = default;
+        //counters belong to one tree, so copy and move of tree start from zero.
+        counting_tree_stats_(counting_tree_stats_ const &) : counting_tree_stats_() { }
+        counting_tree_stats_ & operator=(counting_tree_stats_ const &) { return *this; }
+
+        //search from root visited given number of nodes, making one comparison per node.
+        void record_search(size_t) const;
+        //given number of comparisons out of descent, e.g. equivalence check of found node.
+        void record_compare(size_t) const;
+        //node was linked one level below the last node of the latest search.
+        void record_insert() const;
+        void record_remove() const;
+        void record_alloc(size_t) const;
+        void record_free(size_t) const;
+        void record_alloc_call() const;
+        void record_rotation(size_t) const;
+        void record_split(size_t) const;
+        void record_merge(size_t) const;
+        //raise max depth to given number of levels, if it is lower.
+        void record_depth(size_t) const;
+        //set max depth to given number of levels after rebuild or clear.
+        void reset_depth(size_t) const;
+        //return max depth without taking whole snapshot, e.g. to carry it over to tree made of the same nodes.
+        size_t recorded_depth() const;
+        tree_stats_snapshot snapshot() const;
+        //reset every counter, including max depth.
+        void reset();
+    private:
+        using counter_type = std::atomic<uint64_t>;
+        static void _internal_add(counter_type &, uint64_t);
+    private:
+        mutable counter_type num_search     { 0U };
+        mutable counter_type num_visit      { 0U };
+        mutable counter_type num_compare    { 0U };
+        mutable counter_type num_insert     { 0U };
+        mutable counter_type num_remove     { 0U };
+        mutable counter_type num_alloc      { 0U };
+        mutable counter_type num_free       { 0U };
+        mutable counter_type num_alloc_call { 0U };
+        mutable counter_type num_rotation   { 0U };
+        mutable counter_type num_split      { 0U };
+        mutable counter_type num_merge      { 0U };
+        mutable counter_type max_depth      { 0U };
+        //nodes visited by the latest search, which gives depth of node linked right after it.
+        mutable counter_type last_path      { 0U };
+        mutable std::array<counter_type, tree_stats_snapshot::num_path_bucket> path_histogram {};
+    };
+
+    inline size_t tree_stats_snapshot::bucket_of(size_t _path_length) {
+        size_t bucket = 0U;
+        for (; _path_length; _path_length >>= 1U) ++bucket;
+        return bucket;
+    }
+
+    inline double tree_stats_snapshot::average_path_length() const {
+        return num_search ? static_cast<double>(num_visit) / static_cast<double>(num_search) : 0.0;
+    }
+
+    inline void counting_tree_stats_::_internal_add(counter_type & _counter, uint64_t _delta) {
+        _counter.store(_counter.load(std::memory_order_relaxed) + _delta, std::memory_order_relaxed);
+    }
+
+    inline void counting_tree_stats_::record_search(size_t _path_length) const {
+        _internal_add(num_search, 1U);
+        _internal_add(num_visit, _path_length);
+        _internal_add(num_compare, _path_length);
+        _internal_add(path_histogram[tree_stats_snapshot::bucket_of(_path_length)], 1U);
+        last_path.store(_path_length, std::memory_order_relaxed);
+        record_depth(_path_length);
+    }
+
+    inline void counting_tree_stats_::record_compare(size_t _count) const {
+        _internal_add(num_compare, _count);
+    }
+
+    inline void counting_tree_stats_::record_insert() const {
+        _internal_add(num_insert, 1U);
+        record_depth(static_cast<size_t>(last_path.load(std::memory_order_relaxed)) + 1U);
+    }
+
+    inline void counting_tree_stats_::record_remove() const {
+        _internal_add(num_remove, 1U);
+    }
+
+    inline void counting_tree_stats_::record_alloc(size_t _count) const {
+        _internal_add(num_alloc, _count);
+    }
+
+    inline void counting_tree_stats_::record_free(size_t _count) const {
+        _internal_add(num_free, _count);
+    }
+
+    inline void counting_tree_stats_::record_alloc_call() const {
+        _internal_add(num_alloc_call, 1U);
+    }
+
+    inline void counting_tree_stats_::record_rotation(size_t _count) const {
+        _internal_add(num_rotation, _count);
+    }
+
+    inline void counting_tree_stats_::record_split(size_t _count) const {
+        _internal_add(num_split, _count);
+    }
+
+    inline void counting_tree_stats_::record_merge(size_t _count) const {
+        _internal_add(num_merge, _count);
+    }
+
+    inline void counting_tree_stats_::record_depth(size_t _depth) const {
+        if (max_depth.load(std::memory_order_relaxed) < _depth) max_depth.store(_depth, std::memory_order_relaxed);
+    }
+
+    inline void counting_tree_stats_::reset_depth(size_t _depth) const {
+        max_depth.store(_depth, std::memory_order_relaxed);
+    }
+
+    inline size_t counting_tree_stats_::recorded_depth() const {
+        return static_cast<size_t>(max_depth.load(std::memory_order_relaxed));
+    }
+
+    inline tree_stats_snapshot counting_tree_stats_::snapshot() const {
+        tree_stats_snapshot result;
+        result.num_search     = num_search.load(std::memory_order_relaxed);
+        result.num_visit      = num_visit.load(std::memory_order_relaxed);
+        result.num_compare    = num_compare.load(std::memory_order_relaxed);
+        result.num_insert     = num_insert.load(std::memory_order_relaxed);
+        result.num_remove     = num_remove.load(std::memory_order_relaxed);
+        result.num_alloc      = num_alloc.load(std::memory_order_relaxed);
+        result.num_free       = num_free.load(std::memory_order_relaxed);
+        result.num_alloc_call = num_alloc_call.load(std::memory_order_relaxed);
+        result.num_rotation   = num_rotation.load(std::memory_order_relaxed);
+        result.num_split      = num_split.load(std::memory_order_relaxed);
+        result.num_merge      = num_merge.load(std::memory_order_relaxed);
+        result.max_depth      = max_depth.load(std::memory_order_relaxed);
+        for (size_t bucket = 0U; bucket < tree_stats_snapshot::num_path_bucket; ++bucket) {
+            result.path_histogram[bucket] = path_histogram[bucket].load(std::memory_order_relaxed);
+        }
+        return result;
+    }
+
+    inline void counting_tree_stats_::reset() {
+        for (counter_type* counter : { &num_search, &num_visit, &num_compare, &num_insert, &num_remove,
+                                       &num_alloc, &num_free, &num_alloc_call, &num_rotation, &num_split,
+                                       &num_merge, &max_depth }) {
+            counter->store(0U, std::memory_order_relaxed);
+        }
+        for (counter_type & counter : path_histogram) counter.store(0U, std::memory_order_relaxed);
+    }
+}
+
+#endif
@@ -8,4 +8,71 @@
 #define LOG(msg, exp) 
 #endif
 
+//hint processor to fetch cache line which contains given address, without blocking.
+#if defined(__GNUC__) || defined(__clang__)
+#define TREE_PREFETCH(addr) __builtin_prefetch(static_cast<void const*>(addr))
+#elif defined(_MSC_VER)
+#include <xmmintrin.h>
+#define TREE_PREFETCH(addr) _mm_prefetch(reinterpret_cast<char const*>(addr), _MM_HINT_T0)
+#else
+#define TREE_PREFETCH(addr)
+#endif
+
+#include <cstddef>
+#include <functional>
+#include <type_traits>
+#include <utility>
+
+namespace snowapril {
+    //number of searches which find_batch walks in lockstep. each search keeps one cache miss in flight, and this is
+    //a bit more than line fill buffers of current cores (10 to 16), so memory latency of the group overlaps.
+    constexpr size_t batch_lookup_width = 16U;
+
+    //true if Compare declares is_transparent, which allows lookup with key of other type than Type. (e.g. std::less<>)
+    template <typename Compare, typename = void>
+    struct is_transparent_compare_ : std::false_type { };
+
+    template <typename Compare>
+    struct is_transparent_compare_<Compare, std::void_t<typename Compare::is_transparent>> : std::true_type { };
+
+    //true if Type is arithmetic and Compare is standard ordering, so comparison has no side effect and
+    //search loop can select next node with conditional move.
+    template <typename Type, typename Compare>
+    struct is_branchless_compare_ : std::integral_constant<bool, std::is_arithmetic<Type>::value && (
+        std::is_same<Compare, std::less<Type>>::value || std::is_same<Compare, std::greater<Type>>::value ||
+        std::is_same<Compare, std::less<>>::value     || std::is_same<Compare, std::greater<>>::value)> { };
+
+    //node augmentation. augment is a base of every node and keeps data derived from the sub-tree of the node.
+    //update() recomputes the data of given node from its value and children, whose data are already up to date.
+    struct no_augment_ {
+        template <typename Node>
+        static void update(Node*) { }
+    };
+
+    //number of nodes in the sub-tree, for order statistic queries in O(height).
+    struct subtree_size_augment_ {
+        size_t subtree_size = 1U;
+        template <typename Node>
+        static void update(Node* _node) {
+            _node->subtree_size = 1U + (_node->left_node  ? _node->left_node->subtree_size  : 0U)
+                                     + (_node->right_node ? _node->right_node->subtree_size : 0U);
+        }
+    };
+
+    //summary of the sub-tree folded by given policy, which provides summary_type,
+    //static summary_type of(value) and associative static summary_type combine(summary, summary).
+    //summaries are combined in in-order, so combine does not need to be commutative.
+    template <typename Summary>
+    struct monoid_augment_ {
+        typename Summary::summary_type summary {};
+        template <typename Node>
+        static void update(Node* _node) {
+            typename Summary::summary_type summary = Summary::of(_node->value);
+            if (_node->left_node)  summary = Summary::combine(_node->left_node->summary, summary);
+            if (_node->right_node) summary = Summary::combine(summary, _node->right_node->summary);
+            _node->summary = std::move(summary);
+        }
+    };
+}
+
 #endif
\ No newline at end of file